@@ -7,6 +7,7 @@
 #include "hmc_windows_util.h"
 #include "hmc_shell_util.h"
 #include "./registr_v2.hpp"
+#include "./util/hmc_window_match.hpp"
 
 bool _________HMC___________;
 
@@ -2475,92 +2476,74 @@ string getWindowTextA(HWND hwnd)
  * @param info
  * - className 类名称
  * - titleName 标题
- * - isWindow 是否必须是win
- * - isCaseSensitive 大小写敏感
+ * - isWindow 只要可见的窗口 默认 true
+ * - isCaseSensitive 区分大小写 默认 false
+ * - options { mode: "exact" | "prefix" | "substring" | "glob" | "regex", limit: 最多返回的数量 }
  * @return napi_value
  */
 napi_value fn_findAllWindow(napi_env env, napi_callback_info info)
 {
     napi_status status;
-    size_t argc = 4;
-    napi_value args[4];
+    size_t argc = 5;
+    napi_value args[5];
     auto Results = hmc_napi_create_value::jsArray(env);
 
     status = $napi_get_cb_info(argc, args);
     assert(status == napi_ok);
 
-    if (argc != 4)
+    if (argc < 2)
     {
         return Results.toValue();
     }
 
-    bool flag_isWindow = (hmc_napi_type::isBoolean(env, args[2]) ? hmc_napi_get_value::boolean_bool(env, args[2]) : true);
-    bool flag_isCaseSensitive = (hmc_napi_type::isBoolean(env, args[3]) ? hmc_napi_get_value::boolean_bool(env, args[3]) : true);
-
-    wstring _className = (hmc_napi_type::isString(env, args[0]) ? hmc_napi_get_value::string_utf16(env, args[0]) : wstring(L""));
-    wstring _titleName = (hmc_napi_type::isString(env, args[1]) ? hmc_napi_get_value::string_utf16(env, args[1]) : wstring(L""));
-
-    //"\0title标题\0" ->  flag_isCaseSensitive ? "TITLE标题" : "title标题"
-    wstring className = flag_isCaseSensitive ? hmc_string_util::removeNullCharactersAll(_className) : hmc_string_util::text_to_upper(hmc_string_util::removeNullCharactersAll(_className));
-    wstring titleName = flag_isCaseSensitive ? hmc_string_util::removeNullCharactersAll(_titleName) : hmc_string_util::text_to_upper(hmc_string_util::removeNullCharactersAll(_titleName));
+    bool flag_isWindow = (argc > 2 && hmc_napi_type::isBoolean(env, args[2]) ? hmc_napi_get_value::boolean_bool(env, args[2]) : true);
+    bool flag_isCaseSensitive = (argc > 3 && hmc_napi_type::isBoolean(env, args[3]) ? hmc_napi_get_value::boolean_bool(env, args[3]) : false);
 
-    HWND winEnumerable = GetTopWindow(0);
+    wstring className = (hmc_napi_type::isString(env, args[0]) ? hmc_string_util::removeNullCharactersAll(hmc_napi_get_value::string_utf16(env, args[0])) : wstring(L""));
+    wstring titleName = (hmc_napi_type::isString(env, args[1]) ? hmc_string_util::removeNullCharactersAll(hmc_napi_get_value::string_utf16(env, args[1])) : wstring(L""));
 
-    vector<int> hwnd_list = vector<int>();
+    hmc_window_match::Mode mode = hmc_window_match::MODE_EXACT;
+    hmc_window_match::Query query;
+    query.visible_only = flag_isWindow;
 
-    while (winEnumerable)
+    napi_valuetype options_type = napi_undefined;
+    if (argc > 4 && napi_typeof(env, args[4], &options_type) == napi_ok && options_type == napi_object)
     {
-        if (true)
+        napi_value value;
+        if (napi_get_named_property(env, args[4], "mode", &value) == napi_ok && hmc_napi_type::isString(env, value))
         {
-
-            wstring the_class = wstring();
-            wstring the_titleName = wstring();
-
-            if (!_className.empty())
+            if (!hmc_window_match::parseMode(hmc_napi_get_value::string_utf16(env, value), mode))
             {
-                bool the_class_ok = false;
-                the_class = (flag_isCaseSensitive ? hmc_string_util::text_to_upper(getClassNameW(winEnumerable, the_class_ok)) : getClassNameW(winEnumerable, the_class_ok));
-
-                if (the_class == _className)
-                {
-
-                    if (_titleName.empty())
-                    {
-
-                        hwnd_list.push_back((int)winEnumerable);
-                    }
-                }
-            }
-
-            if (!_titleName.empty())
-            {
-                bool the_title_ok = false;
-                the_titleName = (flag_isCaseSensitive ? hmc_string_util::text_to_upper(getWindowTextW(winEnumerable)) : getWindowTextW(winEnumerable));
-                if (the_titleName == _titleName)
-                {
-
-                    if (_className.empty())
-                    {
-                        hwnd_list.push_back((int)winEnumerable);
-                    }
-                }
+                napi_throw_type_error(env, 0, "mode must be one of exact / prefix / substring / glob / regex");
+                return NULL;
             }
+        }
 
-            if (!_className.empty() && !the_titleName.empty())
-            {
-                if (the_titleName == _titleName && the_class == _className)
-                {
-                    hwnd_list.push_back((int)winEnumerable);
-                }
-            }
+        int64_t limit = 0;
+        if (napi_get_named_property(env, args[4], "limit", &value) == napi_ok && napi_get_value_int64(env, value, &limit) == napi_ok && limit > 0)
+        {
+            query.limit = (size_t)limit;
         }
-        winEnumerable = GetNextWindow(winEnumerable, GW_HWNDNEXT);
     }
 
+    // 模式只编译一次
+    try
+    {
+        query.class_name = hmc_window_match::Pattern(className, mode, flag_isCaseSensitive);
+        query.title = hmc_window_match::Pattern(titleName, mode, flag_isCaseSensitive);
+    }
+    catch (const std::regex_error &error)
+    {
+        napi_throw_error(env, "EINVAL", string("invalid regex => ").append(error.what()).c_str());
+        return NULL;
+    }
+
+    vector<HWND> hwnd_list;
+    hmc_window_match::find(query, hwnd_list);
+
     for (size_t index = 0; index < hwnd_list.size(); index++)
     {
-        int hwnd = hwnd_list[index];
-        napi_value number = hmc_napi_create_value::Number(env, hwnd);
+        napi_value number = hmc_napi_create_value::Number(env, (int64_t)hwnd_list[index]);
         Results.putValue(number);
     }
     return Results.toValue();
@@ -2833,6 +2816,52 @@ static napi_value Init(napi_env env, napi_value exports)
         DECLARE_NAPI_METHODRM("stopLimitMouseRangeWorker", stopLimitMouseRangeWorker),
         // 2023-12-28 add support
         DECLARE_NAPI_METHODRM("sendMessage", fn_SendMessage),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("getKeyboardHookStats", getKeyboardHookStats),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("getExecutorStats", fn_getExecutorStats),
+        DECLARE_NAPI_METHODRM("setExecutorOptions", fn_setExecutorOptions),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("closeEnumProcessHandle", closeEnumProcessHandle),
+        DECLARE_NAPI_METHODRM("closeEnumAllProcess", closeEnumAllProcess),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("getProcessCpuUsageHistory", fn_getProcessCpuUsageHistory),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("createProcessDiffStore", fn_createProcessDiffStore),
+        DECLARE_NAPI_METHODRM("closeProcessDiffStore", fn_closeProcessDiffStore),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("getProcessTree", getProcessTree),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("translatePaths", translatePaths),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("queryWindows", queryWindows),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("findAllWindow", fn_findAllWindow),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("startWindowIndex", startWindowIndex),
+        DECLARE_NAPI_METHODRM("stopWindowIndex", stopWindowIndex),
+        DECLARE_NAPI_METHODRM("isWindowIndexRunning", isWindowIndexRunning),
+        DECLARE_NAPI_METHODRM("windowIndexFind", windowIndexFind),
+        DECLARE_NAPI_METHODRM("windowIndexList", windowIndexList),
+        DECLARE_NAPI_METHODRM("windowIndexByPid", windowIndexByPid),
+        DECLARE_NAPI_METHODRM("windowIndexMainWindow", windowIndexMainWindow),
+        DECLARE_NAPI_METHODRM("windowIndexGet", windowIndexGet),
+        DECLARE_NAPI_METHODRM("getWindowIndexStats", getWindowIndexStats),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("getColors", getColors),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("pixelSearch", pixelSearch),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("findImage", findImage),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("captureScreenFrame", captureScreenFrame),
+        DECLARE_NAPI_METHODRM("releaseScreenFrame", releaseScreenFrame),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("startCaptureStream", startCaptureStream),
+        DECLARE_NAPI_METHODRM("stopCaptureStream", stopCaptureStream),
+        DECLARE_NAPI_METHODRM("getCaptureStreamStats", getCaptureStreamStats),
+        // 2026-10-17 add support
+        DECLARE_NAPI_METHODRM("captureBmpToBuff", captureBmpToBuff),
 
     };
     _________HMC___________ = false;
@@ -165,6 +165,7 @@ napi_value getHidUsbList(napi_env env, napi_callback_info info);
 napi_value getUsbDevsInfo(napi_env env, napi_callback_info info);
 napi_value getVolumeList(napi_env env, napi_callback_info info);
 napi_value formatVolumePath(napi_env env, napi_callback_info info);
+napi_value translatePaths(napi_env env, napi_callback_info info);
 vector<util_Volume> util_getVolumeList();
 wstring FormatVolumePath(wstring VolumeName);
 // napi_value getDeviceUsbList(napi_env env, napi_callback_info info);
@@ -177,6 +178,7 @@ napi_value unKeyboardHook(napi_env env, napi_callback_info info);
 napi_value getKeyboardNextSession(napi_env env, napi_callback_info info);
 napi_value installKeyboardHook(napi_env env, napi_callback_info info);
 napi_value isStartKeyboardHook(napi_env env, napi_callback_info info);
+napi_value getKeyboardHookStats(napi_env env, napi_callback_info info);
 napi_value hasKeyActivate(napi_env env, napi_callback_info info);
 napi_value getMouseMovePoints(napi_env env, napi_callback_info info);
 napi_value leftClick(napi_env env, napi_callback_info info);
@@ -201,6 +203,16 @@ napi_value stopLimitMouseRangeWorker(napi_env env, napi_callback_info info);
 // Windows.cpp
 napi_value getAllWindowsHandle(napi_env env, napi_callback_info info);
 napi_value setForegroundWindow(napi_env env, napi_callback_info info);
+napi_value queryWindows(napi_env env, napi_callback_info info);
+napi_value startWindowIndex(napi_env env, napi_callback_info info);
+napi_value stopWindowIndex(napi_env env, napi_callback_info info);
+napi_value isWindowIndexRunning(napi_env env, napi_callback_info info);
+napi_value windowIndexFind(napi_env env, napi_callback_info info);
+napi_value windowIndexList(napi_env env, napi_callback_info info);
+napi_value windowIndexByPid(napi_env env, napi_callback_info info);
+napi_value windowIndexMainWindow(napi_env env, napi_callback_info info);
+napi_value windowIndexGet(napi_env env, napi_callback_info info);
+napi_value getWindowIndexStats(napi_env env, napi_callback_info info);
 
 
 
@@ -212,16 +224,27 @@ napi_value enumProcessHandlePolling(napi_env env, napi_callback_info info);
 napi_value getProcessThreadList(napi_env env, napi_callback_info info);
 napi_value clearEnumProcessHandle(napi_env env, napi_callback_info info);
 napi_value getSubProcessID(napi_env env, napi_callback_info info);
+napi_value getProcessTree(napi_env env, napi_callback_info info);
 napi_value enumAllProcess(napi_env env, napi_callback_info info);
 napi_value enumAllProcessPolling(napi_env env, napi_callback_info info);
 // napi_value getProcessParentProcessID(napi_env env, napi_callback_info info);
 napi_value clearEnumAllProcessList(napi_env env, napi_callback_info info);
+napi_value closeEnumProcessHandle(napi_env env, napi_callback_info info);
+napi_value closeEnumAllProcess(napi_env env, napi_callback_info info);
 
 // screen.cpp
 
 napi_value captureBmpToFile(napi_env env, napi_callback_info info);
 napi_value getColor(napi_env env, napi_callback_info info);
-// napi_value captureBmpToBuff(napi_env env, napi_callback_info info);
+napi_value getColors(napi_env env, napi_callback_info info);
+napi_value pixelSearch(napi_env env, napi_callback_info info);
+napi_value findImage(napi_env env, napi_callback_info info);
+napi_value captureScreenFrame(napi_env env, napi_callback_info info);
+napi_value releaseScreenFrame(napi_env env, napi_callback_info info);
+napi_value startCaptureStream(napi_env env, napi_callback_info info);
+napi_value stopCaptureStream(napi_env env, napi_callback_info info);
+napi_value getCaptureStreamStats(napi_env env, napi_callback_info info);
+napi_value captureBmpToBuff(napi_env env, napi_callback_info info);
 
 // fn_environment.cpp
 napi_value fn_getVariableAll(napi_env env, napi_callback_info info);
@@ -259,7 +282,16 @@ bool ExistProcessID(DWORD processID);
 wstring GetProcessIdFilePathW(DWORD processID, bool is_snapshot_match = false);
 
 
+napi_value fn_getProcessCpuUsageHistory(napi_env env, napi_callback_info info);
+napi_value fn_createProcessDiffStore(napi_env env, napi_callback_info info);
+napi_value fn_closeProcessDiffStore(napi_env env, napi_callback_info info);
+
 void exports_process_all_v2_fun(napi_env env, napi_value exports);
 
+// fn_executor.cpp
+
+napi_value fn_getExecutorStats(napi_env env, napi_callback_info info);
+napi_value fn_setExecutorOptions(napi_env env, napi_callback_info info);
+
 
 #endif // MODE_INTERNAL_INCLUDE_HMC_MAIN_HPP
\ No newline at end of file
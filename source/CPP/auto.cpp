@@ -1,72 +1,212 @@
 #include "./Mian.hpp";
 #include "hmc_automation_util.h";
 #include "hmc_napi_value_util.h"
+#include "./util/hmc_spsc_ring.hpp"
 
-HHOOK keyboardHook = 0; // 钩子句柄、
 HHOOK MouseHook = 0;    // 钩子句柄、
-bool Keyboard_HOOK_next = false;
+std::atomic<bool> Keyboard_HOOK_next(false);
 bool Mouse_HOOK_next = false;
-vector<vector<int>> KeyboardRecordList;
+std::atomic<DWORD> Keyboard_HOOK_thread_id(0);
+// 钩子线程与投递线程  停止时等待二者结束后才能再次启动 (旧线程的清理不会影响新的会话 环形缓冲区始终只有一个生产者)
+// 进程退出时线程可能仍在运行  析构时分离 (joinable 的 std::thread 析构会直接终止进程)
+struct hmc_keyboard_thread : std::thread
+{
+    using std::thread::operator=;
+    ~hmc_keyboard_thread()
+    {
+        if (joinable())
+        {
+            detach();
+        }
+    }
+};
+hmc_keyboard_thread Keyboard_HOOK_thread;
+hmc_keyboard_thread Keyboard_PUSH_thread;
+
+// 键盘钩子线程按值写入的单条记录
+struct hmc_keyboard_record
+{
+    DWORD vkCode;
+    DWORD flags;
+    DWORD time;
+};
+
+// 钩子线程(生产者) -> js 线程(消费者)  满了直接丢弃并计数 钩子回调里不允许阻塞
+hmc_spsc_ring::SpscRing<hmc_keyboard_record, 4096> KeyboardRecordRing;
+
+// 推送模式  installKeyboardHook(callback, {batchMs, maxBatch})
+napi_threadsafe_function Keyboard_PUSH_tsfn = NULL;
+HANDLE Keyboard_PUSH_event = NULL;               // 唤醒投递线程 (只创建一次 不释放)
+std::atomic<bool> Keyboard_PUSH_next(false);     // 投递线程是否继续
+std::atomic<bool> Keyboard_PUSH_pending(false);  // 已排队但js还没处理的投递 同一个tick内只投递一次
+DWORD Keyboard_PUSH_batch_ms = 16;
+size_t Keyboard_PUSH_max_batch = 256;
 
 int oid_is_key_Down = 0;
 int oid_is_key_vkCode = 0;
 
-void asyncLowLevelKeyboardProc(KBDLLHOOKSTRUCT *ks)
+LRESULT CALLBACK LowLevelKeyboardProc(_In_ int nCode, _In_ WPARAM wParam, _In_ LPARAM lParam)
 {
-    bool is_Down = false;
-    if (ks->flags < 128)
+    // 没有键值
+    if (nCode < 0)
     {
-        is_Down = true;
+        return CallNextHookEx(NULL, nCode, wParam, lParam);
     }
-    int i_is_Down = is_Down ? 1 : 0;
+
+    // lParam 只在本次回调内有效 必须立即按值复制
+    const KBDLLHOOKSTRUCT *ks = (KBDLLHOOKSTRUCT *)lParam; // 低级键盘输入事件信息
+
+    int i_is_Down = (ks->flags & LLKHF_UP) ? 0 : 1;
     int vkCode = (int)ks->vkCode;
+
+    // 过滤长按产生的重复按下
     if (oid_is_key_Down != i_is_Down || vkCode != oid_is_key_vkCode)
     {
-        vector<int> push = {vkCode, i_is_Down};
-        // 监控键盘
-        cout << (ks->vkCode) << "->" << is_Down << endl;
         oid_is_key_Down = i_is_Down;
         oid_is_key_vkCode = vkCode;
-        KeyboardRecordList.push_back(push);
+        KeyboardRecordRing.push(hmc_keyboard_record{ks->vkCode, ks->flags, ks->time});
+
+        // 推送模式下 攒够一批或不需要合并时立即唤醒投递线程
+        if (Keyboard_PUSH_next && (Keyboard_PUSH_batch_ms == 0 || KeyboardRecordRing.size() >= Keyboard_PUSH_max_batch))
+        {
+            ::SetEvent(Keyboard_PUSH_event);
+        }
     }
+
+    // 将消息传递给钩子链中的下一个钩子
+    return CallNextHookEx(NULL, nCode, wParam, lParam);
 }
-LRESULT CALLBACK LowLevelKeyboardProc(_In_ int nCode, _In_ WPARAM wParam, _In_ LPARAM lParam)
+
+/**
+ * @brief 在js线程中执行  将缓冲区里的记录打包为一个 Uint32Array 回调给js
+ * 每条记录占3个uint32: [vkCode, flags, time]  (time 为开机后的毫秒数 超过 24.8 天后 int32 会变成负数)
+ */
+static void KeyboardPushCallJs(napi_env env, napi_value js_cb, void *context, void *data)
 {
-    // 没有键值
-    if (nCode < 0)
+    Keyboard_PUSH_pending = false;
+
+    if (env == NULL || js_cb == NULL)
     {
-        return CallNextHookEx(NULL, nCode, wParam, lParam);
+        return;
     }
 
-    KBDLLHOOKSTRUCT *ks = (KBDLLHOOKSTRUCT *)lParam; // 低级键盘输入事件信息
-    std::thread(asyncLowLevelKeyboardProc, ks).detach();
+    // 只会在js线程使用 复用内存
+    static vector<hmc_keyboard_record> keyboard_list;
+    keyboard_list.clear();
 
-    // 将消息传递给钩子链中的下一个钩子
-    return CallNextHookEx(NULL, nCode, wParam, lParam);
+    size_t count = KeyboardRecordRing.drain(keyboard_list, Keyboard_PUSH_max_batch);
+
+    // 超过单次上限的部分留给下一次投递
+    if (!KeyboardRecordRing.empty() && Keyboard_PUSH_next)
+    {
+        ::SetEvent(Keyboard_PUSH_event);
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    void *buffer = NULL;
+    napi_value arraybuffer, records, undefined;
+
+    if (napi_create_arraybuffer(env, count * 3 * sizeof(uint32_t), &buffer, &arraybuffer) != napi_ok)
+    {
+        return;
+    }
+
+    uint32_t *pack = (uint32_t *)buffer;
+    for (size_t i = 0; i < count; i++)
+    {
+        pack[i * 3] = (uint32_t)keyboard_list[i].vkCode;
+        pack[i * 3 + 1] = (uint32_t)keyboard_list[i].flags;
+        pack[i * 3 + 2] = (uint32_t)keyboard_list[i].time;
+    }
+
+    if (napi_create_typedarray(env, napi_uint32_array, count * 3, arraybuffer, 0, &records) != napi_ok)
+    {
+        return;
+    }
+
+    napi_get_undefined(env, &undefined);
+    napi_call_function(env, undefined, js_cb, 1, &records, NULL);
+}
+
+/**
+ * @brief 投递线程  每 batchMs 毫秒(或攒够 maxBatch 条)向js投递一次
+ */
+void KeyboardPushWorker(napi_threadsafe_function tsfn, DWORD batch_ms)
+{
+    while (Keyboard_PUSH_next)
+    {
+        ::WaitForSingleObject(Keyboard_PUSH_event, batch_ms == 0 ? INFINITE : batch_ms);
+
+        if (!Keyboard_PUSH_next)
+        {
+            break;
+        }
+
+        if (!KeyboardRecordRing.empty() && !Keyboard_PUSH_pending.exchange(true))
+        {
+            if (napi_call_threadsafe_function(tsfn, NULL, napi_tsfn_nonblocking) != napi_ok)
+            {
+                Keyboard_PUSH_pending = false;
+            }
+        }
+    }
+
+    napi_release_threadsafe_function(tsfn, napi_tsfn_release);
 }
 
+void StopKeyboardPushWorker()
+{
+    if (Keyboard_PUSH_next.exchange(false))
+    {
+        ::SetEvent(Keyboard_PUSH_event);
+    }
+}
+
+// 读取 options 里的数字属性
+static bool getKeyboardHookOption(napi_env env, napi_value options, const char *name, int64_t &value)
+{
+    napi_value item;
+    if (napi_get_named_property(env, options, name, &item) != napi_ok || !util_diff_napi_type(env, item, napi_number))
+    {
+        return false;
+    }
+    return napi_get_value_int64(env, item, &value) == napi_ok;
+}
+
+// Keyboard_HOOK_next 在启动线程前由 installKeyboardHook 设置  钩子句柄只属于本线程
 void InstallKeyboardHook()
 {
-    Keyboard_HOOK_next = true;
+    oid_is_key_Down = 0;
+    oid_is_key_vkCode = 0;
 
-    keyboardHook = SetWindowsHookExA(
+    // 先建立消息队列再公开线程id  保证 unKeyboardHook 投递的 WM_QUIT 不会丢失
+    MSG msg;
+    ::PeekMessageW(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+    Keyboard_HOOK_thread_id = ::GetCurrentThreadId();
+
+    HHOOK keyboardHook = SetWindowsHookExA(
         WH_KEYBOARD_LL,         // 钩子类型 安装用于监视低级别键盘输入事件的挂钩过程 与  安装用于监视低级别鼠标输入事件的挂钩过程
         LowLevelKeyboardProc,   // 指向钩子函数的指针
         GetModuleHandleA(NULL), // 没有模块句柄
         NULL);
     if (keyboardHook == 0)
     {
+        Keyboard_HOOK_thread_id = 0;
+        Keyboard_HOOK_next = false;
+        StopKeyboardPushWorker();
         return;
     }
 
-
 	BOOL bRet;
-	MSG msg;
 
-	// 获取消息循环
-	while ((bRet = GetMessageW(&msg, nullptr, 0, 0)) != 0)
+	// 获取消息循环  (已经停止时不再等待消息)
+	while (Keyboard_HOOK_next && (bRet = GetMessageW(&msg, nullptr, 0, 0)) != 0)
 	{ 
-		if (bRet == -1 || (!Keyboard_HOOK_next || keyboardHook == NULL))
+		if (bRet == -1 || !Keyboard_HOOK_next)
 		{
 			break;
 		}
@@ -76,35 +216,106 @@ void InstallKeyboardHook()
 
     // 移除系统钩子
     UnhookWindowsHookEx(keyboardHook);
-    KeyboardRecordList.clear();
+    Keyboard_HOOK_thread_id = 0;
+    Keyboard_HOOK_next = false;
+    StopKeyboardPushWorker();
 }
 
-napi_value installKeyboardHook(napi_env env, napi_callback_info info)
+/**
+ * @brief 停止钩子线程与投递线程并等待它们结束 (js 线程)
+ */
+static void JoinKeyboardHook()
 {
-    if (Keyboard_HOOK_next)
+    Keyboard_HOOK_next = false;
+    StopKeyboardPushWorker();
+
+    // GetMessageW 会一直阻塞 需要主动唤醒钩子线程让它退出
+    DWORD thread_id = Keyboard_HOOK_thread_id;
+    if (thread_id != 0)
     {
-        return NULL;
+        ::PostThreadMessageW(thread_id, WM_QUIT, 0, 0);
+    }
+
+    if (Keyboard_HOOK_thread.joinable())
+    {
+        Keyboard_HOOK_thread.join();
+    }
+    if (Keyboard_PUSH_thread.joinable())
+    {
+        Keyboard_PUSH_thread.join();
     }
-    std::thread(InstallKeyboardHook).detach();
-    return NULL;
 }
 
-napi_value unKeyboardHook(napi_env env, napi_callback_info info)
+/**
+ * @brief 启动键盘钩子
+ * - installKeyboardHook()  轮询模式 由 getKeyboardNextSession 读取
+ * - installKeyboardHook(callback, {batchMs, maxBatch})  推送模式
+ *   callback(records: Uint32Array)  每条记录为 [vkCode, flags, time] 三个uint32
+ *   batchMs 合并时间窗口 默认16ms (0 为每次按键立即投递)
+ *   maxBatch 单次投递最大条数 攒够后立即投递 默认256
+ */
+napi_value installKeyboardHook(napi_env env, napi_callback_info info)
 {
-    Keyboard_HOOK_next = false;
-    if (KeyboardRecordList.size() > 0)
+    if (Keyboard_HOOK_next || Keyboard_PUSH_next)
+    {
+        return NULL;
+    }
+
+    // 上一次的钩子线程可能已自行退出 (安装失败)  等它结束后再开始新的会话
+    JoinKeyboardHook();
+
+    napi_status status;
+    size_t argc = 2;
+    napi_value args[2];
+    status = $napi_get_cb_info(argc, args);
+    assert(status == napi_ok);
+
+    KeyboardRecordRing.clear();
+    KeyboardRecordRing.reset_counter();
+
+    if (argc > 0 && util_diff_napi_type(env, args[0], napi_function))
     {
-        for (size_t i = 0; i < KeyboardRecordList.size(); i++)
+        int64_t batch_ms = 16;
+        int64_t max_batch = 256;
+
+        if (argc > 1 && util_diff_napi_type(env, args[1], napi_object))
         {
-            // 释放数组 里的int数组内存
-            KeyboardRecordList[i].clear();
+            getKeyboardHookOption(env, args[1], "batchMs", batch_ms);
+            getKeyboardHookOption(env, args[1], "maxBatch", max_batch);
         }
-        // 释放数组
-        for (size_t i = 0; i < KeyboardRecordList.size(); i++)
+
+        Keyboard_PUSH_batch_ms = (DWORD)(batch_ms < 0 ? 0 : batch_ms > 10000 ? 10000 : batch_ms);
+        Keyboard_PUSH_max_batch = (size_t)(max_batch < 1 ? 1 : max_batch > (int64_t)KeyboardRecordRing.capacity() ? (int64_t)KeyboardRecordRing.capacity() : max_batch);
+
+        napi_value work_name;
+        napi_create_string_utf8(env, "hmc::keyboardHook", NAPI_AUTO_LENGTH, &work_name);
+
+        if (napi_create_threadsafe_function(env, args[0], NULL, work_name, 0, 1, NULL, NULL, NULL, KeyboardPushCallJs, &Keyboard_PUSH_tsfn) != napi_ok)
+        {
+            napi_throw_error(env, "Creation_failed", "installKeyboardHook < napi_create_threadsafe_function failed. >");
+            return NULL;
+        }
+
+        if (Keyboard_PUSH_event == NULL)
         {
-            KeyboardRecordList.erase(KeyboardRecordList.begin());
+            Keyboard_PUSH_event = ::CreateEventW(NULL, FALSE, FALSE, NULL);
         }
+
+        Keyboard_PUSH_pending = false;
+        Keyboard_PUSH_next = true;
+        Keyboard_PUSH_thread = std::thread(KeyboardPushWorker, Keyboard_PUSH_tsfn, Keyboard_PUSH_batch_ms);
     }
+
+    Keyboard_HOOK_next = true;
+    Keyboard_HOOK_thread = std::thread(InstallKeyboardHook);
+    return NULL;
+}
+
+napi_value unKeyboardHook(napi_env env, napi_callback_info info)
+{
+    JoinKeyboardHook();
+
+    KeyboardRecordRing.clear();
     return NULL;
 }
 
@@ -112,46 +323,59 @@ napi_value getKeyboardNextSession(napi_env env, napi_callback_info info)
 {
     napi_status status;
     napi_value Results;
-    if (!Keyboard_HOOK_next || !KeyboardRecordList.size())
+    if (!Keyboard_HOOK_next || KeyboardRecordRing.empty())
     {
         return NULL;
     }
-    status = napi_create_array(env, &Results);
-    assert(status == napi_ok);
 
-    // 复制并清空上次的所有记录
-    vector<vector<int>> copy_KeyboardRecordList;
-    for (int index = 0; index < KeyboardRecordList.size(); index++)
-    {
-        vector<int> mouse = KeyboardRecordList[index];
-        copy_KeyboardRecordList.push_back(mouse);
-    }
-    KeyboardRecordList.clear();
+    // 一次性取出当前所有记录
+    vector<hmc_keyboard_record> keyboard_list;
+    KeyboardRecordRing.drain(keyboard_list);
+
+    status = napi_create_array_with_length(env, keyboard_list.size(), &Results);
+    assert(status == napi_ok);
 
     // 枚举并返回数据
-    for (int index = 0; index < copy_KeyboardRecordList.size(); index++)
+    string keyboardInfo;
+    for (size_t index = 0; index < keyboard_list.size(); index++)
     {
-        vector<int> keyboard = copy_KeyboardRecordList[index];
+        const hmc_keyboard_record &keyboard = keyboard_list[index];
         // "key|is"
-        string keyboardInfo = "";
-        keyboardInfo.append(to_string(keyboard[0]));
-        keyboardInfo.append("|");
-        keyboardInfo.append(to_string(keyboard[1]));
+        keyboardInfo.clear();
+        keyboardInfo.append(to_string(keyboard.vkCode));
+        keyboardInfo.append((keyboard.flags & LLKHF_UP) ? "|0" : "|1");
         // push
-        status = napi_set_element(env, Results, index, as_String( keyboardInfo));
+        status = napi_set_element(env, Results, (uint32_t)index, as_String(keyboardInfo));
         if (status != napi_ok)
         {
             return Results;
         };
-        keyboard.clear();
     }
 
     return Results;
 }
 
+/**
+ * @brief 键盘钩子缓冲区的状态
+ * - size 当前未读取的数量
+ * - capacity 缓冲区容量
+ * - pushed 已写入的总数
+ * - overflow 缓冲区满而丢弃的数量
+ */
+napi_value getKeyboardHookStats(napi_env env, napi_callback_info info)
+{
+    napi_value Results;
+    napi_create_object(env, &Results);
+    napi_set_property(env, Results, as_String("size"), as_Number((int64_t)KeyboardRecordRing.size()));
+    napi_set_property(env, Results, as_String("capacity"), as_Number((int64_t)KeyboardRecordRing.capacity()));
+    napi_set_property(env, Results, as_String("pushed"), as_Number((int64_t)KeyboardRecordRing.pushed()));
+    napi_set_property(env, Results, as_String("overflow"), as_Number((int64_t)KeyboardRecordRing.overflow()));
+    return Results;
+}
+
 napi_value isStartKeyboardHook(napi_env env, napi_callback_info info)
 {
-    return as_Boolean( Keyboard_HOOK_next);
+    return as_Boolean(Keyboard_HOOK_next.load());
 }
 
 // 判断是否按下三大金刚
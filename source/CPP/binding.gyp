@@ -24,7 +24,12 @@
             "screen_v2.cpp",
             "util/fn_process.cpp",
             "util/fn_environment.cpp",
+            "util/fn_executor.cpp",
             "util/hmc_mouse.cpp",
+            "util/hmc_pixel_search.cpp",
+            "util/hmc_image_match.cpp",
+            "util/hmc_tile_diff.cpp",
+            "util/hmc_image_encode.cpp",
           ],
           'msvs_settings': {
             'VCCLCompilerTool': {
@@ -1,75 +1,32 @@
 #include "./Mian.hpp";
 #include "hmc_napi_value_util.h"
+#include "./util/hmc_result_channel.hpp"
+#include "./util/hmc_cursor.hpp"
+#include "./util/hmc_process_tree.hpp"
+#include "./util/hmc_module_cache.hpp"
+#include "./util/hmc_napi_table.hpp"
+#include "./util/hmc_handle_enum.hpp"
+#include "./util/hmc_handle_name.hpp"
+#include "./util/hmc_device_path.hpp"
 
 void util_getSubProcessList(DWORD ProcessId, vector<DWORD> &SubProcessIDList);
-vector<string> util_getModulePathList(DWORD processID)
+// 进程加载的模块路径  (只对目标进程创建模块快照 路径来自共享的模块缓存)
+vector<wstring> util_getModulePathList(DWORD processID)
 {
+    vector<wstring> resultsData = {};
+    vector<hmc_module_cache::ProcessModule> moduleList;
 
-    HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processID);
-    vector<string> resultsData = {};
-    if (hProcess == NULL)
+    if (!hmc_module_cache::Cache::shared().list(processID, moduleList))
     {
         return resultsData;
     }
 
-    vector<HANDLE> vecFileHandles;
-
-    // 枚举进程打开的文件句柄
-    HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPALL, 0);
-    if (hSnapshot != INVALID_HANDLE_VALUE)
+    resultsData.reserve(moduleList.size());
+    for (auto &module : moduleList)
     {
-        PROCESSENTRY32 pe32;
-        pe32.dwSize = sizeof(PROCESSENTRY32);
-        if (Process32First(hSnapshot, &pe32))
-        {
-            do
-            {
-                if (pe32.th32ProcessID == processID)
-                {
-                    HANDLE hModuleSnap = CreateToolhelp32Snapshot(TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32, processID);
-                    if (hModuleSnap != INVALID_HANDLE_VALUE)
-                    {
-                        MODULEENTRY32 me32;
-                        me32.dwSize = sizeof(MODULEENTRY32);
-                        if (Module32First(hModuleSnap, &me32))
-                        {
-                            do
-                            {
-                                HANDLE hFile = CreateFile(me32.szExePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-                                if (hFile != INVALID_HANDLE_VALUE)
-                                {
-                                    vecFileHandles.push_back(hFile);
-                                }
-                            } while (Module32Next(hModuleSnap, &me32));
-                        }
-                        CloseHandle(hModuleSnap);
-                    }
-                }
-            } while (Process32Next(hSnapshot, &pe32));
-        }
-        CloseHandle(hSnapshot);
-    }
-
-    // 输出文件路径
-    for (auto it = vecFileHandles.begin(); it != vecFileHandles.end(); ++it)
-    {
-        LPWSTR szFilePath = new WCHAR[MAX_PATH];
-        DWORD dwSize = GetFinalPathNameByHandleW(*it, szFilePath, MAX_PATH, FILE_NAME_NORMALIZED);
-        if (dwSize > 0 && dwSize < MAX_PATH)
-        {
-            string szFilePathw2a = hmc_string_util::utf16_to_ansi(szFilePath);
-            string findStr = "\\\\?\\";
-            if (szFilePathw2a.find(findStr) == 0)
-            {
-                szFilePathw2a.replace(0, findStr.length(), "");
-            }
-            resultsData.push_back(szFilePathw2a);
-        }
-        delete[] szFilePath;
-        CloseHandle(*it);
+        resultsData.push_back(module.entry->path);
     }
 
-    CloseHandle(hProcess);
     return resultsData;
 }
 
@@ -165,12 +122,11 @@ napi_value getModulePathList(napi_env env, napi_callback_info info)
     assert(status == napi_ok);
     DWORD ProcessID = (DWORD)Process_PID;
 
-    vector<string> ModulePathList = util_getModulePathList(ProcessID);
-    // thread(util_getModulePathList, ProcessID, ModulePathList).join();
+    vector<wstring> ModulePathList = util_getModulePathList(ProcessID);
 
     for (size_t i = 0; i < ModulePathList.size(); i++)
     {
-        napi_value value = as_String(ModulePathList[i]);
+        napi_value value = hmc_napi_table::utf16(env, ModulePathList[i]);
         // push path to Array
         status = napi_set_element(env, resultsModulePathList, i, value);
         if (status != napi_ok)
@@ -180,433 +136,207 @@ napi_value getModulePathList(napi_env env, napi_callback_info info)
     return resultsModulePathList;
 }
 
-vector<DWORD> ListProcessThreads(DWORD dwOwnerPID)
-{
-    vector<DWORD> ProcessThreadsList = {};
-    HANDLE hThreadSnap = INVALID_HANDLE_VALUE;
-    // `THREADENTRY32` 是一个结构体，它定义在 `tlhelp32.h` 头文件中。它描述了在系统执行快照时正在执行的线程列表中的条目。以下是 `THREADENTRY32` 结构体中的各个变量的含义：⁴⁵
-    // - dwSize：结构体的大小，以字节为单位。
-    // - cntUsage：线程使用计数。
-    // - th32ThreadID：线程标识符，与 `CreateProcess` 函数返回的线程标识符兼容。
-    // - th32OwnerProcessID：创建线程的进程标识符。
-    // - tpBasePri：分配给线程的内核基优先级。
-    // - tpDeltaPri：线程优先级相对于基本优先级的增量。
-    // - dwFlags：保留，不再使用。
-    THREADENTRY32 te32;
-
-    // 对所有正在运行的线程进行快照
-    hThreadSnap = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
-    if (hThreadSnap == INVALID_HANDLE_VALUE)
-        return ProcessThreadsList;
-
-    // 在使用前填写结构的大小。
-    te32.dwSize = sizeof(THREADENTRY32);
-
-    // 检索第一个线程的信息、
-    // 并在不成功的情况下退出
-    if (!Thread32First(hThreadSnap, &te32))
-    {
-        CloseHandle(hThreadSnap); // 必须清理快照对象
-        return ProcessThreadsList;
-    }
-
-    // 现在走一下系统的线程列表、
-    // 并显示每个线程的信息
-    // 与指定进程相关的
-    do
-    {
-        if (te32.th32OwnerProcessID == dwOwnerPID)
-        {
-
-            ProcessThreadsList.push_back(te32.th32ThreadID);
-        }
-    } while (Thread32Next(hThreadSnap, &te32));
-
-    //  不要忘记清理快照对象。
-    CloseHandle(hThreadSnap);
-    return ProcessThreadsList;
-}
-
 struct enumHandleCout
 {
     long long handle;
     wstring type;
     wstring name;
-    int id;
 };
-vector<enumHandleCout> resultsEnumHandleList = {};
-int EnumHandleQueryID = 0;
-
-// #define NT_SUCCESS(x) ((x) >= 0)
-#define STATUS_INFO_LENGTH_MISMATCH 0xc0000004
-
-#define SystemHandleInformation 16
-#define ObjectBasicInformation 0
-#define ObjectNameInformation 1
-#define ObjectTypeInformation 2
-
-typedef NTSTATUS(NTAPI *NTQUERYSYSTEMINFORMATION)(
-    // 检索的信息类型
-    ULONG SystemInformationClass,
-    // 指向缓冲区的指针 有关系统信息的结构体
-    PVOID SystemInformation,
-    // 缓冲区的大小
-    ULONG SystemInformationLength,
-    // 实际返回的信息大小
-    PULONG ReturnLength);
-
-typedef NTSTATUS(NTAPI *NTDUPLICATEOBJECT)(
-    // 源进程的句柄
-    HANDLE SourceProcessHandle,
-    // 复制的内核对象的句柄
-    HANDLE SourceHandle,
-    // 目标进程的句柄
-    HANDLE TargetProcessHandle,
-    // 目标进程中新对象的指针
-    PHANDLE TargetHandle,
-    // 新对象的访问权限
-    ACCESS_MASK DesiredAccess,
-    // 新对象的属性
-    ULONG Attributes,
-    // 复制操作的选项
-    ULONG Options);
-typedef NTSTATUS(NTAPI *NTQUERYOBJECT)(
-    HANDLE ObjectHandle,
-    ULONG ObjectInformationClass,
-    PVOID ObjectInformation,
-    ULONG ObjectInformationLength,
-    PULONG ReturnLength);
-
-typedef struct _SYSTEM_HANDLE
-{
-    ULONG ProcessId;
-    BYTE ObjectTypeNumber;
-    BYTE Flags;
-    USHORT Handle;
-    PVOID Object;
-    ACCESS_MASK GrantedAccess;
-} SYSTEM_HANDLE, *PSYSTEM_HANDLE;
-
-typedef struct _SYSTEM_HANDLE_INFORMATION
-{
-    ULONG HandleCount;
-    SYSTEM_HANDLE Handles[1];
-} SYSTEM_HANDLE_INFORMATION, *PSYSTEM_HANDLE_INFORMATION;
+// 每次 enumProcessHandle 的结果通道
+hmc_result_channel::Registry<enumHandleCout> EnumHandleChannels;
 
-typedef enum _POOL_TYPE
-{
-    NonPagedPool,
-    PagedPool,
-    NonPagedPoolMustSucceed,
-    DontUseThisType,
-    NonPagedPoolCacheAligned,
-    PagedPoolCacheAligned,
-    NonPagedPoolCacheAlignedMustS
-} POOL_TYPE,
-    *PPOOL_TYPE;
-
-typedef struct _OBJECT_TYPE_INFORMATION
+struct enumHandleStats
 {
-    // 对象名称。
-    UNICODE_STRING Name;
-    // 对象的总数。
-    ULONG TotalNumberOfObjects;
-    // 对象句柄的总数。
-    ULONG TotalNumberOfHandles;
-    // 对象使用的分页池内存总量。
-    ULONG TotalPagedPoolUsage;
-    // 对象使用的非分页池内存总量。
-    ULONG TotalNonPagedPoolUsage;
-    // 对象名称使用的内存总量。
-    ULONG TotalNamePoolUsage;
-    // 对象句柄表使用的内存总量。
-    ULONG TotalHandleTableUsage;
-    // 对象的最大数量。
-    ULONG HighWaterNumberOfObjects;
-    // 对象句柄的最大数量。
-    ULONG HighWaterNumberOfHandles;
-    // 对象使用的分页池内存的最大值。
-    ULONG HighWaterPagedPoolUsage;
-    // 对象使用的非分页池内存的最大值。
-    ULONG HighWaterNonPagedPoolUsage;
-    // 对象名称使用的内存的最大值。
-    ULONG HighWaterNamePoolUsage;
-    // 对象句柄表使用的内存的最大值。
-    ULONG HighWaterHandleTableUsage;
-    // 无效属性标志。
-    ULONG InvalidAttributes;
-    // 通用映射结构体。
-    GENERIC_MAPPING GenericMapping;
-    // 有效访问标志。
-    ULONG ValidAccess;
-    // 安全性要求标志。
-    BOOLEAN SecurityRequired;
-    // 维护句柄计数标志。
-    BOOLEAN MaintainHandleCount;
-    // 维护类型列表标志。
-    USHORT MaintainTypeList;
-    // 池类型。
-    POOL_TYPE PoolType;
-    // 分页池内存使用量。
-    ULONG PagedPoolUsage;
-    // 非分页池内存使用量。
-    ULONG NonPagedPoolUsage;
-} OBJECT_TYPE_INFORMATION, *POBJECT_TYPE_INFORMATION;
-
-void EnumHandleList(DWORD ProcessId)
+    // 目标进程的句柄数量
+    size_t handles;
+    // 获取对象名超时的数量
+    size_t timeouts;
+    // 已知会阻塞而跳过获取对象名的数量
+    size_t skipped;
+    // 耗时 (ms)
+    double elapsed;
+};
+// 已结束的枚举的统计  在最后一次 enumProcessHandlePolling 时取出
+mutex EnumHandleStatsMutex;
+map<int, enumHandleStats> EnumHandleStatsList;
+
+// 获取对象名的线程数量
+#define ENUM_HANDLE_NAME_WORKERS 4
+// 同时等待获取对象名的句柄上限 (已复制到当前进程)
+#define ENUM_HANDLE_MAX_IN_FLIGHT 256
+
+// 枚举进程的 线程 / 子进程 / 句柄  结果写入 channel
+void EnumHandleList(DWORD ProcessId, DWORD nameTimeout, hmc_result_channel::Channel<enumHandleCout> &channel, enumHandleStats &stats)
 {
-    vector<DWORD> ProcessThreadsList = ListProcessThreads(ProcessId);
-    vector<DWORD> ProcessIDList = ListProcessThreads(ProcessId);
-    vector<util_Volume> volumeList = util_getVolumeList();
-    int id = EnumHandleQueryID;
+    auto startTime = chrono::steady_clock::now();
+    stats = enumHandleStats{0, 0, 0, 0};
+
+    vector<DWORD> ProcessThreadsList = {};
+    vector<DWORD> ProcessIDList = {};
+
+    // 线程与子进程来自同一次进程快照
+    hmc_nt_process::Snapshot processSnapshot;
+    if (processSnapshot.refresh())
+    {
+        processSnapshot.forEach([&](const hmc_nt_process::HMC_SYSTEM_PROCESS_INFORMATION &info)
+                                {
+            if ((DWORD)(ULONG_PTR)info.UniqueProcessId != ProcessId)
+            {
+                return true;
+            }
+            hmc_nt_process::Snapshot::readThreadIds(info, ProcessThreadsList);
+            return false; });
+
+        hmc_process_tree::Index index;
+        index.build(processSnapshot, false);
+        index.descendants(ProcessId, ProcessIDList);
+    }
+
     for (size_t i = 0; i < ProcessThreadsList.size(); i++)
     {
         DWORD ThreadsID = ProcessThreadsList[i];
         enumHandleCout handleCout;
-        handleCout.id = id;
         handleCout.handle = 0;
         handleCout.name = to_wstring(ThreadsID);
         handleCout.type = L"Thread";
-        resultsEnumHandleList.push_back(handleCout);
+        if (!channel.push(handleCout))
+        {
+            return;
+        }
     }
 
-    util_getSubProcessList(ProcessId, ProcessIDList);
-
     for (size_t i = 0; i < ProcessIDList.size(); i++)
     {
         DWORD ThreadsID = ProcessIDList[i];
         enumHandleCout handleCout;
-        handleCout.id = id;
         handleCout.handle = 0;
         handleCout.name = to_wstring(ThreadsID);
         handleCout.type = L"Process";
-        resultsEnumHandleList.push_back(handleCout);
+        if (!channel.push(handleCout))
+        {
+            return;
+        }
     }
 
-    HMODULE hNtMod = LoadLibraryW(L"ntdll.dll");
-    if (!hNtMod)
+    // 系统句柄快照中只保留目标进程的句柄
+    hmc_handle_enum::Engine &engine = hmc_handle_enum::Engine::shared();
+    vector<hmc_handle_enum::HandleEntry> handleList;
+    if (!engine.snapshot(ProcessId, handleList))
     {
         return;
     }
-    NTQUERYSYSTEMINFORMATION NtQuerySystemInformation = (NTQUERYSYSTEMINFORMATION)GetProcAddress(hNtMod, "NtQuerySystemInformation");
-    NTDUPLICATEOBJECT NtDuplicateObject = (NTDUPLICATEOBJECT)GetProcAddress(hNtMod, "NtDuplicateObject");
-    NTQUERYOBJECT NtQueryObject = (NTQUERYOBJECT)GetProcAddress(hNtMod, "NtQueryObject");
 
-    if (!NtQuerySystemInformation || !NtDuplicateObject || !NtQueryObject)
-    {
-        return;
-    }
+    HANDLE processHandle = OpenProcess(PROCESS_DUP_HANDLE, FALSE, ProcessId);
+    stats.handles = handleList.size();
 
-    PSYSTEM_HANDLE_INFORMATION handleInfo = NULL;
-    HANDLE processHandle;
-    ULONG i;
-    ULONG neededSize = 0x1000;
-    NTSTATUS Status = 0;
-    ULONG ReturnLength = 0;
-    handleInfo = (PSYSTEM_HANDLE_INFORMATION)malloc(neededSize);
+    // 设备路径转换使用共享的缓存索引
+    hmc_device_path::Index &devicePathIndex = hmc_device_path::Index::shared();
 
-    if (!handleInfo)
-    {
-        return;
-    }
+    // 对象名在解析池中获取 完成一个输出一个 (顺序与句柄快照不同)
+    vector<enumHandleCout> handleCoutList(handleList.size());
+    vector<hmc_handle_name::Result> resolvedList;
+    hmc_handle_name::Resolver resolver(ENUM_HANDLE_NAME_WORKERS, nameTimeout);
 
-    // 一直查询 直到成功
-    while (STATUS_INFO_LENGTH_MISMATCH == (Status = NtQuerySystemInformation(
-                                               SystemHandleInformation,
-                                               handleInfo,
-                                               neededSize,
-                                               &ReturnLength)))
+    auto pushHandleCout = [&](enumHandleCout &handleCout) -> bool
     {
-        if (handleInfo)
+        if (handleCout.type == L"File" && !handleCout.name.empty())
         {
-            free(handleInfo);
-            handleInfo = NULL;
+            handleCout.name = devicePathIndex.translate(handleCout.name);
         }
-        neededSize = ReturnLength;
-        handleInfo = (PSYSTEM_HANDLE_INFORMATION)malloc(neededSize);
-        if (!handleInfo)
-        {
 
-            return;
-        }
-    }
-    processHandle = OpenProcess(PROCESS_DUP_HANDLE, FALSE, ProcessId);
-    for (i = 0; i < handleInfo->HandleCount; i++)
-    {
-        enumHandleCout handleCout;
-        handleCout.id = id;
-        handleCout.handle = 0;
-        handleCout.name = L"";
-        handleCout.type = L"";
-        SYSTEM_HANDLE handle = handleInfo->Handles[i];
-        if (handle.ProcessId != ProcessId)
+        if (handleCout.name.empty() && handleCout.type.empty())
         {
-            continue;
+            return true;
         }
-        handleCout.handle = handle.Handle;
-        if (processHandle)
-        {
-            HANDLE dupHandle = NULL;
-            POBJECT_TYPE_INFORMATION objectTypeInfo = NULL;
-            PVOID objectNameInfo = NULL;
-            UNICODE_STRING objectName = {0};
-            ULONG returnLength = 0;
+        return channel.push(handleCout);
+    };
 
-            do
+    auto pushResolved = [&]() -> bool
+    {
+        bool isOpen = true;
+        for (auto &resolved : resolvedList)
+        {
+            enumHandleCout &handleCout = handleCoutList[resolved.index];
+            handleCout.name = move(resolved.name);
+            if (isOpen && !pushHandleCout(handleCout))
             {
-                // 句柄复制失败 就不去获取类型名
-                Status = NtDuplicateObject(
-                    processHandle,
-                    (void *)handle.Handle,
-                    GetCurrentProcess(),
-                    &dupHandle,
-                    0,
-                    0,
-                    0);
-                if (!NT_SUCCESS(Status))
-                {
-                    break;
-                }
-
-                // 获取对象类型名
-                ULONG ObjectInformationLength = 0;
-                while (STATUS_INFO_LENGTH_MISMATCH == (Status = NtQueryObject(
-                                                           dupHandle,
-                                                           ObjectTypeInformation,
-                                                           objectTypeInfo,
-                                                           ObjectInformationLength,
-                                                           &returnLength)))
-                {
-                    if (objectTypeInfo)
-                    {
-                        free(objectTypeInfo);
-                        objectTypeInfo = NULL;
-                    }
-
-                    ObjectInformationLength = returnLength;
-                    objectTypeInfo = (POBJECT_TYPE_INFORMATION)malloc(ObjectInformationLength);
-                    if (!objectTypeInfo)
-                    {
-                        break;
-                    }
-                }
-
-                // 获取对象类型名成功
-                if (NT_SUCCESS(Status))
-                {
-                    handleCout.type = hmc_string_util::unicodeStringToWString(objectTypeInfo->Name);
-                }
-                if (handle.GrantedAccess == 0x0012019f)
-                {
-
-                    break;
-                }
-
-                // 获取对象名
-                ObjectInformationLength = 0;
-                returnLength = 0;
-
-                if (STATUS_INFO_LENGTH_MISMATCH == NtQueryObject(
-                                                       dupHandle,
-                                                       ObjectNameInformation,
-                                                       NULL,
-                                                       0,
-                                                       &returnLength))
-                {
+                isOpen = false;
+            }
+        }
+        resolvedList.clear();
+        return isOpen;
+    };
 
-                    objectNameInfo = (POBJECT_TYPE_INFORMATION)malloc(returnLength);
-                    if (!objectNameInfo)
-                    {
-                        break;
-                    }
-
-                    ZeroMemory(objectNameInfo, returnLength);
-                    Status = NtQueryObject(
-                        dupHandle,
-                        ObjectNameInformation,
-                        objectNameInfo,
-                        returnLength,
-                        NULL);
-                }
+    for (size_t i = 0; i < handleList.size(); i++)
+    {
+        // 查询已被放弃
+        if (channel.isEnded())
+        {
+            break;
+        }
 
-                // 获取对象名成功
-                if (NT_SUCCESS(Status) && ((PUNICODE_STRING)objectNameInfo)->Length > 0)
-                {
+        const hmc_handle_enum::HandleEntry &handle = handleList[i];
+        enumHandleCout &handleCout = handleCoutList[i];
+        handleCout.handle = (long long)handle.handle;
 
-                    UNICODE_STRING objectName = *(PUNICODE_STRING)objectNameInfo;
-
-                    handleCout.name = hmc_string_util::unicodeStringToWString(objectName);
-                    if (handleCout.type == L"File")
-                    {
-                        for (size_t i = 0; i < volumeList.size(); i++)
-                        {
-                            util_Volume volume = volumeList[i];
-                            if (handleCout.name.find(volume.device) == 0)
-                            {
-                                handleCout.name.replace(0, volume.device.length(), volume.path);
-                            }
-                        }
-                    }
-                }
+        // 句柄复制失败 就不去获取类型名
+        HANDLE dupHandle = processHandle ? engine.duplicate(processHandle, handle) : NULL;
+        if (!dupHandle)
+        {
+            continue;
+        }
 
-            } while (FALSE);
+        engine.typeName(dupHandle, handle.type_index, handleCout.type);
 
-            if (dupHandle)
-            {
-                CloseHandle(dupHandle);
-                dupHandle = NULL;
-            }
-            if (objectTypeInfo)
-            {
-                free(objectTypeInfo);
-                objectTypeInfo = NULL;
-            }
-            if (objectNameInfo)
+        // 此类权限的文件句柄 (同步管道) 获取对象名会一直阻塞
+        if (handleCout.type == L"File" && hmc_handle_name::isBlockingAccess(handle.granted_access))
+        {
+            CloseHandle(dupHandle);
+            stats.skipped++;
+            if (!pushHandleCout(handleCout))
             {
-                free(objectNameInfo);
-                objectNameInfo = NULL;
+                break;
             }
+            continue;
+        }
+
+        resolver.submit(i, dupHandle);
+
+        size_t inFlight = resolver.collect(resolvedList, 0);
+        while (inFlight >= ENUM_HANDLE_MAX_IN_FLIGHT)
+        {
+            inFlight = resolver.collect(resolvedList, 50);
         }
-        if (!handleCout.name.empty() || !handleCout.type.empty())
+        if (!pushResolved())
         {
-            // if(handleCout.type ==L"Thread"&&!ProcessThreadsList.empty()){
-            //     enumHandleCout PushNewHandleCout ;
-            //     PushNewHandleCout.id=id;
-            //     PushNewHandleCout.type = L"Thread";
-            //     PushNewHandleCout.name = L"";
-            //     PushNewHandleCout.handle =0;
-            //     DWORD ThreadsPID = ProcessThreadsList.front();
-            //     PushNewHandleCout.name = to_wstring(ThreadsPID);
-            //     ProcessThreadsList.erase(ProcessThreadsList.begin());
-            //     resultsEnumHandleList.push_back(PushNewHandleCout);
-            // }
-            resultsEnumHandleList.push_back(handleCout);
+            break;
         }
-        Sleep(5);
-        // wcout << "id" << ":"<< handleCout.id << "   "
-        //       << "handle"<< ":" << handleCout.handle << "   "
-        //       << "type"<< ":" << handleCout.type << "   "
-        //       << "name"<< ":" << handleCout.name << "   " << endl;
     }
 
-    // wcout << "id" << ":"<< id << "   "
-    //           << "handle"<< ":" << 0 << "   "
-    //           << "type"<< ":" << "hmc::endl::" << "   "
-    //           << "name"<< ":" << 0 << "   " << endl;
-    enumHandleCout handleCout;
-    handleCout.id = id;
-    handleCout.handle = 0;
-    handleCout.name = L"";
-    handleCout.type = L"hmc::endl::";
-    resultsEnumHandleList.push_back(handleCout);
-    free(handleInfo);
+    while (!channel.isEnded())
+    {
+        size_t inFlight = resolver.collect(resolvedList, 50);
+        if (!pushResolved() || inFlight == 0)
+        {
+            break;
+        }
+    }
+
+    if (processHandle)
+    {
+        CloseHandle(processHandle);
+    }
+
+    stats.timeouts = resolver.timeouts();
+    stats.elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
 };
 
+// enumProcessHandle(pid, onReadable?: () => void, highWaterMark?: number, nameTimeout?: number)
 napi_value enumProcessHandle(napi_env env, napi_callback_info info)
 {
     napi_status status;
-    size_t argc = 1;
-    napi_value args[1];
+    size_t argc = 4;
+    napi_value args[4];
     status = $napi_get_cb_info(argc, args);
     assert(status == napi_ok);
     napi_value resultsModulePathList;
@@ -617,18 +347,46 @@ napi_value enumProcessHandle(napi_env env, napi_callback_info info)
     status = napi_get_value_int32(env, args[0], &Process_PID);
     assert(status == napi_ok);
     DWORD ProcessID = (DWORD)Process_PID;
-    EnumHandleQueryID++;
-    thread(EnumHandleList, ProcessID).detach();
 
-    return as_Number32(EnumHandleQueryID);
+    // 单个句柄获取对象名的期限 (ms)
+    int nameTimeout = 100;
+    if (argc > 3 && util_diff_napi_type(env, args[3], napi_number))
+    {
+        napi_get_value_int32(env, args[3], &nameTimeout);
+        if (nameTimeout < 1)
+        {
+            nameTimeout = 1;
+        }
+    }
+
+    hmc_result_channel::Registry<enumHandleCout>::ChannelPtr channel;
+    int QueryID = EnumHandleChannels.open(channel);
+    hmc_cursor::bindFromArgs(env, args, argc, 1, *channel);
+
+    // 无论枚举是否成功 线程结束时都会标记结束
+    thread([ProcessID, nameTimeout, QueryID, channel]()
+           {
+        enumHandleStats stats;
+        EnumHandleList(ProcessID, (DWORD)nameTimeout, *channel, stats);
+
+        // 已被放弃的查询不会再被取出
+        if (!channel->isEnded())
+        {
+            lock_guard<mutex> lock(EnumHandleStatsMutex);
+            EnumHandleStatsList[QueryID] = stats;
+        }
+        channel->end(); })
+        .detach();
+
+    return as_Number32(QueryID);
 };
 
+/**
+ * @brief 取出句柄枚举的结果
+ * 返回 { data: ProcessHandle[], done: boolean, stats? }  done 为 true 时查询已结束并被回收 并附带统计
+ */
 napi_value enumProcessHandlePolling(napi_env env, napi_callback_info info)
 {
-    if (resultsEnumHandleList.empty())
-    {
-        return NULL;
-    }
     napi_status status;
     size_t argc = 1;
     napi_value args[1];
@@ -636,53 +394,50 @@ napi_value enumProcessHandlePolling(napi_env env, napi_callback_info info)
     assert(status == napi_ok);
     hmc_is_argv_type(args, 0, 1, napi_number, NULL);
 
+    int QueryID;
+    status = napi_get_value_int32(env, args[0], &QueryID);
+    assert(status == napi_ok);
+
+    vector<enumHandleCout> enumHandleList;
+    bool done = false;
+    EnumHandleChannels.take(QueryID, enumHandleList, done);
+
     napi_value resultsModulePathList;
-    status = napi_create_array(env, &resultsModulePathList);
+    status = napi_create_array_with_length(env, enumHandleList.size(), &resultsModulePathList);
 
-    int EnumHandleQueryID;
-    status = napi_get_value_int32(env, args[0], &EnumHandleQueryID);
-    assert(status == napi_ok);
-    int push_data_len = 0;
-    for (size_t index = 0; index < resultsEnumHandleList.size(); index++)
+    for (size_t index = 0; index < enumHandleList.size(); index++)
     {
-        enumHandleCout enumHandle = resultsEnumHandleList[index];
-        if (enumHandle.id != EnumHandleQueryID)
-            continue;
+        const enumHandleCout &enumHandle = enumHandleList[index];
         napi_value cur_item;
-        status = napi_create_object(env, &cur_item);
-        if (status != napi_ok)
-        {
-            break;
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, cur_item, as_String("name"), as_String(enumHandle.name.c_str()));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, cur_item, as_String("handle"), as_Number(enumHandle.handle));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, cur_item, as_String("type"), as_String(enumHandle.type.c_str()));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_element(env, resultsModulePathList, (int)index, cur_item);
-        push_data_len++;
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        resultsEnumHandleList.erase(begin(resultsEnumHandleList) + index);
+        napi_create_object(env, &cur_item);
+        napi_set_property(env, cur_item, as_String("name"), as_String(enumHandle.name.c_str()));
+        napi_set_property(env, cur_item, as_String("handle"), as_Number(enumHandle.handle));
+        napi_set_property(env, cur_item, as_String("type"), as_String(enumHandle.type.c_str()));
+        napi_set_element(env, resultsModulePathList, (uint32_t)index, cur_item);
     }
-    if (push_data_len == 0)
+
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_property(env, result, as_String("data"), resultsModulePathList);
+    napi_set_property(env, result, as_String("done"), as_Boolean(done));
+
+    // 结束时附带统计
+    if (done)
     {
-        return NULL;
+        lock_guard<mutex> lock(EnumHandleStatsMutex);
+        auto it = EnumHandleStatsList.find(QueryID);
+        if (it != EnumHandleStatsList.end())
+        {
+            auto stats = hmc_napi_create_value::jsObject(env);
+            stats.putValue("handles", hmc_napi_create_value::Number(env, (int64_t)it->second.handles));
+            stats.putValue("timeouts", hmc_napi_create_value::Number(env, (int64_t)it->second.timeouts));
+            stats.putValue("skipped", hmc_napi_create_value::Number(env, (int64_t)it->second.skipped));
+            stats.putValue("elapsed", hmc_napi_create_value::Number(env, it->second.elapsed));
+            napi_set_property(env, result, as_String("stats"), stats.toValue());
+            EnumHandleStatsList.erase(it);
+        }
     }
-    return resultsModulePathList;
+    return result;
 };
 
 napi_value getProcessThreadList(napi_env env, napi_callback_info info)
@@ -813,16 +568,37 @@ napi_value getProcessThreadList(napi_env env, napi_callback_info info)
 
 napi_value clearEnumProcessHandle(napi_env env, napi_callback_info info)
 {
-    resultsEnumHandleList.clear();
+    EnumHandleChannels.clear();
+    lock_guard<mutex> lock(EnumHandleStatsMutex);
+    EnumHandleStatsList.clear();
+    return NULL;
+}
+
+// 放弃一个句柄枚举 (枚举线程会在下一次写入时停止)
+napi_value closeEnumProcessHandle(napi_env env, napi_callback_info info)
+{
+    napi_status status;
+    size_t argc = 1;
+    napi_value args[1];
+    status = $napi_get_cb_info(argc, args);
+    assert(status == napi_ok);
+    hmc_is_argv_type(args, 0, 1, napi_number, NULL);
+
+    int QueryID;
+    status = napi_get_value_int32(env, args[0], &QueryID);
+    assert(status == napi_ok);
+    EnumHandleChannels.close(QueryID);
+    lock_guard<mutex> lock(EnumHandleStatsMutex);
+    EnumHandleStatsList.erase(QueryID);
     return NULL;
 }
 
 #define MAX_KEY_LENGTH 255
 
-vector<HMC_PROCESSENTRY32> enumeratesProcessSnapshotStorage;
-int enumeratesProcessPollingId = 0;
+// 每次 enumAllProcess 的结果通道
+hmc_result_channel::Registry<HMC_PROCESSENTRY32> enumeratesProcessChannels;
 
-void start_enumAllProcess(int pollingId)
+void start_enumAllProcess(int pollingId, hmc_result_channel::Channel<HMC_PROCESSENTRY32> &channel)
 {
 
     EnableShutDownPriv();
@@ -865,85 +641,23 @@ void start_enumAllProcess(int pollingId)
     CloseHandle(hProcessSnap);
     for (size_t i = 0; i < enumProcessList.size(); i++)
     {
-        HMC_PROCESSENTRY32 p32 = enumProcessList[i];
-        // p32.szExeFile = L"";
-        // HANDLE hProcess = OpenProcess(PROCESS_ALL_ACCESS, FALSE, p32.th32ProcessID);
-
-        // wchar_t processName[MAX_PATH];
-        // if (GetModuleBaseNameW(hProcess, NULL, processName, MAX_PATH))
-        // {
-        //     p32.szExeFile = processName;
-        // };
-        // CloseHandle(hProcess);
-        // enumeratesProcessSnapshotStorage.push_back(p32);
-
-        // Sleep(5);
-        enumeratesProcessSnapshotStorage.push_back(p32);
+        // 查询已被放弃
+        if (!channel.push(std::move(enumProcessList[i])))
+        {
+            return;
+        }
     }
-
-    HMC_PROCESSENTRY32 _p32end;
-    _p32end.cntThreads = 0;
-    _p32end.cntUsage = 0;
-    _p32end.dwFlags = 0;
-    _p32end.dwSize = 0;
-    _p32end.pcPriClassBase = 0;
-    _p32end.szExeFile = L"HMC::endl::";
-    _p32end.th32DefaultHeapID = 0;
-    _p32end.th32ModuleID = 0;
-    _p32end.th32ParentProcessID = 0;
-    _p32end.th32ProcessID = 0;
-    _p32end.pollingId = pollingId;
-    enumeratesProcessSnapshotStorage.push_back(_p32end);
 };
 
+// 获取所有后代进程 (子进程 孙进程 ...)  广度优先
 void util_getSubProcessList(DWORD ProcessId, vector<DWORD> &SubProcessIDList)
 {
-
-    EnableShutDownPriv();
-    PROCESSENTRY32 pe32;
-    pe32.dwSize = sizeof(PROCESSENTRY32);
-
-    // 获取进程快照
-    HANDLE hSnap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (hSnap == INVALID_HANDLE_VALUE)
+    hmc_process_tree::Index index;
+    if (!index.build(false))
     {
         return;
     }
-
-    // 枚举第一个进程
-    if (Process32First(hSnap, &pe32))
-    {
-        do
-        {
-            // 打开进程句柄
-            HANDLE hProcess = OpenProcess(PROCESS_ALL_ACCESS, FALSE, pe32.th32ProcessID);
-            if (hProcess)
-            {
-                // 子进程的进程 ID
-                bool is_sub = pe32.th32ParentProcessID == ProcessId;
-
-                // 二次子进程
-                if (!is_sub)
-                {
-                    if (find(SubProcessIDList.begin(), SubProcessIDList.end(), pe32.th32ParentProcessID) != SubProcessIDList.end())
-                    {
-                        is_sub = true;
-                    }
-                }
-
-                if (is_sub)
-                {
-                    if (!(find(SubProcessIDList.begin(), SubProcessIDList.end(), pe32.th32ProcessID) != SubProcessIDList.end()))
-                    {
-                        SubProcessIDList.push_back(pe32.th32ProcessID);
-                    }
-                }
-                CloseHandle(hProcess);
-            }
-        } while (Process32Next(hSnap, &pe32));
-    }
-
-    CloseHandle(hSnap);
+    index.descendants(ProcessId, SubProcessIDList);
 };
 
 napi_value getSubProcessID(napi_env env, napi_callback_info info)
@@ -979,6 +693,73 @@ napi_value getSubProcessID(napi_env env, napi_callback_info info)
     return resultsSubProcessIDList;
 };
 
+/**
+ * @brief 获取进程树 (广度优先)
+ * getProcessTree(pid?: number, maxDepth?: number)
+ * 不传 pid 时返回所有进程 (从没有存活父进程的进程开始)
+ * @return {pid, ppid, depth, name}[]
+ */
+napi_value getProcessTree(napi_env env, napi_callback_info info)
+{
+    napi_status status;
+    size_t argc = 2;
+    napi_value args[2];
+    status = $napi_get_cb_info(argc, args);
+    assert(status == napi_ok);
+
+    napi_value results;
+    status = napi_create_array(env, &results);
+
+    bool has_pid = argc > 0 && util_diff_napi_type(env, args[0], napi_number);
+    int64_t ProcessID = 0;
+    int64_t maxDepth = -1;
+
+    if (has_pid)
+    {
+        napi_get_value_int64(env, args[0], &ProcessID);
+    }
+
+    if (argc > 1 && util_diff_napi_type(env, args[1], napi_number))
+    {
+        napi_get_value_int64(env, args[1], &maxDepth);
+    }
+
+    hmc_process_tree::Index index;
+    if (!index.build(true))
+    {
+        return results;
+    }
+
+    vector<hmc_process_tree::TreeNode> nodes;
+    size_t max_depth = maxDepth < 0 ? (size_t)-1 : (size_t)maxDepth;
+
+    if (has_pid)
+    {
+        index.tree((DWORD)ProcessID, nodes, max_depth);
+    }
+    else
+    {
+        index.forest(nodes, max_depth);
+    }
+
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        auto item = hmc_napi_create_value::jsObject(env);
+        item.putValue("pid", as_Number((int64_t)nodes[i].pid));
+        item.putValue("ppid", as_Number((int64_t)nodes[i].ppid));
+        item.putValue("depth", as_Number((int64_t)nodes[i].depth));
+        item.putValue("name", hmc_napi_create_value::String(env, nodes[i].name));
+
+        status = napi_set_element(env, results, (uint32_t)i, item.toValue());
+        if (status != napi_ok)
+        {
+            return results;
+        }
+    }
+
+    return results;
+};
+
 // napi_value getProcessParentProcessID(napi_env env, napi_callback_info info)
 // {
 //     napi_status status;
@@ -1036,24 +817,54 @@ napi_value getSubProcessID(napi_env env, napi_callback_info info)
 
 napi_value clearEnumAllProcessList(napi_env env, napi_callback_info info)
 {
-    enumeratesProcessSnapshotStorage.clear();
-    enumeratesProcessPollingId = 0;
+    enumeratesProcessChannels.clear();
+    return NULL;
+}
+
+// 放弃一个进程快照枚举
+napi_value closeEnumAllProcess(napi_env env, napi_callback_info info)
+{
+    napi_status status;
+    size_t argc = 1;
+    napi_value args[1];
+    status = $napi_get_cb_info(argc, args);
+    assert(status == napi_ok);
+    hmc_is_argv_type(args, 0, 1, napi_number, NULL);
+
+    int QueryID;
+    status = napi_get_value_int32(env, args[0], &QueryID);
+    assert(status == napi_ok);
+    enumeratesProcessChannels.close(QueryID);
     return NULL;
 }
 
+// enumAllProcess(onReadable?: () => void, highWaterMark?: number)
 napi_value enumAllProcess(napi_env env, napi_callback_info info)
 {
-    enumeratesProcessPollingId++;
-    thread(start_enumAllProcess, enumeratesProcessPollingId).detach();
-    return as_Number32(enumeratesProcessPollingId);
+    size_t argc = 2;
+    napi_value args[2];
+    $napi_get_cb_info(argc, args);
+
+    hmc_result_channel::Registry<HMC_PROCESSENTRY32>::ChannelPtr channel;
+    int pollingId = enumeratesProcessChannels.open(channel);
+    hmc_cursor::bindFromArgs(env, args, argc, 0, *channel);
+
+    // 无论快照是否成功 线程结束时都会标记结束
+    thread([pollingId, channel]()
+           {
+        start_enumAllProcess(pollingId, *channel);
+        channel->end(); })
+        .detach();
+
+    return as_Number32(pollingId);
 };
 
+/**
+ * @brief 取出进程快照枚举的结果
+ * 返回 { data: PROCESSENTRY[], done: boolean }  done 为 true 时查询已结束并被回收
+ */
 napi_value enumAllProcessPolling(napi_env env, napi_callback_info info)
 {
-    if (enumeratesProcessSnapshotStorage.empty())
-    {
-        return NULL;
-    }
     napi_status status;
     size_t argc = 1;
     napi_value args[1];
@@ -1061,97 +872,38 @@ napi_value enumAllProcessPolling(napi_env env, napi_callback_info info)
     assert(status == napi_ok);
     hmc_is_argv_type(args, 0, 1, napi_number, NULL);
 
-    napi_value resultsModulePathList;
-    status = napi_create_array(env, &resultsModulePathList);
-
     int QueryID;
     status = napi_get_value_int32(env, args[0], &QueryID);
     assert(status == napi_ok);
-    int push_data_len = 0;
-    for (size_t index = 0; index < enumeratesProcessSnapshotStorage.size(); index++)
-    {
-        HMC_PROCESSENTRY32 th32 = enumeratesProcessSnapshotStorage[index];
-        if (th32.pollingId != QueryID)
-            continue;
-        napi_value item;
-        status = napi_create_object(env, &item);
-        if (status != napi_ok)
-        {
-            break;
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, item, as_String("szExeFile"), as_String(th32.szExeFile.c_str()));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, item, as_String("th32ProcessID"), as_Number(th32.th32ProcessID));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, item, as_String("th32ParentProcessID"), as_Number(th32.th32ParentProcessID));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, item, as_String("cntThreads"), as_Number(th32.cntThreads));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, item, as_String("cntUsage"), as_Number(th32.cntUsage));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, item, as_String("dwFlags"), as_Number(th32.dwFlags));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, item, as_String("dwSize"), as_Number(th32.dwSize));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, item, as_String("pcPriClassBase"), as_Number(th32.pcPriClassBase));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, item, as_String("th32DefaultHeapID"), as_Number(th32.th32DefaultHeapID));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, item, as_String("th32ModuleID"), as_Number(th32.th32ModuleID));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, item, as_String("th32ParentProcessID"), as_Number(th32.th32ParentProcessID));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        status = napi_set_property(env, item, as_String("th32ProcessID"), as_Number(th32.th32ProcessID));
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
 
-        status = napi_set_element(env, resultsModulePathList, (int)index, item);
-        push_data_len++;
-        if (status != napi_ok)
-        {
-            return resultsModulePathList;
-        }
-        enumeratesProcessSnapshotStorage.erase(begin(enumeratesProcessSnapshotStorage) + index);
-    }
-    if (push_data_len == 0)
+    vector<HMC_PROCESSENTRY32> processList;
+    bool done = false;
+    enumeratesProcessChannels.take(QueryID, processList, done);
+
+    napi_value resultsModulePathList;
+    status = napi_create_array_with_length(env, processList.size(), &resultsModulePathList);
+
+    for (size_t index = 0; index < processList.size(); index++)
     {
-        return NULL;
+        const HMC_PROCESSENTRY32 &th32 = processList[index];
+        napi_value item;
+        napi_create_object(env, &item);
+        napi_set_property(env, item, as_String("szExeFile"), as_String(th32.szExeFile.c_str()));
+        napi_set_property(env, item, as_String("th32ProcessID"), as_Number(th32.th32ProcessID));
+        napi_set_property(env, item, as_String("th32ParentProcessID"), as_Number(th32.th32ParentProcessID));
+        napi_set_property(env, item, as_String("cntThreads"), as_Number(th32.cntThreads));
+        napi_set_property(env, item, as_String("cntUsage"), as_Number(th32.cntUsage));
+        napi_set_property(env, item, as_String("dwFlags"), as_Number(th32.dwFlags));
+        napi_set_property(env, item, as_String("dwSize"), as_Number(th32.dwSize));
+        napi_set_property(env, item, as_String("pcPriClassBase"), as_Number(th32.pcPriClassBase));
+        napi_set_property(env, item, as_String("th32DefaultHeapID"), as_Number(th32.th32DefaultHeapID));
+        napi_set_property(env, item, as_String("th32ModuleID"), as_Number(th32.th32ModuleID));
+        napi_set_element(env, resultsModulePathList, (uint32_t)index, item);
     }
-    return resultsModulePathList;
+
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_property(env, result, as_String("data"), resultsModulePathList);
+    napi_set_property(env, result, as_String("done"), as_Boolean(done));
+    return result;
 };
@@ -3,6 +3,7 @@
 #include "hmc_registr_util.h"
 #include "./registr_v2.hpp"
 #include "./Mian.hpp"
+#include "./util/hmc_napi_table.hpp"
 #include <format>
 
 napi_value removeRegistrFolder(napi_env env, napi_callback_info info)
@@ -149,38 +150,17 @@ napi_value getRegistrFolderStat(napi_env env, napi_callback_info info)
         return as_Null();
     }
 
-    // 预计算出大概需要多少内存 以减少文本处理 开辟内存的性能消耗 也能替换过程
-    size_t get_reserve_size = 0;
+    // 直接创建 js 对象 不再拼接 json 文本
+    auto stat = hmc_napi_create_value::jsObject(env);
+    stat.putValue("key", hmc_napi_table::utf16Array(env, QueryKeyList));
+    stat.putValue("folder", hmc_napi_table::utf16Array(env, QueryFolderList));
+    stat.putValue("size", as_Number((int64_t)(QueryFolderList.size() + QueryKeyList.size())));
+    stat.putValue("exists", as_Boolean(folderInfo.exists));
+    stat.putValue("folderSize", as_Number((int64_t)folderInfo.folderSize));
+    stat.putValue("keySize", as_Number((int64_t)folderInfo.keySize));
+    stat.putValue("time", folderInfo.time < 1 ? as_Null() : as_Number((int64_t)folderInfo.time));
 
-    if (is_keys)
-    {
-        size_t list_len = QueryFolderList.size();
-
-        for (size_t i = 0; i < list_len; i++)
-        {
-            get_reserve_size += QueryFolderList.at(i).size() + 16;
-        }
-
-        list_len = QueryKeyList.size();
-        for (size_t i = 0; i < list_len; i++)
-        {
-            get_reserve_size += QueryKeyList.at(i).size() + 16;
-        }
-    }
-
-    wstring jsonw = LR"({"key":{key} ,"folder":{folder} ,"size": {size} , "exists":{exists} , "folderSize":{folderSize} ,"keySize":{keySize} , "time":{time} })";
-    jsonw.reserve(get_reserve_size + jsonw.size());
-
-    hmc_string_util::replace(jsonw, L"{folder}", hmc_string_util::vec_to_array_json(QueryFolderList));
-    hmc_string_util::replace(jsonw, L"{key}", hmc_string_util::vec_to_array_json(QueryKeyList));
-
-    hmc_string_util::replace(jsonw, L"{exists}", folderInfo.exists ? L"true" : L"false");
-    hmc_string_util::replace(jsonw, L"{size}", to_wstring(QueryFolderList.size() + QueryKeyList.size()));
-    hmc_string_util::replace(jsonw, L"{folderSize}", to_wstring(folderInfo.folderSize));
-    hmc_string_util::replace(jsonw, L"{keySize}", to_wstring(folderInfo.keySize));
-    hmc_string_util::replace(jsonw, L"{time}", folderInfo.time < 1 ? L"null" : to_wstring(folderInfo.time));
-
-    result = hmc_napi_create_value::String(env, jsonw);
+    result = stat.toValue();
     return result;
 }
 
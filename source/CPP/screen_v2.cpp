@@ -1,6 +1,13 @@
 #include "./Mian.hpp";
 #include "./screen_v2.hpp";
 #include "hmc_napi_value_util.h";
+#include "./util/hmc_napi_table.hpp"
+#include "./util/hmc_screen_capture.hpp"
+#include "./util/hmc_pixel_search.hpp"
+#include "./util/hmc_image_match.hpp"
+#include "./util/hmc_capture_stream.hpp"
+#include <map>
+#include <memory>
 
 bool hmc_screen::isInside(int x1, int y1, int x2, int y2, int x, int y)
 {
@@ -9,94 +16,67 @@ bool hmc_screen::isInside(int x1, int y1, int x2, int y2, int x, int y)
     return false;
 }
 
-// 截屏并且将其写入到文件系统
-void hmc_screen::CaptureBmpToFile(string filename, int x, int y, int nScopeWidth, int nScopeHeight)
+// 截取屏幕区域到常驻的缓冲区  宽或高为 0 时为主屏幕的大小
+static hmc_screen_capture::Lease CaptureLease(int x, int y, int nScopeWidth, int nScopeHeight)
 {
-    vector<std::uint8_t> buffer;
-    CaptureBmpToBuff(buffer, x, y, nScopeWidth, nScopeHeight);
-
-    std::ofstream OutFile(filename.c_str(), std::ofstream::ios_base::trunc|std::ofstream::ios_base::binary );
+    if (nScopeWidth <= 0)
+    {
+        nScopeWidth = GetSystemMetrics(SM_CXSCREEN);
+    }
+    if (nScopeHeight <= 0)
+    {
+        nScopeHeight = GetSystemMetrics(SM_CYSCREEN);
+    }
+    return hmc_screen_capture::FramePool::shared().acquire(x, y, nScopeWidth, nScopeHeight);
+}
 
-    if (!OutFile.is_open())
+// 截屏并且将其写入到文件系统  编码结果分段直接写入文件 (不先生成完整的文件内容)
+bool hmc_screen::CaptureBmpToFile(string filename, int x, int y, int nScopeWidth, int nScopeHeight, const hmc_image_encode::Options &options)
+{
+    hmc_screen_capture::ScopedLease frame(CaptureLease(x, y, nScopeWidth, nScopeHeight));
+    if (frame.lease.id == 0)
     {
-        return;
+        return false;
     }
 
-    OutFile.write(reinterpret_cast<char *>(buffer.data()),buffer.size());
+    std::ofstream OutFile(filename.c_str(), std::ofstream::ios_base::trunc | std::ofstream::ios_base::binary);
 
-    if (OutFile.fail())
+    if (!OutFile.is_open())
     {
-        OutFile.close();
-        return;
+        return false;
     }
 
+    hmc_image_encode::Image image = {frame.lease.pixels, frame.lease.width, frame.lease.height, (size_t)frame.lease.width};
+    hmc_image_encode::StreamWriter writer(OutFile);
+    bool result = hmc_image_encode::encode(image, options, writer);
+
     OutFile.close();
+    return result && !OutFile.fail();
 }
 
-// 截屏bmp文件 并且返回为缓冲区
-void hmc_screen::CaptureBmpToBuff(vector<unsigned char> &buffer, int x, int y, int nScopeWidth, int nScopeHeight)
+// 截屏并且返回为缓冲区  默认为 bmp 文件 (24 位 自下而上)
+// 宽或高为 0 时为主屏幕的大小
+bool hmc_screen::CaptureBmpToBuff(vector<unsigned char> &buffer, int x, int y, int nScopeWidth, int nScopeHeight, const hmc_image_encode::Options &options)
 {
-    try
+    buffer.clear();
+
+    // 由 BitBlt 直接写入常驻的 DIB section  编码时原地读取
+    hmc_screen_capture::ScopedLease frame(CaptureLease(x, y, nScopeWidth, nScopeHeight));
+    if (frame.lease.id == 0)
     {
-        // 获取屏幕DC
-        HDC hScreenDC = CreateDC(TEXT("DISPLAY"), NULL, NULL, NULL);
-        // 获取屏幕分辨率
-        if (nScopeWidth == 0 || nScopeWidth == NULL)
-        {
-            nScopeWidth = GetDeviceCaps(hScreenDC, HORZRES);
-        }
-        if (nScopeHeight == 0 || nScopeHeight == NULL)
-        {
-            nScopeHeight = GetDeviceCaps(hScreenDC, VERTRES);
-        }
-        // 创建与屏幕DC兼容的内存DC
-        HDC hMemoryDC = CreateCompatibleDC(hScreenDC);
-        // 创建位图对象
-        HBITMAP hBitmap = CreateCompatibleBitmap(hScreenDC, nScopeWidth, nScopeHeight);
-        // 将位图选入内存DC中
-        HBITMAP hOldBitmap = (HBITMAP)SelectObject(hMemoryDC, hBitmap);
-        // 将屏幕内容拷贝到内存DC中
-        BitBlt(hMemoryDC, 0, 0, nScopeWidth, nScopeHeight, hScreenDC, 0, 0, SRCCOPY);
-        // 将位图保存到缓冲区
-        PBITMAPINFO pBitmapInfo = (PBITMAPINFO) new char[sizeof(BITMAPINFOHEADER)];
-        memset(pBitmapInfo, 0, sizeof(BITMAPINFOHEADER));
-        pBitmapInfo->bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-        pBitmapInfo->bmiHeader.biWidth = nScopeWidth;
-        pBitmapInfo->bmiHeader.biHeight = nScopeHeight;
-        pBitmapInfo->bmiHeader.biPlanes = 1;
-        pBitmapInfo->bmiHeader.biBitCount = 24;
-        pBitmapInfo->bmiHeader.biCompression = BI_RGB;
-        pBitmapInfo->bmiHeader.biSizeImage = nScopeWidth * nScopeHeight * 3;
-        char *pData = NULL;
-        HGLOBAL hGlobal = GlobalAlloc(GMEM_MOVEABLE, pBitmapInfo->bmiHeader.biSizeImage);
-        pData = (char *)GlobalLock(hGlobal);
-        GetDIBits(hMemoryDC, hBitmap, 0, nScopeHeight, pData, pBitmapInfo, DIB_RGB_COLORS);
-        // 计算文件大小
-        DWORD dwFileSize = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER) + pBitmapInfo->bmiHeader.biSizeImage;
-        // 分配缓冲区
-        buffer.resize(dwFileSize);
-        // 将位图数据拷贝到缓冲区中
-        BITMAPFILEHEADER bmfHeader;
-        bmfHeader.bfType = 0x4d42;
-        bmfHeader.bfOffBits = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER);
-        bmfHeader.bfSize = dwFileSize;
-        memcpy(&buffer[0], &bmfHeader, sizeof(BITMAPFILEHEADER));
-        memcpy(&buffer[sizeof(BITMAPFILEHEADER)], pBitmapInfo, sizeof(BITMAPINFOHEADER));
-        memcpy(&buffer[sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER)], pData, pBitmapInfo->bmiHeader.biSizeImage);
-        // 释放资源
-        GlobalUnlock(hGlobal);
-        GlobalFree(hGlobal);
-        SelectObject(hMemoryDC, hOldBitmap);
-        DeleteObject(hBitmap);
-        DeleteDC(hMemoryDC);
-        DeleteDC(hScreenDC);
-    }
-    catch (...)
-    {
-    }
-}
-
-// 获取屏幕上指定位置的颜色
+        return false;
+    }
+
+    hmc_image_encode::Image image = {frame.lease.pixels, frame.lease.width, frame.lease.height, (size_t)frame.lease.width};
+    if (options.format == hmc_image_encode::FORMAT_BMP)
+    {
+        buffer.reserve(54 + (((size_t)image.width * 3 + 3) & ~(size_t)3) * image.height);
+    }
+    hmc_image_encode::VectorWriter writer(buffer);
+    return hmc_image_encode::encode(image, options, writer);
+}
+
+// 获取屏幕上指定位置的颜色 (只复制该坐标的 1x1 区域)
 hmc_screen::chGetColorInfo hmc_screen::GetColor(int x, int y)
 {
     chGetColorInfo _ColorInfo;
@@ -104,60 +84,23 @@ hmc_screen::chGetColorInfo hmc_screen::GetColor(int x, int y)
     _ColorInfo.g = 0;
     _ColorInfo.r = 0;
     _ColorInfo.hex = "#000000";
-    // 获取屏幕DC
-    HDC hScreenDC = CreateDC(TEXT("DISPLAY"), NULL, NULL, NULL);
-    // 获取屏幕分辨率
-    int nScopeWidth = GetDeviceCaps(hScreenDC, HORZRES);
-    int nScopeHeight = GetDeviceCaps(hScreenDC, VERTRES);
-    int nScopeX = 0;
-    int nScopeY = 0;
-    // nScopeWidth = 3840;
-    //  坐标小于0肯定不对
-    if (x < 0 || y < 0)
+
+    // 虚拟屏幕坐标 (多显示器时可以为负数)  不在任何屏幕内的返回黑色
+    uint32_t color = hmc_screen_capture::pixel(x, y);
+    if (color == hmc_screen_capture::OUTSIDE)
     {
         return _ColorInfo;
     }
-    // 坐标超过了第一个屏幕  则应该开始判断是在第二个屏幕还是参数过界了
-    if (nScopeHeight < y || nScopeWidth < x)
-    {
-        int is_ok = false;
-        vector<RECT> deviceCapsAll = GetDeviceCapsAll();
-        for (size_t i = 0; i < deviceCapsAll.size(); i++)
-        {
-            RECT deviceCaps = deviceCapsAll[i];
-            if (isInside(deviceCaps.left, deviceCaps.top, deviceCaps.right, deviceCaps.bottom, x, y))
-            {
 
-                nScopeWidth = deviceCaps.right;
-                nScopeHeight = deviceCaps.bottom;
-                nScopeX = deviceCaps.left;
-                nScopeY = deviceCaps.top;
-                is_ok = true;
-            }
-        }
-        if (!is_ok)
-            return _ColorInfo;
-    }
-    HDC hMemoryDC = CreateCompatibleDC(hScreenDC);
-    HBITMAP hBitmap = CreateCompatibleBitmap(hScreenDC, nScopeWidth, nScopeHeight);
-    HBITMAP hOldBitmap = (HBITMAP)SelectObject(hMemoryDC, hBitmap);
-    BitBlt(hMemoryDC, 0, 0, nScopeWidth, nScopeHeight, hScreenDC, 0, 0, SRCCOPY);
-    COLORREF color = GetPixel(hMemoryDC, x, y);
-    SelectObject(hMemoryDC, hOldBitmap);
-    DeleteObject(hBitmap);
-    DeleteDC(hMemoryDC);
-    DeleteDC(hScreenDC);
-
-    int r = GetRValue(color);
-    int g = GetGValue(color);
-    int b = GetBValue(color);
+    int r = (color >> 16) & 0xFF;
+    int g = (color >> 8) & 0xFF;
+    int b = color & 0xFF;
     char hex[8];
-    sprintf_s(hex, "#%02X%02X%02X", r, g, b);
+    sprintf_s(hex, "#%02x%02x%02x", r, g, b);
     _ColorInfo.b = b;
     _ColorInfo.g = g;
     _ColorInfo.r = r;
     _ColorInfo.hex = hex;
-    transform(_ColorInfo.hex.begin(), _ColorInfo.hex.end(), _ColorInfo.hex.begin(), ::tolower);
 
     return _ColorInfo;
 }
@@ -191,11 +134,41 @@ vector<RECT> hmc_screen::GetDeviceCapsAll()
     return CrectList;
 }
 
+/**
+ * @brief 读取编码选项 (format, level)  format 为 "bmp" / "qoi" / "png"  不是字符串时保持 options.format
+ * @return false 已抛出异常
+ */
+static bool getEncodeOptions(napi_env env, napi_value *args, size_t argc, size_t index, hmc_image_encode::Options &options)
+{
+    if (argc > index && hmc_napi_type::isString(env, args[index]))
+    {
+        string format = hmc_napi_get_value::string_ansi(env, args[index]);
+        if (!hmc_image_encode::parseFormat(format, options.format))
+        {
+            napi_throw_range_error(env, 0, "format must be \"bmp\", \"qoi\" or \"png\"");
+            return false;
+        }
+    }
+
+    int32_t level = 0;
+    if (argc > index + 1 && napi_get_value_int32(env, args[index + 1], &level) == napi_ok && level > 0)
+    {
+        options.level = level;
+    }
+    return true;
+}
+
+/**
+ * @brief 截屏并写入文件
+ * captureBmpToFile(path, x, y, width, height, format?, level?) -> boolean
+ * format 为 "bmp" / "qoi" / "png"  不传时按文件扩展名 (无法识别时为 bmp)
+ * level 为 png 压缩等级 1-9
+ */
 napi_value captureBmpToFile(napi_env env, napi_callback_info info)
 {
     napi_status status;
-    size_t argc = 5;
-    napi_value args[5];
+    size_t argc = 7;
+    napi_value args[7];
     status = $napi_get_cb_info(argc, args);
     assert(status == napi_ok);
 
@@ -207,8 +180,46 @@ napi_value captureBmpToFile(napi_env env, napi_callback_info info)
     napi_get_value_int32(env, args[2], &y);
     napi_get_value_int32(env, args[3], &w);
     napi_get_value_int32(env, args[4], &h);
-    hmc_screen::CaptureBmpToFile(FilePathA, x, y, w, h);
-    return NULL;
+
+    hmc_image_encode::Options options;
+    options.format = hmc_image_encode::formatOfPath(FilePathA);
+    if (!getEncodeOptions(env, args, argc, 5, options))
+    {
+        return NULL;
+    }
+
+    return hmc_napi_create_value::Boolean(env, hmc_screen::CaptureBmpToFile(FilePathA, x, y, w, h, options));
+}
+
+/**
+ * @brief 截屏并返回编码后的文件内容
+ * captureBmpToBuff(x, y, width, height, format?, level?) -> Uint8Array | null
+ * format 为 "bmp" (默认) / "qoi" / "png"  level 为 png 压缩等级 1-9
+ */
+napi_value captureBmpToBuff(napi_env env, napi_callback_info info)
+{
+    size_t argc = 6;
+    napi_value args[6];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    int32_t region[4] = {0, 0, 0, 0};
+    for (size_t i = 0; i < argc && i < 4; i++)
+    {
+        napi_get_value_int32(env, args[i], &region[i]);
+    }
+
+    hmc_image_encode::Options options;
+    if (!getEncodeOptions(env, args, argc, 4, options))
+    {
+        return NULL;
+    }
+
+    vector<uint8_t> buffer;
+    if (!hmc_screen::CaptureBmpToBuff(buffer, region[0], region[1], region[2], region[3], options))
+    {
+        return hmc_napi_create_value::Null(env);
+    }
+    return hmc_napi_table::typedArray(env, napi_uint8_array, buffer);
 }
 
 napi_value getColor(napi_env env, napi_callback_info info)
@@ -234,3 +245,636 @@ napi_value getColor(napi_env env, napi_callback_info info)
 
     return _getColor;
 }
+
+/**
+ * @brief 批量取色  只截取一次包含所有坐标的矩形
+ * getColors([x0, y0, x1, y1, ...]) -> Uint32Array  每个坐标一个 0xRRGGBB  不在屏幕范围内为 0xFFFFFFFF
+ */
+napi_value getColors(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    bool is_array = false;
+    if (argc > 0)
+    {
+        napi_is_array(env, args[0], &is_array);
+    }
+    if (!is_array)
+    {
+        napi_throw_type_error(env, 0, "getColors(points) requires an array of [x0, y0, x1, y1, ...]");
+        return NULL;
+    }
+
+    uint32_t length = 0;
+    napi_get_array_length(env, args[0], &length);
+    if (length % 2 != 0)
+    {
+        napi_throw_range_error(env, 0, "points must contain x, y pairs");
+        return NULL;
+    }
+
+    vector<POINT> points(length / 2);
+    for (uint32_t i = 0; i < length; i++)
+    {
+        napi_value item;
+        int32_t value = 0;
+        napi_get_element(env, args[0], i, &item);
+        napi_get_value_int32(env, item, &value);
+        if (i % 2 == 0)
+            points[i / 2].x = value;
+        else
+            points[i / 2].y = value;
+    }
+
+    vector<uint32_t> colors;
+    hmc_screen_capture::pixels(points, colors);
+    return hmc_napi_table::typedArray(env, napi_uint32_array, colors);
+}
+
+/**
+ * @brief 在屏幕区域内按颜色搜索  区域只截取一次 在内存中由 SIMD 内核扫描
+ * pixelSearch([x, y, width, height], color, tolerance, step, mode, limit)
+ * 宽或高为 0 时搜索整个虚拟屏幕
+ * mode "first" -> {x, y} | null    "all" -> Int32Array [x0, y0, x1, y1, ...]    "count" -> number
+ */
+napi_value pixelSearch(napi_env env, napi_callback_info info)
+{
+    size_t argc = 6;
+    napi_value args[6];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    bool is_array = false;
+    if (argc >= 2)
+    {
+        napi_is_array(env, args[0], &is_array);
+    }
+    if (!is_array)
+    {
+        napi_throw_type_error(env, 0, "pixelSearch(region, color, tolerance, step, mode, limit) requires region [x, y, width, height] and color");
+        return NULL;
+    }
+
+    int32_t region[4] = {0, 0, 0, 0};
+    uint32_t region_length = 0;
+    napi_get_array_length(env, args[0], &region_length);
+    for (uint32_t i = 0; i < region_length && i < 4; i++)
+    {
+        napi_value item;
+        napi_get_element(env, args[0], i, &item);
+        napi_get_value_int32(env, item, &region[i]);
+    }
+
+    hmc_pixel_search::Options options;
+    napi_get_value_uint32(env, args[1], &options.color);
+
+    int32_t value = 0;
+    if (argc > 2 && napi_get_value_int32(env, args[2], &value) == napi_ok)
+    {
+        options.tolerance = value;
+    }
+    if (argc > 3 && napi_get_value_int32(env, args[3], &value) == napi_ok)
+    {
+        options.step = value;
+    }
+
+    if (argc > 4 && hmc_napi_type::isString(env, args[4]))
+    {
+        wstring mode = hmc_napi_get_value::string_utf16(env, args[4]);
+        if (mode == L"first")
+            options.mode = hmc_pixel_search::MODE_FIRST;
+        else if (mode == L"all")
+            options.mode = hmc_pixel_search::MODE_ALL;
+        else if (mode == L"count")
+            options.mode = hmc_pixel_search::MODE_COUNT;
+        else
+        {
+            napi_throw_range_error(env, 0, "mode must be \"first\", \"all\" or \"count\"");
+            return NULL;
+        }
+    }
+
+    if (argc > 5 && napi_get_value_int32(env, args[5], &value) == napi_ok && value > 0)
+    {
+        options.limit = (size_t)value;
+    }
+
+    if (region[2] <= 0 || region[3] <= 0)
+    {
+        RECT screen = hmc_screen_capture::virtualScreen();
+        region[0] = screen.left;
+        region[1] = screen.top;
+        region[2] = screen.right - screen.left;
+        region[3] = screen.bottom - screen.top;
+    }
+
+    // 在常驻的截图缓冲区中原地搜索
+    vector<hmc_pixel_search::Point> points;
+    size_t found = 0;
+    hmc_screen_capture::ScopedLease scoped(hmc_screen_capture::FramePool::shared().acquire(region[0], region[1], region[2], region[3]));
+    const hmc_screen_capture::Lease &frame = scoped.lease;
+    if (frame.id != 0)
+    {
+        hmc_pixel_search::Image image = {frame.pixels, frame.width, frame.height, (size_t)frame.width};
+        found = hmc_pixel_search::search(image, options, points);
+    }
+
+    if (options.mode == hmc_pixel_search::MODE_COUNT)
+    {
+        return hmc_napi_create_value::Number(env, (int64_t)found);
+    }
+
+    if (options.mode == hmc_pixel_search::MODE_FIRST)
+    {
+        if (points.empty())
+        {
+            return hmc_napi_create_value::Null(env);
+        }
+        auto point = hmc_napi_create_value::jsObject(env);
+        point.putValue("x", hmc_napi_create_value::Number(env, (int64_t)(frame.x + points[0].x)));
+        point.putValue("y", hmc_napi_create_value::Number(env, (int64_t)(frame.y + points[0].y)));
+        return point.toValue();
+    }
+
+    // 转为屏幕坐标
+    vector<int32_t> coordinates;
+    coordinates.reserve(points.size() * 2);
+    for (auto &point : points)
+    {
+        coordinates.push_back(frame.x + point.x);
+        coordinates.push_back(frame.y + point.y);
+    }
+    return hmc_napi_table::typedArray(env, napi_int32_array, coordinates);
+}
+
+/**
+ * @brief 在屏幕区域内查找模板图像 (找图)
+ * findImage(needle, needleWidth, needleHeight, [x, y, width, height], threshold, scales, limit)
+ * needle 为 Uint8Array / Buffer:  needleWidth 与 needleHeight 大于 0 时为 BGRA 像素  否则为 BMP 文件内容
+ * 区域宽或高为 0 时搜索整个虚拟屏幕
+ * 返回 Float64Array 每 6 个为一个结果 [x, y, width, height, score, scale] (屏幕坐标 按得分从高到低)
+ */
+napi_value findImage(napi_env env, napi_callback_info info)
+{
+    size_t argc = 7;
+    napi_value args[7];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    bool is_typedarray = false;
+    if (argc >= 4)
+    {
+        napi_is_typedarray(env, args[0], &is_typedarray);
+    }
+    if (!is_typedarray)
+    {
+        napi_throw_type_error(env, 0, "findImage(needle, needleWidth, needleHeight, region, threshold, scales, limit) requires needle as Uint8Array / Buffer");
+        return NULL;
+    }
+
+    napi_typedarray_type needle_type;
+    size_t needle_length = 0;
+    void *needle_data = NULL;
+    napi_get_typedarray_info(env, args[0], &needle_type, &needle_length, &needle_data, NULL, NULL);
+    if (needle_type != napi_uint8_array && needle_type != napi_uint8_clamped_array)
+    {
+        napi_throw_type_error(env, 0, "needle must be Uint8Array / Buffer");
+        return NULL;
+    }
+
+    int32_t needle_width = 0;
+    int32_t needle_height = 0;
+    napi_get_value_int32(env, args[1], &needle_width);
+    napi_get_value_int32(env, args[2], &needle_height);
+
+    hmc_image_match::Gray needle;
+    if (needle_width > 0 && needle_height > 0)
+    {
+        if (needle_length < (size_t)needle_width * needle_height * 4)
+        {
+            napi_throw_range_error(env, 0, "needle is smaller than needleWidth * needleHeight * 4");
+            return NULL;
+        }
+        // Uint8Array 不一定按 4 字节对齐
+        vector<uint32_t> needle_pixels((size_t)needle_width * needle_height);
+        memcpy(needle_pixels.data(), needle_data, needle_pixels.size() * sizeof(uint32_t));
+        hmc_image_match::toGray(needle_pixels.data(), needle_width, needle_height, (size_t)needle_width, needle);
+    }
+    else if (!hmc_image_match::decodeBmp((const uint8_t *)needle_data, needle_length, needle))
+    {
+        napi_throw_error(env, 0, "needle is not an uncompressed 24 / 32 bit bmp");
+        return NULL;
+    }
+
+    int32_t region[4] = {0, 0, 0, 0};
+    bool is_array = false;
+    napi_is_array(env, args[3], &is_array);
+    if (is_array)
+    {
+        uint32_t region_length = 0;
+        napi_get_array_length(env, args[3], &region_length);
+        for (uint32_t i = 0; i < region_length && i < 4; i++)
+        {
+            napi_value item;
+            napi_get_element(env, args[3], i, &item);
+            napi_get_value_int32(env, item, &region[i]);
+        }
+    }
+
+    hmc_image_match::Options options;
+    double threshold = 0;
+    if (argc > 4 && napi_get_value_double(env, args[4], &threshold) == napi_ok && threshold > 0)
+    {
+        options.threshold = threshold;
+    }
+
+    is_array = false;
+    if (argc > 5)
+    {
+        napi_is_array(env, args[5], &is_array);
+    }
+    if (is_array)
+    {
+        uint32_t scales_length = 0;
+        napi_get_array_length(env, args[5], &scales_length);
+        options.scales.clear();
+        for (uint32_t i = 0; i < scales_length; i++)
+        {
+            napi_value item;
+            double scale = 0;
+            napi_get_element(env, args[5], i, &item);
+            if (napi_get_value_double(env, item, &scale) == napi_ok && scale > 0)
+            {
+                options.scales.push_back(scale);
+            }
+        }
+    }
+
+    int32_t limit = 0;
+    if (argc > 6 && napi_get_value_int32(env, args[6], &limit) == napi_ok && limit > 0)
+    {
+        options.limit = (size_t)limit;
+    }
+
+    if (region[2] <= 0 || region[3] <= 0)
+    {
+        RECT screen = hmc_screen_capture::virtualScreen();
+        region[0] = screen.left;
+        region[1] = screen.top;
+        region[2] = screen.right - screen.left;
+        region[3] = screen.bottom - screen.top;
+    }
+
+    vector<hmc_image_match::Match> matches;
+    int frame_x = 0;
+    int frame_y = 0;
+    hmc_image_match::Gray haystack;
+    {
+        // 灰度转换后立即归还截图缓冲区
+        hmc_screen_capture::ScopedLease frame(hmc_screen_capture::FramePool::shared().acquire(region[0], region[1], region[2], region[3]));
+        if (frame.lease.id != 0)
+        {
+            frame_x = frame.lease.x;
+            frame_y = frame.lease.y;
+            hmc_image_match::toGray(frame.lease.pixels, frame.lease.width, frame.lease.height, (size_t)frame.lease.width, haystack);
+        }
+    }
+    if (!haystack.pixels.empty())
+    {
+        hmc_image_match::find(haystack, needle, options, matches);
+    }
+
+    vector<double> rows;
+    rows.reserve(matches.size() * 6);
+    for (auto &match : matches)
+    {
+        rows.push_back(frame_x + match.x);
+        rows.push_back(frame_y + match.y);
+        rows.push_back(match.width);
+        rows.push_back(match.height);
+        rows.push_back(match.score);
+        rows.push_back(match.scale);
+    }
+    return hmc_napi_table::typedArray(env, napi_float64_array, rows);
+}
+
+// 截图 ArrayBuffer 被回收时归还缓冲区
+static void finalizeScreenFrame(napi_env env, void *data, void *hint)
+{
+    uint64_t *lease_id = (uint64_t *)hint;
+    hmc_screen_capture::FramePool::shared().release(*lease_id);
+    delete lease_id;
+}
+
+/**
+ * @brief 截取屏幕区域 像素直接由常驻的 DIB section 提供给 JS (不复制)
+ * captureScreenFrame(x, y, width, height) -> {x, y, width, height, data: ArrayBuffer (BGRA 自上而下)} | null
+ * 宽或高为 0 时为整个虚拟屏幕  用完后调用 releaseScreenFrame(data) 可立即归还 (否则在回收时归还)
+ * JS 持有的缓冲区达到 FramePool::MAX_EXTERNAL 个时 改为复制到普通的 ArrayBuffer (不再占用 DIB section)
+ */
+napi_value captureScreenFrame(napi_env env, napi_callback_info info)
+{
+    size_t argc = 4;
+    napi_value args[4];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    int32_t region[4] = {0, 0, 0, 0};
+    for (size_t i = 0; i < argc && i < 4; i++)
+    {
+        napi_get_value_int32(env, args[i], &region[i]);
+    }
+
+    if (region[2] <= 0 || region[3] <= 0)
+    {
+        RECT screen = hmc_screen_capture::virtualScreen();
+        region[0] = screen.left;
+        region[1] = screen.top;
+        region[2] = screen.right - screen.left;
+        region[3] = screen.bottom - screen.top;
+    }
+
+    hmc_screen_capture::FramePool &pool = hmc_screen_capture::FramePool::shared();
+    hmc_screen_capture::Lease lease = pool.acquire(region[0], region[1], region[2], region[3], true);
+    bool is_external = lease.id != 0;
+    if (!is_external)
+    {
+        // JS 持有的缓冲区已达上限  截图后复制 缓冲区立即归还
+        lease = pool.acquire(region[0], region[1], region[2], region[3]);
+    }
+    if (lease.id == 0)
+    {
+        return hmc_napi_create_value::Null(env);
+    }
+
+    napi_value data;
+    napi_status status = napi_generic_failure;
+    if (is_external)
+    {
+        uint64_t *lease_id = new uint64_t(lease.id);
+        status = napi_create_external_arraybuffer(env, lease.pixels, lease.byteLength(), finalizeScreenFrame, lease_id, &data);
+        if (status != napi_ok)
+        {
+            delete lease_id;
+        }
+    }
+    if (status != napi_ok)
+    {
+        // 已达上限 或者不允许外部内存时 (例如 electron 的 V8 沙箱) 复制一次
+        void *copy = NULL;
+        status = napi_create_arraybuffer(env, lease.byteLength(), &copy, &data);
+        if (status == napi_ok)
+        {
+            memcpy(copy, lease.pixels, lease.byteLength());
+        }
+        pool.release(lease.id);
+        if (status != napi_ok)
+        {
+            return hmc_napi_create_value::Null(env);
+        }
+    }
+
+    auto object = hmc_napi_create_value::jsObject(env);
+    object.putValue("x", hmc_napi_create_value::Number(env, (int64_t)lease.x));
+    object.putValue("y", hmc_napi_create_value::Number(env, (int64_t)lease.y));
+    object.putValue("width", hmc_napi_create_value::Number(env, (int64_t)lease.width));
+    object.putValue("height", hmc_napi_create_value::Number(env, (int64_t)lease.height));
+    object.putValue("data", data);
+    return object.toValue();
+}
+
+/**
+ * @brief 立即归还 captureScreenFrame 的缓冲区  ArrayBuffer 会被分离 (之后长度为 0)
+ * releaseScreenFrame(data) -> boolean
+ */
+napi_value releaseScreenFrame(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    bool is_arraybuffer = false;
+    if (argc > 0)
+    {
+        napi_is_arraybuffer(env, args[0], &is_arraybuffer);
+    }
+    if (!is_arraybuffer)
+    {
+        return hmc_napi_create_value::Boolean(env, false);
+    }
+
+    void *data = NULL;
+    size_t length = 0;
+    napi_get_arraybuffer_info(env, args[0], &data, &length);
+    if (data == NULL)
+    {
+        return hmc_napi_create_value::Boolean(env, false);
+    }
+
+    // 只处理 captureScreenFrame 返回的 (不分离其他的 ArrayBuffer)
+    hmc_screen_capture::FramePool &pool = hmc_screen_capture::FramePool::shared();
+    if (!pool.isLeased(data))
+    {
+        return hmc_napi_create_value::Boolean(env, false);
+    }
+
+    // 先分离 JS 不会再读到之后被复用的内存
+    if (napi_detach_arraybuffer(env, args[0]) != napi_ok)
+    {
+        return hmc_napi_create_value::Boolean(env, false);
+    }
+    return hmc_napi_create_value::Boolean(env, pool.releasePixels(data));
+}
+
+// 连续截图流  startCaptureStream 返回的 id -> 截图线程与投递用的 threadsafe_function (只在 js 线程访问)
+struct CaptureStreamEntry
+{
+    std::unique_ptr<hmc_capture_stream::Stream> stream;
+    napi_threadsafe_function tsfn = NULL;
+};
+static std::map<uint32_t, CaptureStreamEntry> CaptureStreamList;
+static uint32_t CaptureStreamNextId = 1;
+
+// 截图线程调用 只排队 不阻塞
+// 队列不限长度  任何失败 (不只是 napi_closing) 都不会再回调 js 取走投递  返回 false 让截图线程结束 (否则一直等待取走)
+static bool CaptureStreamNotify(void *context)
+{
+    return napi_call_threadsafe_function((napi_threadsafe_function)context, NULL, napi_tsfn_nonblocking) == napi_ok;
+}
+
+/**
+ * @brief 在js线程中执行  取出等待中的投递回调给js
+ * callback({frame, timestamp, x, y, width, height, dropped, rects: Int32Array, data: ArrayBuffer})
+ */
+static void CaptureStreamCallJs(napi_env env, napi_value js_cb, void *context, void *data)
+{
+    if (env == NULL || js_cb == NULL)
+    {
+        return;
+    }
+
+    // 已停止的流 (停止前排队的投递)
+    auto entry = CaptureStreamList.find((uint32_t)(uintptr_t)context);
+    if (entry == CaptureStreamList.end())
+    {
+        return;
+    }
+
+    // 只会在js线程使用 与截图线程交换复用内存
+    static hmc_capture_stream::Delivery delivery;
+    if (!entry->second.stream->take(delivery))
+    {
+        return;
+    }
+
+    void *buffer = NULL;
+    napi_value pixels, undefined;
+    size_t byte_length = delivery.pixels.size() * sizeof(uint32_t);
+    if (napi_create_arraybuffer(env, byte_length, &buffer, &pixels) != napi_ok)
+    {
+        return;
+    }
+    if (byte_length != 0)
+    {
+        memcpy(buffer, delivery.pixels.data(), byte_length);
+    }
+
+    auto object = hmc_napi_create_value::jsObject(env);
+    object.putValue("frame", hmc_napi_create_value::Number(env, (int64_t)delivery.frame));
+    object.putValue("timestamp", hmc_napi_create_value::Number(env, delivery.timestamp));
+    object.putValue("x", hmc_napi_create_value::Number(env, (int64_t)delivery.x));
+    object.putValue("y", hmc_napi_create_value::Number(env, (int64_t)delivery.y));
+    object.putValue("width", hmc_napi_create_value::Number(env, (int64_t)delivery.width));
+    object.putValue("height", hmc_napi_create_value::Number(env, (int64_t)delivery.height));
+    object.putValue("dropped", hmc_napi_create_value::Number(env, (int64_t)delivery.dropped));
+    object.putValue("rects", hmc_napi_table::typedArray(env, napi_int32_array, delivery.rects));
+    object.putValue("data", pixels);
+
+    napi_value frame = object.toValue();
+    napi_get_undefined(env, &undefined);
+    napi_call_function(env, undefined, js_cb, 1, &frame, NULL);
+}
+
+/**
+ * @brief 开始连续截图  只投递与上一帧相比变化的 64x64 块 (同一行相邻的合并为一个矩形)
+ * startCaptureStream([x, y, width, height], fps, callback) -> id
+ * 区域宽或高为 0 时为整个虚拟屏幕  第一次投递为整个区域
+ * js 处理不过来时 变化合并到下一次投递 (dropped 为合并的帧数)
+ */
+napi_value startCaptureStream(napi_env env, napi_callback_info info)
+{
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    bool is_array = false;
+    if (argc >= 3)
+    {
+        napi_is_array(env, args[0], &is_array);
+    }
+    if (!is_array || !util_diff_napi_type(env, args[2], napi_function))
+    {
+        napi_throw_type_error(env, 0, "startCaptureStream(region, fps, callback) requires region [x, y, width, height] and callback");
+        return NULL;
+    }
+
+    int32_t region[4] = {0, 0, 0, 0};
+    uint32_t region_length = 0;
+    napi_get_array_length(env, args[0], &region_length);
+    for (uint32_t i = 0; i < region_length && i < 4; i++)
+    {
+        napi_value item;
+        napi_get_element(env, args[0], i, &item);
+        napi_get_value_int32(env, item, &region[i]);
+    }
+
+    double fps = 10;
+    if (napi_get_value_double(env, args[1], &fps) != napi_ok || !(fps > 0))
+    {
+        fps = 10;
+    }
+
+    uint32_t id = CaptureStreamNextId++;
+
+    napi_value work_name;
+    napi_threadsafe_function tsfn = NULL;
+    napi_create_string_utf8(env, "hmc::captureStream", NAPI_AUTO_LENGTH, &work_name);
+
+    if (napi_create_threadsafe_function(env, args[2], NULL, work_name, 0, 1, NULL, NULL, (void *)(uintptr_t)id, CaptureStreamCallJs, &tsfn) != napi_ok)
+    {
+        napi_throw_error(env, "Creation_failed", "startCaptureStream < napi_create_threadsafe_function failed. >");
+        return NULL;
+    }
+
+    CaptureStreamEntry &entry = CaptureStreamList[id];
+    entry.tsfn = tsfn;
+    entry.stream.reset(new hmc_capture_stream::Stream(region[0], region[1], region[2], region[3], fps, CaptureStreamNotify, tsfn));
+    entry.stream->start();
+
+    return hmc_napi_create_value::Number(env, (int64_t)id);
+}
+
+/**
+ * @brief 停止连续截图 (等待截图线程结束)
+ * stopCaptureStream(id) -> boolean
+ */
+napi_value stopCaptureStream(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    uint32_t id = 0;
+    if (argc > 0)
+    {
+        napi_get_value_uint32(env, args[0], &id);
+    }
+
+    auto entry = CaptureStreamList.find(id);
+    if (entry == CaptureStreamList.end())
+    {
+        return hmc_napi_create_value::Boolean(env, false);
+    }
+
+    entry->second.stream->stop();
+    napi_release_threadsafe_function(entry->second.tsfn, napi_tsfn_release);
+    CaptureStreamList.erase(entry);
+    return hmc_napi_create_value::Boolean(env, true);
+}
+
+/**
+ * @brief 连续截图的计数
+ * getCaptureStreamStats(id) -> {running, frames, delivered, dropped, overruns, failed} | null
+ * - frames 已截取的帧数
+ * - delivered 已投递的次数
+ * - dropped 有变化但 js 还没处理完上一次投递 合并到之后投递的帧数
+ * - overruns 截图与比较的时间超过帧间隔而跳过的帧数
+ * - failed 截图失败的帧数
+ */
+napi_value getCaptureStreamStats(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    uint32_t id = 0;
+    if (argc > 0)
+    {
+        napi_get_value_uint32(env, args[0], &id);
+    }
+
+    auto entry = CaptureStreamList.find(id);
+    if (entry == CaptureStreamList.end())
+    {
+        return hmc_napi_create_value::Null(env);
+    }
+
+    hmc_capture_stream::Stats stats = entry->second.stream->stats();
+    auto object = hmc_napi_create_value::jsObject(env);
+    object.putValue("running", hmc_napi_create_value::Boolean(env, entry->second.stream->running()));
+    object.putValue("frames", hmc_napi_create_value::Number(env, (int64_t)stats.frames));
+    object.putValue("delivered", hmc_napi_create_value::Number(env, (int64_t)stats.delivered));
+    object.putValue("dropped", hmc_napi_create_value::Number(env, (int64_t)stats.dropped));
+    object.putValue("overruns", hmc_napi_create_value::Number(env, (int64_t)stats.overruns));
+    object.putValue("failed", hmc_napi_create_value::Number(env, (int64_t)stats.failed));
+    return object.toValue();
+}
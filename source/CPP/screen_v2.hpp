@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 #include "./Mian.hpp";
+#include "./util/hmc_image_encode.hpp"
 
 namespace hmc_screen
 {
@@ -24,8 +25,9 @@ namespace hmc_screen
     std::vector<RECT> GetDeviceCapsAll();
     chGetColorInfo GetColor(int x, int y);
     bool isInside(int x1, int y1, int x2, int y2, int x, int y);
-    void CaptureBmpToBuff(std::vector<std::uint8_t> &buffer, int x, int y, int nScopeWidth, int nScopeHeight);
-    void CaptureBmpToFile(std::string filename, int x, int y, int nScopeWidth, int nScopeHeight);
+    // options.format 为 BMP (默认) / QOI / PNG
+    bool CaptureBmpToBuff(std::vector<std::uint8_t> &buffer, int x, int y, int nScopeWidth, int nScopeHeight, const hmc_image_encode::Options &options = hmc_image_encode::Options());
+    bool CaptureBmpToFile(std::string filename, int x, int y, int nScopeWidth, int nScopeHeight, const hmc_image_encode::Options &options = hmc_image_encode::Options());
 
 }
 
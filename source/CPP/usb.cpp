@@ -12,6 +12,7 @@
 #include <Usbioctl.h>
 #include <node_api.h>
 #pragma comment(lib, "Setupapi.lib")
+#include "./util/hmc_device_path.hpp"
 #include "./util.h";
 using namespace std;
 
@@ -432,3 +433,33 @@ napi_value formatVolumePath(napi_env env, napi_callback_info info)
     }
     return as_String(VolumePaths.c_str());
 }
+
+napi_value translatePaths(napi_env env, napi_callback_info info)
+{
+    auto input = hmc_NodeArgsValue(env, info);
+
+    // 参数1 单个路径 或 路径数组
+    vector<wstring> paths;
+    if (input.eq(0, js_string, false))
+    {
+        paths.push_back(input.getStringWide(0, L""));
+    }
+    else
+    {
+        input.eq({{0, js_array}}, true);
+        paths = input.getArrayWstring(0, {});
+    }
+
+    // 整批共用同一份设备路径索引
+    hmc_device_path::Index::shared().translate(paths);
+
+    napi_value Results;
+    napi_create_array_with_length(env, paths.size(), &Results);
+    for (size_t index = 0; index < paths.size(); index++)
+    {
+        napi_value path;
+        napi_create_string_utf16(env, (const char16_t *)paths[index].c_str(), paths[index].size(), &path);
+        napi_set_element(env, Results, (uint32_t)index, path);
+    }
+    return Results;
+}
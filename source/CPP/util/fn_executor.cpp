@@ -0,0 +1,75 @@
+#include "../Mian.hpp";
+#include "hmc_napi_value_util.h";
+#include "./hmc_executor.hpp"
+
+// 执行器通道统计 -> js 对象 (时间单位为毫秒)
+static napi_value format_lane_stats(napi_env env, hmc_executor::Lane lane)
+{
+    hmc_executor::LaneStats stats = hmc_executor::Executor::shared().getStats(lane);
+
+    double avg_wait_ms = stats.completed ? (double)stats.total_wait_us / (double)stats.completed / 1000.0 : 0;
+    double avg_run_ms = stats.completed ? (double)stats.total_run_us / (double)stats.completed / 1000.0 : 0;
+
+    auto object = hmc_napi_create_value::jsObject(env);
+    object.putValue("workers", as_Number((int64_t)stats.workers));
+    object.putValue("depth", as_Number((int64_t)stats.depth));
+    object.putValue("running", as_Number((int64_t)stats.running));
+    object.putValue("maxDepth", as_Number((int64_t)stats.max_depth));
+    object.putValue("submitted", as_Number((int64_t)stats.submitted));
+    object.putValue("completed", as_Number((int64_t)stats.completed));
+    object.putValue("avgWaitMs", as_Number(avg_wait_ms));
+    object.putValue("maxWaitMs", as_Number((double)stats.max_wait_us / 1000.0));
+    object.putValue("avgRunMs", as_Number(avg_run_ms));
+    object.putValue("maxRunMs", as_Number((double)stats.max_run_us / 1000.0));
+    return object.toValue();
+}
+
+/**
+ * @brief 获取异步执行器的队列深度与延迟统计
+ * { quick: {...}, long: {...} }
+ */
+napi_value fn_getExecutorStats(napi_env env, napi_callback_info info)
+{
+    auto object = hmc_napi_create_value::jsObject(env);
+    object.putValue("quick", format_lane_stats(env, hmc_executor::LANE_QUICK));
+    object.putValue("long", format_lane_stats(env, hmc_executor::LANE_LONG));
+    return object.toValue();
+}
+
+/**
+ * @brief 设置异步执行器
+ * { quickWorkers?: number, longWorkers?: number, resetStats?: boolean }
+ */
+napi_value fn_setExecutorOptions(napi_env env, napi_callback_info info)
+{
+    napi_value result;
+    napi_get_undefined(env, &result);
+
+    size_t argc = 1;
+    napi_value args[1];
+    if (napi_get_cb_info(env, info, &argc, args, NULL, NULL) != napi_ok || argc < 1 || !util_diff_napi_type(env, args[0], napi_object))
+    {
+        return result;
+    }
+
+    const char *lane_names[hmc_executor::LANE_COUNT] = {"quickWorkers", "longWorkers"};
+
+    for (size_t i = 0; i < hmc_executor::LANE_COUNT; i++)
+    {
+        napi_value item;
+        int64_t count = 0;
+        if (napi_get_named_property(env, args[0], lane_names[i], &item) == napi_ok && util_diff_napi_type(env, item, napi_number) && napi_get_value_int64(env, item, &count) == napi_ok)
+        {
+            hmc_executor::Executor::shared().setWorkerCount((hmc_executor::Lane)i, (size_t)(count < 1 ? 1 : count));
+        }
+    }
+
+    napi_value reset_stats;
+    bool is_reset_stats = false;
+    if (napi_get_named_property(env, args[0], "resetStats", &reset_stats) == napi_ok && util_diff_napi_type(env, reset_stats, napi_boolean) && napi_get_value_bool(env, reset_stats, &is_reset_stats) == napi_ok && is_reset_stats)
+    {
+        hmc_executor::Executor::shared().resetStats();
+    }
+
+    return result;
+}
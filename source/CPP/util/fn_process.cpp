@@ -4,6 +4,13 @@
 // #include "./environment.hpp";
 // #include "./fmt11.hpp";
 #include "./GetProcessCommandLineByPid.hpp";
+#include "./hmc_promise_pool.hpp"
+#include "./hmc_cpu_sampler.hpp"
+#include "./hmc_process_diff.hpp"
+#include "./hmc_napi_table.hpp"
+#include "./hmc_module_cache.hpp"
+#include "./hmc_handle_search.hpp"
+#include "./hmc_device_path.hpp"
 
 vector<HMC_PROCESSENTRY32W> GetProcessSnapshot(vector<DWORD> pid_list, bool early_result);
 vector<HMC_PROCESSENTRY32W> GetProcessSnapshot(size_t Start, size_t End);
@@ -219,24 +226,7 @@ wstring GetProcessIdFilePathW(DWORD processID, bool is_snapshot_match)
 	//
 	if (!result.empty() && result.front() == '\\')
 	{
-		vector<util_Volume> volumeList = util_getVolumeList();
-
-		for (size_t i = 0; i < volumeList.size(); i++)
-		{
-		    util_Volume volume = volumeList[i];
-			volume.path.push_back('\\');
-			
-		    if (result.find(volume.device) == 0)
-		    {
-		        result.replace(0, volume.device.length(), volume.path);
-		    }
-		    
-			if (result.find(volume.name) == 0)
-		    {
-		        result.replace(0, volume.name.length(), volume.path);
-		    }
-			
-		}
+		result = hmc_device_path::Index::shared().translate(result);
 	}
 
 	// 处理 ntoskrnl.exe 不可见问题
@@ -288,56 +278,53 @@ wstring GetProcessIdFilePathW(DWORD processID, bool is_snapshot_match)
 
 namespace fn_getAllProcessList
 {
-	NEW_PROMISE_FUNCTION_DEFAULT_FUN$SP;
+	NEW_PROMISE_POOL_FUNCTION$SP;
+
+	struct ProcessListResult
+	{
+		bool is_execPath;
+		vector<DWORD> pid_list;
+		vector<wstring> path_list;
+	};
 
-	wstring GetAllProcessList(bool is_execPath)
+	ProcessListResult GetAllProcessList(bool is_execPath)
 	{
+		ProcessListResult result = {is_execPath, {}, {}};
 
 		EnableShutDownPriv();
 
-		DWORD processList[1024], lpcbNeeded;
-		if (!EnumProcesses(processList, sizeof(processList), &lpcbNeeded))
+		// 缓冲区被填满时说明可能还有更多进程
+		vector<DWORD> processList(1024);
+		DWORD lpcbNeeded = 0;
+		while (true)
 		{
-			return L"[]";
+			DWORD buffer_size = (DWORD)(processList.size() * sizeof(DWORD));
+			if (!EnumProcesses(processList.data(), buffer_size, &lpcbNeeded))
+			{
+				return result;
+			}
+			if (lpcbNeeded < buffer_size)
+			{
+				break;
+			}
+			processList.resize(processList.size() * 2);
 		}
 
-		wstring jsonValue = L"[";
+		size_t processe_leng = lpcbNeeded / sizeof(DWORD);
+		result.pid_list.assign(processList.begin(), processList.begin() + processe_leng);
 
-		int processe_leng = lpcbNeeded / sizeof(DWORD);
-		for (int i = 0; i < processe_leng; ++i)
+		if (is_execPath)
 		{
-			DWORD pid = processList[i];
-			wstring item = wstring(L"{\"pid\":");
-			item.append(to_wstring(pid));
-			// {"pid":0
-			if (is_execPath)
+			result.path_list.reserve(processe_leng);
+			for (size_t i = 0; i < processe_leng; ++i)
 			{
-				item.push_back(L',');
-				auto exec_path = GetProcessIdFilePathW(pid, false);
-				item.append(hmc_string_util::escapeJsonString(L"path", true));
-				item.push_back(L':');
-				item.append(hmc_string_util::escapeJsonString(exec_path, true));
-				item.push_back(L',');
-				// {"pid":0,"path":"...",
-				item.append(hmc_string_util::escapeJsonString(L"name", true));
-				item.push_back(L':');
-				item.append(hmc_string_util::escapeJsonString(hmc_string_util::getPathBaseName(exec_path), true));
-				// {"pid":0,"path":"...","name":"..."
+				result.path_list.push_back(GetProcessIdFilePathW(result.pid_list[i], false));
 			}
-
-			item.push_back(L'}');
-			if (i < processe_leng - 1)
-			{
-				item.push_back(L',');
-			}
-
-			jsonValue.append(item);
 		}
-		jsonValue.push_back(L']');
 
-		return jsonValue;
+		return result;
 	}
-	// NEW_PROMISE_FUNCTION_DEFAULT_FUN end
+
 	any PromiseWorkFunc(vector<any> arguments_list)
 	{
 		any result = GetAllProcessList(arguments_list.size() == 1);
@@ -354,8 +341,24 @@ namespace fn_getAllProcessList
 			return result;
 		}
 
-		result = hmc_napi_create_value::String(env, any_cast<wstring>(result_any_data));
-		return result;
+		// [pid]  [path, name]
+		auto process_list = any_cast<ProcessListResult>(result_any_data);
+		size_t leng = process_list.pid_list.size();
+		hmc_napi_table::Table table(env, leng, 1, process_list.is_execPath ? 2 : 0);
+
+		for (size_t i = 0; i < leng; i++)
+		{
+			table.numbers(i)[0] = process_list.pid_list[i];
+
+			if (process_list.is_execPath)
+			{
+				const wstring &exec_path = process_list.path_list[i];
+				table.setString(i, 0, exec_path);
+				table.setString(i, 1, hmc_string_util::getPathBaseName(exec_path));
+			}
+		}
+
+		return table.toValue();
 	}
 };
 
@@ -410,103 +413,238 @@ vector<HMC_PROCESSENTRY32W> GetProcessSnapshot()
 	return result;
 }
 
-// 定义 ZwQuerySystemInformation 函数签名
-typedef NTSTATUS(NTAPI *ZwQuerySystemInformation_t)(SYSTEM_INFORMATION_CLASS, PVOID, ULONG, PULONG);
-
-// #define STATUS_INFO_LENGTH_MISMATCH 0xc0000004
-// #define STATUS_SUCCESS 0x00000000
-
 namespace fn_getAllProcessNtList
 {
-	NEW_PROMISE_FUNCTION_DEFAULT_FUN$SP;
+	NEW_PROMISE_POOL_FUNCTION$SP;
 	// NEW_PROMISE_FUNCTION_DEFAULT_FUN end
 
-	wstring GetAllProcessList()
+	// 每行的数值 顺序与 hmc.ts unpackProcessListNt 一致
+	constexpr size_t NUMBER_WIDTH = 15;
+
+	struct NtProcessItem
 	{
+		wstring ImageName;
+		double numbers[NUMBER_WIDTH];
+	};
 
-		wstring jsonValue = L"[";
+	any PromiseWorkFunc(vector<any> arguments_list)
+	{
+		vector<NtProcessItem> result;
 
-		// 加载 ntdll.dll
-		HMODULE ntdll = LoadLibraryW(L"ntdll.dll");
-		if (ntdll == NULL)
+		hmc_nt_process::Snapshot snapshot;
+		if (!snapshot.refresh())
 		{
-			return L"[]";
+			return result;
 		}
-		hmc_shared_close_Library(ntdll);
 
-		// 获取 ZwQuerySystemInformation 函数地址
-		ZwQuerySystemInformation_t ZwQuerySystemInformation = (ZwQuerySystemInformation_t)GetProcAddress(ntdll, "NtQuerySystemInformation");
-		if (ZwQuerySystemInformation == NULL)
+		snapshot.forEach([&](const hmc_nt_process::HMC_SYSTEM_PROCESS_INFORMATION &info)
+						 {
+			NtProcessItem item;
+			if (info.ImageName.Buffer != NULL && info.ImageName.Length > 0)
+			{
+				item.ImageName.assign(info.ImageName.Buffer, info.ImageName.Length / sizeof(WCHAR));
+			}
+
+			double *row = item.numbers;
+			row[0] = (double)(ULONG_PTR)info.UniqueProcessId;
+			row[1] = info.NextEntryOffset;
+			row[2] = info.NumberOfThreads;
+			row[3] = info.BasePriority;
+			row[4] = info.HandleCount;
+			row[5] = info.SessionId;
+			row[6] = (double)info.PeakVirtualSize;
+			row[7] = (double)info.VirtualSize;
+			row[8] = (double)info.PeakWorkingSetSize;
+			row[9] = (double)info.WorkingSetSize;
+			row[10] = (double)info.QuotaPagedPoolUsage;
+			row[11] = (double)info.QuotaNonPagedPoolUsage;
+			row[12] = (double)info.PagefileUsage;
+			row[13] = (double)info.PeakPagefileUsage;
+			row[14] = (double)info.PrivatePageCount;
+
+			result.push_back(std::move(item));
+			return true; });
+
+		return result;
+	}
+
+	napi_value format_to_js_value(napi_env env, any result_any_data)
+	{
+		napi_value result;
+		napi_get_null(env, &result);
+
+		if (!result_any_data.has_value())
 		{
-			return L"[]";
+			return result;
 		}
 
-		// 调用 ZwQuerySystemInformation 获取系统信息
-		NTSTATUS status;
-		ULONG bufferSize = 0;
-		status = ZwQuerySystemInformation(SystemProcessInformation, NULL, 0, &bufferSize);
-		if (status != STATUS_INFO_LENGTH_MISMATCH)
+		// [UniqueProcessId, NextEntryOffset, NumberOfThreads, BasePriority, HandleCount, SessionId, PeakVirtualSize, VirtualSize, PeakWorkingSetSize, WorkingSetSize, QuotaPagedPoolUsage, QuotaNonPagedPoolUsage, PagefileUsage, PeakPagefileUsage, PrivatePageCount]  [ImageName]
+		auto process_list = any_cast<vector<NtProcessItem>>(result_any_data);
+		hmc_napi_table::Table table(env, process_list.size(), NUMBER_WIDTH, 1);
+
+		for (size_t i = 0; i < process_list.size(); i++)
 		{
-			return L"[]";
+			const NtProcessItem &item = process_list[i];
+			std::copy(item.numbers, item.numbers + NUMBER_WIDTH, table.numbers(i));
+			table.setString(i, 0, item.ImageName);
 		}
 
-		PVOID buffer = VirtualAlloc((LPVOID)NULL, (DWORD)(bufferSize), MEM_COMMIT, PAGE_READWRITE);
+		return table.toValue();
+	}
+};
 
-		hmc_FreeVSAuto(buffer);
+namespace fn_getAllProcessSnpList
+{
+	NEW_PROMISE_POOL_FUNCTION$SP;
 
-		if (buffer == NULL)
+	any PromiseWorkFunc(vector<any> arguments_list)
+	{
+		vector<HMC_PROCESSENTRY32W> ProcessSnapshot_list = GetProcessSnapshot();
+		return ProcessSnapshot_list;
+	}
+
+	napi_value format_to_js_value(napi_env env, any result_any_data)
+	{
+		napi_value result;
+		napi_get_null(env, &result);
+
+		if (!result_any_data.has_value())
 		{
-			return L"[]";
+			return result;
 		}
 
-		status = ZwQuerySystemInformation(SystemProcessInformation, buffer, bufferSize, NULL);
-		if (status != 0x00000000 /*STATUS_SUCCESS*/)
-		{
+		// [th32ProcessID, th32ParentProcessID, cntThreads, cntUsage, dwFlags, dwSize, pcPriClassBase, th32DefaultHeapID, th32ModuleID]  [szExeFile]
+		auto ProcessSnapshot_list = any_cast<vector<HMC_PROCESSENTRY32W>>(result_any_data);
+		hmc_napi_table::Table table(env, ProcessSnapshot_list.size(), 9, 1);
 
-			return L"[]";
+		for (size_t i = 0; i < ProcessSnapshot_list.size(); i++)
+		{
+			const HMC_PROCESSENTRY32W &data = ProcessSnapshot_list[i];
+			double *row = table.numbers(i);
+			row[0] = data.th32ProcessID;
+			row[1] = data.th32ParentProcessID;
+			row[2] = data.cntThreads;
+			row[3] = data.cntUsage;
+			row[4] = data.dwFlags;
+			row[5] = data.dwSize;
+			row[6] = data.pcPriClassBase;
+			row[7] = data.th32DefaultHeapID;
+			row[8] = data.th32ModuleID;
+			table.setString(i, 0, data.szExeFile);
 		}
 
-		// 处理系统信息
-		PSYSTEM_PROCESS_INFORMATION processInfo = (PSYSTEM_PROCESS_INFORMATION)buffer;
-		while (processInfo->NextEntryOffset)
-		{
-			auto ImageName = hmc_string_util::unicodeStringToWString(processInfo->ImageName);
+		return table.toValue();
+	}
 
-			jsonValue.append(L"{");
-			jsonValue.append(hmc_string_util::push_json_value(L"ImageName", ImageName, false, true));
-			jsonValue.append(hmc_string_util::push_json_value(L"UniqueProcessId", to_wstring((INT64)processInfo->UniqueProcessId), true, false));
-			jsonValue.append(hmc_string_util::push_json_value(L"BasePriority", to_wstring((INT64)processInfo->BasePriority), true, false));
-			jsonValue.append(hmc_string_util::push_json_value(L"NextEntryOffset", to_wstring((INT64)processInfo->NextEntryOffset), true, false));
-			jsonValue.append(hmc_string_util::push_json_value(L"NumberOfThreads", to_wstring((INT64)processInfo->NumberOfThreads), true, false));
-			jsonValue.append(hmc_string_util::push_json_value(L"PeakPagefileUsage", to_wstring((INT64)processInfo->PeakPagefileUsage), true, false));
-			jsonValue.append(hmc_string_util::push_json_value(L"PagefileUsage", to_wstring((INT64)processInfo->PagefileUsage), true, false));
-			jsonValue.append(hmc_string_util::push_json_value(L"PeakVirtualSize", to_wstring((INT64)processInfo->PeakVirtualSize), true, false));
+}
 
-			jsonValue.append(hmc_string_util::push_json_value(L"PeakWorkingSetSize", to_wstring((INT64)processInfo->PeakWorkingSetSize), true, false));
-			jsonValue.append(hmc_string_util::push_json_value(L"QuotaNonPagedPoolUsage", to_wstring((INT64)processInfo->QuotaNonPagedPoolUsage), true, false));
-			/* jsonValue.append(hmc_string_util::push_json_value(L"Reserved1", to_wstring((INT64)processInfo->Reserved1), true,false));
-			 jsonValue.append(hmc_string_util::push_json_value(L"Reserved2", to_wstring((INT64)processInfo->Reserved2), true, false));
-			 jsonValue.append(hmc_string_util::push_json_value(L"Reserved3", to_wstring((INT64)processInfo->Reserved3), true, false));
-			 jsonValue.append(hmc_string_util::push_json_value(L"Reserved4", to_wstring((INT64)processInfo->Reserved3), true, false));
-			 jsonValue.append(hmc_string_util::push_json_value(L"Reserved5", to_wstring((INT64)processInfo->Reserved4), true, false));
-			 jsonValue.append(hmc_string_util::push_json_value(L"Reserved6", to_wstring((INT64)processInfo->Reserved6), true, false));*/
+namespace fn_getProcessTable
+{
+	NEW_PROMISE_POOL_FUNCTION$SP;
 
-			jsonValue.append(L"}");
-			processInfo = (PSYSTEM_PROCESS_INFORMATION)((PUCHAR)processInfo + processInfo->NextEntryOffset);
-			if (processInfo->NextEntryOffset)
+	// 按列存放的进程表  在工作线程中完成打包 主线程只做几次内存复制
+	struct ProcessTable
+	{
+		vector<uint32_t> pid;
+		vector<uint32_t> ppid;
+		vector<uint32_t> threads;
+		vector<int32_t> priority;
+		vector<double> working_set;
+		vector<double> private_bytes;
+		// 所有进程名首尾相连  第 i 个为 names[offsets[i], offsets[i + 1])
+		wstring names;
+		vector<uint32_t> offsets;
+	};
+
+	any PromiseWorkFunc(vector<any> arguments_list)
+	{
+		ProcessTable table;
+
+		hmc_nt_process::Snapshot snapshot;
+		if (!snapshot.refresh())
+		{
+			return any();
+		}
+
+		table.offsets.push_back(0);
+		snapshot.forEach([&](const hmc_nt_process::HMC_SYSTEM_PROCESS_INFORMATION &info)
+						 {
+			DWORD pid = (DWORD)(ULONG_PTR)info.UniqueProcessId;
+			table.pid.push_back(pid);
+			table.ppid.push_back((uint32_t)(ULONG_PTR)info.InheritedFromUniqueProcessId);
+			table.threads.push_back(info.NumberOfThreads);
+			table.priority.push_back(info.BasePriority);
+			table.working_set.push_back((double)info.WorkingSetSize);
+			table.private_bytes.push_back((double)info.PagefileUsage);
+
+			if (info.ImageName.Buffer != NULL && info.ImageName.Length > 0)
+			{
+				table.names.append(info.ImageName.Buffer, info.ImageName.Length / sizeof(WCHAR));
+			}
+			else if (pid == 0)
 			{
-				jsonValue.append(L",");
+				table.names.append(L"System Idle Process");
 			}
+			table.offsets.push_back((uint32_t)table.names.size());
+			return true; });
+
+		return table;
+	}
+
+	napi_value format_to_js_value(napi_env env, any result_any_data)
+	{
+		napi_value result;
+		napi_get_null(env, &result);
+
+		if (!result_any_data.has_value())
+		{
+			return result;
 		}
 
-		jsonValue.append(L"]");
-		return jsonValue;
+		auto table = any_cast<ProcessTable>(result_any_data);
+		auto object = hmc_napi_create_value::jsObject(env);
+
+		object.putValue("length", hmc_napi_create_value::Number(env, (int64_t)table.pid.size()));
+		object.putValue("pid", hmc_napi_table::typedArray(env, napi_uint32_array, table.pid));
+		object.putValue("ppid", hmc_napi_table::typedArray(env, napi_uint32_array, table.ppid));
+		object.putValue("threads", hmc_napi_table::typedArray(env, napi_uint32_array, table.threads));
+		object.putValue("priority", hmc_napi_table::typedArray(env, napi_int32_array, table.priority));
+		object.putValue("workingSet", hmc_napi_table::typedArray(env, napi_float64_array, table.working_set));
+		object.putValue("privateBytes", hmc_napi_table::typedArray(env, napi_float64_array, table.private_bytes));
+		object.putValue("names", hmc_napi_table::utf16(env, table.names));
+		object.putValue("nameOffsets", hmc_napi_table::typedArray(env, napi_uint32_array, table.offsets));
+
+		return object.toValue();
+	}
+};
+
+namespace fn_getProcessModules
+{
+	NEW_PROMISE_POOL_FUNCTION$SP$ARG;
+
+	void format_arguments_value(napi_env env, napi_callback_info info, std::vector<any> &ArgumentsList, hmc_NodeArgsValue args_value)
+	{
+		if (!args_value.eq(0, js_number, true))
+		{
+			return;
+		}
+		ArgumentsList.push_back(args_value.getDword(0));
+		ArgumentsList.push_back(args_value.exists(1) ? args_value.getBool(1, false) : false);
 	}
 
 	any PromiseWorkFunc(vector<any> arguments_list)
 	{
-		any result = GetAllProcessList();
-		return result;
+		if (arguments_list.size() < 2 || arguments_list.at(0).type() != typeid(DWORD) || arguments_list.at(1).type() != typeid(bool))
+		{
+			return any();
+		}
+
+		vector<hmc_module_cache::ProcessModule> module_list;
+		if (!hmc_module_cache::Cache::shared().list(any_cast<DWORD>(arguments_list.at(0)), module_list, any_cast<bool>(arguments_list.at(1))))
+		{
+			return any();
+		}
+		return module_list;
 	}
 
 	napi_value format_to_js_value(napi_env env, any result_any_data)
@@ -519,48 +657,70 @@ namespace fn_getAllProcessNtList
 			return result;
 		}
 
-		result = hmc_napi_create_value::String(env, any_cast<wstring>(result_any_data));
-		return result;
+		// [base, size, timestamp]  [path, name, version]
+		auto module_list = any_cast<vector<hmc_module_cache::ProcessModule>>(result_any_data);
+		hmc_napi_table::Table table(env, module_list.size(), 3, 3);
+
+		for (size_t i = 0; i < module_list.size(); i++)
+		{
+			const hmc_module_cache::ProcessModule &module = module_list[i];
+			double *row = table.numbers(i);
+			row[0] = (double)module.base;
+			row[1] = module.size;
+			row[2] = module.timestamp;
+			table.setString(i, 0, module.entry->path);
+			table.setString(i, 1, module.entry->name);
+			table.setString(i, 2, module.version);
+		}
+
+		return table.toValue();
 	}
 };
 
-namespace fn_getAllProcessSnpList
+namespace fn_findHandlesByPath
 {
-	NEW_PROMISE_FUNCTION_DEFAULT_FUN$SP;
+	NEW_PROMISE_POOL_FUNCTION$SP$ARG;
 
-	any PromiseWorkFunc(vector<any> arguments_list)
+	struct SearchResult
 	{
-		wstring result = L"[";
+		vector<hmc_handle_search::Match> matches;
+		hmc_handle_search::Stats stats;
+	};
 
-		vector<HMC_PROCESSENTRY32W> ProcessSnapshot_list = GetProcessSnapshot();
+	// (paths: string | string[], timeout?: number)
+	void format_arguments_value(napi_env env, napi_callback_info info, std::vector<any> &ArgumentsList, hmc_NodeArgsValue args_value)
+	{
+		if (!args_value.exists(0))
+		{
+			return;
+		}
 
-		size_t leng = ProcessSnapshot_list.size();
-		for (size_t i = 0; i < leng; i++)
+		vector<wstring> paths;
+		if (args_value.eq(0, js_string, false))
 		{
-			auto data = ProcessSnapshot_list.at(i);
-			wstring item = L"{";
-			item.append(hmc_string_util::push_json_value(L"szExeFile", data.szExeFile, false, true));
-			item.append(hmc_string_util::push_json_value(L"th32ProcessID", to_wstring(data.th32ProcessID), true, false));
-			item.append(hmc_string_util::push_json_value(L"th32ParentProcessID", to_wstring(data.th32ParentProcessID), true, false));
-			item.append(hmc_string_util::push_json_value(L"cntThreads", to_wstring(data.cntThreads), true, false));
-			item.append(hmc_string_util::push_json_value(L"cntUsage", to_wstring(data.cntUsage), true, false));
-			item.append(hmc_string_util::push_json_value(L"dwFlags", to_wstring(data.dwFlags), true, false));
-			item.append(hmc_string_util::push_json_value(L"dwSize", to_wstring(data.dwSize), true, false));
-			item.append(hmc_string_util::push_json_value(L"pcPriClassBase", to_wstring(data.pcPriClassBase), true, false));
-			item.append(hmc_string_util::push_json_value(L"th32DefaultHeapID", to_wstring(data.th32DefaultHeapID), true, false));
-			item.append(hmc_string_util::push_json_value(L"th32ModuleID", to_wstring(data.th32ModuleID), true, false));
-
-			item.append(L"}");
-
-			if (i < leng - 1)
-			{
-				item.push_back(L',');
-			}
+			paths.push_back(args_value.getStringWide(0, L""));
+		}
+		else
+		{
+			paths = args_value.getArrayWstring(0, {});
+		}
 
-			result.append(item);
+		ArgumentsList.push_back(paths);
+		ArgumentsList.push_back(args_value.exists(1) && args_value.eq(1, js_number, false) ? args_value.getDword(1) : (DWORD)100);
+	}
+
+	any PromiseWorkFunc(vector<any> arguments_list)
+	{
+		if (arguments_list.size() < 2 || arguments_list.at(0).type() != typeid(vector<wstring>) || arguments_list.at(1).type() != typeid(DWORD))
+		{
+			return any();
 		}
 
-		result.append(L"]");
+		SearchResult result;
+		if (!hmc_handle_search::find(any_cast<vector<wstring>>(arguments_list.at(0)), result.matches, result.stats, any_cast<DWORD>(arguments_list.at(1))))
+		{
+			return any();
+		}
 		return result;
 	}
 
@@ -574,116 +734,177 @@ namespace fn_getAllProcessSnpList
 			return result;
 		}
 
-		result = hmc_napi_create_value::String(env, any_cast<wstring>(result_any_data));
-		return result;
-	}
+		auto search_result = any_cast<SearchResult>(result_any_data);
+		napi_value matches;
+		napi_create_array_with_length(env, search_result.matches.size(), &matches);
 
-}
+		for (size_t i = 0; i < search_result.matches.size(); i++)
+		{
+			const hmc_handle_search::Match &match = search_result.matches[i];
+			auto item = hmc_napi_create_value::jsObject(env);
+			item.putValue("index", hmc_napi_create_value::Number(env, (int64_t)match.target));
+			item.putValue("pid", hmc_napi_create_value::Number(env, (int64_t)match.pid));
+			item.putValue("handle", hmc_napi_create_value::Number(env, (int64_t)match.handle));
+			item.putValue("path", hmc_napi_table::utf16(env, match.path));
+			napi_set_element(env, matches, (uint32_t)i, item.toValue());
+		}
 
-/**
- * @brief 获取CPU核心数
- *
- * @return int
- */
-int _hmc_getCPUCount()
-{
-	SYSTEM_INFO system_info;
-	GetSystemInfo(&system_info);
-	return static_cast<int>(system_info.dwNumberOfProcessors);
-}
+		auto stats = hmc_napi_create_value::jsObject(env);
+		stats.putValue("handles", hmc_napi_create_value::Number(env, (int64_t)search_result.stats.handles));
+		stats.putValue("timeouts", hmc_napi_create_value::Number(env, (int64_t)search_result.stats.timeouts));
+		stats.putValue("skipped", hmc_napi_create_value::Number(env, (int64_t)search_result.stats.skipped));
+		stats.putValue("elapsed", hmc_napi_create_value::Number(env, search_result.stats.elapsed));
 
-// 时间格式转换
-__int64 _hmc_FileTimeToInt64(const FILETIME &time)
-{
-	ULARGE_INTEGER tt;
-	tt.LowPart = time.dwLowDateTime;
-	tt.HighPart = time.dwHighDateTime;
-	return (tt.QuadPart);
-}
+		auto object = hmc_napi_create_value::jsObject(env);
+		object.putValue("matches", matches);
+		object.putValue("stats", stats.toValue());
+		return object.toValue();
+	}
+};
 
 /**
- * @brief 获取指定进程CPU使用率
+ * @brief 获取指定进程CPU使用率 (读取后台采样器的最近一次结果)
  *
  * @param ProcessID
- * @return double
+ * @return double 进程不存在时为 -1
  */
 double getProcessCpuUsage(DWORD ProcessID)
 {
-	static int processor_count_ = -1;	  // cpu核心数
-	static __int64 last_system_time_ = 0; // 上一次的系统时间
-	static __int64 last_time_ = 0;		  // 上一次的时间
-
-	FILETIME now;
-	FILETIME creation_time;
-	FILETIME exit_time;
-	FILETIME kernel_time;
-	FILETIME user_time;
+	double cpu_usage = -1;
+	if (!hmc_cpu_sampler::Sampler::shared().getUsage(ProcessID, cpu_usage))
+	{
+		return -1;
+	}
+	return cpu_usage;
+}
 
-	__int64 system_time;
-	__int64 time;
+namespace fn_getProcessCpuUsage
+{
+	NEW_PROMISE_POOL_FUNCTION$SP$ARG;
 
-	double cpu_usage = -1;
+	void format_arguments_value(napi_env env, napi_callback_info info, std::vector<any> &ArgumentsList, hmc_NodeArgsValue args_value)
+	{
+		if (!args_value.eq(0, js_number, true))
+		{
+			return;
+		}
+		ArgumentsList.push_back(args_value.getDword(0));
+	}
 
-	if (processor_count_ == -1)
+	any PromiseWorkFunc(vector<any> arguments_list)
 	{
-		processor_count_ = _hmc_getCPUCount();
+		if (arguments_list.empty() || !arguments_list.at(0).has_value() || arguments_list.at(0).type() != typeid(DWORD))
+		{
+			return any();
+		}
+		return getProcessCpuUsage(any_cast<DWORD>(arguments_list.at(0)));
 	}
 
-	GetSystemTimeAsFileTime(&now);
+	napi_value format_to_js_value(napi_env env, any result_any_data)
+	{
+		napi_value result;
+		napi_get_null(env, &result);
 
-	HANDLE hProcess = OpenProcess(
-		PROCESS_QUERY_INFORMATION |
-			PROCESS_VM_READ,
-		FALSE, ProcessID);
+		if (!result_any_data.has_value())
+		{
+			return result;
+		}
 
-	if (!hProcess)
-	{
-		return -1;
+		result = hmc_napi_create_value::Number(env, any_cast<double>(result_any_data));
+		return result;
 	}
+};
+
+namespace fn_getAllProcessCpuUsage
+{
+	NEW_PROMISE_POOL_FUNCTION$SP;
 
-	if (!GetProcessTimes(hProcess, &creation_time, &exit_time, &kernel_time, &user_time))
+	any PromiseWorkFunc(vector<any> arguments_list)
 	{
-		return -1;
+		vector<hmc_cpu_sampler::ProcessCpuUsage> result;
+		hmc_cpu_sampler::Sampler::shared().getAll(result);
+		return result;
 	}
 
-	system_time = (_hmc_FileTimeToInt64(kernel_time) + _hmc_FileTimeToInt64(user_time)) / processor_count_; // CPU使用时间
-	time = _hmc_FileTimeToInt64(now);																		// 现在的时间
+	napi_value format_to_js_value(napi_env env, any result_any_data)
+	{
+		napi_value result;
+		napi_get_null(env, &result);
 
-	last_system_time_ = system_time;
-	last_time_ = time;
+		if (!result_any_data.has_value())
+		{
+			return result;
+		}
 
-	CloseHandle(hProcess);
+		auto cpu_usage_list = any_cast<vector<hmc_cpu_sampler::ProcessCpuUsage>>(result_any_data);
+		napi_create_array_with_length(env, cpu_usage_list.size(), &result);
 
-	Sleep(1000); // 睡眠1s
+		for (size_t i = 0; i < cpu_usage_list.size(); i++)
+		{
+			auto item = hmc_napi_create_value::jsObject(env);
+			item.putValue("pid", hmc_napi_create_value::Number(env, (int64_t)cpu_usage_list[i].pid));
+			item.putValue("usage", hmc_napi_create_value::Number(env, cpu_usage_list[i].usage));
+			napi_set_element(env, result, (uint32_t)i, item.toValue());
+		}
 
-	hProcess = OpenProcess(
-		PROCESS_QUERY_INFORMATION |
-			PROCESS_VM_READ,
-		FALSE, ProcessID);
+		return result;
+	}
+};
+
+/**
+ * @brief 获取进程最近的cpu使用率采样 (每秒一次 从旧到新 最多60个)
+ * 进程不存在时返回 null
+ */
+napi_value fn_getProcessCpuUsageHistory(napi_env env, napi_callback_info info)
+{
+	napi_value result;
+	napi_get_null(env, &result);
 
-	if (!hProcess)
+	auto args_value = hmc_NodeArgsValue(env, info);
+	if (!args_value.eq(0, js_number, true))
 	{
-		return -1;
+		return result;
 	}
 
-	if (!GetProcessTimes(hProcess, &creation_time, &exit_time, &kernel_time, &user_time))
+	vector<double> history;
+	if (!hmc_cpu_sampler::Sampler::shared().getHistory(args_value.getDword(0), history))
 	{
-		return -1;
+		return result;
 	}
 
-	GetSystemTimeAsFileTime(&now);
-	system_time = (_hmc_FileTimeToInt64(kernel_time) + _hmc_FileTimeToInt64(user_time)) / processor_count_; // CPU使用时间
-	time = _hmc_FileTimeToInt64(now);																		// 现在的时间
+	napi_create_array_with_length(env, history.size(), &result);
+	for (size_t i = 0; i < history.size(); i++)
+	{
+		napi_set_element(env, result, (uint32_t)i, hmc_napi_create_value::Number(env, history[i]));
+	}
+	return result;
+}
 
-	CloseHandle(hProcess);
+/**
+ * @brief 创建进程差异存储 (立即记录当前进程列表作为基准)
+ * @returns 存储id  失败为 0
+ */
+napi_value fn_createProcessDiffStore(napi_env env, napi_callback_info info)
+{
+	return hmc_napi_create_value::Number(env, (int64_t)hmc_process_diff::Registry::shared().open());
+}
 
-	cpu_usage = ((static_cast<double>(system_time - last_system_time_)) / (static_cast<double>(time - last_time_))) * 100;
-	return cpu_usage;
+/**
+ * @brief 释放进程差异存储
+ */
+napi_value fn_closeProcessDiffStore(napi_env env, napi_callback_info info)
+{
+	auto args_value = hmc_NodeArgsValue(env, info);
+	if (!args_value.eq(0, js_number, true))
+	{
+		return hmc_napi_create_value::Boolean(env, false);
+	}
+	return hmc_napi_create_value::Boolean(env, hmc_process_diff::Registry::shared().close((int)args_value.getDword(0)));
 }
 
-namespace fn_getProcessCpuUsage
+namespace fn_refreshProcessDiffStore
 {
-	NEW_PROMISE_FUNCTION_DEFAULT_FUN$SP$ARG;
+	NEW_PROMISE_POOL_FUNCTION$SP$ARG;
 
 	void format_arguments_value(napi_env env, napi_callback_info info, std::vector<any> &ArgumentsList, hmc_NodeArgsValue args_value)
 	{
@@ -700,7 +921,29 @@ namespace fn_getProcessCpuUsage
 		{
 			return any();
 		}
-		return getProcessCpuUsage(any_cast<DWORD>(arguments_list.at(0)));
+
+		auto store = hmc_process_diff::Registry::shared().get((int)any_cast<DWORD>(arguments_list.at(0)));
+		if (!store)
+		{
+			return any();
+		}
+
+		vector<hmc_process_diff::Change> changes;
+		if (!store->refresh(changes))
+		{
+			return any();
+		}
+		return changes;
+	}
+
+	// FILETIME (100ns 自 1601) 转为 js 时间戳 (ms)
+	double fileTimeToUnixMs(ULONGLONG file_time)
+	{
+		if (file_time < 116444736000000000ULL)
+		{
+			return 0;
+		}
+		return (double)((file_time - 116444736000000000ULL) / 10000ULL);
 	}
 
 	napi_value format_to_js_value(napi_env env, any result_any_data)
@@ -713,14 +956,49 @@ namespace fn_getProcessCpuUsage
 			return result;
 		}
 
-		result = hmc_napi_create_value::Number(env, any_cast<double>(result_any_data));
+		auto changes = any_cast<vector<hmc_process_diff::Change>>(result_any_data);
+		napi_create_array_with_length(env, changes.size(), &result);
+
+		for (size_t i = 0; i < changes.size(); i++)
+		{
+			auto &change = changes[i];
+			auto item = hmc_napi_create_value::jsObject(env);
+
+			switch (change.type)
+			{
+			case hmc_process_diff::CHANGE_START:
+				item.putValue("type", hmc_napi_create_value::String(env, wstring(L"start")));
+				break;
+			case hmc_process_diff::CHANGE_EXIT:
+				item.putValue("type", hmc_napi_create_value::String(env, wstring(L"exit")));
+				break;
+			default:
+				item.putValue("type", hmc_napi_create_value::String(env, wstring(L"change")));
+				break;
+			}
+
+			item.putValue("pid", hmc_napi_create_value::Number(env, (int64_t)change.process.pid));
+			item.putValue("ppid", hmc_napi_create_value::Number(env, (int64_t)change.process.ppid));
+			item.putValue("threads", hmc_napi_create_value::Number(env, (int64_t)change.process.threads));
+			item.putValue("createTime", hmc_napi_create_value::Number(env, fileTimeToUnixMs(change.process.create_time)));
+			item.putValue("name", hmc_napi_create_value::String(env, change.process.name));
+
+			if (change.type == hmc_process_diff::CHANGE_UPDATE)
+			{
+				item.putValue("lastPpid", hmc_napi_create_value::Number(env, (int64_t)change.last_ppid));
+				item.putValue("lastThreads", hmc_napi_create_value::Number(env, (int64_t)change.last_threads));
+			}
+
+			napi_set_element(env, result, (uint32_t)i, item.toValue());
+		}
+
 		return result;
 	}
 };
 
 namespace fn_GetProcessIdFilePath
 {
-	NEW_PROMISE_FUNCTION_DEFAULT_FUN$SP$ARG;
+	NEW_PROMISE_POOL_FUNCTION$SP$ARG;
 
 	void format_arguments_value(napi_env env, napi_callback_info info, std::vector<any> &ArgumentsList, hmc_NodeArgsValue args_value)
 	{
@@ -758,7 +1036,7 @@ namespace fn_GetProcessIdFilePath
 
 namespace fn_existProcess
 {
-	NEW_PROMISE_FUNCTION_DEFAULT_FUN$SP$ARG;
+	NEW_PROMISE_POOL_FUNCTION$SP$ARG;
 
 	void format_arguments_value(napi_env env, napi_callback_info info, std::vector<any> &ArgumentsList, hmc_NodeArgsValue args_value)
 	{
@@ -796,7 +1074,7 @@ namespace fn_existProcess
 
 namespace fn_GetProcessCommandLineByPid
 {
-	NEW_PROMISE_FUNCTION_DEFAULT_FUN$SP$ARG;
+	NEW_PROMISE_POOL_FUNCTION$SP$ARG;
 
 	void format_arguments_value(napi_env env, napi_callback_info info, std::vector<any> &ArgumentsList, hmc_NodeArgsValue args_value)
 	{
@@ -843,7 +1121,7 @@ namespace fn_GetProcessCommandLineByPid
 
 namespace fn_GetCurrentWorkingDirectory
 {
-	NEW_PROMISE_FUNCTION_DEFAULT_FUN$SP$ARG;
+	NEW_PROMISE_POOL_FUNCTION$SP$ARG;
 
 	void format_arguments_value(napi_env env, napi_callback_info info, std::vector<any> &ArgumentsList, hmc_NodeArgsValue args_value)
 	{
@@ -894,9 +1172,28 @@ void exports_process_all_v2_fun(napi_env env, napi_value exports)
 	fn_getAllProcessSnpList::exports(env, exports, "getAllProcessListSnp");
 	fn_getAllProcessSnpList::exportsSync(env, exports, "getAllProcessListSnpSync");
 
+	fn_getProcessTable::exports(env, exports, "getProcessTable");
+	fn_getProcessTable::exportsSync(env, exports, "getProcessTableSync");
+
+	fn_getProcessModules::exports(env, exports, "getProcessModules");
+	fn_getProcessModules::exportsSync(env, exports, "getProcessModulesSync");
+
+	fn_findHandlesByPath::promise_function.setLane(hmc_executor::LANE_LONG);
+	fn_findHandlesByPath::exports(env, exports, "findHandlesByPath");
+	fn_findHandlesByPath::exportsSync(env, exports, "findHandlesByPathSync");
+
+	// 采样器首次启动时需要等待一个采样间隔
+	fn_getProcessCpuUsage::promise_function.setLane(hmc_executor::LANE_LONG);
 	fn_getProcessCpuUsage::exports(env, exports, "getProcessCpuUsage");
 	fn_getProcessCpuUsage::exportsSync(env, exports, "getProcessCpuUsageSync");
 
+	fn_getAllProcessCpuUsage::promise_function.setLane(hmc_executor::LANE_LONG);
+	fn_getAllProcessCpuUsage::exports(env, exports, "getAllProcessCpuUsage");
+	fn_getAllProcessCpuUsage::exportsSync(env, exports, "getAllProcessCpuUsageSync");
+
+	fn_refreshProcessDiffStore::exports(env, exports, "refreshProcessDiffStore");
+	fn_refreshProcessDiffStore::exportsSync(env, exports, "refreshProcessDiffStoreSync");
+
 	fn_GetProcessIdFilePath::exports(env, exports, "getProcessFilePath");
 	fn_GetProcessIdFilePath::exportsSync(env, exports, "getProcessFilePathSync");
 
@@ -0,0 +1,272 @@
+#pragma once
+
+#ifndef HMC_IMPORT_CAPTURE_STREAM_H
+#define HMC_IMPORT_CAPTURE_STREAM_H
+
+// 连续截图流
+// 独立线程按固定帧率截取同一个区域 (FramePool 常驻缓冲区)  与上一帧按块比较 只投递变化的块
+// 投递槽只有一个: js 还没取走上一次投递时 新的变化合并到脏块里 等下一次投递 (不会丢失变化 只计为丢帧)
+// 处理时间超过帧间隔时跳过错过的帧 计为超时
+
+#include <windows.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "./hmc_screen_capture.hpp"
+#include "./hmc_tile_diff.hpp"
+
+namespace hmc_capture_stream
+{
+    // 有新的投递时在截图线程调用 (不能阻塞)  返回 false 表示投递失败 (接收方已关闭等) 截图线程随之结束
+    typedef bool (*NotifyFunc)(void *context);
+
+    // 一次投递 (变化的块)
+    struct Delivery
+    {
+        // 第几帧 (从 1 开始)
+        uint64_t frame = 0;
+        // 距离开始的毫秒数
+        double timestamp = 0;
+        // 本次截取的区域 (虚拟屏幕坐标)
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        // 每 4 个为一个矩形 [x, y, width, height]  相对于区域左上角
+        std::vector<int32_t> rects;
+        // 矩形的 BGRA 像素依次排列
+        std::vector<uint32_t> pixels;
+        // 上一次投递之后 因 js 未取走而合并的帧数
+        uint64_t dropped = 0;
+    };
+
+    struct Stats
+    {
+        // 已截取的帧数
+        uint64_t frames = 0;
+        // 已投递的次数
+        uint64_t delivered = 0;
+        // 有变化但 js 未取走上一次投递 合并到之后投递的帧数
+        uint64_t dropped = 0;
+        // 处理时间超过帧间隔而跳过的帧数
+        uint64_t overruns = 0;
+        // 截图失败的帧数
+        uint64_t failed = 0;
+    };
+
+    class Stream
+    {
+    public:
+        /**
+         * @param x
+         * @param y
+         * @param width 宽或高为 0 时为整个虚拟屏幕
+         * @param height
+         * @param fps 每秒帧数 (0.1 - 120)
+         * @param notify
+         * @param context
+         */
+        Stream(int x, int y, int width, int height, double fps, NotifyFunc notify, void *context)
+            : x(x), y(y), width(width), height(height), notify(notify), context(context),
+              is_running(false), is_pending(false)
+        {
+            fps = fps < 0.1 ? 0.1 : (fps > 120 ? 120 : fps);
+            interval = std::chrono::nanoseconds((long long)(1e9 / fps));
+        }
+
+        ~Stream()
+        {
+            stop();
+        }
+
+        Stream(const Stream &) = delete;
+        Stream &operator=(const Stream &) = delete;
+
+        void start()
+        {
+            if (worker.joinable())
+            {
+                return;
+            }
+            is_running = true;
+            worker = std::thread(&Stream::threadMain, this);
+        }
+
+        // 停止并等待截图线程结束  之后不会再调用 notify
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                is_running = false;
+            }
+            wake.notify_all();
+            if (worker.joinable() && worker.get_id() != std::this_thread::get_id())
+            {
+                worker.join();
+            }
+        }
+
+        bool running() const
+        {
+            return is_running;
+        }
+
+        /**
+         * @brief 取出等待中的投递 (js 线程)  之后的变化会再次投递
+         * @return false 没有等待中的投递
+         */
+        bool take(Delivery &output)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!is_pending)
+            {
+                return false;
+            }
+            std::swap(output, ready);
+            is_pending = false;
+            return true;
+        }
+
+        Stats stats()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return counters;
+        }
+
+    private:
+        void threadMain()
+        {
+            hmc_tile_diff::TileDiff diff;
+            // 截图线程独占  与 ready 交换 (复用内存)
+            Delivery packing;
+            uint64_t frame = 0;
+            uint64_t dropped_since = 0;
+            int last_x = 0, last_y = 0;
+
+            const auto started = std::chrono::steady_clock::now();
+            auto next_tick = started;
+
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait_until(lock, next_tick, [this]
+                                    { return !is_running; });
+                    if (!is_running)
+                    {
+                        break;
+                    }
+                }
+
+                int capture_x = x, capture_y = y, capture_width = width, capture_height = height;
+                if (capture_width <= 0 || capture_height <= 0)
+                {
+                    RECT screen = hmc_screen_capture::virtualScreen();
+                    capture_x = screen.left;
+                    capture_y = screen.top;
+                    capture_width = screen.right - screen.left;
+                    capture_height = screen.bottom - screen.top;
+                }
+
+                frame++;
+                size_t changed = 0;
+                bool is_ok = false;
+                {
+                    hmc_screen_capture::ScopedLease scoped(hmc_screen_capture::FramePool::shared().acquire(capture_x, capture_y, capture_width, capture_height));
+                    const hmc_screen_capture::Lease &lease = scoped.lease;
+                    if (lease.id != 0)
+                    {
+                        // 区域被裁剪的位置变化时 (显示器变化) 重新作为第一帧
+                        if (lease.x != last_x || lease.y != last_y)
+                        {
+                            diff.reset();
+                        }
+                        last_x = lease.x;
+                        last_y = lease.y;
+                        packing.x = lease.x;
+                        packing.y = lease.y;
+                        packing.width = lease.width;
+                        packing.height = lease.height;
+                        changed = diff.update(lease.pixels, lease.width, lease.height, (size_t)lease.width);
+                        is_ok = true;
+                    }
+                }
+
+                bool should_notify = false;
+                if (is_ok && diff.hasDirty() && !is_pending)
+                {
+                    // 在锁外打包  只在交换时加锁
+                    diff.take(packing.rects, packing.pixels);
+                    packing.frame = frame;
+                    packing.timestamp = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+                    packing.dropped = dropped_since;
+                    dropped_since = 0;
+                    should_notify = true;
+                }
+                else if (is_ok && changed != 0)
+                {
+                    dropped_since++;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    counters.frames++;
+                    if (!is_ok)
+                    {
+                        counters.failed++;
+                    }
+                    if (should_notify)
+                    {
+                        std::swap(ready, packing);
+                        is_pending = true;
+                        counters.delivered++;
+                    }
+                    else if (is_ok && changed != 0)
+                    {
+                        counters.dropped++;
+                    }
+                }
+
+                if (should_notify && !notify(context))
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    is_running = false;
+                    break;
+                }
+
+                // 处理时间超过帧间隔  跳过错过的帧 (不连续补帧)
+                next_tick += interval;
+                auto now = std::chrono::steady_clock::now();
+                if (now > next_tick)
+                {
+                    uint64_t missed = (uint64_t)((now - next_tick) / interval) + 1;
+                    next_tick += interval * (long long)missed;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    counters.overruns += missed;
+                }
+            }
+        }
+
+        const int x;
+        const int y;
+        const int width;
+        const int height;
+        std::chrono::nanoseconds interval;
+        NotifyFunc notify;
+        void *context;
+
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::atomic<bool> is_running;
+        // ready 中有 js 还没取走的投递
+        std::atomic<bool> is_pending;
+        Delivery ready;
+        Stats counters;
+    };
+}
+
+#endif // HMC_IMPORT_CAPTURE_STREAM_H
@@ -0,0 +1,113 @@
+#pragma once
+
+#ifndef HMC_IMPORT_CPU_FEATURES_H
+#define HMC_IMPORT_CPU_FEATURES_H
+
+// 运行时检测 SIMD 指令集 (SSE2 / AVX2)  供各个 SIMD 内核选择实现
+// 不依赖 windows.h  非 x86 平台全部返回 false
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HMC_CPU_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// gcc / clang 需要按函数开启指令集 (不影响其他函数 也不要求整个文件使用 -mavx2)
+#if defined(HMC_CPU_X86) && !defined(_MSC_VER)
+#define HMC_TARGET_SSE2 __attribute__((target("sse2")))
+#define HMC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HMC_TARGET_SSE2
+#define HMC_TARGET_AVX2
+#endif
+
+namespace hmc_cpu_features
+{
+#ifdef HMC_CPU_X86
+    inline void cpuid(int leaf, int sub_leaf, unsigned int regs[4])
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuidex(info, leaf, sub_leaf);
+        for (int i = 0; i < 4; i++)
+        {
+            regs[i] = (unsigned int)info[i];
+        }
+#else
+        __cpuid_count(leaf, sub_leaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    // AVX2 需要 CPU 支持 并且系统会保存 YMM 寄存器 (XCR0 的 1 2 位)
+    inline bool detectAvx2()
+    {
+        unsigned int regs[4] = {0, 0, 0, 0};
+        cpuid(0, 0, regs);
+        if (regs[0] < 7)
+        {
+            return false;
+        }
+
+        cpuid(1, 0, regs);
+        bool has_osxsave = (regs[2] & (1u << 27)) != 0;
+        bool has_avx = (regs[2] & (1u << 28)) != 0;
+        if (!has_osxsave || !has_avx)
+        {
+            return false;
+        }
+
+#if defined(_MSC_VER)
+        unsigned long long xcr0 = _xgetbv(0);
+#else
+        unsigned int xcr0_low = 0, xcr0_high = 0;
+        __asm__ volatile("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+        unsigned long long xcr0 = ((unsigned long long)xcr0_high << 32) | xcr0_low;
+#endif
+        if ((xcr0 & 0x6) != 0x6)
+        {
+            return false;
+        }
+
+        cpuid(7, 0, regs);
+        return (regs[1] & (1u << 5)) != 0;
+    }
+
+    inline bool detectSse2()
+    {
+#if defined(_M_X64) || defined(__x86_64__)
+        return true;
+#else
+        unsigned int regs[4] = {0, 0, 0, 0};
+        cpuid(1, 0, regs);
+        return (regs[3] & (1u << 26)) != 0;
+#endif
+    }
+#endif // HMC_CPU_X86
+
+    struct Features
+    {
+        bool sse2 = false;
+        bool avx2 = false;
+
+        Features()
+        {
+#ifdef HMC_CPU_X86
+            sse2 = detectSse2();
+            avx2 = sse2 && detectAvx2();
+#endif
+        }
+    };
+
+    // 只检测一次
+    inline const Features &get()
+    {
+        static const Features features;
+        return features;
+    }
+}
+
+#endif // HMC_IMPORT_CPU_FEATURES_H
@@ -0,0 +1,255 @@
+#pragma once
+
+#ifndef HMC_IMPORT_CPU_SAMPLER_H
+#define HMC_IMPORT_CPU_SAMPLER_H
+
+// 全进程 cpu 采样器
+// 后台线程按固定间隔获取一次 NtQuerySystemInformation 快照  一次计算所有进程的 (内核 + 用户) 时间增量
+// 查询直接读取最近一次的结果 不再每次调用 Sleep(1000)
+// 长时间没有查询时采样线程自动退出  下次查询时重新启动
+
+#include <windows.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "./hmc_nt_process.hpp"
+
+namespace hmc_cpu_sampler
+{
+    // 每个进程保留的历史采样数量
+    constexpr size_t HISTORY_SIZE = 60;
+    // 没有查询多久后停止采样 (ms)
+    constexpr ULONGLONG IDLE_TIMEOUT_MS = 30 * 1000;
+
+    struct ProcessCpuUsage
+    {
+        DWORD pid;
+        // 占全部 cpu 的百分比 (0-100)
+        double usage;
+    };
+
+    class Sampler
+    {
+    public:
+        static Sampler &shared()
+        {
+            // 不析构  进程退出时采样线程可能仍在运行
+            static Sampler *sampler = new Sampler();
+            return *sampler;
+        }
+
+        /**
+         * @brief 获取进程的 cpu 使用率  采样器刚启动时最多等待一个采样间隔
+         *
+         * @param pid
+         * @param usage 输出 百分比
+         * @return false 进程不存在
+         */
+        bool getUsage(DWORD pid, double &usage)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            waitReady(lock);
+
+            auto it = states.find(pid);
+            if (it == states.end())
+            {
+                return false;
+            }
+            usage = it->second.usage;
+            return true;
+        }
+
+        // 获取所有进程的 cpu 使用率
+        void getAll(std::vector<ProcessCpuUsage> &output)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            waitReady(lock);
+
+            output.clear();
+            output.reserve(states.size());
+            for (auto &it : states)
+            {
+                output.push_back(ProcessCpuUsage{it.first, it.second.usage});
+            }
+        }
+
+        /**
+         * @brief 获取进程最近的采样历史 (从旧到新)
+         *
+         * @return false 进程不存在
+         */
+        bool getHistory(DWORD pid, std::vector<double> &output)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            waitReady(lock);
+
+            output.clear();
+            auto it = states.find(pid);
+            if (it == states.end())
+            {
+                return false;
+            }
+
+            const ProcessState &state = it->second;
+            output.reserve(state.history_count);
+            size_t start = (state.history_index + HISTORY_SIZE - state.history_count) % HISTORY_SIZE;
+            for (size_t i = 0; i < state.history_count; i++)
+            {
+                output.push_back(state.history[(start + i) % HISTORY_SIZE]);
+            }
+            return true;
+        }
+
+    private:
+        struct ProcessState
+        {
+            // 用于识别 pid 复用
+            ULONGLONG create_time = 0;
+            ULONGLONG cpu_time = 0;
+            double usage = 0;
+            double history[HISTORY_SIZE] = {0};
+            size_t history_count = 0;
+            size_t history_index = 0;
+            uint64_t round = 0;
+        };
+
+        Sampler() : running(false), ready(false), round(0), interval(1000), last_query_time(0), last_sample_time(0)
+        {
+            processor_count = ::GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+            if (processor_count == 0)
+            {
+                processor_count = 1;
+            }
+        }
+
+        // 需持有 mutex  启动采样线程并等待第一次有效结果
+        void waitReady(std::unique_lock<std::mutex> &lock)
+        {
+            last_query_time = ::GetTickCount64();
+
+            if (!running)
+            {
+                running = true;
+                ready = false;
+                std::thread(&Sampler::loop, this).detach();
+            }
+
+            if (!ready)
+            {
+                cv.wait_for(lock, std::chrono::milliseconds(interval * 2 + 500), [&]
+                            { return ready; });
+            }
+        }
+
+        // 需持有 mutex
+        void sample(const hmc_nt_process::Snapshot &snapshot)
+        {
+            round++;
+            // 快照时间是单调时钟 不受系统时间调整影响
+            bool has_baseline = last_sample_time != 0 && snapshot.time() > last_sample_time;
+            ULONGLONG wall_time = has_baseline ? snapshot.time() - last_sample_time : 0;
+
+            snapshot.forEach([&](const hmc_nt_process::HMC_SYSTEM_PROCESS_INFORMATION &info)
+                             {
+                DWORD pid = (DWORD)(ULONG_PTR)info.UniqueProcessId;
+                ULONGLONG create_time = hmc_nt_process::toUInt64(info.CreateTime);
+                ULONGLONG cpu_time = hmc_nt_process::toUInt64(info.UserTime) + hmc_nt_process::toUInt64(info.KernelTime);
+
+                ProcessState &state = states[pid];
+
+                // 新进程 或者 pid 已被其他进程复用
+                if (state.round == 0 || state.create_time != create_time)
+                {
+                    state = ProcessState();
+                    state.create_time = create_time;
+                    state.cpu_time = cpu_time;
+                    state.round = round;
+                    return true;
+                }
+
+                if (has_baseline && cpu_time >= state.cpu_time)
+                {
+                    double usage = (double)(cpu_time - state.cpu_time) / (double)wall_time / (double)processor_count * 100.0;
+                    state.usage = usage > 100.0 ? 100.0 : usage;
+                    state.history[state.history_index] = state.usage;
+                    state.history_index = (state.history_index + 1) % HISTORY_SIZE;
+                    if (state.history_count < HISTORY_SIZE)
+                    {
+                        state.history_count++;
+                    }
+                }
+
+                state.cpu_time = cpu_time;
+                state.round = round;
+                return true; });
+
+            // 移除已退出的进程
+            for (auto it = states.begin(); it != states.end();)
+            {
+                if (it->second.round != round)
+                {
+                    it = states.erase(it);
+                    continue;
+                }
+                ++it;
+            }
+
+            last_sample_time = snapshot.time();
+            if (has_baseline)
+            {
+                ready = true;
+            }
+        }
+
+        void loop()
+        {
+            hmc_nt_process::Snapshot snapshot;
+            std::unique_lock<std::mutex> lock(mutex);
+
+            while (true)
+            {
+                lock.unlock();
+                bool is_ok = snapshot.refresh();
+                lock.lock();
+
+                if (is_ok)
+                {
+                    sample(snapshot);
+                }
+
+                cv.notify_all();
+
+                // 无人查询 停止采样并清空状态
+                if (::GetTickCount64() - last_query_time > IDLE_TIMEOUT_MS || (!is_ok && !ready))
+                {
+                    running = false;
+                    ready = false;
+                    states.clear();
+                    last_sample_time = 0;
+                    cv.notify_all();
+                    return;
+                }
+
+                // 第一轮只是基准 尽快取第二轮
+                DWORD wait_ms = ready ? interval : (interval > 250 ? 250 : interval);
+                cv.wait_for(lock, std::chrono::milliseconds(wait_ms));
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::unordered_map<DWORD, ProcessState> states;
+        bool running;
+        bool ready;
+        uint64_t round;
+        DWORD interval;
+        DWORD processor_count;
+        ULONGLONG last_query_time;
+        ULONGLONG last_sample_time;
+    };
+}
+
+#endif // HMC_IMPORT_CPU_SAMPLER_H
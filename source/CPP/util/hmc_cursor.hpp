@@ -0,0 +1,98 @@
+#pragma once
+
+#ifndef HMC_IMPORT_CURSOR_H
+#define HMC_IMPORT_CURSOR_H
+
+// 将 hmc_result_channel 的通道绑定到 js 回调
+// 有新数据或者结束时通过 napi_threadsafe_function 通知 js (不传数据 js 收到通知后调用对应的 *Polling 取出)
+// 通知在下一次取出之前只会发送一次  空闲的查询不占用任何定时器
+
+#include <node_api.h>
+#include "./hmc_result_channel.hpp"
+
+namespace hmc_cursor
+{
+    // 默认高水位 未取出的数量达到此值时生产线程暂停
+    constexpr size_t DEFAULT_HIGH_WATER_MARK = 1024;
+
+    inline void callJs(napi_env env, napi_value js_callback, void *context, void *data)
+    {
+        if (env == NULL || js_callback == NULL)
+        {
+            return;
+        }
+
+        napi_value undefined;
+        napi_get_undefined(env, &undefined);
+        napi_call_function(env, undefined, js_callback, 0, NULL, NULL);
+    }
+
+    /**
+     * @brief 将通道的可读/结束通知绑定到 js 回调 (需要在生产线程开始之前调用)
+     * threadsafe_function 不会阻止进程退出 (等待数据时由 js 端保持事件循环)  通道结束后被释放
+     *
+     * @param env
+     * @param callback js 函数  () => void
+     * @param channel
+     * @param high_water_mark 0 为不限制
+     * @return true 绑定成功
+     */
+    template <typename T>
+    bool bind(napi_env env, napi_value callback, hmc_result_channel::Channel<T> &channel, size_t high_water_mark = DEFAULT_HIGH_WATER_MARK)
+    {
+        napi_value resource_name;
+        napi_threadsafe_function tsfn = NULL;
+
+        napi_create_string_utf8(env, "hmc_cursor", NAPI_AUTO_LENGTH, &resource_name);
+
+        if (napi_create_threadsafe_function(env, callback, NULL, resource_name, 0, 1, NULL, NULL, NULL, callJs, &tsfn) != napi_ok)
+        {
+            return false;
+        }
+
+        // 被丢弃的游标不能让进程一直无法退出
+        napi_unref_threadsafe_function(env, tsfn);
+
+        channel.setHighWaterMark(high_water_mark);
+        channel.listen([tsfn]()
+                       { napi_call_threadsafe_function(tsfn, NULL, napi_tsfn_nonblocking); },
+                       [tsfn]()
+                       { napi_release_threadsafe_function(tsfn, napi_tsfn_release); });
+        return true;
+    }
+
+    /**
+     * @brief 从 js 参数读取游标选项  (onReadable?: () => void, highWaterMark?: number)
+     *
+     * @param env
+     * @param args
+     * @param argc
+     * @param index 回调所在的参数位置
+     * @param channel
+     * @return true 已绑定
+     */
+    template <typename T>
+    bool bindFromArgs(napi_env env, napi_value *args, size_t argc, size_t index, hmc_result_channel::Channel<T> &channel)
+    {
+        napi_valuetype value_type;
+
+        if (argc <= index || napi_typeof(env, args[index], &value_type) != napi_ok || value_type != napi_function)
+        {
+            return false;
+        }
+
+        int64_t high_water_mark = (int64_t)DEFAULT_HIGH_WATER_MARK;
+        if (argc > index + 1 && napi_typeof(env, args[index + 1], &value_type) == napi_ok && value_type == napi_number)
+        {
+            napi_get_value_int64(env, args[index + 1], &high_water_mark);
+            if (high_water_mark < 0)
+            {
+                high_water_mark = 0;
+            }
+        }
+
+        return bind(env, args[index], channel, (size_t)high_water_mark);
+    }
+}
+
+#endif // HMC_IMPORT_CURSOR_H
@@ -0,0 +1,356 @@
+#pragma once
+
+#ifndef HMC_IMPORT_DEVICE_PATH_H
+#define HMC_IMPORT_DEVICE_PATH_H
+
+// NT 设备路径 -> DOS 路径 的缓存索引
+// \Device\HarddiskVolume3\a -> C:\a     \Device\Mup\server\share -> \\server\share     \??\C:\a -> C:\a     \\?\Volume{...}\a -> C:\a
+// 索引以 (小写) 设备名为键  转换时只按路径前几级查找 不再逐个比较卷列表
+// 卷设备变化 (CM_Register_Notification)  驱动器号变化 (GetLogicalDrives) 或超过刷新间隔时重建
+
+#include <windows.h>
+#include <cfgmgr32.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hmc_device_path
+{
+    // 兜底的刷新间隔 (网络驱动器等变化不一定有通知)
+    constexpr ULONGLONG REFRESH_INTERVAL_MS = 30 * 1000;
+
+    class Index
+    {
+    public:
+        static Index &shared()
+        {
+            static Index index;
+            return index;
+        }
+
+        /**
+         * @brief 转换单个路径  不是设备路径或者没有对应的 DOS 路径时原样返回
+         */
+        std::wstring translate(const std::wstring &nt_path)
+        {
+            std::shared_ptr<const Table> table = current();
+            std::wstring result;
+            if (!translateWith(*table, nt_path, result))
+            {
+                return nt_path;
+            }
+            return result;
+        }
+
+        /**
+         * @brief 批量转换 (原地修改)  整批只检查一次索引是否过期
+         */
+        void translate(std::vector<std::wstring> &path_list)
+        {
+            std::shared_ptr<const Table> table = current();
+            std::wstring result;
+            for (auto &path : path_list)
+            {
+                if (translateWith(*table, path, result))
+                {
+                    path.swap(result);
+                }
+            }
+        }
+
+        // 标记过期 下次转换时重建
+        void invalidate()
+        {
+            dirty = true;
+        }
+
+        // 索引中的设备数量
+        size_t size()
+        {
+            return current()->prefixes.size();
+        }
+
+    private:
+        struct Table
+        {
+            // 小写设备名 -> DOS 路径 (为空表示连同后面的分隔符一起去掉)
+            std::unordered_map<std::wstring, std::wstring> prefixes;
+            // 键中最多的路径级数
+            size_t max_depth = 0;
+            DWORD drive_mask = 0;
+            ULONGLONG build_time = 0;
+        };
+
+        typedef CONFIGRET(WINAPI *CM_Register_Notification_t)(PCM_NOTIFY_FILTER, PVOID, PCM_NOTIFY_CALLBACK, PHCMNOTIFICATION);
+
+        Index() : dirty(false), is_listening(false) {}
+
+        std::shared_ptr<const Table> current()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            listen();
+
+            ULONGLONG now = ::GetTickCount64();
+            if (!table || dirty.exchange(false) || table->drive_mask != ::GetLogicalDrives() || now - table->build_time > REFRESH_INTERVAL_MS)
+            {
+                table = build();
+            }
+            return table;
+        }
+
+        // 卷设备到达 / 移除时标记过期  (cfgmgr32 在 win8 之前没有此函数 只依赖其他检查)
+        void listen()
+        {
+            if (is_listening)
+            {
+                return;
+            }
+            is_listening = true;
+
+            HMODULE cfgmgr32 = ::LoadLibraryW(L"cfgmgr32.dll");
+            if (cfgmgr32 == NULL)
+            {
+                return;
+            }
+
+            CM_Register_Notification_t CM_Register_Notification = (CM_Register_Notification_t)::GetProcAddress(cfgmgr32, "CM_Register_Notification");
+            if (CM_Register_Notification == NULL)
+            {
+                return;
+            }
+
+            // GUID_DEVINTERFACE_VOLUME
+            static const GUID volume_interface = {0x53f5630d, 0xb6bf, 0x11d0, {0x94, 0xf2, 0x00, 0xa0, 0xc9, 0x1e, 0xfb, 0x8b}};
+
+            CM_NOTIFY_FILTER filter;
+            ZeroMemory(&filter, sizeof(filter));
+            filter.cbSize = sizeof(filter);
+            filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE;
+            filter.u.DeviceInterface.ClassGuid = volume_interface;
+
+            HCMNOTIFICATION notification = NULL;
+            CM_Register_Notification(&filter, this, onDeviceChange, &notification);
+        }
+
+        static DWORD CALLBACK onDeviceChange(HCMNOTIFICATION notification, PVOID context, CM_NOTIFY_ACTION action, PCM_NOTIFY_EVENT_DATA event_data, DWORD event_data_size)
+        {
+            ((Index *)context)->invalidate();
+            return ERROR_SUCCESS;
+        }
+
+        static std::wstring toLower(const std::wstring &input)
+        {
+            std::wstring result = input;
+            if (!result.empty())
+            {
+                ::CharLowerBuffW(&result[0], (DWORD)result.size());
+            }
+            return result;
+        }
+
+        static size_t depthOf(const std::wstring &device)
+        {
+            size_t depth = 0;
+            for (WCHAR ch : device)
+            {
+                if (ch == L'\\')
+                {
+                    depth++;
+                }
+            }
+            return depth;
+        }
+
+        static void put(Table &table, const std::wstring &device, const std::wstring &dos_path)
+        {
+            if (device.empty() || device[0] != L'\\')
+            {
+                return;
+            }
+
+            std::wstring key = toLower(device);
+            while (key.size() > 1 && key.back() == L'\\')
+            {
+                key.pop_back();
+            }
+
+            // 已有映射的 (例如驱动器号) 优先
+            if (!table.prefixes.emplace(key, dos_path).second)
+            {
+                return;
+            }
+
+            size_t depth = depthOf(key);
+            if (depth > table.max_depth)
+            {
+                table.max_depth = depth;
+            }
+        }
+
+        static std::shared_ptr<Table> build()
+        {
+            std::shared_ptr<Table> table = std::make_shared<Table>();
+            table->build_time = ::GetTickCount64();
+            table->drive_mask = ::GetLogicalDrives();
+
+            std::vector<WCHAR> target(1024);
+
+            // 驱动器号 (包括 subst 与 网络驱动器)
+            for (int i = 0; i < 26; i++)
+            {
+                if ((table->drive_mask & (1u << i)) == 0)
+                {
+                    continue;
+                }
+
+                WCHAR drive[3] = {(WCHAR)(L'A' + i), L':', L'\0'};
+                if (::QueryDosDeviceW(drive, target.data(), (DWORD)target.size()) == 0)
+                {
+                    continue;
+                }
+                put(*table, target.data(), drive);
+            }
+
+            // 挂载到目录 或者没有驱动器号的卷
+            WCHAR volume_name[MAX_PATH] = {0};
+            HANDLE find_handle = ::FindFirstVolumeW(volume_name, MAX_PATH);
+            if (find_handle != INVALID_HANDLE_VALUE)
+            {
+                do
+                {
+                    size_t length = wcslen(volume_name);
+                    if (length < 5 || volume_name[length - 1] != L'\\')
+                    {
+                        continue;
+                    }
+
+                    volume_name[length - 1] = L'\0';
+                    DWORD device_length = ::QueryDosDeviceW(&volume_name[4], target.data(), (DWORD)target.size());
+                    volume_name[length - 1] = L'\\';
+                    if (device_length == 0)
+                    {
+                        continue;
+                    }
+                    std::wstring device = target.data();
+
+                    // 第一个挂载点  没有时使用卷 GUID 路径
+                    std::wstring dos_path = std::wstring(volume_name, length - 1);
+                    DWORD names_length = 0;
+                    std::vector<WCHAR> names(MAX_PATH + 1);
+                    if (!::GetVolumePathNamesForVolumeNameW(volume_name, names.data(), (DWORD)names.size(), &names_length) && ::GetLastError() == ERROR_MORE_DATA)
+                    {
+                        names.resize(names_length + 1);
+                        if (!::GetVolumePathNamesForVolumeNameW(volume_name, names.data(), (DWORD)names.size(), &names_length))
+                        {
+                            names[0] = L'\0';
+                        }
+                    }
+                    if (names[0] != L'\0')
+                    {
+                        dos_path = names.data();
+                        while (!dos_path.empty() && dos_path.back() == L'\\')
+                        {
+                            dos_path.pop_back();
+                        }
+                    }
+
+                    put(*table, device, dos_path);
+                    // \\?\Volume{...}
+                    put(*table, L"\\??\\" + std::wstring(&volume_name[4], length - 5), dos_path);
+                } while (::FindNextVolumeW(find_handle, volume_name, MAX_PATH));
+
+                ::FindVolumeClose(find_handle);
+            }
+
+            // 网络路径
+            put(*table, L"\\Device\\Mup", L"\\");
+            put(*table, L"\\Device\\LanmanRedirector", L"\\");
+
+            // 对象管理器的别名
+            put(*table, L"\\??", L"");
+            put(*table, L"\\DosDevices", L"");
+            put(*table, L"\\GLOBAL??", L"");
+            put(*table, L"\\??\\UNC", L"\\");
+
+            WCHAR windows_dir[MAX_PATH] = {0};
+            UINT windows_dir_length = ::GetWindowsDirectoryW(windows_dir, MAX_PATH);
+            if (windows_dir_length > 0 && windows_dir_length < MAX_PATH)
+            {
+                put(*table, L"\\SystemRoot", std::wstring(windows_dir, windows_dir_length));
+            }
+
+            return table;
+        }
+
+        // 按前几级查找 最长的匹配优先
+        static bool translateWith(const Table &table, const std::wstring &nt_path, std::wstring &output)
+        {
+            if (nt_path.size() < 2 || nt_path[0] != L'\\')
+            {
+                return false;
+            }
+
+            // \\?\ 与 \??\ 等价
+            bool is_win32_namespace = nt_path.rfind(L"\\\\?\\", 0) == 0;
+            if (nt_path[1] == L'\\' && !is_win32_namespace)
+            {
+                return false;
+            }
+
+            // 每个线程复用 避免每次分配
+            thread_local std::wstring lower;
+            thread_local std::wstring key;
+
+            size_t limit = nt_path.size();
+            lower.assign(nt_path, 0, limit);
+            ::CharLowerBuffW(&lower[0], (DWORD)lower.size());
+            if (is_win32_namespace)
+            {
+                lower[1] = L'?';
+            }
+
+            const std::wstring *matched = NULL;
+            size_t matched_end = 0;
+            size_t end = 0;
+
+            for (size_t depth = 1; depth <= table.max_depth && end < limit; depth++)
+            {
+                size_t next = lower.find(L'\\', end + 1);
+                end = next == std::wstring::npos ? limit : next;
+
+                key.assign(lower, 0, end);
+                auto it = table.prefixes.find(key);
+                if (it != table.prefixes.end())
+                {
+                    matched = &it->second;
+                    matched_end = end;
+                }
+            }
+
+            if (matched == NULL)
+            {
+                return false;
+            }
+
+            // 为空时连同后面的分隔符一起去掉 (\??\C:\a -> C:\a)
+            if (matched->empty() && matched_end < limit)
+            {
+                matched_end++;
+            }
+
+            output.assign(*matched);
+            output.append(nt_path, matched_end, std::wstring::npos);
+            return true;
+        }
+
+        std::mutex mutex;
+        std::shared_ptr<const Table> table;
+        std::atomic<bool> dirty;
+        bool is_listening;
+    };
+}
+
+#endif // HMC_IMPORT_DEVICE_PATH_H
@@ -0,0 +1,361 @@
+#pragma once
+
+#ifndef HMC_IMPORT_EXECUTOR_H
+#define HMC_IMPORT_EXECUTOR_H
+
+// 插件自有的异步执行器
+// napi_create_async_work 与 fs / dns 共用 libuv 默认的 4 个线程  getProcessCpuUsage 这类会阻塞 1s 的调用
+// 并发几次就会把 node 的文件读写全部饿死  这里用独立的线程执行  并按任务类型分为 快速/长耗时 两条通道
+// 完成回调统一通过一个 napi_threadsafe_function 回到 js 线程
+
+#include <node_api.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace hmc_executor
+{
+    enum Lane
+    {
+        // 快速查询 (毫秒级)
+        LANE_QUICK = 0,
+        // 长耗时或阻塞的任务 (cpu采样 句柄枚举 等待进程等)
+        LANE_LONG = 1,
+        LANE_COUNT = 2,
+    };
+
+    // 工作线程中执行
+    typedef void (*ExecuteCallback)(void *data);
+    // js线程中执行  is_ok 为 false 表示任务没有执行 (执行器已关闭)
+    typedef void (*CompleteCallback)(napi_env env, bool is_ok, void *data);
+
+    // 每条通道的统计 (时间单位为微秒)
+    struct LaneStats
+    {
+        size_t workers = 0;
+        size_t depth = 0;
+        size_t running = 0;
+        size_t max_depth = 0;
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+        uint64_t total_wait_us = 0;
+        uint64_t max_wait_us = 0;
+        uint64_t total_run_us = 0;
+        uint64_t max_run_us = 0;
+    };
+
+    class Executor
+    {
+    public:
+        static constexpr size_t MAX_WORKERS = 64;
+
+        static Executor &shared()
+        {
+            // 不析构  进程退出时工作线程可能仍在等待队列
+            static Executor *executor = new Executor();
+            return *executor;
+        }
+
+        /**
+         * @brief 绑定到当前 env (创建完成回调用的 threadsafe_function)
+         * 只绑定第一个调用的 env  其他 env (worker_threads) 提交时返回 false 由调用方回退到 napi_create_async_work
+         *
+         * @param env
+         * @return true 当前 env 可以使用执行器
+         */
+        bool bind(napi_env env)
+        {
+            std::lock_guard<std::mutex> lock(tsfn_mutex);
+
+            if (bound_env != NULL)
+            {
+                return bound_env == env && tsfn != NULL;
+            }
+
+            napi_value resource_name;
+            napi_create_string_utf8(env, "hmc_executor", NAPI_AUTO_LENGTH, &resource_name);
+
+            if (napi_create_threadsafe_function(env, NULL, NULL, resource_name, 0, 1, NULL, NULL, this, callJs, &tsfn) != napi_ok)
+            {
+                tsfn = NULL;
+                return false;
+            }
+
+            // 没有进行中的任务时不阻止进程退出
+            napi_unref_threadsafe_function(env, tsfn);
+            napi_add_env_cleanup_hook(env, cleanupHook, this);
+            bound_env = env;
+            stopping = false;
+            return true;
+        }
+
+        /**
+         * @brief 提交一个任务 (js线程)
+         *
+         * @return true 已进入队列  complete 之后一定会在 js 线程被调用
+         * @return false 当前 env 不可使用执行器  任务没有被接收
+         */
+        bool submit(napi_env env, Lane lane, ExecuteCallback execute, CompleteCallback complete, void *data)
+        {
+            if (lane < 0 || lane >= LANE_COUNT || !bind(env))
+            {
+                return false;
+            }
+
+            Task *task = new Task();
+            task->execute = execute;
+            task->complete = complete;
+            task->data = data;
+            task->lane = lane;
+            task->queued_time = std::chrono::steady_clock::now();
+
+            if (in_flight++ == 0)
+            {
+                napi_ref_threadsafe_function(env, tsfn);
+            }
+
+            LaneState &state = lanes[lane];
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.queue.push_back(task);
+                state.stats.submitted++;
+                if (state.queue.size() > state.stats.max_depth)
+                {
+                    state.stats.max_depth = state.queue.size();
+                }
+                ensureWorkers(lane);
+            }
+            state.cv.notify_one();
+            return true;
+        }
+
+        /**
+         * @brief 设置通道的线程数量  减少时空闲线程会在下次唤醒时退出 正在执行的任务不受影响
+         */
+        void setWorkerCount(Lane lane, size_t count)
+        {
+            if (lane < 0 || lane >= LANE_COUNT)
+            {
+                return;
+            }
+
+            count = count < 1 ? 1 : count > MAX_WORKERS ? MAX_WORKERS : count;
+
+            LaneState &state = lanes[lane];
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.target_workers = count;
+                if (!state.queue.empty())
+                {
+                    ensureWorkers(lane);
+                }
+            }
+            state.cv.notify_all();
+        }
+
+        size_t getWorkerCount(Lane lane)
+        {
+            if (lane < 0 || lane >= LANE_COUNT)
+            {
+                return 0;
+            }
+            std::lock_guard<std::mutex> lock(lanes[lane].mutex);
+            return lanes[lane].target_workers;
+        }
+
+        LaneStats getStats(Lane lane)
+        {
+            LaneStats result;
+            if (lane < 0 || lane >= LANE_COUNT)
+            {
+                return result;
+            }
+
+            LaneState &state = lanes[lane];
+            std::lock_guard<std::mutex> lock(state.mutex);
+            result = state.stats;
+            result.workers = state.live_workers;
+            result.depth = state.queue.size();
+            result.running = state.running;
+            return result;
+        }
+
+        // 清空累计的统计 (不影响当前队列)
+        void resetStats()
+        {
+            for (size_t i = 0; i < LANE_COUNT; i++)
+            {
+                std::lock_guard<std::mutex> lock(lanes[i].mutex);
+                lanes[i].stats = LaneStats();
+            }
+        }
+
+    private:
+        struct Task
+        {
+            ExecuteCallback execute = NULL;
+            CompleteCallback complete = NULL;
+            void *data = NULL;
+            Lane lane = LANE_QUICK;
+            std::chrono::steady_clock::time_point queued_time;
+        };
+
+        struct LaneState
+        {
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::deque<Task *> queue;
+            size_t target_workers = 0;
+            size_t live_workers = 0;
+            size_t running = 0;
+            LaneStats stats;
+        };
+
+        Executor()
+        {
+            lanes[LANE_QUICK].target_workers = 2;
+            lanes[LANE_LONG].target_workers = 4;
+        }
+
+        Executor(const Executor &) = delete;
+        Executor &operator=(const Executor &) = delete;
+
+        // 需持有 lanes[lane].mutex
+        void ensureWorkers(Lane lane)
+        {
+            LaneState &state = lanes[lane];
+            while (state.live_workers < state.target_workers)
+            {
+                state.live_workers++;
+                std::thread(&Executor::workerLoop, this, lane).detach();
+            }
+        }
+
+        void workerLoop(Lane lane)
+        {
+            LaneState &state = lanes[lane];
+            std::unique_lock<std::mutex> lock(state.mutex);
+
+            while (true)
+            {
+                state.cv.wait(lock, [&]
+                              { return stopping.load() || !state.queue.empty() || state.live_workers > state.target_workers; });
+
+                if (stopping.load() || state.live_workers > state.target_workers)
+                {
+                    state.live_workers--;
+                    return;
+                }
+
+                Task *task = state.queue.front();
+                state.queue.pop_front();
+                state.running++;
+                lock.unlock();
+
+                auto start_time = std::chrono::steady_clock::now();
+                try
+                {
+                    task->execute(task->data);
+                }
+                catch (...)
+                {
+                }
+                auto end_time = std::chrono::steady_clock::now();
+
+                // 交给 tsfn 之后任务对象随时会在 js 线程被释放 入队时间需要提前读取
+                auto queued_time = task->queued_time;
+
+                bool is_queued = false;
+                {
+                    std::lock_guard<std::mutex> tsfn_lock(tsfn_mutex);
+                    if (tsfn != NULL)
+                    {
+                        is_queued = napi_call_threadsafe_function(tsfn, task, napi_tsfn_nonblocking) == napi_ok;
+                    }
+                }
+
+                // env 已经关闭 没有 js 线程可以接收结果
+                if (!is_queued)
+                {
+                    delete task;
+                }
+
+                lock.lock();
+                state.running--;
+
+                uint64_t wait_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(start_time - queued_time).count();
+                uint64_t run_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+                state.stats.completed++;
+                state.stats.total_wait_us += wait_us;
+                state.stats.total_run_us += run_us;
+                if (wait_us > state.stats.max_wait_us)
+                {
+                    state.stats.max_wait_us = wait_us;
+                }
+                if (run_us > state.stats.max_run_us)
+                {
+                    state.stats.max_run_us = run_us;
+                }
+            }
+        }
+
+        static void callJs(napi_env env, napi_value js_callback, void *context, void *data)
+        {
+            Executor *self = (Executor *)context;
+            Task *task = (Task *)data;
+
+            if (task == NULL)
+            {
+                return;
+            }
+
+            // env 为 NULL 表示正在卸载  仍需调用 complete 以回收调用方的上下文
+            task->complete(env, env != NULL, task->data);
+            delete task;
+
+            if (env != NULL && --self->in_flight == 0)
+            {
+                std::lock_guard<std::mutex> lock(self->tsfn_mutex);
+                if (self->tsfn != NULL)
+                {
+                    napi_unref_threadsafe_function(env, self->tsfn);
+                }
+            }
+        }
+
+        static void cleanupHook(void *arg)
+        {
+            Executor *self = (Executor *)arg;
+            self->stopping = true;
+
+            {
+                std::lock_guard<std::mutex> lock(self->tsfn_mutex);
+                if (self->tsfn != NULL)
+                {
+                    napi_release_threadsafe_function(self->tsfn, napi_tsfn_abort);
+                    self->tsfn = NULL;
+                }
+            }
+
+            for (size_t i = 0; i < LANE_COUNT; i++)
+            {
+                std::lock_guard<std::mutex> lock(self->lanes[i].mutex);
+                self->lanes[i].cv.notify_all();
+            }
+        }
+
+        LaneState lanes[LANE_COUNT];
+        std::mutex tsfn_mutex;
+        napi_threadsafe_function tsfn = NULL;
+        napi_env bound_env = NULL;
+        std::atomic<bool> stopping{false};
+        // 只在 js 线程读写
+        size_t in_flight = 0;
+    };
+}
+
+#endif // HMC_IMPORT_EXECUTOR_H
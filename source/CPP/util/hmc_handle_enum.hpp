@@ -0,0 +1,355 @@
+#pragma once
+
+#ifndef HMC_IMPORT_HANDLE_ENUM_H
+#define HMC_IMPORT_HANDLE_ENUM_H
+
+// 系统句柄枚举
+// ntdll 函数地址只解析一次  SystemExtendedHandleInformation 的缓冲区在多次调用之间复用并记住所需大小
+// 在复制句柄 (NtDuplicateObject) 之前就按 pid 过滤  对象类型名按类型序号缓存 (同一次开机内不变)
+
+#include <windows.h>
+#include <winternl.h>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace hmc_handle_enum
+{
+    typedef struct _HMC_SYSTEM_HANDLE_TABLE_ENTRY_INFO_EX
+    {
+        PVOID Object;
+        ULONG_PTR UniqueProcessId;
+        ULONG_PTR HandleValue;
+        ULONG GrantedAccess;
+        USHORT CreatorBackTraceIndex;
+        USHORT ObjectTypeIndex;
+        ULONG HandleAttributes;
+        ULONG Reserved;
+    } HMC_SYSTEM_HANDLE_TABLE_ENTRY_INFO_EX;
+
+    typedef struct _HMC_SYSTEM_HANDLE_INFORMATION_EX
+    {
+        ULONG_PTR NumberOfHandles;
+        ULONG_PTR Reserved;
+        HMC_SYSTEM_HANDLE_TABLE_ENTRY_INFO_EX Handles[1];
+    } HMC_SYSTEM_HANDLE_INFORMATION_EX;
+
+    typedef NTSTATUS(NTAPI *NtQuerySystemInformation_t)(ULONG, PVOID, ULONG, PULONG);
+    typedef NTSTATUS(NTAPI *NtDuplicateObject_t)(HANDLE, HANDLE, HANDLE, PHANDLE, ACCESS_MASK, ULONG, ULONG);
+    typedef NTSTATUS(NTAPI *NtQueryObject_t)(HANDLE, ULONG, PVOID, ULONG, PULONG);
+
+    constexpr ULONG HMC_SystemExtendedHandleInformation = 64;
+    constexpr ULONG HMC_ObjectNameInformation = 1;
+    constexpr ULONG HMC_ObjectTypeInformation = 2;
+    constexpr NTSTATUS HMC_STATUS_INFO_LENGTH_MISMATCH = (NTSTATUS)0xC0000004L;
+    constexpr NTSTATUS HMC_STATUS_BUFFER_OVERFLOW = (NTSTATUS)0x80000005L;
+    constexpr NTSTATUS HMC_STATUS_BUFFER_TOO_SMALL = (NTSTATUS)0xC0000023L;
+
+    // 超过此大小的快照缓冲区不保留 (只记住大小)
+    constexpr size_t MAX_KEEP_BUFFER_SIZE = 16 * 1024 * 1024;
+
+    // ntdll 常驻于所有进程  函数地址只需要获取一次
+    struct Ntdll
+    {
+        NtQuerySystemInformation_t NtQuerySystemInformation;
+        NtDuplicateObject_t NtDuplicateObject;
+        NtQueryObject_t NtQueryObject;
+
+        bool ok() const
+        {
+            return NtQuerySystemInformation != NULL && NtDuplicateObject != NULL && NtQueryObject != NULL;
+        }
+
+        static const Ntdll &shared()
+        {
+            static Ntdll ntdll = []()
+            {
+                Ntdll result = {NULL, NULL, NULL};
+                HMODULE module = ::GetModuleHandleW(L"ntdll.dll");
+                if (module != NULL)
+                {
+                    result.NtQuerySystemInformation = (NtQuerySystemInformation_t)::GetProcAddress(module, "NtQuerySystemInformation");
+                    result.NtDuplicateObject = (NtDuplicateObject_t)::GetProcAddress(module, "NtDuplicateObject");
+                    result.NtQueryObject = (NtQueryObject_t)::GetProcAddress(module, "NtQueryObject");
+                }
+                return result;
+            }();
+            return ntdll;
+        }
+    };
+
+    struct HandleEntry
+    {
+        DWORD pid;
+        ULONG_PTR handle;
+        ULONG granted_access;
+        USHORT type_index;
+    };
+
+    class Engine
+    {
+    public:
+        static Engine &shared()
+        {
+            static Engine engine;
+            return engine;
+        }
+
+        /**
+         * @brief 获取指定进程的句柄
+         *
+         * @param pid
+         * @param output 输出 (会被清空)
+         * @return false 获取系统句柄快照失败
+         */
+        bool snapshot(DWORD pid, std::vector<HandleEntry> &output)
+        {
+            return snapshotIf([pid](const HandleEntry &entry)
+                              { return entry.pid == pid; },
+                              output);
+        }
+
+        /**
+         * @brief 获取多个进程的句柄
+         */
+        bool snapshot(const std::unordered_set<DWORD> &pid_list, std::vector<HandleEntry> &output)
+        {
+            return snapshotIf([&pid_list](const HandleEntry &entry)
+                              { return pid_list.find(entry.pid) != pid_list.end(); },
+                              output);
+        }
+
+        /**
+         * @brief 获取系统句柄快照 并只复制 filter 返回 true 的句柄
+         *
+         * @param filter bool(const HandleEntry &)
+         * @param output 输出 (会被清空)
+         * @return false 获取系统句柄快照失败
+         */
+        template <typename Filter>
+        bool snapshotIf(Filter filter, std::vector<HandleEntry> &output)
+        {
+            output.clear();
+            const Ntdll &ntdll = Ntdll::shared();
+            if (!ntdll.ok())
+            {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(buffer_mutex);
+
+            if (buffer.empty())
+            {
+                buffer.resize((learned_size > 0 ? learned_size : 1024 * 1024) / sizeof(ULONGLONG) + 1);
+            }
+
+            NTSTATUS status = 0;
+            for (int retry = 0; retry < 8; retry++)
+            {
+                ULONG buffer_size = (ULONG)(buffer.size() * sizeof(ULONGLONG));
+                ULONG return_length = 0;
+                status = ntdll.NtQuerySystemInformation(HMC_SystemExtendedHandleInformation, buffer.data(), buffer_size, &return_length);
+
+                if (status != HMC_STATUS_INFO_LENGTH_MISMATCH)
+                {
+                    break;
+                }
+
+                // 两次调用之间句柄数会继续增长 多留一些余量
+                size_t need_size = (size_t)(return_length > buffer_size ? return_length : buffer_size) * 3 / 2;
+                buffer.resize(need_size / sizeof(ULONGLONG) + 1);
+            }
+
+            if (status < 0)
+            {
+                return false;
+            }
+
+            learned_size = buffer.size() * sizeof(ULONGLONG);
+
+            const HMC_SYSTEM_HANDLE_INFORMATION_EX *info = (const HMC_SYSTEM_HANDLE_INFORMATION_EX *)buffer.data();
+            size_t max_count = (learned_size - offsetof(HMC_SYSTEM_HANDLE_INFORMATION_EX, Handles)) / sizeof(HMC_SYSTEM_HANDLE_TABLE_ENTRY_INFO_EX);
+            size_t count = info->NumberOfHandles < max_count ? info->NumberOfHandles : max_count;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const HMC_SYSTEM_HANDLE_TABLE_ENTRY_INFO_EX &entry = info->Handles[i];
+                HandleEntry handle_entry{(DWORD)entry.UniqueProcessId, entry.HandleValue, entry.GrantedAccess, entry.ObjectTypeIndex};
+                if (!filter(handle_entry))
+                {
+                    continue;
+                }
+                output.push_back(handle_entry);
+            }
+
+            if (learned_size > MAX_KEEP_BUFFER_SIZE)
+            {
+                std::vector<ULONGLONG>().swap(buffer);
+            }
+            return true;
+        }
+
+        /**
+         * @brief 复制句柄到当前进程
+         *
+         * @param process 目标进程 (需要 PROCESS_DUP_HANDLE)
+         * @return HANDLE 失败为 NULL  成功需要 CloseHandle
+         */
+        HANDLE duplicate(HANDLE process, const HandleEntry &entry)
+        {
+            HANDLE result = NULL;
+            NTSTATUS status = Ntdll::shared().NtDuplicateObject(process, (HANDLE)entry.handle, ::GetCurrentProcess(), &result, 0, 0, 0);
+            if (status < 0)
+            {
+                return NULL;
+            }
+            return result;
+        }
+
+        /**
+         * @brief 获取对象类型名  同一类型序号只查询一次
+         *
+         * @param handle 已复制到当前进程的句柄
+         * @param type_index HandleEntry::type_index
+         * @param output
+         */
+        bool typeName(HANDLE handle, USHORT type_index, std::wstring &output)
+        {
+            {
+                std::lock_guard<std::mutex> lock(type_mutex);
+                auto it = type_names.find(type_index);
+                if (it != type_names.end())
+                {
+                    output = it->second;
+                    return true;
+                }
+            }
+
+            if (!queryUnicodeString(handle, HMC_ObjectTypeInformation, output))
+            {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(type_mutex);
+            type_names[type_index] = output;
+            return true;
+        }
+
+        /**
+         * @brief 获取 File 类型的序号 (只在第一次时打开一个文件句柄并获取快照)
+         *
+         * @param output
+         * @return false 获取失败
+         */
+        bool fileTypeIndex(USHORT &output)
+        {
+            {
+                std::lock_guard<std::mutex> lock(type_mutex);
+                for (auto &it : type_names)
+                {
+                    if (it.second == L"File")
+                    {
+                        output = it.first;
+                        return true;
+                    }
+                }
+            }
+
+            HANDLE probe = ::CreateFileW(L"NUL", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, NULL);
+            if (probe == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+
+            DWORD current_pid = ::GetCurrentProcessId();
+            std::vector<HandleEntry> handle_list;
+            bool ok = snapshotIf([current_pid, probe](const HandleEntry &entry)
+                                 { return entry.pid == current_pid && entry.handle == (ULONG_PTR)probe; },
+                                 handle_list);
+            ::CloseHandle(probe);
+
+            if (!ok || handle_list.empty())
+            {
+                return false;
+            }
+
+            output = handle_list.front().type_index;
+            std::lock_guard<std::mutex> lock(type_mutex);
+            type_names[output] = L"File";
+            return true;
+        }
+
+        /**
+         * @brief 获取对象名 (NtQueryObject ObjectNameInformation)
+         * 同步管道等句柄可能会一直阻塞  需要在可以放弃的线程中调用 (见 hmc_handle_name.hpp)
+         */
+        static bool objectName(HANDLE handle, std::wstring &output)
+        {
+            return queryUnicodeString(handle, HMC_ObjectNameInformation, output) && !output.empty();
+        }
+
+        // 上一次句柄快照所需的缓冲区大小
+        size_t learnedSize()
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex);
+            return learned_size;
+        }
+
+    private:
+        Engine() : learned_size(0) {}
+
+        // ObjectNameInformation / ObjectTypeInformation 的结果都以 UNICODE_STRING 开头
+        static bool queryUnicodeString(HANDLE handle, ULONG information_class, std::wstring &output)
+        {
+            // 每个线程复用自己的缓冲区
+            thread_local std::vector<ULONGLONG> query_buffer(1024 / sizeof(ULONGLONG));
+            const Ntdll &ntdll = Ntdll::shared();
+
+            for (int retry = 0; retry < 4; retry++)
+            {
+                ULONG buffer_size = (ULONG)(query_buffer.size() * sizeof(ULONGLONG));
+                ULONG return_length = 0;
+                NTSTATUS status = ntdll.NtQueryObject(handle, information_class, query_buffer.data(), buffer_size, &return_length);
+
+                if (status == HMC_STATUS_INFO_LENGTH_MISMATCH || status == HMC_STATUS_BUFFER_OVERFLOW || status == HMC_STATUS_BUFFER_TOO_SMALL)
+                {
+                    if (return_length <= buffer_size)
+                    {
+                        return_length = buffer_size * 2;
+                    }
+                    query_buffer.resize(return_length / sizeof(ULONGLONG) + 1);
+                    continue;
+                }
+
+                if (status < 0)
+                {
+                    return false;
+                }
+
+                const UNICODE_STRING *value = (const UNICODE_STRING *)query_buffer.data();
+                if (value->Buffer != NULL && value->Length > 0)
+                {
+                    output.assign(value->Buffer, value->Length / sizeof(WCHAR));
+                }
+                else
+                {
+                    output.clear();
+                }
+                return true;
+            }
+            return false;
+        }
+
+        std::mutex buffer_mutex;
+        std::vector<ULONGLONG> buffer;
+        size_t learned_size;
+
+        std::mutex type_mutex;
+        std::unordered_map<USHORT, std::wstring> type_names;
+    };
+}
+
+#endif // HMC_IMPORT_HANDLE_ENUM_H
@@ -0,0 +1,324 @@
+#pragma once
+
+#ifndef HMC_IMPORT_HANDLE_NAME_H
+#define HMC_IMPORT_HANDLE_NAME_H
+
+// 句柄对象名的并行解析 (带超时)
+// NtQueryObject(ObjectNameInformation) 在同步管道等句柄上可能永远不返回
+// 解析在少量可放弃的工作线程中进行: 单个句柄超过期限即视为超时 该线程被放弃 (调用返回后自行退出) 并补充新的线程
+// 已知会阻塞的访问权限直接跳过
+// 被放弃的线程按整个进程计数: 达到上限后不再补充线程 之后的解析直接视为超时 (阻塞的线程返回后计数减少)
+
+#include <windows.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "./hmc_handle_enum.hpp"
+
+namespace hmc_handle_name
+{
+    // 整个进程中被放弃且仍阻塞的线程数量上限  达到后剩余的句柄全部视为超时
+    constexpr size_t MAX_ABANDONED_WORKERS = 32;
+
+    // 整个进程中被放弃且仍阻塞的线程数量 (所有解析池共享)
+    inline std::atomic<size_t> &abandonedWorkers()
+    {
+        static std::atomic<size_t> count(0);
+        return count;
+    }
+
+    /**
+     * @brief 文件句柄的这些访问权限 (常见于同步管道) 获取对象名会阻塞
+     */
+    inline bool isBlockingAccess(ULONG granted_access)
+    {
+        switch (granted_access)
+        {
+        case 0x0012019f:
+        case 0x001a019f:
+        case 0x00120189:
+        case 0x00100000:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    struct Result
+    {
+        // submit 时传入的序号
+        size_t index;
+        bool timeout;
+        std::wstring name;
+    };
+
+    /**
+     * @brief 对象名解析池
+     * submit / collect 由同一个线程调用  工作线程全部分离 (detach) 不会因为阻塞的句柄卡住调用方
+     *
+     * @code
+     * hmc_handle_name::Resolver resolver(4, 100);
+     * resolver.submit(i, dupHandle);
+     * resolver.collect(results, 50);
+     * @endcode
+     */
+    class Resolver
+    {
+    public:
+        /**
+         * @param worker_count 工作线程数量  被放弃的线程已达到上限时不创建 (所有句柄视为超时)
+         * @param timeout_ms 单个句柄的期限
+         */
+        Resolver(size_t worker_count, DWORD timeout_ms)
+            : state(std::make_shared<State>()), timeout(std::chrono::milliseconds(timeout_ms))
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (abandonedWorkers() >= MAX_ABANDONED_WORKERS)
+            {
+                return;
+            }
+            for (size_t i = 0; i < (worker_count ? worker_count : 1); i++)
+            {
+                spawn();
+            }
+        }
+
+        Resolver(const Resolver &) = delete;
+        Resolver &operator=(const Resolver &) = delete;
+
+        ~Resolver()
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->stopping = true;
+            for (auto &job : state->jobs)
+            {
+                ::CloseHandle(job.handle);
+            }
+            state->jobs.clear();
+            state->job_cv.notify_all();
+        }
+
+        /**
+         * @brief 提交一个句柄 (之后由解析池负责关闭)
+         *
+         * @param index 结果中的序号
+         * @param handle 已复制到当前进程的句柄
+         */
+        void submit(size_t index, HANDLE handle)
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->pending++;
+
+            // 所有线程都已被放弃
+            if (state->workers.empty())
+            {
+                ::CloseHandle(handle);
+                reportTimeout(index);
+                return;
+            }
+
+            state->jobs.push_back(Job{index, handle});
+            state->job_cv.notify_one();
+        }
+
+        /**
+         * @brief 取出已完成的结果  并检查超时
+         *
+         * @param output 追加到此处
+         * @param wait_ms 没有结果时最多等待的时间
+         * @return size_t 尚未完成的数量
+         */
+        size_t collect(std::vector<Result> &output, DWORD wait_ms)
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait_ms);
+
+            while (true)
+            {
+                checkTimeout();
+                if (!state->results.empty() || state->pending == 0)
+                {
+                    break;
+                }
+
+                auto now = std::chrono::steady_clock::now();
+                if (now >= deadline)
+                {
+                    break;
+                }
+
+                // 不超过最早的期限 以便及时发现超时
+                auto wake = deadline;
+                for (auto &worker : state->workers)
+                {
+                    if (worker->busy && worker->started + timeout < wake)
+                    {
+                        wake = worker->started + timeout;
+                    }
+                }
+                state->result_cv.wait_until(lock, wake + std::chrono::milliseconds(1));
+            }
+
+            for (auto &result : state->results)
+            {
+                output.push_back(std::move(result));
+            }
+            state->results.clear();
+            return state->pending;
+        }
+
+        // 尚未完成的数量
+        size_t pending()
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            return state->pending;
+        }
+
+        // 超时的数量
+        size_t timeouts()
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            return state->timeouts;
+        }
+
+    private:
+        struct Job
+        {
+            size_t index;
+            HANDLE handle;
+        };
+
+        struct Worker
+        {
+            bool busy = false;
+            bool abandoned = false;
+            size_t index = 0;
+            std::chrono::steady_clock::time_point started;
+        };
+
+        typedef std::shared_ptr<Worker> WorkerPtr;
+
+        // 工作线程与解析池共享  解析池销毁后被放弃的线程仍可安全访问
+        struct State
+        {
+            std::mutex mutex;
+            std::condition_variable job_cv;
+            std::condition_variable result_cv;
+            std::deque<Job> jobs;
+            std::vector<Result> results;
+            std::vector<WorkerPtr> workers;
+            size_t pending = 0;
+            size_t timeouts = 0;
+            bool stopping = false;
+        };
+
+        typedef std::shared_ptr<State> StatePtr;
+
+        static void workerMain(StatePtr state, WorkerPtr worker)
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            while (true)
+            {
+                state->job_cv.wait(lock, [&]
+                                   { return state->stopping || worker->abandoned || !state->jobs.empty(); });
+
+                if (state->stopping || worker->abandoned)
+                {
+                    return;
+                }
+
+                Job job = state->jobs.front();
+                state->jobs.pop_front();
+                worker->busy = true;
+                worker->index = job.index;
+                worker->started = std::chrono::steady_clock::now();
+                lock.unlock();
+
+                std::wstring name;
+                bool ok = hmc_handle_enum::Engine::objectName(job.handle, name);
+                ::CloseHandle(job.handle);
+
+                lock.lock();
+                worker->busy = false;
+
+                // 已按超时上报
+                if (worker->abandoned)
+                {
+                    abandonedWorkers()--;
+                    return;
+                }
+
+                if (!ok)
+                {
+                    name.clear();
+                }
+                state->results.push_back(Result{job.index, false, std::move(name)});
+                state->pending--;
+                state->result_cv.notify_all();
+            }
+        }
+
+        // 需持有 mutex
+        void spawn()
+        {
+            WorkerPtr worker = std::make_shared<Worker>();
+            state->workers.push_back(worker);
+            std::thread(workerMain, state, worker).detach();
+        }
+
+        // 需持有 mutex
+        void reportTimeout(size_t index)
+        {
+            state->results.push_back(Result{index, true, L""});
+            state->pending--;
+            state->timeouts++;
+        }
+
+        // 需持有 mutex  放弃超时的线程
+        void checkTimeout()
+        {
+            auto now = std::chrono::steady_clock::now();
+
+            for (size_t i = 0; i < state->workers.size();)
+            {
+                WorkerPtr worker = state->workers[i];
+                if (!worker->busy || now - worker->started < timeout)
+                {
+                    i++;
+                    continue;
+                }
+
+                worker->abandoned = true;
+                state->workers.erase(state->workers.begin() + i);
+                reportTimeout(worker->index);
+
+                if (++abandonedWorkers() < MAX_ABANDONED_WORKERS)
+                {
+                    spawn();
+                }
+            }
+
+            // 没有可用的线程 剩余的句柄全部视为超时
+            if (state->workers.empty())
+            {
+                for (auto &job : state->jobs)
+                {
+                    ::CloseHandle(job.handle);
+                    reportTimeout(job.index);
+                }
+                state->jobs.clear();
+            }
+        }
+
+        StatePtr state;
+        std::chrono::steady_clock::duration timeout;
+    };
+}
+
+#endif // HMC_IMPORT_HANDLE_NAME_H
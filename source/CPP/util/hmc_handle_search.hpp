@@ -0,0 +1,284 @@
+#pragma once
+
+#ifndef HMC_IMPORT_HANDLE_SEARCH_H
+#define HMC_IMPORT_HANDLE_SEARCH_H
+
+// 按路径反查打开文件的进程
+// 只获取一次系统句柄快照 只处理 File 类型的句柄 (按类型序号过滤 不需要复制其他句柄)
+// 查询路径预先转换为 NT 设备路径 (\Device\HarddiskVolume3\...)  句柄名直接比较 只有命中的结果才转换回 DOS 路径
+// 对象名在 hmc_handle_name 的解析池中并行获取
+
+#include <windows.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "./hmc_handle_enum.hpp"
+#include "./hmc_handle_name.hpp"
+
+namespace hmc_handle_search
+{
+    // 获取对象名的线程数量
+    constexpr size_t NAME_WORKERS = 8;
+    // 同时等待获取对象名的句柄上限
+    constexpr size_t MAX_IN_FLIGHT = 512;
+
+    struct Match
+    {
+        // 查询路径的序号
+        size_t target;
+        DWORD pid;
+        ULONG_PTR handle;
+        // 打开的文件 (DOS 路径)
+        std::wstring path;
+    };
+
+    struct Stats
+    {
+        // 参与比较的文件句柄数量
+        size_t handles;
+        // 获取对象名超时的数量
+        size_t timeouts;
+        // 不是磁盘文件 (管道 控制台等) 而跳过的数量
+        size_t skipped;
+        // 耗时 (ms)
+        double elapsed;
+    };
+
+    inline std::wstring toLower(const std::wstring &input)
+    {
+        std::wstring result = input;
+        if (!result.empty())
+        {
+            ::CharLowerBuffW(&result[0], (DWORD)result.size());
+        }
+        return result;
+    }
+
+    /**
+     * @brief DOS 路径转为 NT 设备路径
+     * C:\a\b -> \Device\HarddiskVolume3\a\b     \\server\share\a -> \Device\Mup\server\share\a
+     *
+     * @param dos_path
+     * @param output
+     * @param dos_prefix 输出 与 output 对应的完整 DOS 路径 (末尾没有分隔符 根目录为 "C:")
+     * @return false 无法转换 (驱动器不存在等)
+     */
+    inline bool toNtPath(const std::wstring &dos_path, std::wstring &output, std::wstring *dos_prefix = NULL)
+    {
+        DWORD length = ::GetFullPathNameW(dos_path.c_str(), 0, NULL, NULL);
+        if (length == 0)
+        {
+            return false;
+        }
+
+        std::wstring full_path(length, L'\0');
+        length = ::GetFullPathNameW(dos_path.c_str(), length, &full_path[0], NULL);
+        full_path.resize(length);
+
+        // 去掉末尾的分隔符 (根目录除外)
+        while (full_path.size() > 3 && full_path.back() == L'\\')
+        {
+            full_path.pop_back();
+        }
+
+        if (full_path.rfind(L"\\\\?\\", 0) == 0)
+        {
+            full_path.erase(0, 4);
+        }
+
+        if (full_path.rfind(L"\\\\", 0) == 0)
+        {
+            output = L"\\Device\\Mup" + full_path.substr(1);
+            if (dos_prefix != NULL)
+            {
+                *dos_prefix = full_path;
+            }
+            return true;
+        }
+
+        if (full_path.size() < 2 || full_path[1] != L':')
+        {
+            return false;
+        }
+
+        WCHAR device[MAX_PATH] = {0};
+        std::wstring drive = full_path.substr(0, 2);
+        if (::QueryDosDeviceW(drive.c_str(), device, MAX_PATH) == 0)
+        {
+            return false;
+        }
+
+        std::wstring rest = full_path.substr(2);
+        if (rest == L"\\")
+        {
+            rest.clear();
+        }
+        output = std::wstring(device) + rest;
+        if (dos_prefix != NULL)
+        {
+            *dos_prefix = drive + rest;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 查找打开了指定路径 (文件 或 目录及其中的文件) 的句柄
+     *
+     * @param paths DOS 路径
+     * @param output 输出 (会被清空)
+     * @param stats 输出
+     * @param timeout_ms 单个句柄获取对象名的期限
+     * @return false 获取系统句柄快照失败
+     */
+    inline bool find(const std::vector<std::wstring> &paths, std::vector<Match> &output, Stats &stats, DWORD timeout_ms = 100)
+    {
+        auto start_time = std::chrono::steady_clock::now();
+        output.clear();
+        stats = Stats{0, 0, 0, 0};
+
+        // 查询路径只转换一次 (小写)
+        std::vector<std::wstring> nt_targets;
+        std::vector<std::wstring> dos_targets;
+        std::vector<size_t> target_index;
+        for (size_t i = 0; i < paths.size(); i++)
+        {
+            std::wstring nt_path;
+            std::wstring dos_path;
+            if (toNtPath(paths[i], nt_path, &dos_path))
+            {
+                nt_targets.push_back(toLower(nt_path));
+                dos_targets.push_back(dos_path);
+                target_index.push_back(i);
+            }
+        }
+
+        if (nt_targets.empty())
+        {
+            return true;
+        }
+
+        hmc_handle_enum::Engine &engine = hmc_handle_enum::Engine::shared();
+        USHORT file_type_index = 0;
+        if (!engine.fileTypeIndex(file_type_index))
+        {
+            return false;
+        }
+
+        DWORD current_pid = ::GetCurrentProcessId();
+        std::vector<hmc_handle_enum::HandleEntry> handle_list;
+        if (!engine.snapshotIf([file_type_index, current_pid](const hmc_handle_enum::HandleEntry &entry)
+                               { return entry.type_index == file_type_index && entry.pid != current_pid && entry.pid > 4; },
+                               handle_list))
+        {
+            return false;
+        }
+        stats.handles = handle_list.size();
+
+        std::vector<hmc_handle_name::Result> resolved_list;
+        hmc_handle_name::Resolver resolver(NAME_WORKERS, timeout_ms);
+
+        auto matchResolved = [&]()
+        {
+            for (auto &resolved : resolved_list)
+            {
+                if (resolved.name.empty())
+                {
+                    continue;
+                }
+
+                std::wstring name = toLower(resolved.name);
+                for (size_t i = 0; i < nt_targets.size(); i++)
+                {
+                    const std::wstring &target = nt_targets[i];
+                    if (name.compare(0, target.size(), target) != 0)
+                    {
+                        continue;
+                    }
+
+                    // 完全一致 或者位于目录中
+                    if (name.size() != target.size() && name[target.size()] != L'\\')
+                    {
+                        continue;
+                    }
+
+                    const hmc_handle_enum::HandleEntry &handle = handle_list[resolved.index];
+                    Match match;
+                    match.target = target_index[i];
+                    match.pid = handle.pid;
+                    match.handle = handle.handle;
+
+                    // 与查询路径同一前缀 直接拼接为 DOS 路径
+                    match.path = dos_targets[i] + resolved.name.substr(target.size());
+                    output.push_back(std::move(match));
+                }
+            }
+            resolved_list.clear();
+        };
+
+        HANDLE process = NULL;
+        DWORD process_pid = 0;
+        bool is_process_opened = false;
+
+        for (size_t i = 0; i < handle_list.size(); i++)
+        {
+            const hmc_handle_enum::HandleEntry &handle = handle_list[i];
+
+            // 快照按进程排列  每个进程只打开一次 (打开失败也不重试)
+            if (!is_process_opened || process_pid != handle.pid)
+            {
+                is_process_opened = true;
+                if (process != NULL)
+                {
+                    ::CloseHandle(process);
+                }
+                process_pid = handle.pid;
+                process = ::OpenProcess(PROCESS_DUP_HANDLE, FALSE, process_pid);
+            }
+
+            if (process == NULL)
+            {
+                continue;
+            }
+
+            HANDLE dup_handle = engine.duplicate(process, handle);
+            if (dup_handle == NULL)
+            {
+                continue;
+            }
+
+            // 管道 / 控制台等不是磁盘文件 (获取对象名可能阻塞)  GetFileType 不会阻塞
+            if (::GetFileType(dup_handle) != FILE_TYPE_DISK)
+            {
+                ::CloseHandle(dup_handle);
+                stats.skipped++;
+                continue;
+            }
+
+            resolver.submit(i, dup_handle);
+
+            size_t in_flight = resolver.collect(resolved_list, 0);
+            while (in_flight >= MAX_IN_FLIGHT)
+            {
+                in_flight = resolver.collect(resolved_list, 50);
+            }
+            matchResolved();
+        }
+
+        if (process != NULL)
+        {
+            ::CloseHandle(process);
+        }
+
+        while (resolver.collect(resolved_list, 50) > 0)
+        {
+            matchResolved();
+        }
+        matchResolved();
+
+        stats.timeouts = resolver.timeouts();
+        stats.elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+        return true;
+    }
+}
+
+#endif // HMC_IMPORT_HANDLE_SEARCH_H
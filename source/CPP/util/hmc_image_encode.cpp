@@ -0,0 +1,1437 @@
+#include "./hmc_image_encode.hpp"
+
+#include "./hmc_cpu_features.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace hmc_image_encode
+{
+    namespace
+    {
+        // 先攒到固定大小再交给 Writer  (避免逐像素的小写入)
+        class BufferedWriter
+        {
+        public:
+            explicit BufferedWriter(Writer &writer) : writer(writer), is_ok(true)
+            {
+                buffer.reserve(CAPACITY);
+            }
+
+            void put(uint8_t value)
+            {
+                buffer.push_back(value);
+                if (buffer.size() >= CAPACITY)
+                {
+                    flush();
+                }
+            }
+
+            void putBytes(const void *data, size_t size)
+            {
+                const uint8_t *bytes = (const uint8_t *)data;
+                if (buffer.size() + size > CAPACITY)
+                {
+                    flush();
+                }
+                if (size >= CAPACITY)
+                {
+                    is_ok = is_ok && writer.write(bytes, size);
+                    return;
+                }
+                buffer.insert(buffer.end(), bytes, bytes + size);
+            }
+
+            void putBigEndian32(uint32_t value)
+            {
+                put((uint8_t)(value >> 24));
+                put((uint8_t)(value >> 16));
+                put((uint8_t)(value >> 8));
+                put((uint8_t)value);
+            }
+
+            void putLittleEndian16(uint16_t value)
+            {
+                put((uint8_t)value);
+                put((uint8_t)(value >> 8));
+            }
+
+            void putLittleEndian32(uint32_t value)
+            {
+                putLittleEndian16((uint16_t)value);
+                putLittleEndian16((uint16_t)(value >> 16));
+            }
+
+            bool flush()
+            {
+                if (!buffer.empty())
+                {
+                    is_ok = is_ok && writer.write(buffer.data(), buffer.size());
+                    buffer.clear();
+                }
+                return is_ok;
+            }
+
+            bool ok() const { return is_ok; }
+
+        private:
+            static constexpr size_t CAPACITY = 64 * 1024;
+            Writer &writer;
+            std::vector<uint8_t> buffer;
+            bool is_ok;
+        };
+
+        inline bool isEmpty(const Image &image)
+        {
+            return image.pixels == NULL || image.width <= 0 || image.height <= 0 || image.stride < (size_t)image.width;
+        }
+
+        // BGRA -> RGB
+        inline void toRgbRow(const uint32_t *source, int width, uint8_t *target)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                uint32_t pixel = source[x];
+                target[x * 3] = (uint8_t)(pixel >> 16);
+                target[x * 3 + 1] = (uint8_t)(pixel >> 8);
+                target[x * 3 + 2] = (uint8_t)pixel;
+            }
+        }
+
+        // ---------------------------------------------------------------- 校验
+
+        struct Crc32Table
+        {
+            uint32_t values[256];
+            Crc32Table()
+            {
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    uint32_t value = i;
+                    for (int bit = 0; bit < 8; bit++)
+                    {
+                        value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+                    }
+                    values[i] = value;
+                }
+            }
+        };
+
+        // crc 为上一次的结果 (初始为 0)
+        uint32_t crc32(uint32_t crc, const uint8_t *data, size_t size)
+        {
+            static const Crc32Table table;
+            crc = ~crc;
+            for (size_t i = 0; i < size; i++)
+            {
+                crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+            }
+            return ~crc;
+        }
+
+        constexpr uint32_t ADLER_BASE = 65521;
+
+        // adler 为上一次的结果 (初始为 1)
+        uint32_t adler32(uint32_t adler, const uint8_t *data, size_t size)
+        {
+            uint32_t a = adler & 0xFFFF;
+            uint32_t b = adler >> 16;
+            while (size > 0)
+            {
+                // 5552 字节内不会溢出
+                size_t block = size < 5552 ? size : 5552;
+                size -= block;
+                for (size_t i = 0; i < block; i++)
+                {
+                    a += data[i];
+                    b += a;
+                }
+                data += block;
+                a %= ADLER_BASE;
+                b %= ADLER_BASE;
+            }
+            return (b << 16) | a;
+        }
+
+        // 两段数据的 adler32 合并为整体的 (second_length 为第二段的长度)
+        uint32_t adler32Combine(uint32_t first, uint32_t second, size_t second_length)
+        {
+            uint32_t remainder = (uint32_t)(second_length % ADLER_BASE);
+            uint32_t sum1 = first & 0xFFFF;
+            uint32_t sum2 = (uint32_t)(((uint64_t)remainder * sum1) % ADLER_BASE);
+            sum1 += (second & 0xFFFF) + ADLER_BASE - 1;
+            sum2 += ((first >> 16) & 0xFFFF) + ((second >> 16) & 0xFFFF) + ADLER_BASE - remainder;
+            if (sum1 >= ADLER_BASE)
+                sum1 -= ADLER_BASE;
+            if (sum1 >= ADLER_BASE)
+                sum1 -= ADLER_BASE;
+            if (sum2 >= (ADLER_BASE << 1))
+                sum2 -= (ADLER_BASE << 1);
+            if (sum2 >= ADLER_BASE)
+                sum2 -= ADLER_BASE;
+            return sum1 | (sum2 << 16);
+        }
+
+        // ---------------------------------------------------------------- deflate
+
+        constexpr int MIN_MATCH = 3;
+        constexpr int MAX_MATCH = 258;
+        constexpr size_t WINDOW_SIZE = 32768;
+        constexpr int HASH_BITS = 15;
+        // 每个块最多的符号数量  之后重新统计频率
+        constexpr size_t BLOCK_SYMBOLS = 32768;
+        constexpr int LITERAL_CODES = 286;
+        constexpr int DISTANCE_CODES = 30;
+        constexpr int CODE_LENGTH_CODES = 19;
+
+        const uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        const uint16_t DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        const uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        const uint8_t CODE_LENGTH_ORDER[CODE_LENGTH_CODES] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+        // 长度 / 距离 -> 编码
+        struct CodeTables
+        {
+            uint8_t length_code[MAX_MATCH + 1];
+            // 距离 - 1 < 512
+            uint8_t distance_small[512];
+            // (距离 - 1) >> 7  (距离 - 1 >= 512)
+            uint8_t distance_large[256];
+
+            CodeTables()
+            {
+                for (int code = 0; code < 29; code++)
+                {
+                    int count = code == 28 ? 1 : 1 << LENGTH_EXTRA[code];
+                    for (int i = 0; i < count && LENGTH_BASE[code] + i <= MAX_MATCH; i++)
+                    {
+                        length_code[LENGTH_BASE[code] + i] = (uint8_t)code;
+                    }
+                }
+                for (int code = 0; code < 30; code++)
+                {
+                    int first = DISTANCE_BASE[code] - 1;
+                    int last = first + (1 << DISTANCE_EXTRA[code]);
+                    for (int value = first; value < last; value++)
+                    {
+                        if (value < 512)
+                            distance_small[value] = (uint8_t)code;
+                        else
+                            distance_large[value >> 7] = (uint8_t)code;
+                    }
+                }
+            }
+
+            int distanceCode(int distance) const
+            {
+                int value = distance - 1;
+                return value < 512 ? distance_small[value] : distance_large[value >> 7];
+            }
+        };
+
+        const CodeTables &codeTables()
+        {
+            static const CodeTables tables;
+            return tables;
+        }
+
+        // 按压缩等级的匹配参数
+        struct LevelConfig
+        {
+            // 最多比较的候选位置
+            int max_chain;
+            // 达到此长度立即停止查找
+            int nice_length;
+            // 匹配长度超过此值时 匹配内部的位置不加入哈希表
+            int max_insert;
+        };
+
+        const LevelConfig LEVEL_CONFIG[10] = {
+            {4, 8, 4},
+            {4, 8, 4},
+            {6, 16, 8},
+            {8, 32, 32},
+            {16, 64, MAX_MATCH},
+            {32, 128, MAX_MATCH},
+            {64, 128, MAX_MATCH},
+            {128, MAX_MATCH, MAX_MATCH},
+            {512, MAX_MATCH, MAX_MATCH},
+            {2048, MAX_MATCH, MAX_MATCH},
+        };
+
+        // 低位在前的位输出
+        class BitWriter
+        {
+        public:
+            explicit BitWriter(std::vector<uint8_t> &output) : output(output), bits(0), count(0) {}
+
+            // value 不超过 32 位
+            inline void put(uint32_t value, int length)
+            {
+                bits |= (uint64_t)value << count;
+                count += length;
+                while (count >= 8)
+                {
+                    output.push_back((uint8_t)bits);
+                    bits >>= 8;
+                    count -= 8;
+                }
+            }
+
+            void alignToByte()
+            {
+                if (count > 0)
+                {
+                    output.push_back((uint8_t)bits);
+                }
+                bits = 0;
+                count = 0;
+            }
+
+        private:
+            std::vector<uint8_t> &output;
+            uint64_t bits;
+            int count;
+        };
+
+        inline uint32_t reverseBits(uint32_t code, int length)
+        {
+            uint32_t result = 0;
+            for (int i = 0; i < length; i++)
+            {
+                result = (result << 1) | (code & 1);
+                code >>= 1;
+            }
+            return result;
+        }
+
+        // 已按频率从小到大排序的 A 原地转为码长 (Moffat-Katajainen)
+        void minimumRedundancy(int *A, int n)
+        {
+            if (n == 0)
+                return;
+            if (n == 1)
+            {
+                A[0] = 1;
+                return;
+            }
+            A[0] += A[1];
+            int root = 0, leaf = 2, next;
+            for (next = 1; next < n - 1; next++)
+            {
+                if (leaf >= n || A[root] < A[leaf])
+                {
+                    A[next] = A[root];
+                    A[root++] = next;
+                }
+                else
+                    A[next] = A[leaf++];
+                if (leaf >= n || (root < next && A[root] < A[leaf]))
+                {
+                    A[next] += A[root];
+                    A[root++] = next;
+                }
+                else
+                    A[next] += A[leaf++];
+            }
+            A[n - 2] = 0;
+            for (next = n - 3; next >= 0; next--)
+                A[next] = A[A[next]] + 1;
+            int available = 1, used = 0, depth = 0;
+            root = n - 2;
+            next = n - 1;
+            while (available > 0)
+            {
+                while (root >= 0 && A[root] == depth)
+                {
+                    used++;
+                    root--;
+                }
+                while (available > used)
+                {
+                    A[next--] = depth;
+                    available--;
+                }
+                available = 2 * used;
+                depth++;
+                used = 0;
+            }
+        }
+
+        /**
+         * @brief 由频率计算不超过 limit 位的码长  使用的符号少于 2 个时补足 (完整的编码树)
+         */
+        void buildLengths(uint32_t *frequency, int count, int limit, uint8_t *lengths)
+        {
+            int used_count = 0;
+            for (int i = 0; i < count && used_count < 2; i++)
+            {
+                used_count += frequency[i] != 0 ? 1 : 0;
+            }
+            for (int i = 0; i < count && used_count < 2; i++)
+            {
+                if (frequency[i] == 0)
+                {
+                    frequency[i] = 1;
+                    used_count++;
+                }
+            }
+
+            struct Symbol
+            {
+                uint32_t frequency;
+                int index;
+            };
+            Symbol symbols[LITERAL_CODES];
+            int n = 0;
+            for (int i = 0; i < count; i++)
+            {
+                lengths[i] = 0;
+                if (frequency[i] != 0)
+                {
+                    symbols[n++] = Symbol{frequency[i], i};
+                }
+            }
+            std::sort(symbols, symbols + n, [](const Symbol &left, const Symbol &right)
+                      { return left.frequency < right.frequency || (left.frequency == right.frequency && left.index < right.index); });
+
+            int depths[LITERAL_CODES];
+            for (int i = 0; i < n; i++)
+            {
+                depths[i] = (int)symbols[i].frequency;
+            }
+            minimumRedundancy(depths, n);
+
+            // 超过 limit 的码长压到 limit 之后调整 使 kraft 和为 1
+            int length_count[LITERAL_CODES + 1] = {0};
+            for (int i = 0; i < n; i++)
+            {
+                length_count[depths[i] < limit ? depths[i] : limit]++;
+            }
+            uint32_t total = 0;
+            for (int i = limit; i > 0; i--)
+            {
+                total += ((uint32_t)length_count[i]) << (limit - i);
+            }
+            while (total != (1u << limit))
+            {
+                length_count[limit]--;
+                for (int i = limit - 1; i > 0; i--)
+                {
+                    if (length_count[i] != 0)
+                    {
+                        length_count[i]--;
+                        length_count[i + 1] += 2;
+                        break;
+                    }
+                }
+                total--;
+            }
+
+            // 频率高的符号分配短码
+            int j = n;
+            for (int length = 1; length <= limit; length++)
+            {
+                for (int k = length_count[length]; k > 0; k--)
+                {
+                    lengths[symbols[--j].index] = (uint8_t)length;
+                }
+            }
+        }
+
+        // 规范哈夫曼编码 (已按输出顺序反转位)
+        void buildCodes(const uint8_t *lengths, int count, uint16_t *codes)
+        {
+            int length_count[16] = {0};
+            for (int i = 0; i < count; i++)
+            {
+                length_count[lengths[i]]++;
+            }
+            length_count[0] = 0;
+            uint32_t next_code[16] = {0};
+            uint32_t code = 0;
+            for (int length = 1; length < 16; length++)
+            {
+                code = (code + length_count[length - 1]) << 1;
+                next_code[length] = code;
+            }
+            for (int i = 0; i < count; i++)
+            {
+                int length = lengths[i];
+                codes[i] = length == 0 ? 0 : (uint16_t)reverseBits(next_code[length]++, length);
+            }
+        }
+
+        inline size_t matchLength(const uint8_t *left, const uint8_t *right, size_t limit)
+        {
+            size_t length = 0;
+            while (length + 8 <= limit)
+            {
+                uint64_t a, b;
+                memcpy(&a, left + length, 8);
+                memcpy(&b, right + length, 8);
+                uint64_t difference = a ^ b;
+                if (difference != 0)
+                {
+                    // 小端: 最低的不同字节
+                    while ((difference & 0xFF) == 0)
+                    {
+                        difference >>= 8;
+                        length++;
+                    }
+                    return length;
+                }
+                length += 8;
+            }
+            while (length < limit && left[length] == right[length])
+            {
+                length++;
+            }
+            return length;
+        }
+
+        // 一段数据的 deflate 压缩 (可以带预置字典)
+        class Deflater
+        {
+        public:
+            explicit Deflater(int level) : config(LEVEL_CONFIG[level < 1 ? 1 : (level > 9 ? 9 : level)]),
+                                           head((size_t)1 << HASH_BITS, -1), prev(WINDOW_SIZE, -1)
+            {
+                symbols.reserve(BLOCK_SYMBOLS + 1);
+            }
+
+            /**
+             * @brief 压缩 data[dictionary, size)  data[0, dictionary) 作为字典 (不输出)
+             * is_final 为 false 时以空的存储块结束 (字节对齐 之后可以直接拼接下一段)
+             */
+            void compress(const uint8_t *data, size_t dictionary, size_t size, bool is_final, std::vector<uint8_t> &output)
+            {
+                BitWriter bits(output);
+                this->data = data;
+                std::fill(head.begin(), head.end(), -1);
+                resetFrequency();
+                block_start = dictionary;
+
+                for (size_t pos = dictionary > WINDOW_SIZE ? dictionary - WINDOW_SIZE : 0; pos < dictionary; pos++)
+                {
+                    insert(pos, size);
+                }
+
+                size_t pos = dictionary;
+                while (pos < size)
+                {
+                    int best_length = 0;
+                    int best_distance = 0;
+                    if (pos + MIN_MATCH <= size)
+                    {
+                        findMatch(pos, size, best_length, best_distance);
+                        insert(pos, size);
+                    }
+
+                    if (best_length >= MIN_MATCH)
+                    {
+                        addMatch(best_length, best_distance);
+                        if (best_length <= config.max_insert)
+                        {
+                            for (int i = 1; i < best_length; i++)
+                            {
+                                insert(pos + i, size);
+                            }
+                        }
+                        pos += best_length;
+                    }
+                    else
+                    {
+                        addLiteral(data[pos]);
+                        pos++;
+                    }
+
+                    if (symbols.size() >= BLOCK_SYMBOLS)
+                    {
+                        writeBlock(bits, pos, false);
+                    }
+                }
+
+                writeBlock(bits, size, is_final);
+                if (!is_final)
+                {
+                    writeStored(bits, NULL, 0, false);
+                }
+                bits.alignToByte();
+            }
+
+        private:
+            struct Symbol
+            {
+                // 字面量 或 匹配长度
+                uint16_t value;
+                // 0 为字面量
+                uint16_t distance;
+            };
+
+            inline uint32_t hashAt(size_t pos) const
+            {
+                uint32_t value = (uint32_t)data[pos] | ((uint32_t)data[pos + 1] << 8) | ((uint32_t)data[pos + 2] << 16);
+                return (value * 2654435761u) >> (32 - HASH_BITS);
+            }
+
+            inline void insert(size_t pos, size_t size)
+            {
+                if (pos + MIN_MATCH > size)
+                {
+                    return;
+                }
+                uint32_t hash = hashAt(pos);
+                prev[pos & (WINDOW_SIZE - 1)] = head[hash];
+                head[hash] = (int64_t)pos;
+            }
+
+            void findMatch(size_t pos, size_t size, int &best_length, int &best_distance)
+            {
+                size_t limit = size - pos < (size_t)MAX_MATCH ? size - pos : (size_t)MAX_MATCH;
+                int64_t candidate = head[hashAt(pos)];
+                int chain = config.max_chain;
+                while (candidate >= 0 && chain-- > 0)
+                {
+                    size_t distance = pos - (size_t)candidate;
+                    if (distance > WINDOW_SIZE)
+                    {
+                        break;
+                    }
+                    if (data[candidate + best_length] == data[pos + best_length] || best_length == 0)
+                    {
+                        int length = (int)matchLength(data + candidate, data + pos, limit);
+                        if (length > best_length)
+                        {
+                            best_length = length;
+                            best_distance = (int)distance;
+                            if (length >= config.nice_length || (size_t)length >= limit)
+                            {
+                                break;
+                            }
+                        }
+                    }
+                    int64_t next = prev[(size_t)candidate & (WINDOW_SIZE - 1)];
+                    // 槽位已被更新的位置覆盖
+                    if (next >= candidate)
+                    {
+                        break;
+                    }
+                    candidate = next;
+                }
+                if (best_length < MIN_MATCH)
+                {
+                    best_length = 0;
+                }
+            }
+
+            inline void addLiteral(uint8_t value)
+            {
+                symbols.push_back(Symbol{value, 0});
+                literal_frequency[value]++;
+            }
+
+            inline void addMatch(int length, int distance)
+            {
+                const CodeTables &tables = codeTables();
+                symbols.push_back(Symbol{(uint16_t)length, (uint16_t)distance});
+                literal_frequency[257 + tables.length_code[length]]++;
+                distance_frequency[tables.distanceCode(distance)]++;
+            }
+
+            void resetFrequency()
+            {
+                memset(literal_frequency, 0, sizeof(literal_frequency));
+                memset(distance_frequency, 0, sizeof(distance_frequency));
+                symbols.clear();
+            }
+
+            void writeStored(BitWriter &bits, const uint8_t *bytes, size_t size, bool is_final)
+            {
+                do
+                {
+                    size_t chunk = size < 65535 ? size : 65535;
+                    size -= chunk;
+                    bits.put(is_final && size == 0 ? 1 : 0, 1);
+                    bits.put(0, 2);
+                    bits.alignToByte();
+                    bits.put((uint32_t)chunk, 16);
+                    bits.put((uint32_t)(~chunk & 0xFFFF), 16);
+                    for (size_t i = 0; i < chunk; i++)
+                    {
+                        bits.put(bytes[i], 8);
+                    }
+                    bytes += chunk;
+                } while (size > 0);
+            }
+
+            // 输出 [block_start, end) 的符号为一个块 (动态哈夫曼 或者更小时为存储块)
+            void writeBlock(BitWriter &bits, size_t end, bool is_final)
+            {
+                const CodeTables &tables = codeTables();
+                literal_frequency[256]++;
+
+                uint8_t literal_lengths[LITERAL_CODES];
+                uint8_t distance_lengths[DISTANCE_CODES];
+                buildLengths(literal_frequency, LITERAL_CODES, 15, literal_lengths);
+                buildLengths(distance_frequency, DISTANCE_CODES, 15, distance_lengths);
+
+                int literal_count = LITERAL_CODES;
+                while (literal_count > 257 && literal_lengths[literal_count - 1] == 0)
+                    literal_count--;
+                int distance_count = DISTANCE_CODES;
+                while (distance_count > 1 && distance_lengths[distance_count - 1] == 0)
+                    distance_count--;
+
+                // 码长序列的游程编码 (16 重复上一个 17/18 重复 0)
+                uint8_t all_lengths[LITERAL_CODES + DISTANCE_CODES];
+                memcpy(all_lengths, literal_lengths, literal_count);
+                memcpy(all_lengths + literal_count, distance_lengths, distance_count);
+                int total_lengths = literal_count + distance_count;
+
+                struct RunCode
+                {
+                    uint8_t symbol;
+                    uint8_t extra;
+                };
+                RunCode runs[LITERAL_CODES + DISTANCE_CODES];
+                int run_count = 0;
+                uint32_t code_length_frequency[CODE_LENGTH_CODES] = {0};
+                for (int i = 0; i < total_lengths;)
+                {
+                    uint8_t value = all_lengths[i];
+                    int repeat = 1;
+                    while (i + repeat < total_lengths && all_lengths[i + repeat] == value)
+                        repeat++;
+                    i += repeat;
+
+                    if (value == 0)
+                    {
+                        while (repeat >= 11)
+                        {
+                            int chunk = repeat < 138 ? repeat : 138;
+                            runs[run_count++] = RunCode{18, (uint8_t)(chunk - 11)};
+                            repeat -= chunk;
+                        }
+                        if (repeat >= 3)
+                        {
+                            runs[run_count++] = RunCode{17, (uint8_t)(repeat - 3)};
+                            repeat = 0;
+                        }
+                    }
+                    else
+                    {
+                        runs[run_count++] = RunCode{value, 0};
+                        repeat--;
+                        while (repeat >= 3)
+                        {
+                            int chunk = repeat < 6 ? repeat : 6;
+                            runs[run_count++] = RunCode{16, (uint8_t)(chunk - 3)};
+                            repeat -= chunk;
+                        }
+                    }
+                    while (repeat-- > 0)
+                    {
+                        runs[run_count++] = RunCode{value, 0};
+                    }
+                }
+                for (int i = 0; i < run_count; i++)
+                {
+                    code_length_frequency[runs[i].symbol]++;
+                }
+
+                uint8_t code_length_lengths[CODE_LENGTH_CODES];
+                buildLengths(code_length_frequency, CODE_LENGTH_CODES, 7, code_length_lengths);
+                int code_length_count = CODE_LENGTH_CODES;
+                while (code_length_count > 4 && code_length_lengths[CODE_LENGTH_ORDER[code_length_count - 1]] == 0)
+                    code_length_count--;
+
+                // 动态块的位数  与存储块比较
+                uint64_t dynamic_bits = 3 + 5 + 5 + 4 + 3 * (uint64_t)code_length_count;
+                for (int i = 0; i < run_count; i++)
+                {
+                    uint8_t symbol = runs[i].symbol;
+                    dynamic_bits += code_length_lengths[symbol] + (symbol == 16 ? 2 : symbol == 17 ? 3
+                                                                                 : symbol == 18   ? 7
+                                                                                                  : 0);
+                }
+                for (int i = 0; i < LITERAL_CODES; i++)
+                {
+                    dynamic_bits += (uint64_t)literal_frequency[i] * (literal_lengths[i] + (i >= 257 ? LENGTH_EXTRA[i - 257] : 0));
+                }
+                for (int i = 0; i < DISTANCE_CODES; i++)
+                {
+                    dynamic_bits += (uint64_t)distance_frequency[i] * (distance_lengths[i] + DISTANCE_EXTRA[i]);
+                }
+
+                size_t raw_size = end - block_start;
+                uint64_t stored_bits = ((uint64_t)raw_size + 5 * (raw_size / 65535 + 1)) * 8;
+                if (stored_bits <= dynamic_bits)
+                {
+                    writeStored(bits, data + block_start, raw_size, is_final);
+                    resetFrequency();
+                    block_start = end;
+                    return;
+                }
+
+                uint16_t literal_codes[LITERAL_CODES];
+                uint16_t distance_codes[DISTANCE_CODES];
+                uint16_t code_length_codes[CODE_LENGTH_CODES];
+                buildCodes(literal_lengths, LITERAL_CODES, literal_codes);
+                buildCodes(distance_lengths, DISTANCE_CODES, distance_codes);
+                buildCodes(code_length_lengths, CODE_LENGTH_CODES, code_length_codes);
+
+                bits.put(is_final ? 1 : 0, 1);
+                bits.put(2, 2);
+                bits.put(literal_count - 257, 5);
+                bits.put(distance_count - 1, 5);
+                bits.put(code_length_count - 4, 4);
+                for (int i = 0; i < code_length_count; i++)
+                {
+                    bits.put(code_length_lengths[CODE_LENGTH_ORDER[i]], 3);
+                }
+                for (int i = 0; i < run_count; i++)
+                {
+                    uint8_t symbol = runs[i].symbol;
+                    bits.put(code_length_codes[symbol], code_length_lengths[symbol]);
+                    if (symbol == 16)
+                        bits.put(runs[i].extra, 2);
+                    else if (symbol == 17)
+                        bits.put(runs[i].extra, 3);
+                    else if (symbol == 18)
+                        bits.put(runs[i].extra, 7);
+                }
+
+                for (const Symbol &symbol : symbols)
+                {
+                    if (symbol.distance == 0)
+                    {
+                        bits.put(literal_codes[symbol.value], literal_lengths[symbol.value]);
+                        continue;
+                    }
+                    int length_code = tables.length_code[symbol.value];
+                    bits.put(literal_codes[257 + length_code], literal_lengths[257 + length_code]);
+                    bits.put(symbol.value - LENGTH_BASE[length_code], LENGTH_EXTRA[length_code]);
+                    int distance_code = tables.distanceCode(symbol.distance);
+                    bits.put(distance_codes[distance_code], distance_lengths[distance_code]);
+                    bits.put(symbol.distance - DISTANCE_BASE[distance_code], DISTANCE_EXTRA[distance_code]);
+                }
+                bits.put(literal_codes[256], literal_lengths[256]);
+
+                resetFrequency();
+                block_start = end;
+            }
+
+            const LevelConfig config;
+            const uint8_t *data = NULL;
+            size_t block_start = 0;
+            std::vector<int64_t> head;
+            std::vector<int64_t> prev;
+            std::vector<Symbol> symbols;
+            uint32_t literal_frequency[LITERAL_CODES];
+            uint32_t distance_frequency[DISTANCE_CODES];
+        };
+
+        // ---------------------------------------------------------------- PNG 行过滤
+
+        constexpr int PNG_BPP = 3;
+        // 行缓冲区前后的 0 填充 (左侧像素 / SIMD 读取越界部分)
+        constexpr size_t ROW_PADDING = 32;
+
+        enum PngFilter
+        {
+            FILTER_NONE = 0,
+            FILTER_SUB = 1,
+            FILTER_UP = 2,
+            FILTER_AVERAGE = 3,
+            FILTER_PAETH = 4,
+            FILTER_COUNT = 5,
+        };
+
+        inline uint8_t paeth(int a, int b, int c)
+        {
+            int p = a + b - c;
+            int pa = p > a ? p - a : a - p;
+            int pb = p > b ? p - b : b - p;
+            int pc = p > c ? p - c : c - p;
+            if (pa <= pb && pa <= pc)
+                return (uint8_t)a;
+            if (pb <= pc)
+                return (uint8_t)b;
+            return (uint8_t)c;
+        }
+
+        inline uint64_t signedCost(uint8_t value)
+        {
+            return value < 128 ? value : 256 - value;
+        }
+
+        /**
+         * @brief 计算五种过滤的结果与代价 (按有符号字节的绝对值之和)
+         * row / prior 前面至少有 PNG_BPP 个 0 字节  后面至少有 16 个可读字节
+         */
+        typedef void (*FilterRows)(const uint8_t *row, const uint8_t *prior, size_t length, uint8_t *outputs[FILTER_COUNT], uint64_t costs[FILTER_COUNT]);
+
+        void filterRowsScalar(const uint8_t *row, const uint8_t *prior, size_t length, uint8_t *outputs[FILTER_COUNT], uint64_t costs[FILTER_COUNT])
+        {
+            for (int filter = 0; filter < FILTER_COUNT; filter++)
+            {
+                costs[filter] = 0;
+            }
+            for (size_t i = 0; i < length; i++)
+            {
+                int raw = row[i];
+                int left = row[(ptrdiff_t)i - PNG_BPP];
+                int up = prior[i];
+                int up_left = prior[(ptrdiff_t)i - PNG_BPP];
+
+                uint8_t values[FILTER_COUNT] = {
+                    (uint8_t)raw,
+                    (uint8_t)(raw - left),
+                    (uint8_t)(raw - up),
+                    (uint8_t)(raw - ((left + up) >> 1)),
+                    (uint8_t)(raw - paeth(left, up, up_left)),
+                };
+                for (int filter = 0; filter < FILTER_COUNT; filter++)
+                {
+                    outputs[filter][i] = values[filter];
+                    costs[filter] += signedCost(values[filter]);
+                }
+            }
+        }
+
+#ifdef HMC_CPU_X86
+
+        // 有符号字节的绝对值 (按无符号)  min(v, -v)
+        HMC_TARGET_SSE2 inline __m128i absSigned8(__m128i value)
+        {
+            return _mm_min_epu8(value, _mm_sub_epi8(_mm_setzero_si128(), value));
+        }
+
+        HMC_TARGET_SSE2 inline __m128i select16(__m128i mask, __m128i when_true, __m128i when_false)
+        {
+            return _mm_or_si128(_mm_and_si128(mask, when_true), _mm_andnot_si128(mask, when_false));
+        }
+
+        HMC_TARGET_SSE2 inline __m128i abs16(__m128i value)
+        {
+            return _mm_max_epi16(value, _mm_sub_epi16(_mm_setzero_si128(), value));
+        }
+
+        // 8 个 16 位 lane 的 paeth 预测
+        HMC_TARGET_SSE2 inline __m128i paeth16(__m128i a, __m128i b, __m128i c)
+        {
+            __m128i bc = _mm_sub_epi16(b, c);
+            __m128i ac = _mm_sub_epi16(a, c);
+            __m128i pa = abs16(bc);
+            __m128i pb = abs16(ac);
+            __m128i pc = abs16(_mm_add_epi16(bc, ac));
+            __m128i b_or_c = select16(_mm_cmpgt_epi16(pb, pc), c, b);
+            return select16(_mm_cmpgt_epi16(pa, _mm_min_epi16(pb, pc)), b_or_c, a);
+        }
+
+        HMC_TARGET_SSE2 void filterRowsSse2(const uint8_t *row, const uint8_t *prior, size_t length, uint8_t *outputs[FILTER_COUNT], uint64_t costs[FILTER_COUNT])
+        {
+            // 最后一组中超出 length 的字节不计入代价
+            alignas(16) static const uint8_t TAIL_MASK[32] = {
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i one = _mm_set1_epi8(1);
+            __m128i sums[FILTER_COUNT];
+            for (int filter = 0; filter < FILTER_COUNT; filter++)
+            {
+                sums[filter] = zero;
+            }
+
+            for (size_t i = 0; i < length; i += 16)
+            {
+                __m128i raw = _mm_loadu_si128((const __m128i *)(row + i));
+                __m128i left = _mm_loadu_si128((const __m128i *)(row + i - PNG_BPP));
+                __m128i up = _mm_loadu_si128((const __m128i *)(prior + i));
+                __m128i up_left = _mm_loadu_si128((const __m128i *)(prior + i - PNG_BPP));
+
+                // floor((left + up) / 2)  (avg_epu8 向上取整)
+                __m128i average = _mm_sub_epi8(_mm_avg_epu8(left, up), _mm_and_si128(_mm_xor_si128(left, up), one));
+
+                __m128i predict_low = paeth16(_mm_unpacklo_epi8(left, zero), _mm_unpacklo_epi8(up, zero), _mm_unpacklo_epi8(up_left, zero));
+                __m128i predict_high = paeth16(_mm_unpackhi_epi8(left, zero), _mm_unpackhi_epi8(up, zero), _mm_unpackhi_epi8(up_left, zero));
+                __m128i predict = _mm_packus_epi16(predict_low, predict_high);
+
+                __m128i values[FILTER_COUNT] = {
+                    raw,
+                    _mm_sub_epi8(raw, left),
+                    _mm_sub_epi8(raw, up),
+                    _mm_sub_epi8(raw, average),
+                    _mm_sub_epi8(raw, predict),
+                };
+
+                size_t remaining = length - i;
+                __m128i mask = remaining >= 16 ? _mm_set1_epi8(-1) : _mm_loadu_si128((const __m128i *)(TAIL_MASK + 16 - remaining));
+
+                for (int filter = 0; filter < FILTER_COUNT; filter++)
+                {
+                    _mm_storeu_si128((__m128i *)(outputs[filter] + i), values[filter]);
+                    sums[filter] = _mm_add_epi64(sums[filter], _mm_sad_epu8(_mm_and_si128(absSigned8(values[filter]), mask), zero));
+                }
+            }
+
+            for (int filter = 0; filter < FILTER_COUNT; filter++)
+            {
+                alignas(16) uint64_t lanes[2];
+                _mm_store_si128((__m128i *)lanes, sums[filter]);
+                costs[filter] = lanes[0] + lanes[1];
+            }
+        }
+
+#endif // HMC_CPU_X86
+
+        FilterRows filterRowsOf(bool simd)
+        {
+#ifdef HMC_CPU_X86
+            if (simd && hmc_cpu_features::get().sse2)
+                return filterRowsSse2;
+#endif
+            return filterRowsScalar;
+        }
+
+        // 行过滤器  逐行调用 append  输出 [过滤方式][过滤后的行]
+        class RowFilter
+        {
+        public:
+            RowFilter(const Image &image, bool simd) : image(image), length((size_t)image.width * PNG_BPP), filter_rows(filterRowsOf(simd))
+            {
+                size_t row_buffer = ROW_PADDING + length + ROW_PADDING;
+                rows[0].assign(row_buffer, 0);
+                rows[1].assign(row_buffer, 0);
+                for (int filter = 0; filter < FILTER_COUNT; filter++)
+                {
+                    outputs[filter].assign(length + ROW_PADDING, 0);
+                }
+            }
+
+            // 下一次 append 不再连续 (重新读取上一行)
+            void restart()
+            {
+                has_prior = false;
+            }
+
+            /**
+             * @brief 过滤第 y 行追加到 output  (需要逐行连续调用  restart 之后的第一行会先读取 y - 1 行)
+             */
+            void append(int y, std::vector<uint8_t> &output)
+            {
+                uint8_t *row = rows[current].data() + ROW_PADDING;
+                const uint8_t *prior = rows[current ^ 1].data() + ROW_PADDING;
+                if (!has_prior)
+                {
+                    memset(rows[current ^ 1].data(), 0, rows[current ^ 1].size());
+                    if (y > 0)
+                    {
+                        toRgbRow(image.pixels + (size_t)(y - 1) * image.stride, image.width, rows[current ^ 1].data() + ROW_PADDING);
+                    }
+                    has_prior = true;
+                }
+                toRgbRow(image.pixels + (size_t)y * image.stride, image.width, row);
+
+                uint8_t *targets[FILTER_COUNT];
+                for (int filter = 0; filter < FILTER_COUNT; filter++)
+                {
+                    targets[filter] = outputs[filter].data();
+                }
+                uint64_t costs[FILTER_COUNT];
+                filter_rows(row, prior, length, targets, costs);
+
+                int best = FILTER_NONE;
+                for (int filter = 1; filter < FILTER_COUNT; filter++)
+                {
+                    if (costs[filter] < costs[best])
+                    {
+                        best = filter;
+                    }
+                }
+
+                output.push_back((uint8_t)best);
+                output.insert(output.end(), targets[best], targets[best] + length);
+                current ^= 1;
+            }
+
+        private:
+            const Image &image;
+            const size_t length;
+            const FilterRows filter_rows;
+            std::vector<uint8_t> rows[2];
+            std::vector<uint8_t> outputs[FILTER_COUNT];
+            int current = 0;
+            bool has_prior = false;
+        };
+
+        // ---------------------------------------------------------------- PNG 分段
+
+        // 每段过滤后的大小 (约)
+        constexpr size_t STRIPE_BYTES = 256 * 1024;
+
+        struct Stripe
+        {
+            std::vector<uint8_t> compressed;
+            uint32_t adler = 1;
+            size_t length = 0;
+            bool done = false;
+        };
+
+        void putBigEndian32(uint8_t *target, uint32_t value)
+        {
+            target[0] = (uint8_t)(value >> 24);
+            target[1] = (uint8_t)(value >> 16);
+            target[2] = (uint8_t)(value >> 8);
+            target[3] = (uint8_t)value;
+        }
+
+        bool writeChunk(Writer &writer, const char *type, const uint8_t *data, size_t size)
+        {
+            uint8_t header[8];
+            putBigEndian32(header, (uint32_t)size);
+            memcpy(header + 4, type, 4);
+            uint32_t crc = crc32(0, header + 4, 4);
+            crc = crc32(crc, data, size);
+            uint8_t footer[4];
+            putBigEndian32(footer, crc);
+            return writer.write(header, 8) && (size == 0 || writer.write(data, size)) && writer.write(footer, 4);
+        }
+    }
+
+    bool parseFormat(const std::string &name, Format &output)
+    {
+        std::string lower = name;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](char value)
+                       { return (char)(value >= 'A' && value <= 'Z' ? value - 'A' + 'a' : value); });
+        if (lower == "bmp")
+            output = FORMAT_BMP;
+        else if (lower == "qoi")
+            output = FORMAT_QOI;
+        else if (lower == "png")
+            output = FORMAT_PNG;
+        else
+            return false;
+        return true;
+    }
+
+    Format formatOfPath(const std::string &path)
+    {
+        size_t dot = path.find_last_of('.');
+        size_t slash = path.find_last_of("/\\");
+        Format format = FORMAT_BMP;
+        if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+        {
+            parseFormat(path.substr(dot + 1), format);
+        }
+        return format;
+    }
+
+    const char *formatName(Format format)
+    {
+        switch (format)
+        {
+        case FORMAT_QOI:
+            return "qoi";
+        case FORMAT_PNG:
+            return "png";
+        default:
+            return "bmp";
+        }
+    }
+
+    bool encodeBmp(const Image &image, Writer &writer)
+    {
+        if (isEmpty(image))
+        {
+            return false;
+        }
+
+        // 每行按 4 字节对齐
+        size_t row_size = ((size_t)image.width * 3 + 3) & ~(size_t)3;
+        size_t image_size = row_size * image.height;
+        const uint32_t offset = 14 + 40;
+
+        BufferedWriter output(writer);
+        // BITMAPFILEHEADER
+        output.put('B');
+        output.put('M');
+        output.putLittleEndian32((uint32_t)(offset + image_size));
+        output.putLittleEndian32(0);
+        output.putLittleEndian32(offset);
+        // BITMAPINFOHEADER  高度为正数: 自下而上
+        output.putLittleEndian32(40);
+        output.putLittleEndian32((uint32_t)image.width);
+        output.putLittleEndian32((uint32_t)image.height);
+        output.putLittleEndian16(1);
+        output.putLittleEndian16(24);
+        output.putLittleEndian32(0);
+        output.putLittleEndian32((uint32_t)image_size);
+        output.putLittleEndian32(0);
+        output.putLittleEndian32(0);
+        output.putLittleEndian32(0);
+        output.putLittleEndian32(0);
+
+        // 行尾的填充保持为 0
+        std::vector<uint8_t> row(row_size, 0);
+        for (int y = image.height - 1; y >= 0 && output.ok(); y--)
+        {
+            const uint32_t *source = image.pixels + (size_t)y * image.stride;
+            for (int x = 0; x < image.width; x++)
+            {
+                uint32_t pixel = source[x];
+                row[x * 3] = (uint8_t)pixel;
+                row[x * 3 + 1] = (uint8_t)(pixel >> 8);
+                row[x * 3 + 2] = (uint8_t)(pixel >> 16);
+            }
+            output.putBytes(row.data(), row.size());
+        }
+        return output.flush();
+    }
+
+    bool encodeQoi(const Image &image, Writer &writer)
+    {
+        if (isEmpty(image))
+        {
+            return false;
+        }
+
+        BufferedWriter output(writer);
+        output.putBytes("qoif", 4);
+        output.putBigEndian32((uint32_t)image.width);
+        output.putBigEndian32((uint32_t)image.height);
+        // 3 通道 sRGB
+        output.put(3);
+        output.put(0);
+
+        // 0x00RRGGBB  alpha 固定为 255 (哈希中 a * 11 为常量)
+        uint32_t index[64] = {0};
+        bool index_used[64] = {false};
+        uint32_t previous = 0;
+        int run = 0;
+
+        for (int y = 0; y < image.height && output.ok(); y++)
+        {
+            const uint32_t *source = image.pixels + (size_t)y * image.stride;
+            bool is_last_row = y == image.height - 1;
+            for (int x = 0; x < image.width; x++)
+            {
+                uint32_t pixel = source[x] & 0x00FFFFFF;
+                if (pixel == previous)
+                {
+                    run++;
+                    if (run == 62 || (is_last_row && x == image.width - 1))
+                    {
+                        output.put((uint8_t)(0xC0 | (run - 1)));
+                        run = 0;
+                    }
+                    continue;
+                }
+
+                if (run > 0)
+                {
+                    output.put((uint8_t)(0xC0 | (run - 1)));
+                    run = 0;
+                }
+
+                int r = (int)(pixel >> 16) & 0xFF;
+                int g = (int)(pixel >> 8) & 0xFF;
+                int b = (int)pixel & 0xFF;
+                int position = (r * 3 + g * 5 + b * 7 + 255 * 11) % 64;
+
+                if (index_used[position] && index[position] == pixel)
+                {
+                    output.put((uint8_t)position);
+                }
+                else
+                {
+                    index[position] = pixel;
+                    index_used[position] = true;
+
+                    int vr = (int8_t)(uint8_t)(r - (int)((previous >> 16) & 0xFF));
+                    int vg = (int8_t)(uint8_t)(g - (int)((previous >> 8) & 0xFF));
+                    int vb = (int8_t)(uint8_t)(b - (int)(previous & 0xFF));
+                    int vg_r = vr - vg;
+                    int vg_b = vb - vg;
+
+                    if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2)
+                    {
+                        output.put((uint8_t)(0x40 | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2)));
+                    }
+                    else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8)
+                    {
+                        output.put((uint8_t)(0x80 | (vg + 32)));
+                        output.put((uint8_t)(((vg_r + 8) << 4) | (vg_b + 8)));
+                    }
+                    else
+                    {
+                        output.put(0xFE);
+                        output.put((uint8_t)r);
+                        output.put((uint8_t)g);
+                        output.put((uint8_t)b);
+                    }
+                }
+                previous = pixel;
+            }
+        }
+
+        static const uint8_t END_MARKER[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+        output.putBytes(END_MARKER, sizeof(END_MARKER));
+        return output.flush();
+    }
+
+    bool encodePng(const Image &image, const Options &options, Writer &writer)
+    {
+        if (isEmpty(image))
+        {
+            return false;
+        }
+
+        static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        uint8_t header[13];
+        putBigEndian32(header, (uint32_t)image.width);
+        putBigEndian32(header + 4, (uint32_t)image.height);
+        // 8 位 RGB  deflate  自适应过滤  不隔行
+        header[8] = 8;
+        header[9] = 2;
+        header[10] = 0;
+        header[11] = 0;
+        header[12] = 0;
+        if (!writer.write(SIGNATURE, sizeof(SIGNATURE)) || !writeChunk(writer, "IHDR", header, sizeof(header)))
+        {
+            return false;
+        }
+
+        const size_t filtered_row = 1 + (size_t)image.width * PNG_BPP;
+        const int stripe_rows = (int)std::max<size_t>(1, STRIPE_BYTES / filtered_row);
+        const int stripe_count = (image.height + stripe_rows - 1) / stripe_rows;
+        // 字典为前一段最后 32KB 的过滤结果 (各段独立压缩也能引用上一段)
+        const int dictionary_rows = (int)((WINDOW_SIZE + filtered_row - 1) / filtered_row);
+
+        unsigned int thread_count = options.threads != 0 ? options.threads : std::thread::hardware_concurrency();
+        thread_count = std::max(1u, std::min(thread_count, (unsigned int)stripe_count));
+        // 领先写出位置的段数上限 (限制内存)
+        const int max_ahead = (int)thread_count * 2;
+
+        std::vector<Stripe> stripes(stripe_count);
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::atomic<int> next_stripe(0);
+        int written = 0;
+        bool is_aborted = false;
+
+        auto worker = [&]()
+        {
+            Deflater deflater(options.level);
+            RowFilter filter(image, options.simd);
+            std::vector<uint8_t> filtered;
+
+            while (true)
+            {
+                int index = next_stripe++;
+                if (index >= stripe_count)
+                {
+                    return;
+                }
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&]
+                                 { return is_aborted || index < written + max_ahead; });
+                    if (is_aborted)
+                    {
+                        return;
+                    }
+                }
+
+                int first_row = index * stripe_rows;
+                int last_row = std::min(image.height, first_row + stripe_rows);
+                int dictionary_first = std::max(0, first_row - dictionary_rows);
+
+                filtered.clear();
+                filter.restart();
+                for (int y = dictionary_first; y < last_row; y++)
+                {
+                    filter.append(y, filtered);
+                }
+                size_t dictionary = (size_t)(first_row - dictionary_first) * filtered_row;
+
+                Stripe result;
+                if (index == 0)
+                {
+                    // zlib 头: deflate 32K 窗口
+                    result.compressed.push_back(0x78);
+                    result.compressed.push_back(0x5E);
+                }
+                deflater.compress(filtered.data(), dictionary, filtered.size(), index == stripe_count - 1, result.compressed);
+                result.length = filtered.size() - dictionary;
+                result.adler = adler32(1, filtered.data() + dictionary, result.length);
+                result.done = true;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                stripes[index] = std::move(result);
+                changed.notify_all();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned int i = 0; i < thread_count; i++)
+        {
+            threads.emplace_back(worker);
+        }
+
+        // 按顺序写出  每段一个 IDAT
+        bool is_ok = true;
+        uint32_t adler = 1;
+        for (int index = 0; index < stripe_count && is_ok; index++)
+        {
+            Stripe stripe;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]
+                             { return stripes[index].done; });
+                stripe = std::move(stripes[index]);
+            }
+
+            adler = adler32Combine(adler, stripe.adler, stripe.length);
+            if (index == stripe_count - 1)
+            {
+                uint8_t trailer[4];
+                putBigEndian32(trailer, adler);
+                stripe.compressed.insert(stripe.compressed.end(), trailer, trailer + 4);
+            }
+            is_ok = writeChunk(writer, "IDAT", stripe.compressed.data(), stripe.compressed.size());
+
+            std::lock_guard<std::mutex> lock(mutex);
+            written = index + 1;
+            is_aborted = !is_ok;
+            changed.notify_all();
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        return is_ok && writeChunk(writer, "IEND", NULL, 0);
+    }
+
+    bool encode(const Image &image, const Options &options, Writer &writer)
+    {
+        switch (options.format)
+        {
+        case FORMAT_QOI:
+            return encodeQoi(image, writer);
+        case FORMAT_PNG:
+            return encodePng(image, options, writer);
+        default:
+            return encodeBmp(image, writer);
+        }
+    }
+}
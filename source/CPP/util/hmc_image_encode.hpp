@@ -0,0 +1,115 @@
+#pragma once
+
+#ifndef HMC_IMPORT_IMAGE_ENCODE_H
+#define HMC_IMPORT_IMAGE_ENCODE_H
+
+// 截图编码为 BMP / QOI / PNG
+// 输入为 BGRA 像素 (alpha 忽略 BitBlt 得到的 alpha 不可靠)  输出均为 24 位 RGB
+// 编码结果分段写入 Writer (文件不会先完整生成在内存中)
+// PNG: 按行分段 每段在独立线程中过滤 (SIMD 选择过滤方式) 并压缩 (deflate)  段与段之间以同步块相连 按顺序写出
+// 只处理内存中的像素 不依赖 windows.h 与 node  (实现位于 hmc_image_encode.cpp 可以单独编译测试)
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace hmc_image_encode
+{
+    enum Format
+    {
+        FORMAT_BMP = 0,
+        FORMAT_QOI = 1,
+        FORMAT_PNG = 2,
+    };
+
+    // 自上而下逐行 每个像素为 B G R A 四个字节 (按小端读取为 0xAARRGGBB)
+    struct Image
+    {
+        const uint32_t *pixels;
+        int width;
+        int height;
+        // 每行的像素数量 (>= width)
+        size_t stride;
+    };
+
+    struct Options
+    {
+        Format format = FORMAT_BMP;
+        // PNG 压缩等级 1-9  越大文件越小 越慢
+        int level = 3;
+        // PNG 压缩线程数  0 为 CPU 核心数
+        unsigned int threads = 0;
+        // PNG 行过滤是否使用 SIMD (对比测试用)
+        bool simd = true;
+    };
+
+    // 编码输出
+    class Writer
+    {
+    public:
+        virtual ~Writer() {}
+        // 返回 false 时编码立即结束
+        virtual bool write(const void *data, size_t size) = 0;
+    };
+
+    // 追加到内存
+    class VectorWriter : public Writer
+    {
+    public:
+        explicit VectorWriter(std::vector<uint8_t> &output) : output(output) {}
+        bool write(const void *data, size_t size) override
+        {
+            const uint8_t *bytes = (const uint8_t *)data;
+            output.insert(output.end(), bytes, bytes + size);
+            return true;
+        }
+
+    private:
+        std::vector<uint8_t> &output;
+    };
+
+    // 写入文件等输出流
+    class StreamWriter : public Writer
+    {
+    public:
+        explicit StreamWriter(std::ostream &stream) : stream(stream) {}
+        bool write(const void *data, size_t size) override
+        {
+            stream.write((const char *)data, (std::streamsize)size);
+            return !stream.fail();
+        }
+
+    private:
+        std::ostream &stream;
+    };
+
+    /**
+     * @brief 格式名称 "bmp" / "qoi" / "png" (不区分大小写)
+     * @return false 不支持的格式
+     */
+    bool parseFormat(const std::string &name, Format &output);
+
+    // 按文件扩展名判断格式  无法识别时为 BMP
+    Format formatOfPath(const std::string &path);
+
+    const char *formatName(Format format);
+
+    // 24 位 自下而上 每行按 4 字节对齐
+    bool encodeBmp(const Image &image, Writer &writer);
+
+    // QOI (RGB 三通道)
+    bool encodeQoi(const Image &image, Writer &writer);
+
+    // PNG (8 位 RGB)
+    bool encodePng(const Image &image, const Options &options, Writer &writer);
+
+    /**
+     * @brief 按 options.format 编码
+     * @return false 图像为空 或者 writer 写入失败
+     */
+    bool encode(const Image &image, const Options &options, Writer &writer);
+}
+
+#endif // HMC_IMPORT_IMAGE_ENCODE_H
@@ -0,0 +1,813 @@
+#include "./hmc_image_match.hpp"
+
+#include "./hmc_cpu_features.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace hmc_image_match
+{
+    namespace
+    {
+        // 金字塔最多的层数 (不含原始分辨率)
+        constexpr int MAX_LEVELS = 4;
+        // 顶层模板的最小边长  太小时失去细节 候选位置过多
+        constexpr int MIN_NEEDLE_SIZE = 8;
+        // 降采样会模糊边缘  原始分辨率以外的各层至少放宽的得分
+        constexpr double COARSE_SLACK = 0.1;
+        // 匹配的位置不一定对齐到格子  各层按估计的相位误差放宽时乘以的系数
+        constexpr double PHASE_MARGIN = 1.5;
+        // 顶层按原始分辨率的固定行数分段 (候选的数量与线程数无关  单线程与多线程的结果相同)
+        constexpr int BAND_HEIGHT = 64;
+        // 每个分段保留的最好的候选位置数量 (limit 较大时按 limit 放大)
+        // 不论是否超过顶层的上限都保留  相位误差估计偏小时真实位置仍在其中
+        constexpr size_t BAND_CANDIDATES = 128;
+        // 逐层细化时的搜索半径
+        constexpr int REFINE_RADIUS = 2;
+
+        typedef uint32_t (*RowSad)(const uint8_t *a, const uint8_t *b, int length);
+
+        uint32_t rowSadScalar(const uint8_t *a, const uint8_t *b, int length)
+        {
+            uint32_t sum = 0;
+            for (int i = 0; i < length; i++)
+            {
+                sum += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+            }
+            return sum;
+        }
+
+#ifdef HMC_CPU_X86
+
+        // psadbw 每 8 个字节得到一个 64 位的和
+        HMC_TARGET_SSE2 uint32_t rowSadSse2(const uint8_t *a, const uint8_t *b, int length)
+        {
+            __m128i total = _mm_setzero_si128();
+            int i = 0;
+            for (; i + 16 <= length; i += 16)
+            {
+                __m128i sad = _mm_sad_epu8(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i)));
+                total = _mm_add_epi64(total, sad);
+            }
+            if (i + 8 <= length)
+            {
+                total = _mm_add_epi64(total, _mm_sad_epu8(_mm_loadl_epi64((const __m128i *)(a + i)), _mm_loadl_epi64((const __m128i *)(b + i))));
+                i += 8;
+            }
+            uint32_t sum = (uint32_t)_mm_cvtsi128_si32(total) + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(total, 8));
+            return sum + rowSadScalar(a + i, b + i, length - i);
+        }
+
+        HMC_TARGET_AVX2 uint32_t rowSadAvx2(const uint8_t *a, const uint8_t *b, int length)
+        {
+            __m256i total = _mm256_setzero_si256();
+            int i = 0;
+            for (; i + 32 <= length; i += 32)
+            {
+                __m256i sad = _mm256_sad_epu8(_mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i)));
+                total = _mm256_add_epi64(total, sad);
+            }
+
+            __m128i half = _mm_add_epi64(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+            if (i + 16 <= length)
+            {
+                half = _mm_add_epi64(half, _mm_sad_epu8(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+                i += 16;
+            }
+            if (i + 8 <= length)
+            {
+                half = _mm_add_epi64(half, _mm_sad_epu8(_mm_loadl_epi64((const __m128i *)(a + i)), _mm_loadl_epi64((const __m128i *)(b + i))));
+                i += 8;
+            }
+            uint32_t sum = (uint32_t)_mm_cvtsi128_si32(half) + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(half, 8));
+            return sum + rowSadScalar(a + i, b + i, length - i);
+        }
+
+#endif // HMC_CPU_X86
+
+        RowSad rowSadOf()
+        {
+#ifdef HMC_CPU_X86
+            if (hmc_cpu_features::get().avx2)
+                return rowSadAvx2;
+            if (hmc_cpu_features::get().sse2)
+                return rowSadSse2;
+#endif
+            return rowSadScalar;
+        }
+
+        /**
+         * @brief 模板在 (x, y) 的绝对差之和
+         * 超过 limit 时提前结束 (此时返回值只保证大于 limit)
+         */
+        uint64_t sadAt(const Gray &haystack, const Gray &needle, int x, int y, uint64_t limit, RowSad row_sad)
+        {
+            uint64_t sum = 0;
+            const uint8_t *haystack_row = haystack.pixels.data() + (size_t)y * haystack.width + x;
+            const uint8_t *needle_row = needle.pixels.data();
+            for (int row = 0; row < needle.height; row++)
+            {
+                sum += row_sad(haystack_row, needle_row, needle.width);
+                if (sum > limit)
+                {
+                    return sum;
+                }
+                haystack_row += haystack.width;
+                needle_row += needle.width;
+            }
+            return sum;
+        }
+
+        // 2x2 平均
+        void downsample(const Gray &input, Gray &output)
+        {
+            output.width = input.width / 2;
+            output.height = input.height / 2;
+            output.pixels.resize((size_t)output.width * output.height);
+
+            for (int y = 0; y < output.height; y++)
+            {
+                const uint8_t *top = input.pixels.data() + (size_t)(y * 2) * input.width;
+                const uint8_t *bottom = top + input.width;
+                uint8_t *target = output.pixels.data() + (size_t)y * output.width;
+                for (int x = 0; x < output.width; x++)
+                {
+                    target[x] = (uint8_t)((top[x * 2] + top[x * 2 + 1] + bottom[x * 2] + bottom[x * 2 + 1] + 2) >> 2);
+                }
+            }
+        }
+
+        // 第 0 层引用原图 (不复制)
+        struct Pyramid
+        {
+            const Gray *base = NULL;
+            std::vector<Gray> levels;
+
+            void build(const Gray &image, int max_levels)
+            {
+                base = &image;
+                levels.clear();
+                levels.reserve(max_levels);
+                while ((int)levels.size() < max_levels)
+                {
+                    const Gray &last = at((int)levels.size());
+                    if (last.width / 2 < MIN_NEEDLE_SIZE || last.height / 2 < MIN_NEEDLE_SIZE)
+                    {
+                        break;
+                    }
+                    Gray next;
+                    downsample(last, next);
+                    levels.push_back(std::move(next));
+                }
+            }
+
+            const Gray &at(int level) const
+            {
+                return level == 0 ? *base : levels[level - 1];
+            }
+
+            int count() const
+            {
+                return 1 + (int)levels.size();
+            }
+        };
+
+        /**
+         * @brief 常驻的工作线程 (首次需要时创建 之后所有搜索复用  不再每次搜索创建线程)
+         * 调用线程也参与执行  同一时间只执行一批任务
+         */
+        class WorkerPool
+        {
+        public:
+            typedef void (*TaskFunc)(void *context, size_t task);
+
+            static WorkerPool &shared()
+            {
+                // 不析构  进程退出时工作线程可能仍在等待
+                static WorkerPool *pool = new WorkerPool();
+                return *pool;
+            }
+
+            /**
+             * @brief 执行 [0, tasks) 全部完成后返回
+             *
+             * @param tasks
+             * @param threads 参与的线程数量 (含调用线程)
+             * @param call
+             * @param context
+             */
+            void run(size_t tasks, unsigned int threads, TaskFunc call, void *context)
+            {
+                std::lock_guard<std::mutex> run_lock(run_mutex);
+
+                size_t helpers = std::min((size_t)threads - 1, MAX_WORKERS);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    while (workers < helpers)
+                    {
+                        std::thread(&WorkerPool::workerLoop, this).detach();
+                        workers++;
+                    }
+                    job_call = call;
+                    job_context = context;
+                    job_tasks = tasks;
+                    next = 0;
+                    seats = helpers;
+                    generation++;
+                }
+                wake.notify_all();
+
+                work(call, context, tasks);
+
+                // 所有任务都已被取走  等待仍在执行的工作线程
+                std::unique_lock<std::mutex> lock(mutex);
+                idle.wait(lock, [this]
+                          { return active == 0; });
+                job_call = NULL;
+                seats = 0;
+            }
+
+        private:
+            static constexpr size_t MAX_WORKERS = 63;
+
+            WorkerPool() {}
+
+            void work(TaskFunc call, void *context, size_t tasks)
+            {
+                for (size_t task = next.fetch_add(1); task < tasks; task = next.fetch_add(1))
+                {
+                    call(context, task);
+                }
+            }
+
+            void workerLoop()
+            {
+                uint64_t seen = 0;
+                std::unique_lock<std::mutex> lock(mutex);
+                while (true)
+                {
+                    wake.wait(lock, [&]
+                              { return generation != seen; });
+                    seen = generation;
+                    // 已经结束 或者参与的线程已足够
+                    if (job_call == NULL || seats == 0)
+                    {
+                        continue;
+                    }
+                    seats--;
+                    active++;
+                    TaskFunc call = job_call;
+                    void *context = job_context;
+                    size_t tasks = job_tasks;
+                    lock.unlock();
+
+                    work(call, context, tasks);
+
+                    lock.lock();
+                    if (--active == 0)
+                    {
+                        idle.notify_all();
+                    }
+                }
+            }
+
+            std::mutex run_mutex;
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::condition_variable idle;
+            size_t workers = 0;
+            size_t seats = 0;
+            size_t active = 0;
+            uint64_t generation = 0;
+            TaskFunc job_call = NULL;
+            void *job_context = NULL;
+            size_t job_tasks = 0;
+            std::atomic<size_t> next{0};
+        };
+
+        /**
+         * @brief 把 [0, tasks) 分给多个线程  fn(task)
+         */
+        template <typename Fn>
+        void parallelFor(size_t tasks, unsigned int threads, Fn fn)
+        {
+            if (threads > tasks)
+            {
+                threads = (unsigned int)tasks;
+            }
+            if (threads <= 1)
+            {
+                for (size_t task = 0; task < tasks; task++)
+                {
+                    fn(task);
+                }
+                return;
+            }
+
+            WorkerPool::shared().run(tasks, threads, [](void *context, size_t task)
+                                     { (*(Fn *)context)(task); }, &fn);
+        }
+
+        struct Candidate
+        {
+            int x;
+            int y;
+            uint64_t sad;
+        };
+
+        inline bool betterThan(const Candidate &a, const Candidate &b)
+        {
+            return a.sad < b.sad || (a.sad == b.sad && (a.y < b.y || (a.y == b.y && a.x < b.x)));
+        }
+
+        // 两个矩形的交集超过较小的一个的一半
+        bool overlaps(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh)
+        {
+            int64_t width = (int64_t)std::min(ax + aw, bx + bw) - std::max(ax, bx);
+            int64_t height = (int64_t)std::min(ay + ah, by + bh) - std::max(ay, by);
+            if (width <= 0 || height <= 0)
+            {
+                return false;
+            }
+            int64_t smaller = std::min((int64_t)aw * ah, (int64_t)bw * bh);
+            return width * height * 2 > smaller;
+        }
+
+        /**
+         * @brief 模板错开半个格子 (2^(level-1) 像素) 再降采样  与不错开时每层的平均每像素差
+         * 匹配的位置对不齐格子时 金字塔各层的 sad 大约高出这么多 (纹理越细越大  噪声一样的纹理接近随机)
+         */
+        std::vector<double> phaseErrors(const Gray &needle, const Pyramid &needle_levels)
+        {
+            int top = needle_levels.count() - 1;
+            std::vector<double> errors(top + 1, 0.0);
+            for (int level = 1; level <= top; level++)
+            {
+                int half = 1 << (level - 1);
+                Gray shifted;
+                shifted.width = needle.width - half;
+                shifted.height = needle.height - half;
+                shifted.pixels.resize((size_t)shifted.width * shifted.height);
+                for (int y = 0; y < shifted.height; y++)
+                {
+                    memcpy(shifted.pixels.data() + (size_t)y * shifted.width, needle.pixels.data() + (size_t)(y + half) * needle.width + half, shifted.width);
+                }
+                for (int i = 0; i < level; i++)
+                {
+                    Gray next;
+                    downsample(shifted, next);
+                    shifted = std::move(next);
+                }
+
+                const Gray &aligned = needle_levels.at(level);
+                int width = std::min(aligned.width, shifted.width);
+                int height = std::min(aligned.height, shifted.height);
+                if (width <= 0 || height <= 0)
+                {
+                    errors[level] = 255.0;
+                    continue;
+                }
+                uint64_t sum = 0;
+                for (int y = 0; y < height; y++)
+                {
+                    sum += rowSadScalar(aligned.pixels.data() + (size_t)y * aligned.width, shifted.pixels.data() + (size_t)y * shifted.width, width);
+                }
+                errors[level] = (double)sum / ((double)width * height);
+            }
+            return errors;
+        }
+
+        // (x, y) 是否为 3x3 内最好的  相邻的位置细化后收敛到同一处 不必占用保留的名额
+        template <typename SadOf>
+        bool isLocalBest(int x, int y, uint64_t sad, int max_x, int max_y, SadOf sad_of)
+        {
+            Candidate self = {x, y, sad};
+            for (int ny = std::max(0, y - 1); ny <= std::min(max_y, y + 1); ny++)
+            {
+                for (int nx = std::max(0, x - 1); nx <= std::min(max_x, x + 1); nx++)
+                {
+                    if (nx == x && ny == y)
+                    {
+                        continue;
+                    }
+                    Candidate neighbor = {nx, ny, sad_of(nx, ny)};
+                    if (betterThan(neighbor, self))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // 按位置排序 去掉重复的 (逐层细化后相邻的候选会收敛到同一个位置)
+        void dedupe(std::vector<Candidate> &list)
+        {
+            std::sort(list.begin(), list.end(), [](const Candidate &a, const Candidate &b)
+                      { return a.y < b.y || (a.y == b.y && a.x < b.x); });
+            list.erase(std::unique(list.begin(), list.end(), [](const Candidate &a, const Candidate &b)
+                                   { return a.x == b.x && a.y == b.y; }),
+                       list.end());
+        }
+
+        // 单个缩放比例
+        void findScale(const Pyramid &haystack, const Gray &needle, double scale, const Options &options, unsigned int threads, RowSad row_sad, std::vector<Match> &output)
+        {
+            Pyramid needle_levels;
+            needle_levels.build(needle, haystack.count() - 1);
+
+            int top = needle_levels.count() - 1;
+            const Gray &haystack_top = haystack.at(top);
+            const Gray &needle_top = needle_levels.at(top);
+            int range_x = haystack_top.width - needle_top.width;
+            int range_y = haystack_top.height - needle_top.height;
+            if (range_x < 0 || range_y < 0)
+            {
+                return;
+            }
+
+            // 每层的 sad 上限  原始分辨率按 threshold  其他层再放宽降采样与相位不对齐的误差
+            std::vector<double> errors = phaseErrors(needle, needle_levels);
+            std::vector<uint64_t> limits(top + 1);
+            for (int level = 0; level <= top; level++)
+            {
+                double per_pixel = std::max(0.0, 1.0 - options.threshold) * 255.0;
+                if (level > 0)
+                {
+                    per_pixel += std::max(COARSE_SLACK * 255.0, errors[level] * PHASE_MARGIN);
+                }
+                const Gray &needle_level = needle_levels.at(level);
+                limits[level] = (uint64_t)(std::min(per_pixel, 255.0) * needle_level.width * needle_level.height);
+            }
+
+            // 顶层穷举 按行分段  每段保留最好的 band_keep 个
+            // 顶层之下还有细化时不按上限筛选 (相位误差只是估计)  否则超过上限的直接跳过
+            size_t rows = (size_t)range_y + 1;
+            size_t band_rows = std::max(1, BAND_HEIGHT >> top);
+            size_t bands = (rows + band_rows - 1) / band_rows;
+            size_t band_keep = std::max(BAND_CANDIDATES, options.limit * 16);
+            uint64_t coarse_limit = top > 0 ? UINT64_MAX : limits[0];
+            std::vector<std::vector<Candidate>> band_candidates(bands);
+
+            parallelFor(bands, threads, [&](size_t band)
+                        {
+                int y_begin = (int)(band * band_rows);
+                int y_end = (int)std::min(rows, (band + 1) * band_rows);
+
+                // 最大堆 堆顶为保留的候选中最差的
+                std::vector<Candidate> &heap = band_candidates[band];
+                uint64_t limit = coarse_limit;
+
+                // 该段 (上下各多一行) 每个位置的 sad  3x3 的比较直接查表  每行在用到前按当时的上限计算
+                // 上限只会收紧: 先算的行超过上限时 比之后通过的位置一定更差 比较仍然准确
+                int map_begin = std::max(0, y_begin - 1);
+                int map_end = std::min((int)rows, y_end + 1);
+                size_t stride = (size_t)range_x + 1;
+                std::vector<uint64_t> map((size_t)(map_end - map_begin) * stride);
+                int map_ready = map_begin;
+                auto sad_of = [&](int x, int y)
+                {
+                    return map[(size_t)(y - map_begin) * stride + x];
+                };
+
+                for (int y = y_begin; y < y_end; y++)
+                {
+                    for (; map_ready < std::min(map_end, y + 2); map_ready++)
+                    {
+                        for (int x = 0; x <= range_x; x++)
+                        {
+                            map[(size_t)(map_ready - map_begin) * stride + x] = sadAt(haystack_top, needle_top, x, map_ready, limit, row_sad);
+                        }
+                    }
+
+                    for (int x = 0; x <= range_x; x++)
+                    {
+                        uint64_t sad = sad_of(x, y);
+                        if (sad > limit || !isLocalBest(x, y, sad, range_x, range_y, sad_of))
+                        {
+                            continue;
+                        }
+
+                        Candidate candidate = {x, y, sad};
+                        if (heap.size() >= band_keep)
+                        {
+                            if (!betterThan(candidate, heap.front()))
+                            {
+                                continue;
+                            }
+                            std::pop_heap(heap.begin(), heap.end(), betterThan);
+                            heap.back() = candidate;
+                        }
+                        else
+                        {
+                            heap.push_back(candidate);
+                        }
+                        std::push_heap(heap.begin(), heap.end(), betterThan);
+
+                        if (heap.size() >= band_keep)
+                        {
+                            limit = std::min(coarse_limit, heap.front().sad);
+                        }
+                    }
+                } });
+
+            std::vector<Candidate> candidates;
+            for (auto &list : band_candidates)
+            {
+                candidates.insert(candidates.end(), list.begin(), list.end());
+            }
+
+            // 逐层细化 每层在上一层位置 x2 的 ±REFINE_RADIUS 内取最好的  超过该层上限的去掉
+            // 顶层不做重叠的筛选: 真实位置旁边更好的候选会把它挤掉  而相邻的候选细化后本就会收敛到一起
+            for (int level = top - 1; level >= 0; level--)
+            {
+                const Gray &haystack_level = haystack.at(level);
+                const Gray &needle_level = needle_levels.at(level);
+                int max_x = haystack_level.width - needle_level.width;
+                int max_y = haystack_level.height - needle_level.height;
+                uint64_t level_limit = limits[level];
+
+                parallelFor(candidates.size(), threads, [&](size_t index)
+                            {
+                    int center_x = std::min(candidates[index].x * 2, max_x);
+                    int center_y = std::min(candidates[index].y * 2, max_y);
+
+                    // 先算中心  通常最接近最好的 其余位置可以更早结束
+                    Candidate best = {center_x, center_y, UINT64_MAX};
+                    uint64_t center_sad = sadAt(haystack_level, needle_level, center_x, center_y, level_limit, row_sad);
+                    if (center_sad <= level_limit)
+                    {
+                        best.sad = center_sad;
+                    }
+                    for (int y = std::max(0, center_y - REFINE_RADIUS); y <= std::min(max_y, center_y + REFINE_RADIUS); y++)
+                    {
+                        for (int x = std::max(0, center_x - REFINE_RADIUS); x <= std::min(max_x, center_x + REFINE_RADIUS); x++)
+                        {
+                            if (x == center_x && y == center_y)
+                            {
+                                continue;
+                            }
+                            uint64_t limit = std::min(best.sad, level_limit);
+                            uint64_t sad = sadAt(haystack_level, needle_level, x, y, limit, row_sad);
+                            Candidate candidate = {x, y, sad};
+                            if (sad <= limit && betterThan(candidate, best))
+                            {
+                                best = candidate;
+                            }
+                        }
+                    }
+                    candidates[index] = best; });
+
+                candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [](const Candidate &candidate)
+                                                { return candidate.sad == UINT64_MAX; }),
+                                 candidates.end());
+                dedupe(candidates);
+            }
+
+            // 原始分辨率的得分
+            double full_sad = 255.0 * needle.width * needle.height;
+            for (auto &candidate : candidates)
+            {
+                double score = 1.0 - (double)candidate.sad / full_sad;
+                if (score >= options.threshold)
+                {
+                    output.push_back(Match{candidate.x, candidate.y, needle.width, needle.height, score, scale});
+                }
+            }
+        }
+
+        uint32_t readU32(const uint8_t *data)
+        {
+            return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+        }
+
+        uint16_t readU16(const uint8_t *data)
+        {
+            return (uint16_t)(data[0] | (data[1] << 8));
+        }
+
+        inline uint8_t luma(uint8_t r, uint8_t g, uint8_t b)
+        {
+            return (uint8_t)((r * 77 + g * 150 + b * 29 + 128) >> 8);
+        }
+    }
+
+    void toGray(const uint32_t *bgra, int width, int height, size_t stride, Gray &output)
+    {
+        output.width = width > 0 ? width : 0;
+        output.height = height > 0 ? height : 0;
+        output.pixels.resize((size_t)output.width * output.height);
+
+        for (int y = 0; y < output.height; y++)
+        {
+            const uint32_t *row = bgra + (size_t)y * stride;
+            uint8_t *target = output.pixels.data() + (size_t)y * output.width;
+            for (int x = 0; x < output.width; x++)
+            {
+                uint32_t pixel = row[x];
+                target[x] = luma((uint8_t)(pixel >> 16), (uint8_t)(pixel >> 8), (uint8_t)pixel);
+            }
+        }
+    }
+
+    bool decodeBmp(const uint8_t *data, size_t size, Gray &output)
+    {
+        // BITMAPFILEHEADER (14) + BITMAPINFOHEADER (40)
+        if (data == NULL || size < 54 || data[0] != 'B' || data[1] != 'M')
+        {
+            return false;
+        }
+
+        uint32_t pixel_offset = readU32(data + 10);
+        int32_t width = (int32_t)readU32(data + 18);
+        int32_t height = (int32_t)readU32(data + 22);
+        uint16_t bit_count = readU16(data + 28);
+        uint32_t compression = readU32(data + 30);
+
+        // BI_RGB 或 (32 位) BI_BITFIELDS
+        if (width <= 0 || height == 0 || (bit_count != 24 && bit_count != 32) || (compression != 0 && !(compression == 3 && bit_count == 32)))
+        {
+            return false;
+        }
+
+        // 负数为自上而下
+        bool is_top_down = height < 0;
+        int rows = is_top_down ? -height : height;
+        size_t bytes_per_pixel = bit_count / 8;
+        // 每行按 4 字节对齐
+        size_t row_size = ((size_t)width * bit_count + 31) / 32 * 4;
+        if (pixel_offset > size || row_size * rows > size - pixel_offset)
+        {
+            return false;
+        }
+
+        output.width = width;
+        output.height = rows;
+        output.pixels.resize((size_t)width * rows);
+
+        for (int y = 0; y < rows; y++)
+        {
+            int source_row = is_top_down ? y : rows - 1 - y;
+            const uint8_t *row = data + pixel_offset + (size_t)source_row * row_size;
+            uint8_t *target = output.pixels.data() + (size_t)y * width;
+            for (int x = 0; x < width; x++)
+            {
+                const uint8_t *pixel = row + x * bytes_per_pixel;
+                target[x] = luma(pixel[2], pixel[1], pixel[0]);
+            }
+        }
+        return true;
+    }
+
+    void resize(const Gray &input, int width, int height, Gray &output)
+    {
+        output.width = width;
+        output.height = height;
+        output.pixels.assign((size_t)width * height, 0);
+        if (input.width <= 0 || input.height <= 0 || width <= 0 || height <= 0)
+        {
+            return;
+        }
+
+        double scale_x = (double)input.width / width;
+        double scale_y = (double)input.height / height;
+
+        for (int y = 0; y < height; y++)
+        {
+            double source_y = std::min(std::max((y + 0.5) * scale_y - 0.5, 0.0), (double)(input.height - 1));
+            int y0 = (int)source_y;
+            int y1 = std::min(y0 + 1, input.height - 1);
+            double fy = source_y - y0;
+
+            for (int x = 0; x < width; x++)
+            {
+                double source_x = std::min(std::max((x + 0.5) * scale_x - 0.5, 0.0), (double)(input.width - 1));
+                int x0 = (int)source_x;
+                int x1 = std::min(x0 + 1, input.width - 1);
+                double fx = source_x - x0;
+
+                const uint8_t *row0 = input.pixels.data() + (size_t)y0 * input.width;
+                const uint8_t *row1 = input.pixels.data() + (size_t)y1 * input.width;
+                double top = row0[x0] + (row0[x1] - row0[x0]) * fx;
+                double bottom = row1[x0] + (row1[x1] - row1[x0]) * fx;
+                output.pixels[(size_t)y * width + x] = (uint8_t)(top + (bottom - top) * fy + 0.5);
+            }
+        }
+    }
+
+    double scoreAt(const Gray &haystack, const Gray &needle, int x, int y)
+    {
+        if (needle.width <= 0 || needle.height <= 0 || x < 0 || y < 0 || x + needle.width > haystack.width || y + needle.height > haystack.height)
+        {
+            return 0;
+        }
+        uint64_t sad = sadAt(haystack, needle, x, y, UINT64_MAX, rowSadOf());
+        return 1.0 - (double)sad / (255.0 * needle.width * needle.height);
+    }
+
+    size_t find(const Gray &haystack, const Gray &needle, const Options &options, std::vector<Match> &output)
+    {
+        output.clear();
+        if (haystack.width <= 0 || haystack.height <= 0 || needle.width <= 0 || needle.height <= 0)
+        {
+            return 0;
+        }
+
+        unsigned int threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        RowSad row_sad = rowSadOf();
+
+        std::vector<double> requested = options.scales;
+        if (requested.empty())
+        {
+            requested.push_back(1.0);
+        }
+
+        // 先确定缩放后的大小  无效的比例 (非正数 / NaN) 与缩放后比被搜索图像还大的直接跳过 (不会缩放出巨大的模板)
+        struct Scale
+        {
+            double scale;
+            int width;
+            int height;
+        };
+        std::vector<Scale> scales;
+        for (double scale : requested)
+        {
+            if (!(scale > 0))
+            {
+                continue;
+            }
+            double width = std::floor(needle.width * scale + 0.5);
+            double height = std::floor(needle.height * scale + 0.5);
+            if (!(width >= 1 && height >= 1 && width <= haystack.width && height <= haystack.height))
+            {
+                continue;
+            }
+            scales.push_back(Scale{scale, (int)width, (int)height});
+        }
+        if (scales.empty())
+        {
+            return 0;
+        }
+
+        // 被搜索图像的金字塔只构建一次  层数按最大的模板决定
+        int largest = 0;
+        for (const Scale &item : scales)
+        {
+            largest = std::max(largest, std::min(item.width, item.height));
+        }
+        int levels = 0;
+        while (levels < MAX_LEVELS && (largest >> (levels + 1)) >= MIN_NEEDLE_SIZE)
+        {
+            levels++;
+        }
+
+        Pyramid haystack_levels;
+        haystack_levels.build(haystack, levels);
+
+        std::vector<Match> matches;
+        Gray scaled;
+        for (const Scale &item : scales)
+        {
+            const Gray *scaled_needle = &needle;
+            if (std::fabs(item.scale - 1.0) > 1e-6)
+            {
+                resize(needle, item.width, item.height, scaled);
+                scaled_needle = &scaled;
+            }
+
+            findScale(haystack_levels, *scaled_needle, item.scale, options, threads, row_sad, matches);
+        }
+
+        // 不同比例的结果之间也去掉重叠的
+        std::sort(matches.begin(), matches.end(), [](const Match &a, const Match &b)
+                  { return a.score > b.score || (a.score == b.score && (a.y < b.y || (a.y == b.y && a.x < b.x))); });
+
+        for (auto &match : matches)
+        {
+            bool is_overlapped = false;
+            for (auto &kept : output)
+            {
+                if (overlaps(match.x, match.y, match.width, match.height, kept.x, kept.y, kept.width, kept.height))
+                {
+                    is_overlapped = true;
+                    break;
+                }
+            }
+            if (is_overlapped)
+            {
+                continue;
+            }
+            output.push_back(match);
+            if (options.limit != 0 && output.size() >= options.limit)
+            {
+                break;
+            }
+        }
+        return output.size();
+    }
+}
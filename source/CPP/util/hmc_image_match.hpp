@@ -0,0 +1,84 @@
+#pragma once
+
+#ifndef HMC_IMPORT_IMAGE_MATCH_H
+#define HMC_IMPORT_IMAGE_MATCH_H
+
+// 在图像中查找模板图像 (找图)
+// 灰度图金字塔由粗到细: 最顶层穷举所有位置 (SIMD 绝对差之和 SAD)  候选位置逐层在 ±2 像素内细化  最后在原始分辨率确认得分
+// 顶层搜索按行分段  细化按候选位置  在常驻的工作线程中进行 (首次使用时创建 之后所有搜索复用)
+// 只处理内存中的像素 不依赖 windows.h 与 node  (实现位于 hmc_image_match.cpp 可以单独编译测试)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hmc_image_match
+{
+    // 8 位灰度图  逐行连续存放
+    struct Gray
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+    struct Options
+    {
+        // 最低得分 0-1  得分 = 1 - 平均每像素灰度差 / 255
+        double threshold = 0.95;
+        // 模板的缩放比例 (每个比例单独搜索)
+        std::vector<double> scales = {1.0};
+        // 最多返回的数量  0 为不限
+        size_t limit = 0;
+        // 线程数量  0 为 CPU 核心数
+        unsigned int threads = 0;
+    };
+
+    struct Match
+    {
+        // 相对于被搜索图像的左上角
+        int32_t x;
+        int32_t y;
+        // 缩放后的模板大小
+        int32_t width;
+        int32_t height;
+        double score;
+        double scale;
+    };
+
+    /**
+     * @brief BGRA 像素转为灰度
+     *
+     * @param bgra 每个像素为 B G R A 四个字节 (按小端读取为 0xAARRGGBB)
+     * @param width
+     * @param height
+     * @param stride 每行的像素数量 (>= width)
+     * @param output
+     */
+    void toGray(const uint32_t *bgra, int width, int height, size_t stride, Gray &output);
+
+    /**
+     * @brief 解码未压缩的 24 / 32 位 BMP 文件为灰度图 (CaptureBmpToBuff 的输出)
+     * @return false 格式不支持或者数据不完整
+     */
+    bool decodeBmp(const uint8_t *data, size_t size, Gray &output);
+
+    // 双线性缩放
+    void resize(const Gray &input, int width, int height, Gray &output);
+
+    // 模板在原始分辨率某个位置的得分
+    double scoreAt(const Gray &haystack, const Gray &needle, int x, int y);
+
+    /**
+     * @brief 查找模板
+     *
+     * @param haystack 被搜索的图像
+     * @param needle 模板
+     * @param options
+     * @param output 输出 (会被清空) 按得分从高到低  互相重叠超过一半的结果只保留得分最高的
+     * @return 结果数量
+     */
+    size_t find(const Gray &haystack, const Gray &needle, const Options &options, std::vector<Match> &output);
+}
+
+#endif // HMC_IMPORT_IMAGE_MATCH_H
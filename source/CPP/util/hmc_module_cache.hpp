@@ -0,0 +1,274 @@
+#pragma once
+
+#ifndef HMC_IMPORT_MODULE_CACHE_H
+#define HMC_IMPORT_MODULE_CACHE_H
+
+// 进程模块枚举与路径缓存
+// 每次只对目标 pid 创建模块快照 (TH32CS_SNAPMODULE)  不再打开模块文件
+// 规范化后的模块路径按 (基址, 大小, PE 时间戳) 缓存在共享池中  多个进程加载同一个 dll 时只处理一次
+// 版本信息 (需要读取文件) 按需获取并与路径一起缓存
+
+#include <windows.h>
+#include <Tlhelp32.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "./hmc_device_path.hpp"
+
+#pragma comment(lib, "version.lib")
+
+namespace hmc_module_cache
+{
+    // 缓存条目上限  超出后清空重建
+    constexpr size_t MAX_CACHE_SIZE = 8192;
+
+    struct ModuleEntry
+    {
+        // 规范化后的路径
+        std::wstring path;
+        std::wstring name;
+        // 文件版本 "1.2.3.4"  没有版本信息为空
+        // 只在 version_once 中写入一次  之后只读 (读取前必须经过 version_once)
+        std::wstring version;
+        std::once_flag version_once;
+    };
+
+    typedef std::shared_ptr<ModuleEntry> ModuleEntryPtr;
+
+    struct ProcessModule
+    {
+        ULONG_PTR base;
+        DWORD size;
+        // PE 头中的 TimeDateStamp  读取失败为 0
+        DWORD timestamp;
+        ModuleEntryPtr entry;
+        // with_version 时从 entry 复制的文件版本  否则为空
+        std::wstring version;
+    };
+
+    /**
+     * @brief 去掉 \\?\ \??\ 前缀  \SystemRoot\ 与设备路径转换为 DOS 路径
+     */
+    inline std::wstring normalizePath(const std::wstring &input)
+    {
+        std::wstring path = input;
+
+        if (path.rfind(L"\\\\?\\UNC\\", 0) == 0)
+        {
+            path = L"\\\\" + path.substr(8);
+        }
+        else if (path.rfind(L"\\\\?\\", 0) == 0 || path.rfind(L"\\??\\", 0) == 0)
+        {
+            path.erase(0, 4);
+        }
+        else if (path.size() > 1 && path[0] == L'\\' && path[1] != L'\\')
+        {
+            // \SystemRoot\... 与 \Device\HarddiskVolumeN\... 等设备路径
+            path = hmc_device_path::Index::shared().translate(path);
+        }
+
+        for (auto &ch : path)
+        {
+            if (ch == L'/')
+            {
+                ch = L'\\';
+            }
+        }
+        return path;
+    }
+
+    // 读取文件版本 (VS_FIXEDFILEINFO)
+    inline std::wstring readFileVersion(const std::wstring &path)
+    {
+        DWORD handle = 0;
+        DWORD size = ::GetFileVersionInfoSizeW(path.c_str(), &handle);
+        if (size == 0)
+        {
+            return L"";
+        }
+
+        std::vector<BYTE> buffer(size);
+        if (!::GetFileVersionInfoW(path.c_str(), 0, size, buffer.data()))
+        {
+            return L"";
+        }
+
+        VS_FIXEDFILEINFO *info = NULL;
+        UINT info_size = 0;
+        if (!::VerQueryValueW(buffer.data(), L"\\", (LPVOID *)&info, &info_size) || info == NULL || info_size < sizeof(VS_FIXEDFILEINFO))
+        {
+            return L"";
+        }
+
+        return std::to_wstring(HIWORD(info->dwFileVersionMS)) + L"." +
+               std::to_wstring(LOWORD(info->dwFileVersionMS)) + L"." +
+               std::to_wstring(HIWORD(info->dwFileVersionLS)) + L"." +
+               std::to_wstring(LOWORD(info->dwFileVersionLS));
+    }
+
+    // 从目标进程内存读取模块 PE 头的时间戳  (一次 ReadProcessMemory)
+    inline DWORD readImageTimestamp(HANDLE process, ULONG_PTR base)
+    {
+        if (process == NULL)
+        {
+            return 0;
+        }
+
+        BYTE header[1024];
+        SIZE_T read_size = 0;
+        if (!::ReadProcessMemory(process, (LPCVOID)base, header, sizeof(header), &read_size) || read_size < sizeof(IMAGE_DOS_HEADER))
+        {
+            return 0;
+        }
+
+        const IMAGE_DOS_HEADER *dos_header = (const IMAGE_DOS_HEADER *)header;
+        if (dos_header->e_magic != IMAGE_DOS_SIGNATURE || dos_header->e_lfanew < 0)
+        {
+            return 0;
+        }
+
+        // Signature + IMAGE_FILE_HEADER 的位置在 32 / 64 位下相同
+        size_t file_header_offset = (size_t)dos_header->e_lfanew + sizeof(DWORD);
+        if (file_header_offset + sizeof(IMAGE_FILE_HEADER) > read_size)
+        {
+            return 0;
+        }
+
+        if (*(const DWORD *)(header + dos_header->e_lfanew) != IMAGE_NT_SIGNATURE)
+        {
+            return 0;
+        }
+
+        return ((const IMAGE_FILE_HEADER *)(header + file_header_offset))->TimeDateStamp;
+    }
+
+    class Cache
+    {
+    public:
+        static Cache &shared()
+        {
+            static Cache cache;
+            return cache;
+        }
+
+        /**
+         * @brief 枚举进程的模块
+         *
+         * @param pid
+         * @param output 输出 (会被清空)
+         * @param with_version 是否获取版本信息 (首次需要读取文件 之后从缓存获取)
+         * @return false 无法创建模块快照 (进程不存在或没有权限)
+         */
+        bool list(DWORD pid, std::vector<ProcessModule> &output, bool with_version = false)
+        {
+            output.clear();
+
+            HANDLE snapshot = INVALID_HANDLE_VALUE;
+            // 目标进程正在加载模块时可能返回 ERROR_BAD_LENGTH  重试几次
+            for (int retry = 0; retry < 4; retry++)
+            {
+                snapshot = ::CreateToolhelp32Snapshot(TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32, pid);
+                if (snapshot != INVALID_HANDLE_VALUE || ::GetLastError() != ERROR_BAD_LENGTH)
+                {
+                    break;
+                }
+            }
+
+            if (snapshot == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+
+            HANDLE process = ::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+
+            MODULEENTRY32W module_entry;
+            module_entry.dwSize = sizeof(MODULEENTRY32W);
+
+            if (::Module32FirstW(snapshot, &module_entry))
+            {
+                do
+                {
+                    ProcessModule module;
+                    module.base = (ULONG_PTR)module_entry.modBaseAddr;
+                    module.size = module_entry.modBaseSize;
+                    module.timestamp = readImageTimestamp(process, module.base);
+                    module.entry = intern(module.base, module.size, module.timestamp, module_entry.szExePath);
+                    output.push_back(module);
+                } while (::Module32NextW(snapshot, &module_entry));
+            }
+
+            if (process != NULL)
+            {
+                ::CloseHandle(process);
+            }
+            ::CloseHandle(snapshot);
+
+            if (with_version)
+            {
+                for (auto &module : output)
+                {
+                    module.version = loadVersion(module.entry);
+                }
+            }
+            return true;
+        }
+
+        size_t size()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return entries.size();
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.clear();
+        }
+
+    private:
+        typedef std::tuple<ULONG_PTR, DWORD, DWORD> Key;
+
+        Cache() {}
+
+        ModuleEntryPtr intern(ULONG_PTR base, DWORD size, DWORD timestamp, const WCHAR *raw_path)
+        {
+            Key key(base, size, timestamp);
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto it = entries.find(key);
+            // 同一地址可能先后加载了不同的文件 (时间戳读取失败时无法区分) 以路径再确认一次
+            if (it != entries.end() && (timestamp != 0 || _wcsicmp(it->second->path.c_str(), normalizePath(raw_path).c_str()) == 0))
+            {
+                return it->second;
+            }
+
+            if (entries.size() >= MAX_CACHE_SIZE)
+            {
+                entries.clear();
+            }
+
+            ModuleEntryPtr entry = std::make_shared<ModuleEntry>();
+            entry->path = normalizePath(raw_path);
+            size_t name_start = entry->path.find_last_of(L'\\');
+            entry->name = name_start == std::wstring::npos ? entry->path : entry->path.substr(name_start + 1);
+            entries[key] = entry;
+            return entry;
+        }
+
+        // 每个条目只读取一次文件  同时获取的线程等待第一个线程读取完成 (不持有缓存的锁)
+        const std::wstring &loadVersion(const ModuleEntryPtr &entry)
+        {
+            std::call_once(entry->version_once, [&entry]()
+                           { entry->version = readFileVersion(entry->path); });
+            return entry->version;
+        }
+
+        std::mutex mutex;
+        std::map<Key, ModuleEntryPtr> entries;
+    };
+}
+
+#endif // HMC_IMPORT_MODULE_CACHE_H
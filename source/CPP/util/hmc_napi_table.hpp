@@ -0,0 +1,119 @@
+#pragma once
+
+#ifndef HMC_IMPORT_NAPI_TABLE_H
+#define HMC_IMPORT_NAPI_TABLE_H
+
+// 列表结果的紧凑传输格式  [numbers: Float64Array, strings: string[]]  以及按列复制的 TypedArray
+// 每行的数值连续写入同一个 Float64Array  字符串按行依次放入同一个数组
+// js 端按固定宽度读取后用对象字面量组装 (见 hmc.ts unpack*)
+// 取代 拼接 json 文本 -> 转换 utf8 -> JSON.parse  也比逐个 napi_set_property 创建对象快得多
+
+#include <node_api.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace hmc_napi_table
+{
+    // 直接以 utf16 创建字符串 (windows 下 wchar_t 为 16 位)  省去 utf8 转换
+    inline napi_value utf16(napi_env env, const std::wstring &value)
+    {
+        napi_value result;
+        napi_create_string_utf16(env, (const char16_t *)value.c_str(), value.size(), &result);
+        return result;
+    }
+
+    inline napi_value utf16Array(napi_env env, const std::vector<std::wstring> &list)
+    {
+        napi_value result;
+        napi_create_array_with_length(env, list.size(), &result);
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            napi_set_element(env, result, (uint32_t)i, utf16(env, list[i]));
+        }
+        return result;
+    }
+
+    /**
+     * @brief 复制为 TypedArray (一次分配)
+     *
+     * @param type 需要与 T 的大小一致 例如 uint32_t -> napi_uint32_array
+     */
+    template <typename T>
+    napi_value typedArray(napi_env env, napi_typedarray_type type, const std::vector<T> &list)
+    {
+        napi_value buffer;
+        napi_value result;
+        void *data = NULL;
+        napi_create_arraybuffer(env, list.size() * sizeof(T), &data, &buffer);
+        if (!list.empty() && data != NULL)
+        {
+            memcpy(data, list.data(), list.size() * sizeof(T));
+        }
+        napi_create_typedarray(env, type, list.size(), buffer, 0, &result);
+        return result;
+    }
+
+    /**
+     * @brief 按行写入的结果表
+     *
+     * @code
+     * hmc_napi_table::Table table(env, list.size(), 3, 1);
+     * for (...) {
+     *     double *row = table.numbers(i);
+     *     row[0] = pid; ...
+     *     table.setString(i, 0, name);
+     * }
+     * return table.toValue();
+     * @endcode
+     */
+    class Table
+    {
+    public:
+        /**
+         * @param env
+         * @param rows 行数
+         * @param number_width 每行的数值数量
+         * @param string_width 每行的字符串数量
+         */
+        Table(napi_env env, size_t rows, size_t number_width, size_t string_width)
+            : env(env), number_width(number_width), string_width(string_width), data(NULL)
+        {
+            napi_value buffer;
+            size_t length = rows * number_width;
+            napi_create_arraybuffer(env, length * sizeof(double), (void **)&data, &buffer);
+            napi_create_typedarray(env, napi_float64_array, length, buffer, 0, &number_list);
+            napi_create_array_with_length(env, rows * string_width, &string_list);
+        }
+
+        // 第 row 行的数值  (宽度为 number_width)
+        double *numbers(size_t row)
+        {
+            return data + row * number_width;
+        }
+
+        void setString(size_t row, size_t column, const std::wstring &value)
+        {
+            napi_set_element(env, string_list, (uint32_t)(row * string_width + column), utf16(env, value));
+        }
+
+        napi_value toValue()
+        {
+            napi_value result;
+            napi_create_array_with_length(env, 2, &result);
+            napi_set_element(env, result, 0, number_list);
+            napi_set_element(env, result, 1, string_list);
+            return result;
+        }
+
+    private:
+        napi_env env;
+        size_t number_width;
+        size_t string_width;
+        double *data;
+        napi_value number_list;
+        napi_value string_list;
+    };
+}
+
+#endif // HMC_IMPORT_NAPI_TABLE_H
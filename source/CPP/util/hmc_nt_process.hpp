@@ -0,0 +1,280 @@
+#pragma once
+
+#ifndef HMC_IMPORT_NT_PROCESS_H
+#define HMC_IMPORT_NT_PROCESS_H
+
+// NtQuerySystemInformation(SystemProcessInformation) 进程快照
+// 一次调用即可得到所有进程的 pid / 父进程 / 创建时间 / cpu时间 / 线程数 等  不需要逐个 OpenProcess
+// 快照缓冲区在多次 refresh 之间复用
+
+#include <windows.h>
+#include <winternl.h>
+#include <string>
+#include <vector>
+
+namespace hmc_nt_process
+{
+    // winternl.h 中的 SYSTEM_PROCESS_INFORMATION 隐藏了大部分字段 (Reserved)  这里是完整的布局
+    typedef struct _HMC_SYSTEM_PROCESS_INFORMATION
+    {
+        ULONG NextEntryOffset;
+        ULONG NumberOfThreads;
+        LARGE_INTEGER WorkingSetPrivateSize;
+        ULONG HardFaultCount;
+        ULONG NumberOfThreadsHighWatermark;
+        ULONGLONG CycleTime;
+        LARGE_INTEGER CreateTime;
+        LARGE_INTEGER UserTime;
+        LARGE_INTEGER KernelTime;
+        UNICODE_STRING ImageName;
+        LONG BasePriority;
+        HANDLE UniqueProcessId;
+        HANDLE InheritedFromUniqueProcessId;
+        ULONG HandleCount;
+        ULONG SessionId;
+        ULONG_PTR UniqueProcessKey;
+        SIZE_T PeakVirtualSize;
+        SIZE_T VirtualSize;
+        ULONG PageFaultCount;
+        SIZE_T PeakWorkingSetSize;
+        SIZE_T WorkingSetSize;
+        SIZE_T QuotaPeakPagedPoolUsage;
+        SIZE_T QuotaPagedPoolUsage;
+        SIZE_T QuotaPeakNonPagedPoolUsage;
+        SIZE_T QuotaNonPagedPoolUsage;
+        SIZE_T PagefileUsage;
+        SIZE_T PeakPagefileUsage;
+        SIZE_T PrivatePageCount;
+        LARGE_INTEGER ReadOperationCount;
+        LARGE_INTEGER WriteOperationCount;
+        LARGE_INTEGER OtherOperationCount;
+        LARGE_INTEGER ReadTransferCount;
+        LARGE_INTEGER WriteTransferCount;
+        LARGE_INTEGER OtherTransferCount;
+    } HMC_SYSTEM_PROCESS_INFORMATION, *PHMC_SYSTEM_PROCESS_INFORMATION;
+
+    // 紧跟在每个进程信息之后  共 NumberOfThreads 项
+    typedef struct _HMC_SYSTEM_THREAD_INFORMATION
+    {
+        LARGE_INTEGER KernelTime;
+        LARGE_INTEGER UserTime;
+        LARGE_INTEGER CreateTime;
+        ULONG WaitTime;
+        PVOID StartAddress;
+        HANDLE UniqueProcess;
+        HANDLE UniqueThread;
+        LONG Priority;
+        LONG BasePriority;
+        ULONG ContextSwitches;
+        ULONG ThreadState;
+        ULONG WaitReason;
+    } HMC_SYSTEM_THREAD_INFORMATION, *PHMC_SYSTEM_THREAD_INFORMATION;
+
+    typedef NTSTATUS(NTAPI *NtQuerySystemInformation_t)(SYSTEM_INFORMATION_CLASS, PVOID, ULONG, PULONG);
+
+    constexpr SYSTEM_INFORMATION_CLASS HMC_SystemProcessInformation = (SYSTEM_INFORMATION_CLASS)5;
+    constexpr NTSTATUS HMC_STATUS_INFO_LENGTH_MISMATCH = (NTSTATUS)0xC0000004L;
+
+    // ntdll 常驻于所有进程  函数地址只需要获取一次
+    inline NtQuerySystemInformation_t getNtQuerySystemInformation()
+    {
+        static NtQuerySystemInformation_t NtQuerySystemInformation = []()
+        {
+            HMODULE ntdll = ::GetModuleHandleW(L"ntdll.dll");
+            if (ntdll == NULL)
+            {
+                return (NtQuerySystemInformation_t)NULL;
+            }
+            return (NtQuerySystemInformation_t)::GetProcAddress(ntdll, "NtQuerySystemInformation");
+        }();
+        return NtQuerySystemInformation;
+    }
+
+    inline ULONGLONG toUInt64(const LARGE_INTEGER &value)
+    {
+        return (ULONGLONG)value.QuadPart;
+    }
+
+    // 快照中的单个进程 (只保留常用字段)
+    struct ProcessRecord
+    {
+        DWORD pid;
+        DWORD ppid;
+        // FILETIME 格式 (100ns)  与 pid 一起唯一标识一个进程 (pid 会被复用)
+        ULONGLONG create_time;
+        ULONGLONG user_time;
+        ULONGLONG kernel_time;
+        ULONG threads;
+        ULONG handles;
+        ULONG session_id;
+        LONG base_priority;
+        SIZE_T working_set;
+        SIZE_T private_bytes;
+        std::wstring name;
+    };
+
+    /**
+     * @brief 进程快照  缓冲区在多次 refresh 之间复用
+     * 不是线程安全的 每个线程使用自己的实例
+     */
+    class Snapshot
+    {
+    public:
+        Snapshot() : used_size(0), snapshot_time(0) {}
+
+        /**
+         * @brief 重新获取快照
+         *
+         * @return true 成功
+         */
+        bool refresh()
+        {
+            NtQuerySystemInformation_t NtQuerySystemInformation = getNtQuerySystemInformation();
+            used_size = 0;
+
+            if (NtQuerySystemInformation == NULL)
+            {
+                return false;
+            }
+
+            if (buffer.empty())
+            {
+                buffer.resize((512 * 1024) / sizeof(ULONGLONG));
+            }
+
+            for (int retry = 0; retry < 8; retry++)
+            {
+                ULONG buffer_size = (ULONG)(buffer.size() * sizeof(ULONGLONG));
+                ULONG return_length = 0;
+                NTSTATUS status = NtQuerySystemInformation(HMC_SystemProcessInformation, buffer.data(), buffer_size, &return_length);
+
+                if (status == HMC_STATUS_INFO_LENGTH_MISMATCH)
+                {
+                    // 两次调用之间可能有新进程 多留一些余量
+                    size_t need_size = (size_t)(return_length > buffer_size ? return_length : buffer_size) * 3 / 2;
+                    buffer.resize(need_size / sizeof(ULONGLONG) + 1);
+                    continue;
+                }
+
+                if (status < 0)
+                {
+                    return false;
+                }
+
+                // 单调时钟 系统时间被调整时采样间隔不会出现负数或极大值 (睡眠期间不计时 与 CPU 时间一致)
+                ::QueryUnbiasedInterruptTime(&snapshot_time);
+                used_size = return_length ? return_length : buffer_size;
+                return true;
+            }
+
+            return false;
+        }
+
+        /**
+         * @brief 遍历快照中的每个进程 (包含最后一项)
+         *
+         * @param callback bool(const HMC_SYSTEM_PROCESS_INFORMATION &)  返回 false 停止遍历
+         */
+        template <typename Callback>
+        void forEach(Callback callback) const
+        {
+            if (used_size == 0)
+            {
+                return;
+            }
+
+            const BYTE *start = (const BYTE *)buffer.data();
+            size_t offset = 0;
+
+            while (offset + sizeof(HMC_SYSTEM_PROCESS_INFORMATION) <= used_size)
+            {
+                const HMC_SYSTEM_PROCESS_INFORMATION &info = *(const HMC_SYSTEM_PROCESS_INFORMATION *)(start + offset);
+
+                if (!callback(info))
+                {
+                    return;
+                }
+
+                if (info.NextEntryOffset == 0)
+                {
+                    return;
+                }
+                offset += info.NextEntryOffset;
+            }
+        }
+
+        /**
+         * @brief 读取为 ProcessRecord 列表
+         *
+         * @param output
+         * @param with_name 是否复制进程名
+         */
+        void read(std::vector<ProcessRecord> &output, bool with_name = true) const
+        {
+            output.clear();
+            forEach([&](const HMC_SYSTEM_PROCESS_INFORMATION &info)
+                    {
+                output.push_back(toRecord(info, with_name));
+                return true; });
+        }
+
+        /**
+         * @brief 读取进程的线程id (快照中已包含 不需要另外创建线程快照)
+         *
+         * @param info forEach 中得到的进程信息
+         * @param output 追加到此处
+         */
+        static void readThreadIds(const HMC_SYSTEM_PROCESS_INFORMATION &info, std::vector<DWORD> &output)
+        {
+            const HMC_SYSTEM_THREAD_INFORMATION *threads = (const HMC_SYSTEM_THREAD_INFORMATION *)(&info + 1);
+            output.reserve(output.size() + info.NumberOfThreads);
+            for (ULONG i = 0; i < info.NumberOfThreads; i++)
+            {
+                output.push_back((DWORD)(ULONG_PTR)threads[i].UniqueThread);
+            }
+        }
+
+        // 快照时的单调时间 (QueryUnbiasedInterruptTime 100ns)  只能用于计算间隔
+        ULONGLONG time() const
+        {
+            return snapshot_time;
+        }
+
+        static ProcessRecord toRecord(const HMC_SYSTEM_PROCESS_INFORMATION &info, bool with_name = true)
+        {
+            ProcessRecord record;
+            record.pid = (DWORD)(ULONG_PTR)info.UniqueProcessId;
+            record.ppid = (DWORD)(ULONG_PTR)info.InheritedFromUniqueProcessId;
+            record.create_time = toUInt64(info.CreateTime);
+            record.user_time = toUInt64(info.UserTime);
+            record.kernel_time = toUInt64(info.KernelTime);
+            record.threads = info.NumberOfThreads;
+            record.handles = info.HandleCount;
+            record.session_id = info.SessionId;
+            record.base_priority = info.BasePriority;
+            record.working_set = info.WorkingSetSize;
+            record.private_bytes = info.PagefileUsage;
+
+            if (with_name)
+            {
+                if (info.ImageName.Buffer != NULL && info.ImageName.Length > 0)
+                {
+                    record.name.assign(info.ImageName.Buffer, info.ImageName.Length / sizeof(WCHAR));
+                }
+                else if (record.pid == 0)
+                {
+                    record.name = L"System Idle Process";
+                }
+            }
+            return record;
+        }
+
+    private:
+        // 使用 ULONGLONG 保证 8 字节对齐
+        std::vector<ULONGLONG> buffer;
+        size_t used_size;
+        ULONGLONG snapshot_time;
+    };
+}
+
+#endif // HMC_IMPORT_NT_PROCESS_H
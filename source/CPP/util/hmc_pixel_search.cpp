@@ -0,0 +1,266 @@
+#include "./hmc_pixel_search.hpp"
+
+#include "./hmc_cpu_features.hpp"
+
+#include <climits>
+
+namespace hmc_pixel_search
+{
+    namespace
+    {
+        struct Target
+        {
+            // 0x00RRGGBB
+            uint32_t color;
+            // 每个字节的误差 (alpha 为 0xFF 即忽略 alpha)
+            uint32_t tolerance;
+        };
+
+        // 扫描一行  返回命中的数量
+        // xs 不为 NULL 时追加命中的列  命中数量达到 limit 立即返回
+        typedef size_t (*RowScan)(const uint32_t *row, int width, int step, const Target &target, std::vector<int32_t> *xs, size_t limit);
+
+        inline bool matchPixel(uint32_t pixel, const Target &target)
+        {
+            for (int shift = 0; shift < 24; shift += 8)
+            {
+                int value = (int)((pixel >> shift) & 0xFF);
+                int expect = (int)((target.color >> shift) & 0xFF);
+                int diff = value > expect ? value - expect : expect - value;
+                if (diff > (int)((target.tolerance >> shift) & 0xFF))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // 逐像素扫描 [x, width)  x 需要是 step 的倍数
+        size_t scanRowFrom(const uint32_t *row, int x, int width, int step, const Target &target, std::vector<int32_t> *xs, size_t limit, size_t found)
+        {
+            for (; x < width; x += step)
+            {
+                if (!matchPixel(row[x], target))
+                {
+                    continue;
+                }
+                found++;
+                if (xs != NULL)
+                {
+                    xs->push_back(x);
+                }
+                if (found >= limit)
+                {
+                    break;
+                }
+            }
+            return found;
+        }
+
+        size_t scanRowScalar(const uint32_t *row, int width, int step, const Target &target, std::vector<int32_t> *xs, size_t limit)
+        {
+            return scanRowFrom(row, 0, width, step, target, xs, limit, 0);
+        }
+
+#ifdef HMC_CPU_X86
+
+        // 处理一组比较结果 (每位对应一个像素)  返回 true 表示已达到 limit
+        inline bool collectMask(unsigned int mask, int lanes, int x, int step, std::vector<int32_t> *xs, size_t limit, size_t &found)
+        {
+            for (int lane = 0; lane < lanes; lane++)
+            {
+                if ((mask & (1u << lane)) == 0)
+                {
+                    continue;
+                }
+                int column = x + lane;
+                if (step > 1 && column % step != 0)
+                {
+                    continue;
+                }
+                found++;
+                if (xs != NULL)
+                {
+                    xs->push_back(column);
+                }
+                if (found >= limit)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // 剩余不足一组的像素交给逐像素版本 (从下一个 step 的倍数开始)
+        inline int alignToStep(int x, int step)
+        {
+            return step > 1 ? (x + step - 1) / step * step : x;
+        }
+
+        // |pixel - color| <= tolerance (按字节)  四个字节都满足的像素对应的 32 位为全 1
+        HMC_TARGET_SSE2 size_t scanRowSse2(const uint32_t *row, int width, int step, const Target &target, std::vector<int32_t> *xs, size_t limit)
+        {
+            const __m128i color = _mm_set1_epi32((int)target.color);
+            const __m128i tolerance = _mm_set1_epi32((int)target.tolerance);
+            const __m128i all_ones = _mm_set1_epi32(-1);
+            // 只统计数量且不跳过像素时 直接累加位数
+            const bool count_only = xs == NULL && step == 1 && limit == SIZE_MAX;
+
+            size_t found = 0;
+            int x = 0;
+            for (; x + 4 <= width; x += 4)
+            {
+                __m128i pixels = _mm_loadu_si128((const __m128i *)(row + x));
+                __m128i diff = _mm_or_si128(_mm_subs_epu8(pixels, color), _mm_subs_epu8(color, pixels));
+                __m128i within = _mm_cmpeq_epi8(_mm_max_epu8(diff, tolerance), tolerance);
+                unsigned int mask = (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(within, all_ones)));
+                if (mask == 0)
+                {
+                    continue;
+                }
+                if (count_only)
+                {
+                    found += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+                    continue;
+                }
+                if (collectMask(mask, 4, x, step, xs, limit, found))
+                {
+                    return found;
+                }
+            }
+            return scanRowFrom(row, alignToStep(x, step), width, step, target, xs, limit, found);
+        }
+
+        HMC_TARGET_AVX2 size_t scanRowAvx2(const uint32_t *row, int width, int step, const Target &target, std::vector<int32_t> *xs, size_t limit)
+        {
+            const __m256i color = _mm256_set1_epi32((int)target.color);
+            const __m256i tolerance = _mm256_set1_epi32((int)target.tolerance);
+            const __m256i all_ones = _mm256_set1_epi32(-1);
+            const bool count_only = xs == NULL && step == 1 && limit == SIZE_MAX;
+
+            size_t found = 0;
+            int x = 0;
+            for (; x + 8 <= width; x += 8)
+            {
+                __m256i pixels = _mm256_loadu_si256((const __m256i *)(row + x));
+                __m256i diff = _mm256_or_si256(_mm256_subs_epu8(pixels, color), _mm256_subs_epu8(color, pixels));
+                __m256i within = _mm256_cmpeq_epi8(_mm256_max_epu8(diff, tolerance), tolerance);
+                unsigned int mask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(within, all_ones)));
+                if (mask == 0)
+                {
+                    continue;
+                }
+                if (count_only)
+                {
+                    for (unsigned int bits = mask; bits != 0; bits &= bits - 1)
+                    {
+                        found++;
+                    }
+                    continue;
+                }
+                if (collectMask(mask, 8, x, step, xs, limit, found))
+                {
+                    return found;
+                }
+            }
+            return scanRowFrom(row, alignToStep(x, step), width, step, target, xs, limit, found);
+        }
+
+#endif // HMC_CPU_X86
+
+        RowScan rowScanOf(Kernel kernel)
+        {
+            if (kernel == KERNEL_AUTO || !isSupported(kernel))
+            {
+                kernel = bestKernel();
+            }
+#ifdef HMC_CPU_X86
+            if (kernel == KERNEL_AVX2)
+                return scanRowAvx2;
+            if (kernel == KERNEL_SSE2)
+                return scanRowSse2;
+#endif
+            return scanRowScalar;
+        }
+    }
+
+    bool isSupported(Kernel kernel)
+    {
+        switch (kernel)
+        {
+        case KERNEL_AUTO:
+        case KERNEL_SCALAR:
+            return true;
+        case KERNEL_SSE2:
+            return hmc_cpu_features::get().sse2;
+        case KERNEL_AVX2:
+            return hmc_cpu_features::get().avx2;
+        default:
+            return false;
+        }
+    }
+
+    Kernel bestKernel()
+    {
+        if (hmc_cpu_features::get().avx2)
+            return KERNEL_AVX2;
+        if (hmc_cpu_features::get().sse2)
+            return KERNEL_SSE2;
+        return KERNEL_SCALAR;
+    }
+
+    const char *kernelName(Kernel kernel)
+    {
+        switch (kernel)
+        {
+        case KERNEL_SCALAR:
+            return "scalar";
+        case KERNEL_SSE2:
+            return "sse2";
+        case KERNEL_AVX2:
+            return "avx2";
+        default:
+            return kernelName(bestKernel());
+        }
+    }
+
+    size_t search(const Image &image, const Options &options, std::vector<Point> &output, Kernel kernel)
+    {
+        output.clear();
+        if (image.pixels == NULL || image.width <= 0 || image.height <= 0)
+        {
+            return 0;
+        }
+
+        int tolerance = options.tolerance < 0 ? 0 : (options.tolerance > 255 ? 255 : options.tolerance);
+        Target target;
+        target.color = options.color & 0x00FFFFFF;
+        target.tolerance = 0xFF000000u | ((uint32_t)tolerance << 16) | ((uint32_t)tolerance << 8) | (uint32_t)tolerance;
+
+        int step = options.step < 1 ? 1 : options.step;
+
+        size_t limit = SIZE_MAX;
+        if (options.mode == MODE_FIRST)
+            limit = 1;
+        else if (options.mode == MODE_ALL && options.limit != 0)
+            limit = options.limit;
+
+        RowScan scan = rowScanOf(kernel);
+        std::vector<int32_t> xs;
+        std::vector<int32_t> *row_output = options.mode == MODE_COUNT ? NULL : &xs;
+
+        size_t total = 0;
+        for (int y = 0; y < image.height && total < limit; y += step)
+        {
+            xs.clear();
+            const uint32_t *row = image.pixels + (size_t)y * image.stride;
+            total += scan(row, image.width, step, target, row_output, limit == SIZE_MAX ? SIZE_MAX : limit - total);
+
+            for (int32_t x : xs)
+            {
+                output.push_back(Point{x, y});
+            }
+        }
+        return total;
+    }
+}
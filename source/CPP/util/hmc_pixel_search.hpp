@@ -0,0 +1,84 @@
+#pragma once
+
+#ifndef HMC_IMPORT_PIXEL_SEARCH_H
+#define HMC_IMPORT_PIXEL_SEARCH_H
+
+// 在 BGRA 像素缓冲区中按颜色 (允许误差) 搜索
+// 逐行扫描 每行由 SIMD 内核 (AVX2 / SSE2) 一次比较 8 / 4 个像素  运行时按 CPU 支持选择  其他平台使用逐像素的版本
+// 不依赖 windows.h 与 node  (实现位于 hmc_pixel_search.cpp 可以单独编译测试)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hmc_pixel_search
+{
+    enum Mode
+    {
+        // 第一个命中的坐标 (逐行从左到右)
+        MODE_FIRST,
+        // 所有命中的坐标
+        MODE_ALL,
+        // 只统计命中的数量
+        MODE_COUNT,
+    };
+
+    enum Kernel
+    {
+        KERNEL_AUTO,
+        KERNEL_SCALAR,
+        KERNEL_SSE2,
+        KERNEL_AVX2,
+    };
+
+    struct Image
+    {
+        // 自上而下逐行 每个像素为 B G R A 四个字节 (按小端读取为 0xAARRGGBB)
+        const uint32_t *pixels;
+        int width;
+        int height;
+        // 每行的像素数量 (>= width)
+        size_t stride;
+    };
+
+    struct Options
+    {
+        // 0xRRGGBB
+        uint32_t color = 0;
+        // 每个颜色通道允许的误差 0-255 (与 AU3_PixelSearch 的 nVar 相同)
+        int tolerance = 0;
+        // 每隔多少个像素比较一次 (行与列都跳过 与 AU3_PixelSearch 的 nStep 相同)
+        int step = 1;
+        Mode mode = MODE_FIRST;
+        // MODE_ALL 时最多返回的数量  0 为不限
+        size_t limit = 0;
+    };
+
+    struct Point
+    {
+        // 相对于 Image 左上角
+        int32_t x;
+        int32_t y;
+    };
+
+    /**
+     * @brief 搜索颜色
+     *
+     * @param image
+     * @param options
+     * @param output 输出 (会被清空) MODE_FIRST 最多一个  MODE_COUNT 不输出
+     * @param kernel 指定内核 (CPU 不支持时使用 KERNEL_AUTO 选择的内核)
+     * @return 命中的数量 (MODE_FIRST 为 0 或 1  MODE_ALL 不超过 limit)
+     */
+    size_t search(const Image &image, const Options &options, std::vector<Point> &output, Kernel kernel = KERNEL_AUTO);
+
+    // 当前 CPU 可用的最快内核
+    Kernel bestKernel();
+
+    // CPU 是否支持该内核
+    bool isSupported(Kernel kernel);
+
+    const char *kernelName(Kernel kernel);
+}
+
+#endif // HMC_IMPORT_PIXEL_SEARCH_H
@@ -0,0 +1,249 @@
+#pragma once
+
+#ifndef HMC_IMPORT_PROCESS_DIFF_H
+#define HMC_IMPORT_PROCESS_DIFF_H
+
+// 进程快照差异
+// 保存上一次的进程列表 (以 pid + 创建时间 作为唯一标识 pid 会被复用)  每次刷新只返回变化的部分
+// 启动 / 退出 / 线程数或父进程变化
+
+#include <windows.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "./hmc_nt_process.hpp"
+
+namespace hmc_process_diff
+{
+    enum ChangeType
+    {
+        // 新启动的进程
+        CHANGE_START = 0,
+        // 已退出的进程
+        CHANGE_EXIT = 1,
+        // 线程数或者父进程发生变化
+        CHANGE_UPDATE = 2,
+    };
+
+    struct ProcessEntry
+    {
+        DWORD pid;
+        DWORD ppid;
+        // FILETIME 格式 (100ns)
+        ULONGLONG create_time;
+        ULONG threads;
+        std::wstring name;
+    };
+
+    struct Change
+    {
+        ChangeType type;
+        ProcessEntry process;
+        // CHANGE_UPDATE 时为变化前的值
+        DWORD last_ppid;
+        ULONG last_threads;
+    };
+
+    /**
+     * @brief 进程列表存储  每次 refresh 与上一次比较
+     * 线程安全 (同一个存储的 refresh 会串行执行)
+     */
+    class Store
+    {
+    public:
+        Store() : round(0), has_baseline(false) {}
+
+        /**
+         * @brief 重新获取快照并计算差异
+         * 第一次调用只记录基准 不产生变化
+         *
+         * @param changes 输出 (会被清空)
+         * @return false 获取快照失败 (存储保持不变)
+         */
+        bool refresh(std::vector<Change> &changes)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            changes.clear();
+
+            if (!snapshot.refresh())
+            {
+                return false;
+            }
+
+            round++;
+            bool emit = has_baseline;
+
+            snapshot.forEach([&](const hmc_nt_process::HMC_SYSTEM_PROCESS_INFORMATION &info)
+                             {
+                DWORD pid = (DWORD)(ULONG_PTR)info.UniqueProcessId;
+                DWORD ppid = (DWORD)(ULONG_PTR)info.InheritedFromUniqueProcessId;
+                ULONGLONG create_time = hmc_nt_process::toUInt64(info.CreateTime);
+
+                auto it = entries.find(pid);
+
+                // pid 已被其他进程复用  旧进程视为退出
+                if (it != entries.end() && it->second.entry.create_time != create_time)
+                {
+                    if (emit)
+                    {
+                        changes.push_back(Change{CHANGE_EXIT, std::move(it->second.entry), 0, 0});
+                    }
+                    entries.erase(it);
+                    it = entries.end();
+                }
+
+                if (it == entries.end())
+                {
+                    // 只有新进程才复制进程名
+                    TrackedEntry &tracked = entries[pid];
+                    tracked.entry = toEntry(info);
+                    tracked.round = round;
+                    if (emit)
+                    {
+                        changes.push_back(Change{CHANGE_START, tracked.entry, 0, 0});
+                    }
+                    return true;
+                }
+
+                TrackedEntry &tracked = it->second;
+                tracked.round = round;
+
+                if (tracked.entry.ppid != ppid || tracked.entry.threads != info.NumberOfThreads)
+                {
+                    DWORD last_ppid = tracked.entry.ppid;
+                    ULONG last_threads = tracked.entry.threads;
+                    tracked.entry.ppid = ppid;
+                    tracked.entry.threads = info.NumberOfThreads;
+                    if (emit)
+                    {
+                        changes.push_back(Change{CHANGE_UPDATE, tracked.entry, last_ppid, last_threads});
+                    }
+                }
+                return true; });
+
+            // 本轮没有出现的进程已经退出
+            for (auto it = entries.begin(); it != entries.end();)
+            {
+                if (it->second.round != round)
+                {
+                    if (emit)
+                    {
+                        changes.push_back(Change{CHANGE_EXIT, std::move(it->second.entry), 0, 0});
+                    }
+                    it = entries.erase(it);
+                    continue;
+                }
+                ++it;
+            }
+
+            has_baseline = true;
+            return true;
+        }
+
+        // 当前记录的进程数量
+        size_t size()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return entries.size();
+        }
+
+    private:
+        struct TrackedEntry
+        {
+            ProcessEntry entry;
+            uint64_t round = 0;
+        };
+
+        static ProcessEntry toEntry(const hmc_nt_process::HMC_SYSTEM_PROCESS_INFORMATION &info)
+        {
+            ProcessEntry entry;
+            entry.pid = (DWORD)(ULONG_PTR)info.UniqueProcessId;
+            entry.ppid = (DWORD)(ULONG_PTR)info.InheritedFromUniqueProcessId;
+            entry.create_time = hmc_nt_process::toUInt64(info.CreateTime);
+            entry.threads = info.NumberOfThreads;
+
+            if (info.ImageName.Buffer != NULL && info.ImageName.Length > 0)
+            {
+                entry.name.assign(info.ImageName.Buffer, info.ImageName.Length / sizeof(WCHAR));
+            }
+            else if (entry.pid == 0)
+            {
+                entry.name = L"System Idle Process";
+            }
+            return entry;
+        }
+
+        std::mutex mutex;
+        hmc_nt_process::Snapshot snapshot;
+        std::unordered_map<DWORD, TrackedEntry> entries;
+        uint64_t round;
+        bool has_baseline;
+    };
+
+    typedef std::shared_ptr<Store> StorePtr;
+
+    // 按 id 管理存储 (js 端持有 id)
+    class Registry
+    {
+    public:
+        static Registry &shared()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        /**
+         * @brief 创建存储并立即记录基准
+         *
+         * @return int 存储id (从 1 开始)  失败为 0
+         */
+        int open()
+        {
+            StorePtr store = std::make_shared<Store>();
+            std::vector<Change> changes;
+            if (!store->refresh(changes))
+            {
+                return 0;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            int id = ++next_id;
+            if (id <= 0)
+            {
+                next_id = 1;
+                id = 1;
+            }
+            stores[id] = store;
+            return id;
+        }
+
+        StorePtr get(int id)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = stores.find(id);
+            if (it == stores.end())
+            {
+                return nullptr;
+            }
+            return it->second;
+        }
+
+        bool close(int id)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return stores.erase(id) != 0;
+        }
+
+    private:
+        Registry() : next_id(0) {}
+
+        std::mutex mutex;
+        std::map<int, StorePtr> stores;
+        int next_id;
+    };
+}
+
+#endif // HMC_IMPORT_PROCESS_DIFF_H
@@ -0,0 +1,226 @@
+#pragma once
+
+#ifndef HMC_IMPORT_PROCESS_TREE_H
+#define HMC_IMPORT_PROCESS_TREE_H
+
+// 进程树索引
+// 一次快照建立 父进程 -> 子进程 的邻接表  之后按广度优先遍历获取所有后代 不需要逐个 OpenProcess
+// 父进程 pid 可能已被复用: 父进程的创建时间晚于子进程时 视为父进程已退出
+
+#include <windows.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "./hmc_nt_process.hpp"
+
+namespace hmc_process_tree
+{
+    struct TreeNode
+    {
+        DWORD pid;
+        DWORD ppid;
+        // 相对于遍历起点的深度 (起点为 0)
+        size_t depth;
+        std::wstring name;
+    };
+
+    class Index
+    {
+    public:
+        /**
+         * @brief 获取快照并建立索引
+         *
+         * @param with_name 是否保留进程名
+         * @return false 获取快照失败
+         */
+        bool build(bool with_name = true)
+        {
+            hmc_nt_process::Snapshot snapshot;
+            if (!snapshot.refresh())
+            {
+                records.clear();
+                index_of.clear();
+                children.clear();
+                roots.clear();
+                return false;
+            }
+            build(snapshot, with_name);
+            return true;
+        }
+
+        /**
+         * @brief 从已有的快照建立索引 (与其他查询共用一次快照)
+         *
+         * @param snapshot 已 refresh 的快照
+         * @param with_name 是否保留进程名
+         */
+        void build(const hmc_nt_process::Snapshot &snapshot, bool with_name = true)
+        {
+            records.clear();
+            index_of.clear();
+            children.clear();
+            roots.clear();
+
+            snapshot.read(records, with_name);
+            index_of.reserve(records.size());
+
+            for (size_t i = 0; i < records.size(); i++)
+            {
+                index_of[records[i].pid] = i;
+            }
+
+            for (size_t i = 0; i < records.size(); i++)
+            {
+                const hmc_nt_process::ProcessRecord &record = records[i];
+
+                if (hasLiveParent(record))
+                {
+                    children[record.ppid].push_back(i);
+                }
+                else
+                {
+                    roots.push_back(i);
+                }
+            }
+        }
+
+        bool has(DWORD pid) const
+        {
+            return index_of.find(pid) != index_of.end();
+        }
+
+        /**
+         * @brief 获取所有后代进程 (广度优先 不包含自身)
+         *
+         * @param pid
+         * @param output 追加到此处
+         */
+        void descendants(DWORD pid, std::vector<DWORD> &output) const
+        {
+            std::vector<TreeNode> nodes;
+            walk(pid, nodes, (size_t)-1, false);
+
+            output.reserve(output.size() + nodes.size());
+            for (size_t i = 1; i < nodes.size(); i++)
+            {
+                output.push_back(nodes[i].pid);
+            }
+        }
+
+        /**
+         * @brief 获取进程树 (广度优先 包含起点 深度为 0)
+         *
+         * @param pid 起点进程  不存在时结果为空
+         * @param output 追加到此处
+         * @param max_depth 最大深度
+         */
+        void tree(DWORD pid, std::vector<TreeNode> &output, size_t max_depth = (size_t)-1) const
+        {
+            walk(pid, output, max_depth, true);
+        }
+
+        /**
+         * @brief 获取所有进程组成的森林 (从没有存活父进程的进程开始 广度优先)
+         *
+         * @param output 追加到此处
+         * @param max_depth 最大深度
+         */
+        void forest(std::vector<TreeNode> &output, size_t max_depth = (size_t)-1) const
+        {
+            std::unordered_set<DWORD> visited;
+            std::vector<size_t> queue;
+            std::vector<size_t> depth_list;
+
+            for (size_t root : roots)
+            {
+                queue.push_back(root);
+                depth_list.push_back(0);
+            }
+            bfs(queue, depth_list, visited, output, max_depth, true);
+        }
+
+    private:
+        // 父进程存在 并且不是 pid 复用后的新进程
+        bool hasLiveParent(const hmc_nt_process::ProcessRecord &record) const
+        {
+            if (record.ppid == record.pid)
+            {
+                return false;
+            }
+
+            auto it = index_of.find(record.ppid);
+            if (it == index_of.end())
+            {
+                return false;
+            }
+
+            const hmc_nt_process::ProcessRecord &parent = records[it->second];
+            return parent.create_time <= record.create_time;
+        }
+
+        void walk(DWORD pid, std::vector<TreeNode> &output, size_t max_depth, bool with_name) const
+        {
+            auto it = index_of.find(pid);
+            if (it == index_of.end())
+            {
+                return;
+            }
+
+            std::unordered_set<DWORD> visited;
+            std::vector<size_t> queue = {it->second};
+            std::vector<size_t> depth_list = {0};
+            bfs(queue, depth_list, visited, output, max_depth, with_name);
+        }
+
+        void bfs(std::vector<size_t> &queue, std::vector<size_t> &depth_list, std::unordered_set<DWORD> &visited, std::vector<TreeNode> &output, size_t max_depth, bool with_name) const
+        {
+            // queue 只追加 用下标作为队头
+            for (size_t head = 0; head < queue.size(); head++)
+            {
+                const hmc_nt_process::ProcessRecord &record = records[queue[head]];
+                size_t depth = depth_list[head];
+
+                // 异常数据形成环时避免重复
+                if (!visited.insert(record.pid).second)
+                {
+                    continue;
+                }
+
+                TreeNode node;
+                node.pid = record.pid;
+                node.ppid = record.ppid;
+                node.depth = depth;
+                if (with_name)
+                {
+                    node.name = record.name;
+                }
+                output.push_back(std::move(node));
+
+                if (depth >= max_depth)
+                {
+                    continue;
+                }
+
+                auto child_it = children.find(record.pid);
+                if (child_it == children.end())
+                {
+                    continue;
+                }
+
+                for (size_t child : child_it->second)
+                {
+                    queue.push_back(child);
+                    depth_list.push_back(depth + 1);
+                }
+            }
+        }
+
+        std::vector<hmc_nt_process::ProcessRecord> records;
+        std::unordered_map<DWORD, size_t> index_of;
+        std::unordered_map<DWORD, std::vector<size_t>> children;
+        std::vector<size_t> roots;
+    };
+}
+
+#endif // HMC_IMPORT_PROCESS_TREE_H
@@ -0,0 +1,345 @@
+#pragma once
+
+#ifndef HMC_IMPORT_PROMISE_POOL_H
+#define HMC_IMPORT_PROMISE_POOL_H
+
+// 每次调用独立上下文的 Promise 异步函数封装
+// 旧的 NEW_PROMISE_FUNCTION_DEFAULT_FUN 每个导出函数只有一个静态 work/deferred 槽位
+// 上一次调用还没结束时再次调用会直接返回 null  这里改为每次调用从空闲链表取一个上下文 完成后归还复用
+// 任务交给 hmc_executor 的独立线程执行 不占用 libuv 线程池 (当前 env 无法使用执行器时才回退到 napi_create_async_work)
+
+#include <node_api.h>
+#include <any>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <exception>
+#include "hmc_napi_value_util.h"
+#include "./hmc_executor.hpp"
+
+namespace hmc_promise_pool
+{
+    typedef std::any (*WorkFuncType)(std::vector<std::any> arguments_list);
+    typedef napi_value (*FormatResultFuncType)(napi_env env, std::any result_any_data);
+    typedef void (*FormatArgsFuncType)(napi_env env, napi_callback_info info, std::vector<std::any> &ArgumentsList, hmc_NodeArgsValue args_value);
+
+    class PromiseFunction;
+
+    // 单次调用的上下文 (参数 deferred work句柄 结果)
+    struct PromiseContext
+    {
+        napi_async_work work = NULL;
+        napi_deferred deferred = NULL;
+        std::vector<std::any> arguments_list;
+        std::any result;
+        std::string error_message;
+        bool has_error = false;
+        PromiseFunction *function = NULL;
+
+        void reset()
+        {
+            work = NULL;
+            deferred = NULL;
+            arguments_list.clear();
+            result.reset();
+            error_message.clear();
+            has_error = false;
+            function = NULL;
+        }
+    };
+
+    /**
+     * @brief 上下文对象池  空闲上下文保留在链表中复用 避免每次调用都分配
+     */
+    class ContextPool
+    {
+    public:
+        // 空闲链表最多保留的数量 超出的直接释放
+        static constexpr size_t MAX_FREE_SIZE = 64;
+
+        static ContextPool &shared()
+        {
+            static ContextPool pool;
+            return pool;
+        }
+
+        PromiseContext *acquire()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!free_list.empty())
+                {
+                    PromiseContext *context = free_list.back();
+                    free_list.pop_back();
+                    return context;
+                }
+            }
+            return new PromiseContext();
+        }
+
+        void release(PromiseContext *context)
+        {
+            if (context == NULL)
+            {
+                return;
+            }
+
+            context->reset();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (free_list.size() < MAX_FREE_SIZE)
+                {
+                    free_list.push_back(context);
+                    return;
+                }
+            }
+            delete context;
+        }
+
+        size_t free_size()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return free_list.size();
+        }
+
+    private:
+        ContextPool() { free_list.reserve(MAX_FREE_SIZE); }
+        std::mutex mutex;
+        std::vector<PromiseContext *> free_list;
+    };
+
+    /**
+     * @brief 一个导出函数的定义 (异步 + 同步)
+     */
+    class PromiseFunction
+    {
+    public:
+        PromiseFunction(WorkFuncType work_func, FormatResultFuncType format_result_func, FormatArgsFuncType format_args_func)
+            : work_func(work_func), format_result_func(format_result_func), format_args_func(format_args_func)
+        {
+        }
+
+        void exports(napi_env env, napi_value exports, std::string name, bool is_sync)
+        {
+            napi_value exported_function;
+            if (!is_sync)
+            {
+                work_name = name;
+                hmc_executor::Executor::shared().bind(env);
+            }
+            napi_create_function(env, name.c_str(), name.length(), is_sync ? startSync : startWork, this, &exported_function);
+            napi_set_named_property(env, exports, name.c_str(), exported_function);
+        }
+
+        // 设置执行通道 长耗时或阻塞的函数需要放到 LANE_LONG 避免堵住快速查询
+        void setLane(hmc_executor::Lane value)
+        {
+            lane = value;
+        }
+
+        WorkFuncType work_func;
+        FormatResultFuncType format_result_func;
+        FormatArgsFuncType format_args_func;
+        std::string work_name;
+        hmc_executor::Lane lane = hmc_executor::LANE_QUICK;
+
+    private:
+        void getArguments(napi_env env, napi_callback_info info, std::vector<std::any> &arguments_list)
+        {
+            if (format_args_func != NULL)
+            {
+                format_args_func(env, info, arguments_list, hmc_NodeArgsValue(env, info));
+                return;
+            }
+
+            auto input = hmc_NodeArgsValue(env, info).get_values();
+            arguments_list.reserve(input.size());
+            for (size_t i = 0; i < input.size(); i++)
+            {
+                arguments_list.push_back(input.at(i));
+            }
+        }
+
+        // 工作线程
+        static void executeTask(void *data)
+        {
+            PromiseContext *context = (PromiseContext *)data;
+            try
+            {
+                context->result = context->function->work_func(context->arguments_list);
+            }
+            catch (const std::exception &err)
+            {
+                context->has_error = true;
+                context->error_message = err.what();
+            }
+            catch (...)
+            {
+                context->has_error = true;
+                context->error_message = "unknown error";
+            }
+        }
+
+        static void executeWork(napi_env env, void *data)
+        {
+            executeTask(data);
+        }
+
+        // js线程 结束 Promise
+        static void settle(napi_env env, bool is_ok, PromiseContext *context)
+        {
+            napi_value error = NULL;
+
+            if (!is_ok || context->has_error)
+            {
+                std::string message = !is_ok ? std::string("async work cancelled") : context->error_message;
+                napi_create_string_utf8(env, message.c_str(), message.length(), &error);
+                napi_reject_deferred(env, context->deferred, error);
+            }
+            else
+            {
+                try
+                {
+                    napi_resolve_deferred(env, context->deferred, context->function->format_result_func(env, context->result));
+                }
+                catch (...)
+                {
+                    napi_create_string_utf8(env, "error -> FormatResultValue(env, resultSend) an error has occurred", NAPI_AUTO_LENGTH, &error);
+                    napi_reject_deferred(env, context->deferred, error);
+                }
+            }
+        }
+
+        static void completeTask(napi_env env, bool is_ok, void *data)
+        {
+            PromiseContext *context = (PromiseContext *)data;
+            if (env != NULL)
+            {
+                settle(env, is_ok, context);
+            }
+            ContextPool::shared().release(context);
+        }
+
+        static void completeWork(napi_env env, napi_status status, void *data)
+        {
+            PromiseContext *context = (PromiseContext *)data;
+            settle(env, status == napi_ok, context);
+            napi_delete_async_work(env, context->work);
+            ContextPool::shared().release(context);
+        }
+
+        static napi_value startWork(napi_env env, napi_callback_info info)
+        {
+            napi_value result, work_name, promise;
+            PromiseFunction *self = NULL;
+
+            napi_get_null(env, &result);
+            napi_get_cb_info(env, info, NULL, NULL, NULL, (void **)&self);
+
+            if (self == NULL)
+            {
+                return result;
+            }
+
+            PromiseContext *context = ContextPool::shared().acquire();
+            context->function = self;
+
+            if (napi_create_promise(env, &context->deferred, &promise) != napi_ok)
+            {
+                ContextPool::shared().release(context);
+                napi_throw_error(env, "Creation_failed", "error < Promise Creation failed. >");
+                return result;
+            }
+
+            try
+            {
+                self->getArguments(env, info, context->arguments_list);
+            }
+            catch (...)
+            {
+                // 参数不完整 不调度工作函数 直接拒绝
+                napi_value error;
+                napi_create_string_utf8(env, "error < format arguments failed. >", NAPI_AUTO_LENGTH, &error);
+                napi_reject_deferred(env, context->deferred, error);
+                ContextPool::shared().release(context);
+                return promise;
+            }
+
+            if (hmc_executor::Executor::shared().submit(env, self->lane, executeTask, completeTask, context))
+            {
+                return promise;
+            }
+
+            napi_create_string_utf8(env, self->work_name.c_str(), self->work_name.length(), &work_name);
+
+            if (napi_create_async_work(env, NULL, work_name, executeWork, completeWork, context, &context->work) != napi_ok)
+            {
+                napi_value error;
+                napi_create_string_utf8(env, "error < Promise Creation work async failed. >", NAPI_AUTO_LENGTH, &error);
+                napi_reject_deferred(env, context->deferred, error);
+                ContextPool::shared().release(context);
+                return promise;
+            }
+
+            // 添加进node的异步队列
+            napi_queue_async_work(env, context->work);
+            return promise;
+        }
+
+        static napi_value startSync(napi_env env, napi_callback_info info)
+        {
+            napi_value result;
+            PromiseFunction *self = NULL;
+
+            napi_get_null(env, &result);
+            napi_get_cb_info(env, info, NULL, NULL, NULL, (void **)&self);
+
+            if (self == NULL)
+            {
+                return result;
+            }
+
+            try
+            {
+                std::vector<std::any> arguments_list;
+                self->getArguments(env, info, arguments_list);
+                return self->format_result_func(env, self->work_func(arguments_list));
+            }
+            catch (const std::exception &err)
+            {
+                napi_throw_error(env, "catch (const std::exception&)", err.what());
+            }
+            catch (...)
+            {
+                napi_throw_error(env, "catch (...)", "");
+            }
+
+            return result;
+        }
+    };
+}
+
+// 声明一个 Promise 异步函数 (参数由 hmc_NodeArgsValue 自动转换)
+// 需要实现:
+// any PromiseWorkFunc(vector<any> arguments_list)
+// napi_value format_to_js_value(napi_env env, any result_any_data)
+#define NEW_PROMISE_POOL_FUNCTION$SP                                                                                        \
+    any PromiseWorkFunc(vector<any> arguments_list);                                                                        \
+    napi_value format_to_js_value(napi_env env, any result_any_data);                                                       \
+    hmc_promise_pool::PromiseFunction promise_function(PromiseWorkFunc, format_to_js_value, NULL);                          \
+    void exports(napi_env env, napi_value exports, string name) { promise_function.exports(env, exports, name, false); }    \
+    void exportsSync(napi_env env, napi_value exports, string name) { promise_function.exports(env, exports, name, true); }
+
+// 声明一个 Promise 异步函数 (参数由 format_arguments_value 自定义转换)
+// 除 NEW_PROMISE_POOL_FUNCTION$SP 外还需要实现:
+// void format_arguments_value(napi_env env, napi_callback_info info, std::vector<any> &ArgumentsList, hmc_NodeArgsValue args_value)
+#define NEW_PROMISE_POOL_FUNCTION$SP$ARG                                                                                                    \
+    any PromiseWorkFunc(vector<any> arguments_list);                                                                                        \
+    napi_value format_to_js_value(napi_env env, any result_any_data);                                                                       \
+    void format_arguments_value(napi_env env, napi_callback_info info, std::vector<any> &ArgumentsList, hmc_NodeArgsValue args_value);      \
+    hmc_promise_pool::PromiseFunction promise_function(PromiseWorkFunc, format_to_js_value, format_arguments_value);                        \
+    void exports(napi_env env, napi_value exports, string name) { promise_function.exports(env, exports, name, false); }                    \
+    void exportsSync(napi_env env, napi_value exports, string name) { promise_function.exports(env, exports, name, true); }
+
+#endif // HMC_IMPORT_PROMISE_POOL_H
@@ -0,0 +1,388 @@
+#pragma once
+
+#ifndef HMC_IMPORT_RESULT_CHANNEL_H
+#define HMC_IMPORT_RESULT_CHANNEL_H
+
+// 流式查询的结果通道
+// 每个查询(枚举进程 枚举句柄等)拥有独立的缓冲区与结束标志 取代共用的全局 vector 与 "HMC::endl::" 结束行
+// 不依赖 windows.h / node_api.h  (推送到 js 的部分见 hmc_cursor.hpp)
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hmc_result_channel
+{
+    /**
+     * @brief 单个查询的结果缓冲区 (一个或多个生产线程 一个消费线程)
+     *
+     * @tparam T
+     */
+    template <typename T>
+    class Channel
+    {
+    public:
+        typedef std::function<void()> Listener;
+
+        Channel() : ended(false), readable_pending(false), total(0), high_water_mark(0) {}
+
+        Channel(const Channel &) = delete;
+        Channel &operator=(const Channel &) = delete;
+
+        /**
+         * @brief 设置监听 (需要在生产线程开始之前设置)
+         * 回调在持有通道锁的情况下调用 不能阻塞也不能再访问通道
+         *
+         * @param on_readable 缓冲区从空变为有数据 或者通道结束时调用 (在下一次 take 之前只调用一次)
+         * @param on_end 通道结束时调用一次 (在最后一次 on_readable 之后)
+         */
+        void listen(Listener on_readable, Listener on_end)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            readable_listener = on_readable;
+            end_listener = on_end;
+        }
+
+        /**
+         * @brief 设置高水位  未取出的数量达到此值时 push 会阻塞生产线程 直到被 take 或者通道结束
+         *
+         * @param size 0 为不限制
+         */
+        void setHighWaterMark(size_t size)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            high_water_mark = size;
+            writable_cv.notify_all();
+        }
+
+        // 写入一条结果 (生产线程)  结束后写入的数据会被丢弃
+        bool push(const T &value)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!waitWritable(lock))
+            {
+                return false;
+            }
+            markWaiting();
+            buffer.push_back(value);
+            total++;
+            emitReadable();
+            return true;
+        }
+
+        bool push(T &&value)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!waitWritable(lock))
+            {
+                return false;
+            }
+            markWaiting();
+            buffer.push_back(std::move(value));
+            total++;
+            emitReadable();
+            return true;
+        }
+
+        // 标记已经没有更多数据 (生产线程 或者放弃查询的消费线程)
+        void end()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (ended)
+            {
+                return;
+            }
+
+            ended = true;
+            ended_time = std::chrono::steady_clock::now();
+            emitReadable();
+
+            if (end_listener)
+            {
+                end_listener();
+            }
+            readable_listener = nullptr;
+            end_listener = nullptr;
+            writable_cv.notify_all();
+        }
+
+        /**
+         * @brief 取出当前所有(或最多 max_size 条)结果 (消费线程)
+         *
+         * @param output 追加到此处
+         * @param max_size 0 为不限制
+         * @return true 已结束并且所有数据都已取出 (此后不会再有数据)
+         */
+        bool take(std::vector<T> &output, size_t max_size = 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            readable_pending = false;
+            writable_cv.notify_all();
+
+            if (max_size == 0 || buffer.size() <= max_size)
+            {
+                if (output.empty())
+                {
+                    output.swap(buffer);
+                }
+                else
+                {
+                    output.reserve(output.size() + buffer.size());
+                    for (auto &item : buffer)
+                    {
+                        output.push_back(std::move(item));
+                    }
+                    buffer.clear();
+                }
+            }
+            else
+            {
+                output.reserve(output.size() + max_size);
+                for (size_t i = 0; i < max_size; i++)
+                {
+                    output.push_back(std::move(buffer[i]));
+                }
+                buffer.erase(buffer.begin(), buffer.begin() + max_size);
+                waiting_time = std::chrono::steady_clock::now();
+            }
+
+            return ended && buffer.empty();
+        }
+
+        // 未取出的数量
+        size_t size()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return buffer.size();
+        }
+
+        bool isEnded()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return ended;
+        }
+
+        // 结束并且已经全部取出
+        bool isDrained()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return ended && buffer.empty();
+        }
+
+        // 写入过的总数量
+        uint64_t pushed()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return total;
+        }
+
+        // 结束后经过的时间 未结束为 0
+        std::chrono::steady_clock::duration endedFor()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!ended)
+            {
+                return std::chrono::steady_clock::duration::zero();
+            }
+            return std::chrono::steady_clock::now() - ended_time;
+        }
+
+        // 有未取出的数据但消费线程一直没有取出的时间  (已结束或缓冲区为空时为 0)
+        std::chrono::steady_clock::duration stalledFor()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (ended || buffer.empty())
+            {
+                return std::chrono::steady_clock::duration::zero();
+            }
+            return std::chrono::steady_clock::now() - waiting_time;
+        }
+
+    private:
+        // 需持有 mutex  返回 false 表示通道已结束
+        bool waitWritable(std::unique_lock<std::mutex> &lock)
+        {
+            if (high_water_mark != 0)
+            {
+                writable_cv.wait(lock, [&]
+                                 { return ended || high_water_mark == 0 || buffer.size() < high_water_mark; });
+            }
+            return !ended;
+        }
+
+        // 需持有 mutex  缓冲区从空变为有数据时开始计时
+        void markWaiting()
+        {
+            if (buffer.empty())
+            {
+                waiting_time = std::chrono::steady_clock::now();
+            }
+        }
+
+        // 需持有 mutex
+        void emitReadable()
+        {
+            if (readable_listener && !readable_pending)
+            {
+                readable_pending = true;
+                readable_listener();
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable writable_cv;
+        std::vector<T> buffer;
+        bool ended;
+        bool readable_pending;
+        uint64_t total;
+        size_t high_water_mark;
+        Listener readable_listener;
+        Listener end_listener;
+        std::chrono::steady_clock::time_point ended_time;
+        std::chrono::steady_clock::time_point waiting_time;
+    };
+
+    /**
+     * @brief 按 id 管理查询通道
+     * - 取完并结束的通道会在 take 时自动回收
+     * - 结束后长时间没有被取走的通道会在下次 open 时回收 (js 端放弃了查询)
+     * - 有数据但长时间没有被取出的通道会在下次 open 时结束并回收 (js 端丢弃了游标 生产线程不再阻塞在高水位)
+     *
+     * @tparam T
+     */
+    template <typename T>
+    class Registry
+    {
+    public:
+        typedef std::shared_ptr<Channel<T>> ChannelPtr;
+
+        // 已结束但未被取走的通道保留时间
+        static constexpr std::chrono::seconds ABANDONED_TIMEOUT = std::chrono::seconds(60);
+        // 有数据但没有被取出的通道保留时间
+        static constexpr std::chrono::seconds STALLED_TIMEOUT = std::chrono::seconds(60);
+
+        Registry() : next_id(0) {}
+
+        /**
+         * @brief 创建一个新的查询通道
+         *
+         * @param channel 输出 交给生产线程持有
+         * @return int 查询id (从 1 开始)
+         */
+        int open(ChannelPtr &channel)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sweep();
+
+            channel = std::make_shared<Channel<T>>();
+            int id = ++next_id;
+            if (id <= 0)
+            {
+                next_id = 1;
+                id = 1;
+            }
+            channels[id] = channel;
+            return id;
+        }
+
+        /**
+         * @brief 取出查询的结果
+         *
+         * @param id
+         * @param output
+         * @param done 输出 已经结束并且全部取出 (通道已被回收)
+         * @return false 查询不存在 (已回收或从未创建)
+         */
+        bool take(int id, std::vector<T> &output, bool &done, size_t max_size = 0)
+        {
+            ChannelPtr channel;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = channels.find(id);
+                if (it == channels.end())
+                {
+                    done = true;
+                    return false;
+                }
+                channel = it->second;
+            }
+
+            done = channel->take(output, max_size);
+
+            if (done)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                channels.erase(id);
+            }
+            return true;
+        }
+
+        // 放弃查询 生产线程仍持有通道 但之后写入的数据会被丢弃
+        void close(int id)
+        {
+            ChannelPtr channel;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = channels.find(id);
+                if (it == channels.end())
+                {
+                    return;
+                }
+                channel = it->second;
+                channels.erase(it);
+            }
+            channel->end();
+        }
+
+        void clear()
+        {
+            std::map<int, ChannelPtr> removed;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                removed.swap(channels);
+            }
+            for (auto &it : removed)
+            {
+                it.second->end();
+            }
+        }
+
+        size_t size()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return channels.size();
+        }
+
+    private:
+        // 需持有 mutex
+        void sweep()
+        {
+            for (auto it = channels.begin(); it != channels.end();)
+            {
+                if (it->second->endedFor() > ABANDONED_TIMEOUT)
+                {
+                    it = channels.erase(it);
+                    continue;
+                }
+                if (it->second->stalledFor() > STALLED_TIMEOUT)
+                {
+                    it->second->end();
+                    it = channels.erase(it);
+                    continue;
+                }
+                ++it;
+            }
+        }
+
+        std::mutex mutex;
+        std::map<int, ChannelPtr> channels;
+        int next_id;
+    };
+}
+
+#endif // HMC_IMPORT_RESULT_CHANNEL_H
@@ -0,0 +1,565 @@
+#pragma once
+
+#ifndef HMC_IMPORT_SCREEN_CAPTURE_H
+#define HMC_IMPORT_SCREEN_CAPTURE_H
+
+// 截取屏幕区域为 32 位 BGRA 像素
+// 只复制请求的区域 (取色只需要 1x1)  坐标为虚拟屏幕坐标 (多显示器时可以为负数)
+// 多个坐标取色时只截取一次包含所有坐标的最小矩形 再从内存中读取
+// FramePool: 常驻的 DIB section 缓冲池  截图直接由 BitBlt 写入 之后原地读取 (不再 GetDIBits / 复制)
+
+#include <windows.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hmc_screen_capture
+{
+    // 不在屏幕范围内的坐标的取色结果 (有效颜色不会超过 0xFFFFFF)
+    constexpr uint32_t OUTSIDE = 0xFFFFFFFF;
+
+    struct Frame
+    {
+        // 区域左上角 (虚拟屏幕坐标)
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        // 自上而下逐行 每个像素为 B G R A 四个字节 (按小端读取为 0xAARRGGBB)
+        std::vector<uint32_t> pixels;
+
+        // 屏幕坐标处的颜色 0xRRGGBB  不在区域内返回 OUTSIDE
+        uint32_t rgbAt(int screen_x, int screen_y) const
+        {
+            int column = screen_x - x;
+            int row = screen_y - y;
+            if (column < 0 || row < 0 || column >= width || row >= height)
+            {
+                return OUTSIDE;
+            }
+            return pixels[(size_t)row * width + column] & 0x00FFFFFF;
+        }
+    };
+
+    // 虚拟屏幕 (所有显示器) 的范围
+    inline RECT virtualScreen()
+    {
+        RECT rect;
+        rect.left = ::GetSystemMetrics(SM_XVIRTUALSCREEN);
+        rect.top = ::GetSystemMetrics(SM_YVIRTUALSCREEN);
+        rect.right = rect.left + ::GetSystemMetrics(SM_CXVIRTUALSCREEN);
+        rect.bottom = rect.top + ::GetSystemMetrics(SM_CYVIRTUALSCREEN);
+        return rect;
+    }
+
+    /**
+     * @brief 区域与虚拟屏幕的交集
+     * @return false 没有交集
+     */
+    inline bool clipToScreen(int x, int y, int width, int height, RECT &output)
+    {
+        RECT screen = virtualScreen();
+        output.left = x > screen.left ? x : screen.left;
+        output.top = y > screen.top ? y : screen.top;
+        output.right = x + width < screen.right ? x + width : screen.right;
+        output.bottom = y + height < screen.bottom ? y + height : screen.bottom;
+        return width > 0 && height > 0 && output.right > output.left && output.bottom > output.top;
+    }
+
+    /**
+     * @brief 截取屏幕区域  超出虚拟屏幕的部分会被裁掉 (frame 中为实际截取的位置与大小)
+     *
+     * @param x
+     * @param y
+     * @param width
+     * @param height
+     * @param frame 输出
+     * @return false 区域与屏幕没有交集 或者 GDI 调用失败
+     */
+    inline bool capture(int x, int y, int width, int height, Frame &frame)
+    {
+        RECT rect;
+        bool is_inside = clipToScreen(x, y, width, height, rect);
+
+        frame.x = rect.left;
+        frame.y = rect.top;
+        frame.width = 0;
+        frame.height = 0;
+        frame.pixels.clear();
+
+        if (!is_inside)
+        {
+            return false;
+        }
+
+        int left = rect.left;
+        int top = rect.top;
+        int capture_width = rect.right - rect.left;
+        int capture_height = rect.bottom - rect.top;
+
+        // 整个虚拟屏幕的 DC (坐标与 GetSystemMetrics(SM_XVIRTUALSCREEN) 一致)
+        HDC screen_dc = ::GetDC(NULL);
+        if (screen_dc == NULL)
+        {
+            return false;
+        }
+
+        bool result = false;
+        HDC memory_dc = ::CreateCompatibleDC(screen_dc);
+
+        BITMAPINFO bitmap_info;
+        ZeroMemory(&bitmap_info, sizeof(bitmap_info));
+        bitmap_info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bitmap_info.bmiHeader.biWidth = capture_width;
+        // 负数为自上而下
+        bitmap_info.bmiHeader.biHeight = -capture_height;
+        bitmap_info.bmiHeader.biPlanes = 1;
+        bitmap_info.bmiHeader.biBitCount = 32;
+        bitmap_info.bmiHeader.biCompression = BI_RGB;
+
+        void *bits = NULL;
+        HBITMAP bitmap = memory_dc != NULL ? ::CreateDIBSection(screen_dc, &bitmap_info, DIB_RGB_COLORS, &bits, NULL, 0) : NULL;
+
+        if (bitmap != NULL && bits != NULL)
+        {
+            HGDIOBJ old_bitmap = ::SelectObject(memory_dc, bitmap);
+            if (::BitBlt(memory_dc, 0, 0, capture_width, capture_height, screen_dc, left, top, SRCCOPY))
+            {
+                ::GdiFlush();
+                frame.width = capture_width;
+                frame.height = capture_height;
+                frame.pixels.resize((size_t)capture_width * capture_height);
+                memcpy(frame.pixels.data(), bits, frame.pixels.size() * sizeof(uint32_t));
+                result = true;
+            }
+            ::SelectObject(memory_dc, old_bitmap);
+        }
+
+        if (bitmap != NULL)
+        {
+            ::DeleteObject(bitmap);
+        }
+        if (memory_dc != NULL)
+        {
+            ::DeleteDC(memory_dc);
+        }
+        ::ReleaseDC(NULL, screen_dc);
+        return result;
+    }
+
+    /**
+     * @brief 单个坐标的颜色 (只复制 1x1)
+     *
+     * @return 0xRRGGBB  不在屏幕范围内返回 OUTSIDE
+     */
+    inline uint32_t pixel(int x, int y)
+    {
+        Frame frame;
+        if (!capture(x, y, 1, 1, frame))
+        {
+            return OUTSIDE;
+        }
+        return frame.rgbAt(x, y);
+    }
+
+    /**
+     * @brief 多个坐标的颜色  只截取一次包含所有坐标的矩形
+     *
+     * @param points
+     * @param output 输出 (会被清空) 与 points 一一对应 0xRRGGBB  不在屏幕范围内为 OUTSIDE
+     */
+    inline void pixels(const std::vector<POINT> &points, std::vector<uint32_t> &output)
+    {
+        output.assign(points.size(), OUTSIDE);
+        if (points.empty())
+        {
+            return;
+        }
+
+        // 只计算屏幕范围内的坐标 避免一个无效坐标扩大截取范围
+        RECT screen = virtualScreen();
+        bool has_inside = false;
+        LONG left = 0, top = 0, right = 0, bottom = 0;
+        for (auto &point : points)
+        {
+            if (point.x < screen.left || point.y < screen.top || point.x >= screen.right || point.y >= screen.bottom)
+            {
+                continue;
+            }
+            if (!has_inside)
+            {
+                left = right = point.x;
+                top = bottom = point.y;
+                has_inside = true;
+                continue;
+            }
+            left = point.x < left ? point.x : left;
+            top = point.y < top ? point.y : top;
+            right = point.x > right ? point.x : right;
+            bottom = point.y > bottom ? point.y : bottom;
+        }
+
+        if (!has_inside)
+        {
+            return;
+        }
+
+        Frame frame;
+        if (!capture(left, top, right - left + 1, bottom - top + 1, frame))
+        {
+            return;
+        }
+
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            output[i] = frame.rgbAt(points[i].x, points[i].y);
+        }
+    }
+
+    // 一次截图占用的缓冲区  id 为 0 表示失败
+    struct Lease
+    {
+        uint64_t id = 0;
+        // 区域左上角 (虚拟屏幕坐标)
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        // 自上而下逐行 每行 width 个像素 (BGRA)  在释放前有效
+        uint32_t *pixels = NULL;
+
+        size_t byteLength() const
+        {
+            return (size_t)width * height * sizeof(uint32_t);
+        }
+    };
+
+    /**
+     * @brief 常驻的截图缓冲区
+     * 每个缓冲区是一个 32 位自上而下的 DIB section  截图时由 BitBlt 直接写入  使用方原地读取后归还
+     * 空闲的同尺寸缓冲区直接复用  全部被占用时临时创建 (归还时删除)
+     * 交给 JS 持有的 (external) 最多 MAX_EXTERNAL 个  JS 不归还时不会无限创建 DIB section
+     */
+    class FramePool
+    {
+    public:
+        // 常驻的缓冲区数量
+        static constexpr size_t POOL_SIZE = 3;
+        // 同时被 JS 持有的缓冲区上限  超出后 acquire(..., true) 失败 (调用方改为复制)
+        static constexpr size_t MAX_EXTERNAL = 8;
+
+        static FramePool &shared()
+        {
+            static FramePool pool;
+            return pool;
+        }
+
+        /**
+         * @brief 截取屏幕区域到空闲的缓冲区  超出虚拟屏幕的部分会被裁掉
+         * 成功后必须调用 release 归还
+         *
+         * @param is_external 缓冲区交给 JS 持有 (归还时间不确定)  已有 MAX_EXTERNAL 个时失败
+         */
+        Lease acquire(int x, int y, int width, int height, bool is_external = false)
+        {
+            Lease lease;
+            RECT rect;
+            if (!clipToScreen(x, y, width, height, rect))
+            {
+                return lease;
+            }
+
+            int capture_width = rect.right - rect.left;
+            int capture_height = rect.bottom - rect.top;
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (is_external && externalCount() >= MAX_EXTERNAL)
+            {
+                return lease;
+            }
+
+            Slot *slot = takeSlot(capture_width, capture_height);
+            if (slot == NULL)
+            {
+                return lease;
+            }
+            slot->is_external = is_external;
+
+            HDC screen_dc = ::GetDC(NULL);
+            if (memory_dc == NULL)
+            {
+                memory_dc = ::CreateCompatibleDC(screen_dc);
+            }
+
+            bool is_ok = false;
+            if (screen_dc != NULL && memory_dc != NULL)
+            {
+                HGDIOBJ old_bitmap = ::SelectObject(memory_dc, slot->bitmap);
+                is_ok = ::BitBlt(memory_dc, 0, 0, capture_width, capture_height, screen_dc, rect.left, rect.top, SRCCOPY) != FALSE;
+                ::SelectObject(memory_dc, old_bitmap);
+                ::GdiFlush();
+            }
+            if (screen_dc != NULL)
+            {
+                ::ReleaseDC(NULL, screen_dc);
+            }
+
+            if (!is_ok)
+            {
+                releaseSlot(slot);
+                return lease;
+            }
+
+            lease.id = slot->lease;
+            lease.x = rect.left;
+            lease.y = rect.top;
+            lease.width = capture_width;
+            lease.height = capture_height;
+            lease.pixels = slot->bits;
+            return lease;
+        }
+
+        /**
+         * @brief 归还缓冲区  已经归还过的 (id 不再对应) 忽略
+         */
+        bool release(uint64_t id)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &slot : slots)
+            {
+                if (slot->in_use && slot->lease == id)
+                {
+                    releaseSlot(slot.get());
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // 像素地址是否为被占用的缓冲区
+        bool isLeased(const void *pixels)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &slot : slots)
+            {
+                if (slot->in_use && slot->bits == pixels)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief 按像素地址归还 (JS 主动释放 ArrayBuffer 时)
+         */
+        bool releasePixels(const void *pixels)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &slot : slots)
+            {
+                if (slot->in_use && slot->bits == pixels)
+                {
+                    releaseSlot(slot.get());
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // 删除空闲的缓冲区
+        void trim()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = slots.size(); i > 0; i--)
+            {
+                if (!slots[i - 1]->in_use)
+                {
+                    slots.erase(slots.begin() + (i - 1));
+                }
+            }
+        }
+
+        // 缓冲区数量 / 被占用的数量
+        void stats(size_t &total, size_t &in_use)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            total = slots.size();
+            in_use = 0;
+            for (auto &slot : slots)
+            {
+                in_use += slot->in_use ? 1 : 0;
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            HBITMAP bitmap = NULL;
+            uint32_t *bits = NULL;
+            int width = 0;
+            int height = 0;
+            bool in_use = false;
+            // 超出 POOL_SIZE 临时创建的  归还时删除
+            bool is_temporary = false;
+            // 由 JS 持有
+            bool is_external = false;
+            uint64_t lease = 0;
+
+            ~Slot()
+            {
+                if (bitmap != NULL)
+                {
+                    ::DeleteObject(bitmap);
+                }
+            }
+        };
+
+        FramePool() : memory_dc(NULL), next_lease(1) {}
+
+        static bool createBitmap(Slot &slot, int width, int height)
+        {
+            if (slot.bitmap != NULL)
+            {
+                ::DeleteObject(slot.bitmap);
+                slot.bitmap = NULL;
+                slot.bits = NULL;
+            }
+
+            BITMAPINFO bitmap_info;
+            ZeroMemory(&bitmap_info, sizeof(bitmap_info));
+            bitmap_info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+            bitmap_info.bmiHeader.biWidth = width;
+            bitmap_info.bmiHeader.biHeight = -height;
+            bitmap_info.bmiHeader.biPlanes = 1;
+            bitmap_info.bmiHeader.biBitCount = 32;
+            bitmap_info.bmiHeader.biCompression = BI_RGB;
+
+            void *bits = NULL;
+            slot.bitmap = ::CreateDIBSection(NULL, &bitmap_info, DIB_RGB_COLORS, &bits, NULL, 0);
+            if (slot.bitmap == NULL || bits == NULL)
+            {
+                if (slot.bitmap != NULL)
+                {
+                    ::DeleteObject(slot.bitmap);
+                    slot.bitmap = NULL;
+                }
+                return false;
+            }
+            slot.bits = (uint32_t *)bits;
+            slot.width = width;
+            slot.height = height;
+            return true;
+        }
+
+        // 选择顺序: 空闲的同尺寸 -> 新建 (未满) -> 空闲的其他尺寸 (重建) -> 临时
+        Slot *takeSlot(int width, int height)
+        {
+            Slot *slot = NULL;
+            Slot *idle = NULL;
+            for (auto &item : slots)
+            {
+                if (item->in_use)
+                {
+                    continue;
+                }
+                if (item->width == width && item->height == height)
+                {
+                    slot = item.get();
+                    break;
+                }
+                if (idle == NULL)
+                {
+                    idle = item.get();
+                }
+            }
+
+            if (slot == NULL)
+            {
+                if (slots.size() < POOL_SIZE || idle == NULL)
+                {
+                    std::unique_ptr<Slot> created(new Slot());
+                    created->is_temporary = slots.size() >= POOL_SIZE;
+                    if (!createBitmap(*created, width, height))
+                    {
+                        return NULL;
+                    }
+                    slot = created.get();
+                    slots.push_back(std::move(created));
+                }
+                else
+                {
+                    if (!createBitmap(*idle, width, height))
+                    {
+                        return NULL;
+                    }
+                    slot = idle;
+                }
+            }
+
+            slot->in_use = true;
+            slot->lease = next_lease++;
+            return slot;
+        }
+
+        // 需持有 mutex
+        size_t externalCount()
+        {
+            size_t count = 0;
+            for (auto &slot : slots)
+            {
+                count += slot->in_use && slot->is_external ? 1 : 0;
+            }
+            return count;
+        }
+
+        void releaseSlot(Slot *slot)
+        {
+            slot->in_use = false;
+            slot->is_external = false;
+            slot->lease = 0;
+            if (!slot->is_temporary)
+            {
+                return;
+            }
+            for (size_t i = 0; i < slots.size(); i++)
+            {
+                if (slots[i].get() == slot)
+                {
+                    slots.erase(slots.begin() + i);
+                    break;
+                }
+            }
+        }
+
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Slot>> slots;
+        HDC memory_dc;
+        uint64_t next_lease;
+    };
+
+    /**
+     * @brief 在作用域结束时归还
+     */
+    class ScopedLease
+    {
+    public:
+        explicit ScopedLease(const Lease &lease) : lease(lease) {}
+        ~ScopedLease()
+        {
+            if (lease.id != 0)
+            {
+                FramePool::shared().release(lease.id);
+            }
+        }
+        ScopedLease(const ScopedLease &) = delete;
+        ScopedLease &operator=(const ScopedLease &) = delete;
+
+        const Lease lease;
+    };
+}
+
+#endif // HMC_IMPORT_SCREEN_CAPTURE_H
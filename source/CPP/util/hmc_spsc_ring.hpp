@@ -0,0 +1,168 @@
+#pragma once
+
+#ifndef HMC_IMPORT_SPSC_RING_H
+#define HMC_IMPORT_SPSC_RING_H
+
+// 单生产者/单消费者 无锁环形缓冲区
+// 不依赖 windows.h / node_api.h  可以脱离插件单独编译与基准测试
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hmc_spsc_ring
+{
+    // 避免生产者与消费者的游标落在同一缓存行上 (伪共享)
+    constexpr size_t CACHE_LINE_SIZE = 64;
+
+    /**
+     * @brief 固定容量的单生产者单消费者环形缓冲区
+     * - push 只允许在一个线程调用(例如键盘钩子线程) O(1) 且不会分配内存
+     * - drain / clear 只允许在另一个线程调用(例如 js 主线程)
+     * - 缓冲区满时新的数据会被丢弃并计入溢出计数 不会阻塞生产者
+     *
+     * @tparam T 元素类型 (按值写入 需要可平凡复制)
+     * @tparam Capacity 容量 必须是2的幂
+     */
+    template <typename T, size_t Capacity>
+    class SpscRing
+    {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        SpscRing() : head(0), tail(0), overflow_count(0), push_count(0) {}
+
+        SpscRing(const SpscRing &) = delete;
+        SpscRing &operator=(const SpscRing &) = delete;
+
+        /**
+         * @brief 写入一个元素 (生产者线程)
+         *
+         * @param value
+         * @return true 写入成功
+         * @return false 缓冲区已满 数据被丢弃
+         */
+        bool push(const T &value)
+        {
+            const size_t the_head = head.load(std::memory_order_relaxed);
+            const size_t the_tail = tail.load(std::memory_order_acquire);
+
+            if (the_head - the_tail >= Capacity)
+            {
+                overflow_count.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            buffer[the_head & (Capacity - 1)] = value;
+            head.store(the_head + 1, std::memory_order_release);
+            push_count.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief 取出一个元素 (消费者线程)
+         *
+         * @param value
+         * @return true
+         * @return false 缓冲区为空
+         */
+        bool pop(T &value)
+        {
+            const size_t the_tail = tail.load(std::memory_order_relaxed);
+            const size_t the_head = head.load(std::memory_order_acquire);
+
+            if (the_tail == the_head)
+            {
+                return false;
+            }
+
+            value = buffer[the_tail & (Capacity - 1)];
+            tail.store(the_tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief 一次性取出当前所有(或最多 max_size 个)元素追加到 output (消费者线程)
+         *
+         * @param output
+         * @param max_size 0 为不限制
+         * @return size_t 取出的数量
+         */
+        size_t drain(std::vector<T> &output, size_t max_size = 0)
+        {
+            const size_t the_tail = tail.load(std::memory_order_relaxed);
+            const size_t the_head = head.load(std::memory_order_acquire);
+
+            size_t count = the_head - the_tail;
+            if (max_size != 0 && count > max_size)
+            {
+                count = max_size;
+            }
+
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            output.reserve(output.size() + count);
+            for (size_t i = 0; i < count; i++)
+            {
+                output.push_back(buffer[(the_tail + i) & (Capacity - 1)]);
+            }
+
+            tail.store(the_tail + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * @brief 丢弃当前所有未读取的元素 (消费者线程)
+         */
+        void clear()
+        {
+            tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+        }
+
+        // 当前未读取的数量 (近似值)
+        size_t size() const
+        {
+            return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        constexpr size_t capacity() const
+        {
+            return Capacity;
+        }
+
+        // 因缓冲区已满而被丢弃的数量
+        uint64_t overflow() const
+        {
+            return overflow_count.load(std::memory_order_relaxed);
+        }
+
+        // 成功写入的总数量
+        uint64_t pushed() const
+        {
+            return push_count.load(std::memory_order_relaxed);
+        }
+
+        void reset_counter()
+        {
+            overflow_count.store(0, std::memory_order_relaxed);
+            push_count.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> head;
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> overflow_count;
+        std::atomic<uint64_t> push_count;
+        alignas(CACHE_LINE_SIZE) T buffer[Capacity];
+    };
+}
+
+#endif // HMC_IMPORT_SPSC_RING_H
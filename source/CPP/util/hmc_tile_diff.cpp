@@ -0,0 +1,261 @@
+#include "./hmc_tile_diff.hpp"
+
+#include "./hmc_cpu_features.hpp"
+
+#include <cstring>
+
+namespace hmc_tile_diff
+{
+    namespace
+    {
+        // 两行像素是否完全一致
+        typedef bool (*RowEqual)(const uint32_t *left, const uint32_t *right, int count);
+
+        bool rowEqualScalar(const uint32_t *left, const uint32_t *right, int count)
+        {
+            return memcmp(left, right, (size_t)count * sizeof(uint32_t)) == 0;
+        }
+
+#ifdef HMC_CPU_X86
+
+        // 整行的异或结果按位或在一起  最后只判断一次 (块宽度只有 64 个像素 分支比比较更贵)
+        HMC_TARGET_SSE2 bool rowEqualSse2(const uint32_t *left, const uint32_t *right, int count)
+        {
+            __m128i difference = _mm_setzero_si128();
+            int x = 0;
+            for (; x + 4 <= count; x += 4)
+            {
+                __m128i a = _mm_loadu_si128((const __m128i *)(left + x));
+                __m128i b = _mm_loadu_si128((const __m128i *)(right + x));
+                difference = _mm_or_si128(difference, _mm_xor_si128(a, b));
+            }
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(difference, _mm_setzero_si128())) != 0xFFFF)
+            {
+                return false;
+            }
+            for (; x < count; x++)
+            {
+                if (left[x] != right[x])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        HMC_TARGET_AVX2 bool rowEqualAvx2(const uint32_t *left, const uint32_t *right, int count)
+        {
+            __m256i difference = _mm256_setzero_si256();
+            int x = 0;
+            for (; x + 8 <= count; x += 8)
+            {
+                __m256i a = _mm256_loadu_si256((const __m256i *)(left + x));
+                __m256i b = _mm256_loadu_si256((const __m256i *)(right + x));
+                difference = _mm256_or_si256(difference, _mm256_xor_si256(a, b));
+            }
+            if (!_mm256_testz_si256(difference, difference))
+            {
+                return false;
+            }
+            for (; x < count; x++)
+            {
+                if (left[x] != right[x])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+#endif // HMC_CPU_X86
+
+        RowEqual rowEqualOf(Kernel kernel)
+        {
+            if (kernel == KERNEL_AUTO || !isSupported(kernel))
+            {
+                kernel = bestKernel();
+            }
+#ifdef HMC_CPU_X86
+            if (kernel == KERNEL_AVX2)
+                return rowEqualAvx2;
+            if (kernel == KERNEL_SSE2)
+                return rowEqualSse2;
+#endif
+            return rowEqualScalar;
+        }
+    }
+
+    bool isSupported(Kernel kernel)
+    {
+        switch (kernel)
+        {
+        case KERNEL_AUTO:
+        case KERNEL_SCALAR:
+            return true;
+        case KERNEL_SSE2:
+            return hmc_cpu_features::get().sse2;
+        case KERNEL_AVX2:
+            return hmc_cpu_features::get().avx2;
+        default:
+            return false;
+        }
+    }
+
+    Kernel bestKernel()
+    {
+        if (hmc_cpu_features::get().avx2)
+            return KERNEL_AVX2;
+        if (hmc_cpu_features::get().sse2)
+            return KERNEL_SSE2;
+        return KERNEL_SCALAR;
+    }
+
+    const char *kernelName(Kernel kernel)
+    {
+        switch (kernel)
+        {
+        case KERNEL_SCALAR:
+            return "scalar";
+        case KERNEL_SSE2:
+            return "sse2";
+        case KERNEL_AVX2:
+            return "avx2";
+        default:
+            return kernelName(bestKernel());
+        }
+    }
+
+    TileDiff::TileDiff(int tile_size, Kernel kernel) : tile_size(tile_size < 8 ? 8 : tile_size), kernel(kernel) {}
+
+    void TileDiff::reset()
+    {
+        frame_width = 0;
+        frame_height = 0;
+        columns = 0;
+        rows = 0;
+        dirty_count = 0;
+        previous.clear();
+        dirty.clear();
+    }
+
+    size_t TileDiff::update(const uint32_t *pixels, int width, int height, size_t stride)
+    {
+        if (pixels == NULL || width <= 0 || height <= 0)
+        {
+            return 0;
+        }
+
+        // 第一帧 / 尺寸变化  整帧保存 全部为脏块
+        if (width != frame_width || height != frame_height || previous.empty())
+        {
+            frame_width = width;
+            frame_height = height;
+            columns = (width + tile_size - 1) / tile_size;
+            rows = (height + tile_size - 1) / tile_size;
+            previous.resize((size_t)width * height);
+            for (int y = 0; y < height; y++)
+            {
+                memcpy(previous.data() + (size_t)y * width, pixels + (size_t)y * stride, (size_t)width * sizeof(uint32_t));
+            }
+            dirty.assign((size_t)columns * rows, 1);
+            dirty_count = dirty.size();
+            return dirty_count;
+        }
+
+        RowEqual row_equal = rowEqualOf(kernel);
+
+        size_t changed = 0;
+        for (int tile_y = 0; tile_y < rows; tile_y++)
+        {
+            int top = tile_y * tile_size;
+            int bottom = top + tile_size < height ? top + tile_size : height;
+
+            for (int tile_x = 0; tile_x < columns; tile_x++)
+            {
+                int left = tile_x * tile_size;
+                int tile_width = left + tile_size < width ? tile_size : width - left;
+
+                // 找到第一个不同的行  之后的行直接复制
+                int y = top;
+                for (; y < bottom; y++)
+                {
+                    if (!row_equal(pixels + (size_t)y * stride + left, previous.data() + (size_t)y * width + left, tile_width))
+                    {
+                        break;
+                    }
+                }
+                if (y == bottom)
+                {
+                    continue;
+                }
+
+                for (; y < bottom; y++)
+                {
+                    memcpy(previous.data() + (size_t)y * width + left, pixels + (size_t)y * stride + left, (size_t)tile_width * sizeof(uint32_t));
+                }
+
+                changed++;
+                uint8_t &flag = dirty[(size_t)tile_y * columns + tile_x];
+                if (flag == 0)
+                {
+                    flag = 1;
+                    dirty_count++;
+                }
+            }
+        }
+        return changed;
+    }
+
+    size_t TileDiff::take(std::vector<int32_t> &rects, std::vector<uint32_t> &pixels)
+    {
+        rects.clear();
+        pixels.clear();
+        if (dirty_count == 0)
+        {
+            return 0;
+        }
+
+        for (int tile_y = 0; tile_y < rows; tile_y++)
+        {
+            int top = tile_y * tile_size;
+            int rect_height = top + tile_size < frame_height ? tile_size : frame_height - top;
+
+            int tile_x = 0;
+            while (tile_x < columns)
+            {
+                if (dirty[(size_t)tile_y * columns + tile_x] == 0)
+                {
+                    tile_x++;
+                    continue;
+                }
+
+                // 同一行相邻的脏块合并
+                int first = tile_x;
+                while (tile_x < columns && dirty[(size_t)tile_y * columns + tile_x] != 0)
+                {
+                    dirty[(size_t)tile_y * columns + tile_x] = 0;
+                    tile_x++;
+                }
+
+                int left = first * tile_size;
+                int right = tile_x * tile_size < frame_width ? tile_x * tile_size : frame_width;
+                int rect_width = right - left;
+
+                rects.push_back(left);
+                rects.push_back(top);
+                rects.push_back(rect_width);
+                rects.push_back(rect_height);
+
+                size_t offset = pixels.size();
+                pixels.resize(offset + (size_t)rect_width * rect_height);
+                for (int y = 0; y < rect_height; y++)
+                {
+                    memcpy(pixels.data() + offset + (size_t)y * rect_width, previous.data() + (size_t)(top + y) * frame_width + left, (size_t)rect_width * sizeof(uint32_t));
+                }
+            }
+        }
+
+        dirty_count = 0;
+        return rects.size() / 4;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef HMC_IMPORT_TILE_DIFF_H
+#define HMC_IMPORT_TILE_DIFF_H
+
+// 连续截图的变化区域检测
+// 每一帧按 64x64 的块与上一帧比较 (SIMD 逐行异或 有差异立即停止)  变化的块记为脏块 直到被取出
+// 取出时同一行相邻的脏块合并为一个矩形  像素按矩形逐个 逐行紧密排列
+// 只处理内存中的像素 不依赖 windows.h 与 node  (实现位于 hmc_tile_diff.cpp 可以单独编译测试)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hmc_tile_diff
+{
+    // 默认块大小
+    constexpr int TILE_SIZE = 64;
+
+    enum Kernel
+    {
+        KERNEL_AUTO,
+        KERNEL_SCALAR,
+        KERNEL_SSE2,
+        KERNEL_AVX2,
+    };
+
+    // 当前 CPU 可用的最快内核
+    Kernel bestKernel();
+
+    // CPU 是否支持该内核
+    bool isSupported(Kernel kernel);
+
+    const char *kernelName(Kernel kernel);
+
+    class TileDiff
+    {
+    public:
+        /**
+         * @param tile_size 块大小 (最小 8)
+         * @param kernel 逐行比较的内核 (CPU 不支持时使用 KERNEL_AUTO 选择的内核)
+         */
+        explicit TileDiff(int tile_size = TILE_SIZE, Kernel kernel = KERNEL_AUTO);
+
+        /**
+         * @brief 与上一帧比较  变化的块标记为脏块 并更新保存的帧
+         * 第一帧或者尺寸变化时所有块都是脏块
+         *
+         * @param pixels BGRA 自上而下
+         * @param width
+         * @param height
+         * @param stride 每行的像素数量 (>= width)
+         * @return 本帧变化的块数量
+         */
+        size_t update(const uint32_t *pixels, int width, int height, size_t stride);
+
+        /**
+         * @brief 取出所有脏块 (之后清空)
+         *
+         * @param rects 输出 (会被清空) 每 4 个为一个矩形 [x, y, width, height]  相对于帧的左上角
+         * @param pixels 输出 (会被清空) 矩形的像素依次排列  每个矩形自上而下 每行 width 个像素
+         * @return 矩形数量
+         */
+        size_t take(std::vector<int32_t> &rects, std::vector<uint32_t> &pixels);
+
+        // 是否有未取出的脏块
+        bool hasDirty() const { return dirty_count != 0; }
+
+        // 下一帧作为第一帧处理 (全部为脏块)
+        void reset();
+
+        int width() const { return frame_width; }
+        int height() const { return frame_height; }
+        int tileSize() const { return tile_size; }
+
+    private:
+        int tile_size;
+        Kernel kernel;
+        int frame_width = 0;
+        int frame_height = 0;
+        int columns = 0;
+        int rows = 0;
+        size_t dirty_count = 0;
+        std::vector<uint32_t> previous;
+        std::vector<uint8_t> dirty;
+    };
+}
+
+#endif // HMC_IMPORT_TILE_DIFF_H
@@ -0,0 +1,627 @@
+#pragma once
+
+#ifndef HMC_IMPORT_WINDOW_INDEX_H
+#define HMC_IMPORT_WINDOW_INDEX_H
+
+// 常驻内存的顶层窗口索引 (按需启动)
+// 启动时用 EnumWindows 获取一次  之后由独立线程上的 WinEvent 钩子 (创建 销毁 显示 隐藏 标题 位置 前台) 保持更新
+// 按 pid / 类名 / 标题 建立哈希索引  查询不再遍历桌面
+// 变化事件写入环形缓冲区 可由 js 订阅
+
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "./hmc_spsc_ring.hpp"
+#include "./hmc_window_query.hpp"
+
+namespace hmc_window_index
+{
+    enum EventType : uint32_t
+    {
+        EVENT_CREATE = 1,
+        EVENT_DESTROY = 2,
+        EVENT_NAME = 3,
+        EVENT_LOCATION = 4,
+        EVENT_FOREGROUND = 5,
+        EVENT_SHOW = 6,
+        EVENT_HIDE = 7,
+    };
+
+    // 钩子线程 -> js 线程  (按值写入)
+    struct Event
+    {
+        uint32_t type;
+        ULONG_PTR hwnd;
+    };
+
+    struct WindowRecord
+    {
+        HWND hwnd = NULL;
+        DWORD pid = 0;
+        DWORD thread_id = 0;
+        HWND owner = NULL;
+        bool visible = false;
+        RECT rect = {0, 0, 0, 0};
+        std::wstring class_name;
+        std::wstring title;
+        // 近似 Z 序 越小越靠上  启动时按 EnumWindows 的 Z 序  之后新建与成为前台的窗口移到最上
+        int64_t order = 0;
+    };
+
+    // 有事件写入时在钩子线程调用 (不能阻塞)
+    typedef void (*NotifyFunc)(void *context);
+
+    class Registry
+    {
+    public:
+        static Registry &shared()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        // 变化事件  消费者只能是一个线程 (js 线程)  只在设置了通知时写入 (没有订阅时不会堆积)
+        hmc_spsc_ring::SpscRing<Event, 4096> events;
+
+        /**
+         * @brief 启动索引线程 并等待首次获取完成
+         *
+         * @return false 钩子安装失败
+         */
+        bool start()
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            if (is_running)
+            {
+                return true;
+            }
+
+            if (worker.joinable())
+            {
+                worker.join();
+            }
+
+            is_started = false;
+            is_start_failed = false;
+            events.clear();
+            worker = std::thread(&Registry::threadMain, this);
+            state_cv.wait(lock, [this]
+                          { return is_started || is_start_failed; });
+
+            if (!is_running)
+            {
+                // 启动失败的线程已经在退出  等它结束 不留下 joinable 的线程
+                lock.unlock();
+                worker.join();
+                return false;
+            }
+            return true;
+        }
+
+        // 停止并清空索引
+        void stop()
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            if (!worker.joinable())
+            {
+                return;
+            }
+
+            if (thread_id != 0)
+            {
+                ::PostThreadMessageW(thread_id, WM_QUIT, 0, 0);
+            }
+            lock.unlock();
+            worker.join();
+        }
+
+        bool running()
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            return is_running;
+        }
+
+        /**
+         * @brief 设置事件通知 (js 线程设置 在钩子线程调用)  同一批事件在 resetNotify 之前只通知一次
+         * func 为 NULL 时取消订阅 并丢弃未取出的事件
+         */
+        void setNotify(NotifyFunc func, void *context)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            notify_func = func;
+            notify_context = context;
+            notify_pending = false;
+            if (func == NULL)
+            {
+                events.clear();
+            }
+        }
+
+        // js 线程取出事件后调用  之后的事件会再次通知
+        void resetNotify()
+        {
+            notify_pending = false;
+        }
+
+        // 所有窗口 (按近似 Z 序)
+        void all(std::vector<HWND> &output, bool visible_only)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            output.clear();
+            std::vector<const WindowRecord *> list;
+            list.reserve(records.size());
+            for (auto &item : records)
+            {
+                if (!visible_only || item.second.visible)
+                {
+                    list.push_back(&item.second);
+                }
+            }
+            sortByOrder(list, output);
+        }
+
+        // 进程的所有窗口
+        void findByPid(DWORD pid, std::vector<HWND> &output)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            output.clear();
+            std::vector<const WindowRecord *> list;
+            auto it = by_pid.find(pid);
+            if (it != by_pid.end())
+            {
+                for (HWND hwnd : it->second)
+                {
+                    list.push_back(&records[hwnd]);
+                }
+            }
+            sortByOrder(list, output);
+        }
+
+        /**
+         * @brief 按类名与标题查找 (完全一致 不区分大小写)
+         *
+         * @param class_name 为空时不限制
+         * @param title 为空时不限制
+         * @param limit 0 为不限
+         */
+        void find(const std::wstring &class_name, const std::wstring &title, std::vector<HWND> &output, size_t limit = 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            output.clear();
+
+            const std::unordered_set<HWND> *class_set = NULL;
+            const std::unordered_set<HWND> *title_set = NULL;
+
+            if (!class_name.empty())
+            {
+                auto it = by_class.find(foldCase(class_name));
+                if (it == by_class.end())
+                    return;
+                class_set = &it->second;
+            }
+
+            if (!title.empty())
+            {
+                auto it = by_title.find(foldCase(title));
+                if (it == by_title.end())
+                    return;
+                title_set = &it->second;
+            }
+
+            std::vector<const WindowRecord *> list;
+            if (class_set == NULL && title_set == NULL)
+            {
+                for (auto &item : records)
+                    list.push_back(&item.second);
+            }
+            else
+            {
+                // 遍历较小的集合 与另一个求交集
+                const std::unordered_set<HWND> *smaller = class_set;
+                const std::unordered_set<HWND> *other = title_set;
+                if (smaller == NULL || (other != NULL && other->size() < smaller->size()))
+                {
+                    std::swap(smaller, other);
+                }
+                for (HWND hwnd : *smaller)
+                {
+                    if (other == NULL || other->count(hwnd))
+                    {
+                        list.push_back(&records[hwnd]);
+                    }
+                }
+            }
+
+            sortByOrder(list, output);
+            if (limit != 0 && output.size() > limit)
+            {
+                output.resize(limit);
+            }
+        }
+
+        /**
+         * @brief 进程的主窗口  可见 没有所有者  优先前台窗口 其次有标题且面积最大的
+         */
+        HWND mainWindow(DWORD pid)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = by_pid.find(pid);
+            if (it == by_pid.end())
+            {
+                return NULL;
+            }
+
+            HWND result = NULL;
+            long long best_score = -1;
+            for (HWND hwnd : it->second)
+            {
+                const WindowRecord &record = records[hwnd];
+                if (!record.visible || record.owner != NULL)
+                {
+                    continue;
+                }
+                if (hwnd == foreground_hwnd)
+                {
+                    return hwnd;
+                }
+
+                long long area = (long long)(record.rect.right - record.rect.left) * (long long)(record.rect.bottom - record.rect.top);
+                long long score = (record.title.empty() ? 0 : (1LL << 48)) + (area > 0 ? area : 0);
+                if (score > best_score)
+                {
+                    best_score = score;
+                    result = hwnd;
+                }
+            }
+            return result;
+        }
+
+        bool get(HWND hwnd, WindowRecord &output)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = records.find(hwnd);
+            if (it == records.end())
+            {
+                return false;
+            }
+            output = it->second;
+            return true;
+        }
+
+        HWND foreground()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return foreground_hwnd;
+        }
+
+        size_t size()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return records.size();
+        }
+
+        // 已处理的 WinEvent 数量
+        uint64_t updates() const
+        {
+            return update_count.load(std::memory_order_relaxed);
+        }
+
+    private:
+        Registry() : thread_id(0), is_running(false), is_started(false), is_start_failed(false),
+                     next_order(0), top_order(0), foreground_hwnd(NULL), title_buffer(256), notify_func(NULL), notify_context(NULL),
+                     notify_pending(false), update_count(0) {}
+
+        // 没有调用 stop 就退出进程时线程可能仍在运行  析构时分离 (joinable 的 std::thread 析构会直接终止进程)
+        ~Registry()
+        {
+            if (worker.joinable())
+            {
+                worker.detach();
+            }
+        }
+
+        static std::wstring foldCase(const std::wstring &input)
+        {
+            std::wstring result = input;
+            if (!result.empty())
+            {
+                ::CharUpperBuffW(&result[0], (DWORD)result.size());
+            }
+            return result;
+        }
+
+        static void sortByOrder(std::vector<const WindowRecord *> &list, std::vector<HWND> &output)
+        {
+            std::sort(list.begin(), list.end(), [](const WindowRecord *a, const WindowRecord *b)
+                      { return a->order < b->order; });
+            output.reserve(list.size());
+            for (auto record : list)
+            {
+                output.push_back(record->hwnd);
+            }
+        }
+
+        static bool isTopLevel(HWND hwnd)
+        {
+            return ::GetAncestor(hwnd, GA_PARENT) == ::GetDesktopWindow();
+        }
+
+        // 与 queryWindows / findAllWindow 相同的读取方式 (不发送 WM_GETTEXT 长标题不会被截断)  需持有 mutex
+        void readTitle(HWND hwnd, std::wstring &output)
+        {
+            int length = hmc_window_query::readTitle(hwnd, title_buffer);
+            output.assign(title_buffer.data(), length);
+        }
+
+        static void eraseFrom(std::unordered_map<std::wstring, std::unordered_set<HWND>> &index, const std::wstring &key, HWND hwnd)
+        {
+            auto it = index.find(key);
+            if (it != index.end())
+            {
+                it->second.erase(hwnd);
+                if (it->second.empty())
+                    index.erase(it);
+            }
+        }
+
+        // 以下需持有 mutex
+
+        // is_top 为 true 时放到最上 (新建 / 成为前台)  否则排在已有窗口之后 (启动时按 Z 序获取)
+        void insert(HWND hwnd, bool is_top)
+        {
+            if (records.count(hwnd))
+            {
+                return;
+            }
+
+            WindowRecord record;
+            record.hwnd = hwnd;
+            record.thread_id = ::GetWindowThreadProcessId(hwnd, &record.pid);
+            record.owner = ::GetWindow(hwnd, GW_OWNER);
+            record.visible = ::IsWindowVisible(hwnd) != FALSE;
+            ::GetWindowRect(hwnd, &record.rect);
+
+            WCHAR class_buffer[257];
+            int length = ::GetClassNameW(hwnd, class_buffer, 257);
+            record.class_name.assign(class_buffer, length > 0 ? length : 0);
+            readTitle(hwnd, record.title);
+            record.order = is_top ? --top_order : next_order++;
+
+            by_pid[record.pid].insert(hwnd);
+            by_class[foldCase(record.class_name)].insert(hwnd);
+            by_title[foldCase(record.title)].insert(hwnd);
+            records.emplace(hwnd, std::move(record));
+        }
+
+        void erase(HWND hwnd)
+        {
+            auto it = records.find(hwnd);
+            if (it == records.end())
+            {
+                return;
+            }
+
+            const WindowRecord &record = it->second;
+            auto pid_it = by_pid.find(record.pid);
+            if (pid_it != by_pid.end())
+            {
+                pid_it->second.erase(hwnd);
+                if (pid_it->second.empty())
+                    by_pid.erase(pid_it);
+            }
+            eraseFrom(by_class, foldCase(record.class_name), hwnd);
+            eraseFrom(by_title, foldCase(record.title), hwnd);
+
+            if (foreground_hwnd == hwnd)
+            {
+                foreground_hwnd = NULL;
+            }
+            records.erase(it);
+        }
+
+        void updateTitle(WindowRecord &record)
+        {
+            std::wstring title;
+            readTitle(record.hwnd, title);
+            if (title == record.title)
+            {
+                return;
+            }
+            eraseFrom(by_title, foldCase(record.title), record.hwnd);
+            record.title.swap(title);
+            by_title[foldCase(record.title)].insert(record.hwnd);
+        }
+
+        // 没有订阅时只更新索引 不记录事件
+        void push(uint32_t type, HWND hwnd)
+        {
+            if (notify_func == NULL)
+            {
+                return;
+            }
+            events.push(Event{type, (ULONG_PTR)hwnd});
+            if (!notify_pending.exchange(true))
+            {
+                notify_func(notify_context);
+            }
+        }
+
+        void onEvent(DWORD event, HWND hwnd)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            update_count.fetch_add(1, std::memory_order_relaxed);
+
+            if (event == EVENT_OBJECT_DESTROY)
+            {
+                if (records.count(hwnd))
+                {
+                    erase(hwnd);
+                    push(EVENT_DESTROY, hwnd);
+                }
+                return;
+            }
+
+            auto it = records.find(hwnd);
+            if (it == records.end())
+            {
+                // 没有记录的窗口只接受顶层窗口的创建 / 显示 / 前台
+                if ((event != EVENT_OBJECT_CREATE && event != EVENT_OBJECT_SHOW && event != EVENT_SYSTEM_FOREGROUND) || !::IsWindow(hwnd) || !isTopLevel(hwnd))
+                {
+                    return;
+                }
+                insert(hwnd, true);
+                push(EVENT_CREATE, hwnd);
+                it = records.find(hwnd);
+                if (event == EVENT_OBJECT_CREATE)
+                {
+                    return;
+                }
+            }
+
+            WindowRecord &record = it->second;
+            switch (event)
+            {
+            case EVENT_OBJECT_SHOW:
+            case EVENT_OBJECT_HIDE:
+                record.visible = ::IsWindowVisible(hwnd) != FALSE;
+                ::GetWindowRect(hwnd, &record.rect);
+                push(record.visible ? EVENT_SHOW : EVENT_HIDE, hwnd);
+                break;
+            case EVENT_OBJECT_NAMECHANGE:
+                updateTitle(record);
+                push(EVENT_NAME, hwnd);
+                break;
+            case EVENT_OBJECT_LOCATIONCHANGE:
+                ::GetWindowRect(hwnd, &record.rect);
+                push(EVENT_LOCATION, hwnd);
+                break;
+            case EVENT_SYSTEM_FOREGROUND:
+                foreground_hwnd = hwnd;
+                record.order = --top_order;
+                push(EVENT_FOREGROUND, hwnd);
+                break;
+            default:
+                break;
+            }
+        }
+
+        static void CALLBACK winEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG id_object, LONG id_child, DWORD event_thread, DWORD event_time)
+        {
+            // 只处理窗口本身 (忽略光标 滚动条 子元素等)
+            if (hwnd == NULL || id_object != OBJID_WINDOW || id_child != CHILDID_SELF)
+            {
+                return;
+            }
+            shared().onEvent(event, hwnd);
+        }
+
+        static BOOL CALLBACK enumWindowsProc(HWND hwnd, LPARAM context)
+        {
+            ((Registry *)context)->insert(hwnd, false);
+            return TRUE;
+        }
+
+        void threadMain()
+        {
+            MSG msg;
+            // 创建消息队列 以便接收 WM_QUIT
+            ::PeekMessageW(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+
+            // 先安装钩子再获取 避免两者之间的变化丢失 (重复的创建事件会被忽略)
+            const DWORD flags = WINEVENT_OUTOFCONTEXT;
+            HWINEVENTHOOK hooks[3] = {
+                ::SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, NULL, winEventProc, 0, 0, flags),
+                ::SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_HIDE, NULL, winEventProc, 0, 0, flags),
+                ::SetWinEventHook(EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_NAMECHANGE, NULL, winEventProc, 0, 0, flags),
+            };
+
+            bool is_hooked = hooks[0] != NULL && hooks[1] != NULL && hooks[2] != NULL;
+
+            if (is_hooked)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ::EnumWindows(enumWindowsProc, (LPARAM)this);
+                foreground_hwnd = ::GetForegroundWindow();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                thread_id = ::GetCurrentThreadId();
+                is_running = is_hooked;
+                is_started = is_hooked;
+                is_start_failed = !is_hooked;
+            }
+            state_cv.notify_all();
+
+            if (is_hooked)
+            {
+                while (::GetMessageW(&msg, NULL, 0, 0) > 0)
+                {
+                    ::TranslateMessage(&msg);
+                    ::DispatchMessageW(&msg);
+                }
+            }
+
+            for (HWINEVENTHOOK hook : hooks)
+            {
+                if (hook != NULL)
+                {
+                    ::UnhookWinEvent(hook);
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                records.clear();
+                by_pid.clear();
+                by_class.clear();
+                by_title.clear();
+                foreground_hwnd = NULL;
+                next_order = 0;
+                top_order = 0;
+                notify_func = NULL;
+                notify_context = NULL;
+            }
+
+            std::lock_guard<std::mutex> lock(state_mutex);
+            thread_id = 0;
+            is_running = false;
+        }
+
+        // 线程状态
+        std::mutex state_mutex;
+        std::condition_variable state_cv;
+        std::thread worker;
+        DWORD thread_id;
+        bool is_running;
+        bool is_started;
+        bool is_start_failed;
+
+        // 索引
+        std::mutex mutex;
+        std::unordered_map<HWND, WindowRecord> records;
+        std::unordered_map<DWORD, std::unordered_set<HWND>> by_pid;
+        // 键为大小写折叠后的文本
+        std::unordered_map<std::wstring, std::unordered_set<HWND>> by_class;
+        std::unordered_map<std::wstring, std::unordered_set<HWND>> by_title;
+        // 启动时的窗口从 0 递增  之后移到最上的窗口从 -1 递减
+        int64_t next_order;
+        int64_t top_order;
+        HWND foreground_hwnd;
+        std::vector<WCHAR> title_buffer;
+
+        NotifyFunc notify_func;
+        void *notify_context;
+        std::atomic<bool> notify_pending;
+        std::atomic<uint64_t> update_count;
+    };
+}
+
+#endif // HMC_IMPORT_WINDOW_INDEX_H
@@ -0,0 +1,241 @@
+#pragma once
+
+#ifndef HMC_IMPORT_WINDOW_MATCH_H
+#define HMC_IMPORT_WINDOW_MATCH_H
+
+// 按类名 / 标题搜索顶层窗口
+// 匹配规则在每次搜索前编译一次 (大小写折叠 正则编译只处理一次模式)
+// 先比较类名 命中后才获取标题  文本缓冲区在所有窗口间复用  达到数量上限立即结束
+// 标题由 hmc_window_query::readTitle 读取 (不发送 WM_GETTEXT 无响应的窗口不会阻塞搜索)
+
+#include <windows.h>
+#include <algorithm>
+#include <regex>
+#include <string>
+#include <vector>
+#include "./hmc_window_query.hpp"
+
+namespace hmc_window_match
+{
+    enum Mode
+    {
+        // 完全一致
+        MODE_EXACT,
+        // 以模式开头
+        MODE_PREFIX,
+        // 包含模式
+        MODE_SUBSTRING,
+        // 通配符 * ?
+        MODE_GLOB,
+        // ECMAScript 正则 (regex_search)
+        MODE_REGEX,
+    };
+
+    /**
+     * @brief 模式名转为 Mode  未知的返回 false
+     */
+    inline bool parseMode(const std::wstring &name, Mode &mode)
+    {
+        if (name == L"exact")
+            mode = MODE_EXACT;
+        else if (name == L"prefix")
+            mode = MODE_PREFIX;
+        else if (name == L"substring")
+            mode = MODE_SUBSTRING;
+        else if (name == L"glob")
+            mode = MODE_GLOB;
+        else if (name == L"regex")
+            mode = MODE_REGEX;
+        else
+            return false;
+        return true;
+    }
+
+    // 大小写折叠 (原地)
+    inline void foldCase(std::wstring &text)
+    {
+        if (!text.empty())
+        {
+            ::CharUpperBuffW(&text[0], (DWORD)text.size());
+        }
+    }
+
+    /**
+     * @brief 通配符匹配  * 任意长度  ? 单个字符
+     */
+    inline bool globMatch(const WCHAR *text, size_t text_length, const std::wstring &pattern)
+    {
+        size_t t = 0, p = 0;
+        size_t star = std::wstring::npos, star_text = 0;
+
+        while (t < text_length)
+        {
+            if (p < pattern.size() && (pattern[p] == L'?' || pattern[p] == text[t]))
+            {
+                t++;
+                p++;
+            }
+            else if (p < pattern.size() && pattern[p] == L'*')
+            {
+                star = p++;
+                star_text = t;
+            }
+            else if (star != std::wstring::npos)
+            {
+                // 回到上一个 * 多吃一个字符
+                p = star + 1;
+                t = ++star_text;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        while (p < pattern.size() && pattern[p] == L'*')
+        {
+            p++;
+        }
+        return p == pattern.size();
+    }
+
+    /**
+     * @brief 编译后的单个匹配规则
+     */
+    class Pattern
+    {
+    public:
+        Pattern() : mode(MODE_EXACT), case_sensitive(true), is_empty(true) {}
+
+        /**
+         * @brief 编译模式
+         * @exception std::regex_error 正则无效
+         */
+        Pattern(const std::wstring &source, Mode mode, bool case_sensitive)
+            : pattern(source), mode(mode), case_sensitive(case_sensitive), is_empty(source.empty())
+        {
+            if (mode == MODE_REGEX)
+            {
+                auto flags = std::regex_constants::ECMAScript | std::regex_constants::optimize;
+                if (!case_sensitive)
+                {
+                    flags |= std::regex_constants::icase;
+                }
+                regex = std::wregex(source, flags);
+            }
+            else if (!case_sensitive)
+            {
+                foldCase(pattern);
+            }
+        }
+
+        // 空模式匹配所有文本
+        bool empty() const
+        {
+            return is_empty;
+        }
+
+        /**
+         * @param text 可以被修改 (大小写折叠在原缓冲区进行)
+         */
+        bool match(WCHAR *text, size_t length) const
+        {
+            if (is_empty)
+            {
+                return true;
+            }
+
+            if (mode == MODE_REGEX)
+            {
+                return std::regex_search(text, text + length, regex);
+            }
+
+            if (!case_sensitive && length > 0)
+            {
+                ::CharUpperBuffW(text, (DWORD)length);
+            }
+
+            switch (mode)
+            {
+            case MODE_EXACT:
+                return length == pattern.size() && pattern.compare(0, length, text, length) == 0;
+            case MODE_PREFIX:
+                return length >= pattern.size() && pattern.compare(0, pattern.size(), text, pattern.size()) == 0;
+            case MODE_SUBSTRING:
+                return pattern.size() <= length &&
+                       std::search(text, text + length, pattern.begin(), pattern.end()) != text + length;
+            case MODE_GLOB:
+                return globMatch(text, length, pattern);
+            default:
+                return false;
+            }
+        }
+
+    private:
+        std::wstring pattern;
+        std::wregex regex;
+        Mode mode;
+        bool case_sensitive;
+        bool is_empty;
+    };
+
+    struct Query
+    {
+        Pattern class_name;
+        Pattern title;
+        // 只要可见的窗口
+        bool visible_only = true;
+        // 最多返回的数量  0 为不限
+        size_t limit = 0;
+    };
+
+    /**
+     * @brief 按 Z 序搜索顶层窗口
+     *
+     * @param query
+     * @param output 输出 (会被清空)
+     */
+    inline void find(const Query &query, std::vector<HWND> &output)
+    {
+        output.clear();
+
+        // 类名最长 256
+        WCHAR class_buffer[257];
+        std::vector<WCHAR> title_buffer(MAX_PATH);
+
+        HWND hwnd = ::GetWindow(::GetDesktopWindow(), GW_CHILD);
+        for (; hwnd != NULL; hwnd = ::GetWindow(hwnd, GW_HWNDNEXT))
+        {
+            if (query.visible_only && !::IsWindowVisible(hwnd))
+            {
+                continue;
+            }
+
+            if (!query.class_name.empty())
+            {
+                int length = ::GetClassNameW(hwnd, class_buffer, 257);
+                if (!query.class_name.match(class_buffer, length > 0 ? length : 0))
+                {
+                    continue;
+                }
+            }
+
+            if (!query.title.empty())
+            {
+                int length = hmc_window_query::readTitle(hwnd, title_buffer);
+                if (!query.title.match(title_buffer.data(), length))
+                {
+                    continue;
+                }
+            }
+
+            output.push_back(hwnd);
+            if (query.limit != 0 && output.size() >= query.limit)
+            {
+                break;
+            }
+        }
+    }
+}
+
+#endif // HMC_IMPORT_WINDOW_MATCH_H
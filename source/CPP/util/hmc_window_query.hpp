@@ -0,0 +1,211 @@
+#pragma once
+
+#ifndef HMC_IMPORT_WINDOW_QUERY_H
+#define HMC_IMPORT_WINDOW_QUERY_H
+
+// 批量获取窗口属性
+// 只获取请求的字段 一次遍历写入按列存放的结果  (取代每个窗口分别调用 标题/类名/位置/样式/pid 等多个接口)
+// 标题与类名的缓冲区在所有窗口间复用  标题由 InternalGetWindowText 读取 (不发送 WM_GETTEXT 无响应的窗口不会阻塞遍历)
+
+#include <windows.h>
+#include <string>
+#include <vector>
+
+namespace hmc_window_query
+{
+    /**
+     * @brief 读取窗口标题到 buffer (不发送消息)  返回长度
+     * InternalGetWindowText 没有获取长度的方式  填满缓冲区时加倍后重新读取
+     */
+    inline int readTitle(HWND hwnd, std::vector<WCHAR> &buffer)
+    {
+        while (true)
+        {
+            int length = ::InternalGetWindowText(hwnd, buffer.data(), (int)buffer.size());
+            if (length <= 0)
+            {
+                return 0;
+            }
+            if (length + 1 < (int)buffer.size() || buffer.size() >= 32768)
+            {
+                return length;
+            }
+            buffer.resize(buffer.size() * 2);
+        }
+    }
+
+    enum Field : unsigned int
+    {
+        FIELD_TITLE = 1 << 0,
+        FIELD_CLASS_NAME = 1 << 1,
+        FIELD_RECT = 1 << 2,
+        FIELD_STYLE = 1 << 3,
+        FIELD_EX_STYLE = 1 << 4,
+        FIELD_CLASS_STYLE = 1 << 5,
+        FIELD_PID = 1 << 6,
+        FIELD_THREAD_ID = 1 << 7,
+        FIELD_VISIBLE = 1 << 8,
+        FIELD_MINIMIZED = 1 << 9,
+        FIELD_OWNER = 1 << 10,
+    };
+
+    /**
+     * @brief 字段名转为 Field  未知的字段返回 0
+     */
+    inline unsigned int parseField(const std::wstring &name)
+    {
+        static const struct
+        {
+            const wchar_t *name;
+            unsigned int field;
+        } field_names[] = {
+            {L"title", FIELD_TITLE},
+            {L"className", FIELD_CLASS_NAME},
+            {L"rect", FIELD_RECT},
+            {L"style", FIELD_STYLE},
+            {L"exStyle", FIELD_EX_STYLE},
+            {L"classStyle", FIELD_CLASS_STYLE},
+            {L"pid", FIELD_PID},
+            {L"threadId", FIELD_THREAD_ID},
+            {L"visible", FIELD_VISIBLE},
+            {L"minimized", FIELD_MINIMIZED},
+            {L"owner", FIELD_OWNER},
+        };
+
+        for (auto &item : field_names)
+        {
+            if (name == item.name)
+            {
+                return item.field;
+            }
+        }
+        return 0;
+    }
+
+    // 按列存放的结果  未请求的字段保持为空
+    struct Columns
+    {
+        unsigned int fields = 0;
+        std::vector<double> hwnd;
+        std::vector<std::wstring> title;
+        std::vector<std::wstring> class_name;
+        // 每个窗口 4 个: x, y, width, height
+        std::vector<int32_t> rect;
+        std::vector<uint32_t> style;
+        std::vector<uint32_t> ex_style;
+        std::vector<uint32_t> class_style;
+        std::vector<uint32_t> pid;
+        std::vector<uint32_t> thread_id;
+        std::vector<uint8_t> visible;
+        std::vector<uint8_t> minimized;
+        std::vector<double> owner;
+    };
+
+    /**
+     * @brief 枚举桌面的顶层窗口 (与 getAllWindowsHandle 顺序一致)
+     *
+     * @param output 输出 (会被清空)
+     * @param visible_only 只要可见的窗口
+     */
+    inline void enumTopWindows(std::vector<HWND> &output, bool visible_only)
+    {
+        output.clear();
+        HWND hwnd = ::GetWindow(::GetDesktopWindow(), GW_CHILD);
+        while (hwnd != NULL)
+        {
+            if (!visible_only || ::IsWindowVisible(hwnd))
+            {
+                output.push_back(hwnd);
+            }
+            hwnd = ::GetWindow(hwnd, GW_HWNDNEXT);
+        }
+    }
+
+    /**
+     * @brief 获取窗口的指定字段
+     *
+     * @param hwnd_list
+     * @param fields Field 的组合
+     * @param output 输出 (会被清空)  无效的窗口各字段为空值 (0 / "")
+     */
+    inline void query(const std::vector<HWND> &hwnd_list, unsigned int fields, Columns &output)
+    {
+        output = Columns();
+        output.fields = fields;
+
+        size_t count = hwnd_list.size();
+        output.hwnd.reserve(count);
+        if (fields & FIELD_TITLE)
+            output.title.reserve(count);
+        if (fields & FIELD_CLASS_NAME)
+            output.class_name.reserve(count);
+        if (fields & FIELD_RECT)
+            output.rect.reserve(count * 4);
+
+        // 所有窗口共用 只在遇到更长的标题时扩大
+        std::vector<WCHAR> text_buffer(MAX_PATH);
+        // 类名最长 256
+        WCHAR class_buffer[257];
+
+        for (HWND hwnd : hwnd_list)
+        {
+            output.hwnd.push_back((double)(ULONG_PTR)hwnd);
+            bool is_window = ::IsWindow(hwnd) != FALSE;
+
+            if (fields & FIELD_TITLE)
+            {
+                int length = is_window ? readTitle(hwnd, text_buffer) : 0;
+                output.title.emplace_back(text_buffer.data(), length);
+            }
+
+            if (fields & FIELD_CLASS_NAME)
+            {
+                int length = is_window ? ::GetClassNameW(hwnd, class_buffer, 257) : 0;
+                output.class_name.emplace_back(class_buffer, length > 0 ? length : 0);
+            }
+
+            if (fields & FIELD_RECT)
+            {
+                RECT rect = {0, 0, 0, 0};
+                if (is_window)
+                {
+                    ::GetWindowRect(hwnd, &rect);
+                }
+                output.rect.push_back(rect.left);
+                output.rect.push_back(rect.top);
+                output.rect.push_back(rect.right - rect.left);
+                output.rect.push_back(rect.bottom - rect.top);
+            }
+
+            if (fields & FIELD_STYLE)
+                output.style.push_back(is_window ? (uint32_t)::GetWindowLongPtrW(hwnd, GWL_STYLE) : 0);
+
+            if (fields & FIELD_EX_STYLE)
+                output.ex_style.push_back(is_window ? (uint32_t)::GetWindowLongPtrW(hwnd, GWL_EXSTYLE) : 0);
+
+            if (fields & FIELD_CLASS_STYLE)
+                output.class_style.push_back(is_window ? (uint32_t)::GetClassLongPtrW(hwnd, GCL_STYLE) : 0);
+
+            if (fields & (FIELD_PID | FIELD_THREAD_ID))
+            {
+                DWORD pid = 0;
+                DWORD thread_id = is_window ? ::GetWindowThreadProcessId(hwnd, &pid) : 0;
+                if (fields & FIELD_PID)
+                    output.pid.push_back(pid);
+                if (fields & FIELD_THREAD_ID)
+                    output.thread_id.push_back(thread_id);
+            }
+
+            if (fields & FIELD_VISIBLE)
+                output.visible.push_back(is_window && ::IsWindowVisible(hwnd) ? 1 : 0);
+
+            if (fields & FIELD_MINIMIZED)
+                output.minimized.push_back(is_window && ::IsIconic(hwnd) ? 1 : 0);
+
+            if (fields & FIELD_OWNER)
+                output.owner.push_back(is_window ? (double)(ULONG_PTR)::GetWindow(hwnd, GW_OWNER) : 0);
+        }
+    }
+}
+
+#endif // HMC_IMPORT_WINDOW_QUERY_H
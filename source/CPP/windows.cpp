@@ -1,5 +1,8 @@
 #include "./Mian.hpp";
 #include "hmc_napi_value_util.h"
+#include "./util/hmc_napi_table.hpp"
+#include "./util/hmc_window_query.hpp"
+#include "./util/hmc_window_index.hpp"
 
 // 获取所有窗口
 napi_value getAllWindowsHandle(napi_env env, napi_callback_info info)
@@ -162,3 +165,362 @@ napi_value setForegroundWindow(napi_env env, napi_callback_info info)
     return NULL;
 }
 
+/**
+ * @brief 批量获取窗口属性 (按列返回)
+ *
+ * @param env
+ * @param info
+ * - hwnds 窗口句柄数组  或 "all" (所有顶层窗口) / "visible" (可见的顶层窗口)
+ * - fields 需要的字段 title className rect style exStyle classStyle pid threadId visible minimized owner
+ * @return napi_value { length, hwnd, ...fields }
+ */
+napi_value queryWindows(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value args[2];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 2)
+    {
+        napi_throw_type_error(env, 0, "queryWindows(hwnds, fields) requires 2 arguments");
+        return NULL;
+    }
+
+    vector<HWND> hwnd_list;
+    if (hmc_napi_type::isString(env, args[0]))
+    {
+        wstring mode = hmc_napi_get_value::string_utf16(env, args[0]);
+        hmc_window_query::enumTopWindows(hwnd_list, mode == L"visible");
+    }
+    else
+    {
+        bool is_array = false;
+        napi_is_array(env, args[0], &is_array);
+        if (!is_array)
+        {
+            napi_throw_type_error(env, 0, "hwnds must be an array or \"all\" / \"visible\"");
+            return NULL;
+        }
+
+        uint32_t length = 0;
+        napi_get_array_length(env, args[0], &length);
+        hwnd_list.reserve(length);
+        for (uint32_t i = 0; i < length; i++)
+        {
+            napi_value item;
+            int64_t hwnd = 0;
+            napi_get_element(env, args[0], i, &item);
+            napi_get_value_int64(env, item, &hwnd);
+            hwnd_list.push_back((HWND)hwnd);
+        }
+    }
+
+    unsigned int fields = 0;
+    bool is_fields_array = false;
+    napi_is_array(env, args[1], &is_fields_array);
+    if (is_fields_array)
+    {
+        uint32_t length = 0;
+        napi_get_array_length(env, args[1], &length);
+        for (uint32_t i = 0; i < length; i++)
+        {
+            napi_value item;
+            napi_get_element(env, args[1], i, &item);
+            if (hmc_napi_type::isString(env, item))
+            {
+                fields |= hmc_window_query::parseField(hmc_napi_get_value::string_utf16(env, item));
+            }
+        }
+    }
+
+    hmc_window_query::Columns columns;
+    hmc_window_query::query(hwnd_list, fields, columns);
+
+    auto object = hmc_napi_create_value::jsObject(env);
+    object.putValue("length", hmc_napi_create_value::Number(env, (int64_t)columns.hwnd.size()));
+    object.putValue("hwnd", hmc_napi_table::typedArray(env, napi_float64_array, columns.hwnd));
+
+    if (fields & hmc_window_query::FIELD_TITLE)
+        object.putValue("title", hmc_napi_table::utf16Array(env, columns.title));
+    if (fields & hmc_window_query::FIELD_CLASS_NAME)
+        object.putValue("className", hmc_napi_table::utf16Array(env, columns.class_name));
+    if (fields & hmc_window_query::FIELD_RECT)
+        object.putValue("rect", hmc_napi_table::typedArray(env, napi_int32_array, columns.rect));
+    if (fields & hmc_window_query::FIELD_STYLE)
+        object.putValue("style", hmc_napi_table::typedArray(env, napi_uint32_array, columns.style));
+    if (fields & hmc_window_query::FIELD_EX_STYLE)
+        object.putValue("exStyle", hmc_napi_table::typedArray(env, napi_uint32_array, columns.ex_style));
+    if (fields & hmc_window_query::FIELD_CLASS_STYLE)
+        object.putValue("classStyle", hmc_napi_table::typedArray(env, napi_uint32_array, columns.class_style));
+    if (fields & hmc_window_query::FIELD_PID)
+        object.putValue("pid", hmc_napi_table::typedArray(env, napi_uint32_array, columns.pid));
+    if (fields & hmc_window_query::FIELD_THREAD_ID)
+        object.putValue("threadId", hmc_napi_table::typedArray(env, napi_uint32_array, columns.thread_id));
+    if (fields & hmc_window_query::FIELD_VISIBLE)
+        object.putValue("visible", hmc_napi_table::typedArray(env, napi_uint8_array, columns.visible));
+    if (fields & hmc_window_query::FIELD_MINIMIZED)
+        object.putValue("minimized", hmc_napi_table::typedArray(env, napi_uint8_array, columns.minimized));
+    if (fields & hmc_window_query::FIELD_OWNER)
+        object.putValue("owner", hmc_napi_table::typedArray(env, napi_float64_array, columns.owner));
+
+    return object.toValue();
+}
+
+// 窗口索引的事件推送  startWindowIndex(callback)
+napi_threadsafe_function WindowIndex_PUSH_tsfn = NULL;
+
+// 钩子线程调用 只排队 不阻塞
+static void WindowIndexNotify(void *context)
+{
+    if (napi_call_threadsafe_function((napi_threadsafe_function)context, NULL, napi_tsfn_nonblocking) != napi_ok)
+    {
+        hmc_window_index::Registry::shared().resetNotify();
+    }
+}
+
+/**
+ * @brief 在js线程中执行  将缓冲区里的事件打包为一个 Float64Array 回调给js
+ * 每个事件占2个值: [type, hwnd]
+ */
+static void WindowIndexPushCallJs(napi_env env, napi_value js_cb, void *context, void *data)
+{
+    hmc_window_index::Registry &registry = hmc_window_index::Registry::shared();
+    registry.resetNotify();
+
+    if (env == NULL || js_cb == NULL)
+    {
+        return;
+    }
+
+    // 只会在js线程使用 复用内存
+    static vector<hmc_window_index::Event> event_list;
+    event_list.clear();
+
+    size_t count = registry.events.drain(event_list);
+    if (count == 0)
+    {
+        return;
+    }
+
+    void *buffer = NULL;
+    napi_value arraybuffer, records, undefined;
+
+    if (napi_create_arraybuffer(env, count * 2 * sizeof(double), &buffer, &arraybuffer) != napi_ok)
+    {
+        return;
+    }
+
+    double *pack = (double *)buffer;
+    for (size_t i = 0; i < count; i++)
+    {
+        pack[i * 2] = (double)event_list[i].type;
+        pack[i * 2 + 1] = (double)event_list[i].hwnd;
+    }
+
+    if (napi_create_typedarray(env, napi_float64_array, count * 2, arraybuffer, 0, &records) != napi_ok)
+    {
+        return;
+    }
+
+    napi_get_undefined(env, &undefined);
+    napi_call_function(env, undefined, js_cb, 1, &records, NULL);
+}
+
+static void StopWindowIndexPush()
+{
+    hmc_window_index::Registry::shared().setNotify(NULL, NULL);
+    if (WindowIndex_PUSH_tsfn != NULL)
+    {
+        napi_release_threadsafe_function(WindowIndex_PUSH_tsfn, napi_tsfn_release);
+        WindowIndex_PUSH_tsfn = NULL;
+    }
+}
+
+// 注册了清理钩子的 env  (同一个钩子不能重复注册)
+napi_env WindowIndex_cleanup_env = NULL;
+
+// env 销毁时停止索引 (js 没有调用 stopWindowIndex 就退出)
+static void WindowIndexCleanupHook(void *arg)
+{
+    WindowIndex_cleanup_env = NULL;
+    StopWindowIndexPush();
+    hmc_window_index::Registry::shared().stop();
+}
+
+static napi_value hwndListToValue(napi_env env, const vector<HWND> &hwnd_list)
+{
+    napi_value Results;
+    napi_create_array_with_length(env, hwnd_list.size(), &Results);
+    for (size_t index = 0; index < hwnd_list.size(); index++)
+    {
+        napi_set_element(env, Results, (uint32_t)index, as_Number((int64_t)hwnd_list[index]));
+    }
+    return Results;
+}
+
+/**
+ * @brief 启动窗口索引 (已启动时只更新回调)
+ * - startWindowIndex()  只维护索引
+ * - startWindowIndex(callback)  callback(events: Float64Array)  每个事件为 [type, hwnd]
+ *   type 1 创建 2 销毁 3 标题 4 位置 5 前台 6 显示 7 隐藏
+ * @return napi_value 是否在运行
+ */
+napi_value startWindowIndex(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    hmc_window_index::Registry &registry = hmc_window_index::Registry::shared();
+    StopWindowIndexPush();
+
+    if (!registry.start())
+    {
+        return as_Boolean(false);
+    }
+
+    if (WindowIndex_cleanup_env == NULL)
+    {
+        napi_add_env_cleanup_hook(env, WindowIndexCleanupHook, NULL);
+        WindowIndex_cleanup_env = env;
+    }
+
+    if (argc > 0 && util_diff_napi_type(env, args[0], napi_function))
+    {
+        napi_value work_name;
+        napi_create_string_utf8(env, "hmc::windowIndex", NAPI_AUTO_LENGTH, &work_name);
+
+        if (napi_create_threadsafe_function(env, args[0], NULL, work_name, 0, 1, NULL, NULL, NULL, WindowIndexPushCallJs, &WindowIndex_PUSH_tsfn) != napi_ok)
+        {
+            napi_throw_error(env, "Creation_failed", "startWindowIndex < napi_create_threadsafe_function failed. >");
+            return NULL;
+        }
+
+        // 不阻止进程退出
+        napi_unref_threadsafe_function(env, WindowIndex_PUSH_tsfn);
+        registry.events.clear();
+        registry.setNotify(WindowIndexNotify, WindowIndex_PUSH_tsfn);
+    }
+
+    return as_Boolean(true);
+}
+
+napi_value stopWindowIndex(napi_env env, napi_callback_info info)
+{
+    StopWindowIndexPush();
+    hmc_window_index::Registry::shared().stop();
+
+    if (WindowIndex_cleanup_env == env)
+    {
+        napi_remove_env_cleanup_hook(env, WindowIndexCleanupHook, NULL);
+        WindowIndex_cleanup_env = NULL;
+    }
+    return NULL;
+}
+
+napi_value isWindowIndexRunning(napi_env env, napi_callback_info info)
+{
+    return as_Boolean(hmc_window_index::Registry::shared().running());
+}
+
+/**
+ * @brief 从窗口索引查找 (类名 标题 完全一致 不区分大小写)
+ * - className 类名 null 为不限
+ * - title 标题 null 为不限
+ * - limit 最多返回的数量 0 为不限
+ */
+napi_value windowIndexFind(napi_env env, napi_callback_info info)
+{
+    auto input = hmc_NodeArgsValue(env, info);
+
+    wstring className = input.eq(0, js_string, false) ? input.getStringWide(0, L"") : wstring(L"");
+    wstring title = input.eq(1, js_string, false) ? input.getStringWide(1, L"") : wstring(L"");
+    size_t limit = input.eq(2, js_number, false) ? (size_t)input.getDword(2) : 0;
+
+    vector<HWND> hwnd_list;
+    hmc_window_index::Registry::shared().find(className, title, hwnd_list, limit);
+    return hwndListToValue(env, hwnd_list);
+}
+
+/**
+ * @brief 窗口索引中的所有窗口 (按近似 Z 序)
+ * - visibleOnly 只要可见的窗口 默认 false
+ */
+napi_value windowIndexList(napi_env env, napi_callback_info info)
+{
+    auto input = hmc_NodeArgsValue(env, info);
+
+    vector<HWND> hwnd_list;
+    hmc_window_index::Registry::shared().all(hwnd_list, input.exists(0) ? input.getBool(0, false) : false);
+    return hwndListToValue(env, hwnd_list);
+}
+
+napi_value windowIndexByPid(napi_env env, napi_callback_info info)
+{
+    auto input = hmc_NodeArgsValue(env, info);
+    input.eq({{0, js_number}}, true);
+
+    vector<HWND> hwnd_list;
+    hmc_window_index::Registry::shared().findByPid(input.getDword(0), hwnd_list);
+    return hwndListToValue(env, hwnd_list);
+}
+
+napi_value windowIndexMainWindow(napi_env env, napi_callback_info info)
+{
+    auto input = hmc_NodeArgsValue(env, info);
+    input.eq({{0, js_number}}, true);
+
+    return as_Number((int64_t)hmc_window_index::Registry::shared().mainWindow(input.getDword(0)));
+}
+
+// 索引中的窗口信息  没有记录时返回 null
+napi_value windowIndexGet(napi_env env, napi_callback_info info)
+{
+    auto input = hmc_NodeArgsValue(env, info);
+    input.eq({{0, js_number}}, true);
+
+    hmc_window_index::WindowRecord record;
+    if (!hmc_window_index::Registry::shared().get((HWND)input.getInt64(0), record))
+    {
+        napi_value result;
+        napi_get_null(env, &result);
+        return result;
+    }
+
+    auto rect = hmc_napi_create_value::jsObject(env);
+    rect.putValue("x", hmc_napi_create_value::Number(env, (int64_t)record.rect.left));
+    rect.putValue("y", hmc_napi_create_value::Number(env, (int64_t)record.rect.top));
+    rect.putValue("width", hmc_napi_create_value::Number(env, (int64_t)(record.rect.right - record.rect.left)));
+    rect.putValue("height", hmc_napi_create_value::Number(env, (int64_t)(record.rect.bottom - record.rect.top)));
+
+    auto object = hmc_napi_create_value::jsObject(env);
+    object.putValue("hwnd", hmc_napi_create_value::Number(env, (int64_t)record.hwnd));
+    object.putValue("pid", hmc_napi_create_value::Number(env, (int64_t)record.pid));
+    object.putValue("threadId", hmc_napi_create_value::Number(env, (int64_t)record.thread_id));
+    object.putValue("owner", hmc_napi_create_value::Number(env, (int64_t)record.owner));
+    object.putValue("visible", hmc_napi_create_value::Boolean(env, record.visible));
+    object.putValue("rect", rect.toValue());
+    object.putValue("className", hmc_napi_table::utf16(env, record.class_name));
+    object.putValue("title", hmc_napi_table::utf16(env, record.title));
+    return object.toValue();
+}
+
+/**
+ * @brief 窗口索引的状态
+ * - size 窗口数量
+ * - updates 已处理的事件数量
+ * - pending 未读取的推送事件
+ * - overflow 推送缓冲区满而丢弃的数量
+ */
+napi_value getWindowIndexStats(napi_env env, napi_callback_info info)
+{
+    hmc_window_index::Registry &registry = hmc_window_index::Registry::shared();
+
+    auto object = hmc_napi_create_value::jsObject(env);
+    object.putValue("running", hmc_napi_create_value::Boolean(env, registry.running()));
+    object.putValue("size", hmc_napi_create_value::Number(env, (int64_t)registry.size()));
+    object.putValue("updates", hmc_napi_create_value::Number(env, (int64_t)registry.updates()));
+    object.putValue("pending", hmc_napi_create_value::Number(env, (int64_t)registry.events.size()));
+    object.putValue("overflow", hmc_napi_create_value::Number(env, (int64_t)registry.events.overflow()));
+    return object.toValue();
+}
@@ -52,6 +52,7 @@ const get_native: () => HMC.Native = (binPath?: string) => {
         function fnAnyArr(...args: any[]) { console.error(HMCNotPlatform); return [] as any[] }
         function fnPromise(...args: any[]) { console.error(HMCNotPlatform); return Promise.reject("HMC::HMC current method only supports win32 platform") }
         function fnArrStr(...args: any[]) { console.error(HMCNotPlatform); return "[]" }
+        function fnPackedRows(...args: any[]) { console.error(HMCNotPlatform); return [new Float64Array(0), []] as HMC.PackedRows }
 
         return {
             getRegistrBuffValue: fnNull,
@@ -85,10 +86,13 @@ const get_native: () => HMC.Native = (binPath?: string) => {
             popen: fnStr,
             createMutex: fnBool,
             getSubProcessID: fnAnyArr,
+            getProcessTree: fnAnyArr,
             enumAllProcessPolling: fnVoid,
             clearEnumAllProcessList: fnVoid,
             isStartKeyboardHook: fnBool,
             clearEnumProcessHandle: fnVoid,
+            closeEnumProcessHandle: fnVoid,
+            closeEnumAllProcess: fnVoid,
             getProcessThreadList: fnAnyArr,
             getKeyboardNextSession: fnAnyArr,
             unKeyboardHook: fnVoid,
@@ -113,6 +117,16 @@ const get_native: () => HMC.Native = (binPath?: string) => {
             desc: "HMC Connection System api",
             getAllWindows: fnAnyArr,
             getAllWindowsHandle: fnAnyArr,
+            startWindowIndex: fnBool,
+            stopWindowIndex: fnVoid,
+            isWindowIndexRunning: fnBool,
+            windowIndexFind: fnAnyArr,
+            windowIndexList: fnAnyArr,
+            windowIndexByPid: fnAnyArr,
+            windowIndexMainWindow: fnNum,
+            windowIndexGet: fnNull,
+            getWindowIndexStats() { return { running: false, size: 0, updates: 0, pending: 0, overflow: 0 } },
+            queryWindows() { console.error(HMCNotPlatform); return { length: 0, hwnd: new Float64Array(0) } },
             getBasicKeys: () => {
                 console.error(HMCNotPlatform);
                 return {
@@ -208,11 +222,21 @@ const get_native: () => HMC.Native = (binPath?: string) => {
             getWindowClassName: fnStr,
             formatVolumePath: fnStr,
             getVolumeList: fnAnyArr,
+            translatePaths: fnStrList,
             enumProcessHandlePolling: fnVoid,
             enumProcessHandle: fnNum,
             getModulePathList: fnStrList,
             getColor() { return { r: 0, g: 0, b: 0, hex: "#000000" } as HMC.Color },
-            captureBmpToFile: fnVoid,
+            getColors() { console.error(HMCNotPlatform); return new Uint32Array(0) },
+            pixelSearch: fnNull,
+            findImage() { console.error(HMCNotPlatform); return new Float64Array(0) },
+            captureScreenFrame: fnNull,
+            releaseScreenFrame: fnBool,
+            startCaptureStream: fnNum,
+            stopCaptureStream: fnBool,
+            getCaptureStreamStats: fnNull,
+            captureBmpToFile: fnBool,
+            captureBmpToBuff: fnNull,
             sendKeyboard: fnBool,
             sendBasicKeys: fnBool,
             sendKeyT2C: fnVoid,
@@ -238,13 +262,26 @@ const get_native: () => HMC.Native = (binPath?: string) => {
             _PromiseSession_ongoingTasks: fnAnyArr,
             _PromiseSession_get_sleep_time: fnNum,
             getAllProcessList: fnPromise,
-            getAllProcessListSync: fnArrStr,
+            getAllProcessListSync: fnPackedRows,
             getAllProcessListSnp: fnPromise,
-            getAllProcessListSnpSync: fnArrStr,
+            getAllProcessListSnpSync: fnPackedRows,
             getAllProcessListNt: fnPromise,
-            getAllProcessListNtSync: fnArrStr,
+            getAllProcessListNtSync: fnPackedRows,
+            getProcessTable: fnPromise,
+            getProcessTableSync: fnNull,
+            getProcessModules: fnPromise,
+            getProcessModulesSync: fnPackedRows,
+            findHandlesByPath: fnPromise,
+            findHandlesByPathSync: fnNull,
             getProcessCpuUsage: fnPromise,
             getProcessCpuUsageSync: fnNum,
+            getAllProcessCpuUsage: fnPromise,
+            getAllProcessCpuUsageSync: fnAnyArr,
+            getProcessCpuUsageHistory: fnNull,
+            createProcessDiffStore: fnNum,
+            closeProcessDiffStore: fnBool,
+            refreshProcessDiffStore: fnPromise,
+            refreshProcessDiffStoreSync: fnNull,
             getProcessFilePath: fnPromise,
             getProcessFilePathSync: fnArrStr,
             existProcess: fnPromise,
@@ -262,6 +299,16 @@ const get_native: () => HMC.Native = (binPath?: string) => {
             getProcessCommandSync: fnNull,
             getProcessCwd: fnPromise,
             getProcessCwdSync: fnStr,
+            getExecutorStats: () => {
+                console.error(HMCNotPlatform);
+                const lane = { workers: 0, depth: 0, running: 0, maxDepth: 0, submitted: 0, completed: 0, avgWaitMs: 0, maxWaitMs: 0, avgRunMs: 0, maxRunMs: 0 };
+                return { quick: lane, long: { ...lane } };
+            },
+            setExecutorOptions: fnVoid,
+            getKeyboardHookStats: () => {
+                console.error(HMCNotPlatform);
+                return { size: 0, capacity: 0, pushed: 0, overflow: 0 };
+            },
         }
     })();
     return Native;
@@ -557,6 +604,72 @@ export module HMC {
         time: number | null;   // 时间戳(最后写入时间)
     };
 
+    /**
+     * 异步执行器通道统计 (quick: 快速查询  long: 长耗时或阻塞的任务)
+     */
+    export type ExecutorLaneStats = {
+        /**当前线程数量 */
+        workers: number;
+        /**排队中的任务数量 */
+        depth: number;
+        /**执行中的任务数量 */
+        running: number;
+        /**历史最大排队数量 */
+        maxDepth: number;
+        /**提交的任务数量 */
+        submitted: number;
+        /**完成的任务数量 */
+        completed: number;
+        /**平均排队时间 (ms) */
+        avgWaitMs: number;
+        /**最大排队时间 (ms) */
+        maxWaitMs: number;
+        /**平均执行时间 (ms) */
+        avgRunMs: number;
+        /**最大执行时间 (ms) */
+        maxRunMs: number;
+    };
+
+    export type ExecutorOptions = {
+        /**快速查询通道的线程数量 默认 2 */
+        quickWorkers?: number;
+        /**长耗时通道的线程数量 默认 4 */
+        longWorkers?: number;
+        /**清空累计统计 */
+        resetStats?: boolean;
+    };
+
+    /**
+     * 进程树节点
+     */
+    export type ProcessTreeNode = {
+        pid: number;
+        ppid: number;
+        /**相对于起点的深度 (起点为 0) */
+        depth: number;
+        name: string;
+    };
+
+    /**
+     * 进程变化 (进程差异存储每次刷新的结果)
+     * - start 新启动的进程
+     * - exit 已退出的进程
+     * - change 线程数或者父进程发生变化
+     */
+    export type ProcessChange = {
+        type: "start" | "exit" | "change";
+        pid: number;
+        ppid: number;
+        threads: number;
+        /**进程创建时间 (时间戳 ms) 与 pid 一起唯一标识一个进程 */
+        createTime: number;
+        name: string;
+        /**变化前的父进程 (仅 change) */
+        lastPpid?: number;
+        /**变化前的线程数 (仅 change) */
+        lastThreads?: number;
+    };
+
     /**
      * （进程快照）PROCESSENTRY 结构体  它包含了进程的各种信息，如进程 ID、线程计数器、优先级等等
      */
@@ -1201,6 +1314,248 @@ export module HMC {
 
     export type PROCESSENTRY_V2 = HMC.PROCESSENTRY & { name: string, pid: number, ppid: number };
 
+    /**
+     * 插件返回列表的紧凑格式  [数值 (每行固定数量 连续存放), 字符串 (每行固定数量 连续存放)]
+     * 由 unpack* 函数组装为对象数组
+     */
+    export type PackedRows = [Float64Array, string[]];
+
+    /**
+     * 按列存放的进程表 (第 i 个进程的各项数据位于每一列的第 i 位)
+     */
+    export type ProcessTable = {
+        /**进程数量 */
+        length: number;
+        pid: Uint32Array;
+        ppid: Uint32Array;
+        /**线程数 */
+        threads: Uint32Array;
+        /**基本优先级 */
+        priority: Int32Array;
+        /**工作集 (字节) */
+        workingSet: Float64Array;
+        /**私有内存 (字节) */
+        privateBytes: Float64Array;
+        /**所有进程名首尾相连  第 i 个为 names.slice(nameOffsets[i], nameOffsets[i + 1]) */
+        names: string;
+        /**长度为 length + 1 */
+        nameOffsets: Uint32Array;
+    };
+
+    /**
+     * 截图的文件格式
+     * - bmp 24 位 不压缩
+     * - qoi 快速的无损压缩
+     * - png 无损压缩 (多线程)
+     */
+    export type ImageFormat = "bmp" | "qoi" | "png";
+
+    /**
+     * captureBmpToFile / captureBmpToBuff 的选项
+     */
+    export type CaptureImageOptions = {
+        /**文件格式  captureBmpToFile 默认按文件扩展名 (无法识别时为 bmp)  captureBmpToBuff 默认 bmp */
+        format?: ImageFormat;
+        /**png 压缩等级 1-9  越大文件越小 越慢  默认 3 */
+        level?: number;
+    };
+
+    /**
+     * captureScreenFrame 的截图
+     */
+    export type ScreenFrame = {
+        /**区域左上角 (屏幕坐标) */
+        x: number;
+        y: number;
+        width: number;
+        height: number;
+        /**自上而下逐行 每个像素 B G R A 四个字节  (new Uint32Array(data) 读取为 0xAARRGGBB) */
+        data: ArrayBuffer;
+    };
+
+    /**
+     * 连续截图的一次投递 (原生返回的格式)
+     */
+    export type CaptureStreamDelivery = {
+        /**第几帧 (从 1 开始) */
+        frame: number;
+        /**距离开始的毫秒数 */
+        timestamp: number;
+        /**截取的区域 (屏幕坐标) */
+        x: number;
+        y: number;
+        width: number;
+        height: number;
+        /**上一次投递之后 因回调未处理完而合并到本次的帧数 */
+        dropped: number;
+        /**每 4 个为一个矩形 [x, y, width, height] (相对于区域左上角) */
+        rects: Int32Array;
+        /**矩形的像素依次排列  每个矩形自上而下 每个像素 B G R A 四个字节 */
+        data: ArrayBuffer;
+    };
+
+    /**
+     * 连续截图中变化的块
+     */
+    export type CaptureStreamTile = {
+        /**相对于区域左上角 */
+        x: number;
+        y: number;
+        width: number;
+        height: number;
+        /**自上而下逐行 0xAARRGGBB */
+        pixels: Uint32Array;
+    };
+
+    /**
+     * 连续截图的变化
+     */
+    export type CaptureStreamFrame = CaptureStreamDelivery & {
+        /**变化的块 (同一行相邻的块合并为一个)  pixels 与 data 共享内存 */
+        tiles: CaptureStreamTile[];
+    };
+
+    /**
+     * 连续截图的计数
+     */
+    export type CaptureStreamStats = {
+        running: boolean;
+        /**已截取的帧数 */
+        frames: number;
+        /**已投递的次数 */
+        delivered: number;
+        /**有变化但回调还没处理完上一次投递  合并到之后投递的帧数 */
+        dropped: number;
+        /**截图与比较的时间超过帧间隔而跳过的帧数 */
+        overruns: number;
+        /**截图失败的帧数 */
+        failed: number;
+    };
+
+    /**
+     * findImage 的选项
+     */
+    export type ImageMatchOptions = {
+        /**最低得分 0-1 (1 - 平均每像素灰度差 / 255) 默认 0.95 */
+        threshold?: number;
+        /**模板的缩放比例 默认 [1] */
+        scales?: number[];
+        /**最多返回的数量 0 为不限 */
+        limit?: number;
+    };
+
+    /**
+     * findImage 的结果 (屏幕坐标)
+     */
+    export type ImageMatch = {
+        x: number;
+        y: number;
+        width: number;
+        height: number;
+        score: number;
+        /**命中的缩放比例 */
+        scale: number;
+    };
+
+    /**
+     * pixelSearch 的选项
+     */
+    export type PixelSearchOptions = {
+        /**每个颜色通道允许的误差 0-255 默认 0 */
+        tolerance?: number;
+        /**每隔多少个像素比较一次 (行与列) 默认 1 */
+        step?: number;
+        /**all 模式最多返回的数量 0 为不限 */
+        limit?: number;
+    };
+
+    /**
+     * findAllWindow 的匹配方式
+     * - exact 完全一致
+     * - prefix 以此开头
+     * - substring 包含
+     * - glob 通配符 (* ?)
+     * - regex ECMAScript 正则 (部分匹配)
+     */
+    export type WindowMatchOptions = {
+        mode?: "exact" | "prefix" | "substring" | "glob" | "regex";
+        /**最多返回的数量 0 为不限 */
+        limit?: number;
+    };
+
+    /**
+     * 窗口索引中的窗口信息
+     */
+    export type WindowIndexRecord = {
+        hwnd: number;
+        pid: number;
+        threadId: number;
+        /**所有者窗口 没有为 0 */
+        owner: number;
+        visible: boolean;
+        rect: { x: number, y: number, width: number, height: number };
+        className: string;
+        title: string;
+    };
+
+    /**
+     * 窗口索引的变化事件
+     */
+    export type WindowIndexEvent = {
+        type: "create" | "destroy" | "title" | "location" | "foreground" | "show" | "hide";
+        hwnd: number;
+    };
+
+    /**
+     * queryWindows 可获取的字段
+     */
+    export type WindowQueryField = "title" | "className" | "rect" | "style" | "exStyle" | "classStyle" | "pid" | "threadId" | "visible" | "minimized" | "owner";
+
+    /**
+     * 按列存放的窗口属性 (第 i 个窗口的各项数据位于每一列的第 i 位)  只包含请求的字段
+     */
+    export type WindowTable = {
+        /**窗口数量 */
+        length: number;
+        hwnd: Float64Array;
+        title?: string[];
+        className?: string[];
+        /**每个窗口 4 个值 [x, y, width, height] */
+        rect?: Int32Array;
+        /**GWL_STYLE */
+        style?: Uint32Array;
+        /**GWL_EXSTYLE */
+        exStyle?: Uint32Array;
+        /**GCL_STYLE (与 getWindowStyle 相同) */
+        classStyle?: Uint32Array;
+        pid?: Uint32Array;
+        threadId?: Uint32Array;
+        /**1 可见 */
+        visible?: Uint8Array;
+        /**1 最小化 */
+        minimized?: Uint8Array;
+        /**所有者窗口 没有为 0 */
+        owner?: Float64Array;
+    };
+
+    /**
+     * 进程加载的模块
+     */
+    export type ProcessModule = {
+        /**模块基址 */
+        base: number;
+        /**模块大小 (字节) */
+        size: number;
+        /**PE 头中的链接时间戳 (秒)  无法读取进程内存时为 0 */
+        timestamp: number;
+        /**模块路径 */
+        path: string;
+        /**模块文件名 */
+        name: string;
+        /**文件版本 "a.b.c.d"  未要求获取或没有版本信息时为空字符串 */
+        version: string;
+    };
+
     export interface PSYSTEM_PROCESS_INFORMATION {
         // 下一个结构体实例的偏移量，用于遍历多个结构体。
         NextEntryOffset: number;
@@ -1463,6 +1818,39 @@ export module HMC {
          * 获取所有窗口的句柄
          */
         getAllWindowsHandle(isWindows?: boolean): number[];
+        /**
+         * 批量获取窗口属性 (只获取请求的字段 按列返回)
+         * @param hwnds 窗口句柄数组 或 "all" / "visible" (顶层窗口)
+         * @param fields 需要的字段
+         */
+        queryWindows(hwnds: number[] | "all" | "visible", fields: HMC.WindowQueryField[]): HMC.WindowTable;
+        /**
+         * 启动窗口索引 (已启动时只更新回调)
+         * @param callback 变化事件 每个事件为 [type, hwnd] 两个值  type 1 创建 2 销毁 3 标题 4 位置 5 前台 6 显示 7 隐藏
+         * @returns 是否在运行
+         */
+        startWindowIndex(callback?: (events: Float64Array) => void): boolean;
+        /**停止窗口索引并清空 */
+        stopWindowIndex(): void;
+        /**窗口索引是否在运行 */
+        isWindowIndexRunning(): boolean;
+        /**
+         * 从窗口索引查找 (完全一致 不区分大小写)
+         * @param className 类名 null 为不限
+         * @param title 标题 null 为不限
+         * @param limit 最多返回的数量 0 为不限
+         */
+        windowIndexFind(className: string | null, title: string | null, limit?: number): number[];
+        /**窗口索引中的所有顶层窗口 (按近似 Z 序 新建与前台窗口在前) */
+        windowIndexList(visibleOnly?: boolean): number[];
+        /**窗口索引中进程的所有顶层窗口 */
+        windowIndexByPid(pid: number): number[];
+        /**窗口索引中进程的主窗口 没有为 0 */
+        windowIndexMainWindow(pid: number): number;
+        /**窗口索引中的窗口信息 */
+        windowIndexGet(hwnd: number): HMC.WindowIndexRecord | null;
+        /**窗口索引的状态 */
+        getWindowIndexStats(): { running: boolean, size: number, updates: number, pending: number, overflow: number };
         /**
          * 获取所有窗口的信息
          * @deprecated 已被移除 已使用js获取所有句柄模拟
@@ -1590,8 +1978,12 @@ export module HMC {
         unKeyboardHook(): void;
         /**
          * 启动键盘动作挂钩
+         * - 不传入回调时为轮询模式 由 getKeyboardNextSession 读取
+         * - 传入回调时为推送模式 每次回调一个 Uint32Array 每条记录占3位 [vkCode, flags, time]
+         * @param callback 推送回调
+         * @param options batchMs 合并时间窗口(默认16ms 0为立即投递)  maxBatch 单次投递最大条数(默认256)
          */
-        installKeyboardHook(): void;
+        installKeyboardHook(callback?: (records: Uint32Array) => void, options?: { batchMs?: number, maxBatch?: number }): void;
         /**
          * 获取已经记录了的低级鼠标动作数据 出于性能优化使用了(文本数组)
          */
@@ -1600,11 +1992,28 @@ export module HMC {
          * 键盘挂钩是否已经启用
          */
         isStartKeyboardHook(): boolean;
+        /**
+         * 键盘挂钩缓冲区状态
+         * - size 当前未读取的数量
+         * - capacity 缓冲区容量
+         * - pushed 已写入的总数
+         * - overflow 缓冲区满而丢弃的数量
+         */
+        getKeyboardHookStats(): { size: number, capacity: number, pushed: number, overflow: number };
         /**
          * 格式化 驱动器路径  ('\\Device\\HarddiskVolume2' => "D:\\")
          * @param VolumePath 
          */
         formatVolumePath(VolumePath: string): string;
+        /**
+         * 批量转换 NT 设备路径为 DOS 路径 (使用缓存的设备路径索引 驱动器变化时自动重建)
+         * - \\Device\\HarddiskVolume3\\a => C:\\a
+         * - \\Device\\Mup\\server\\share => \\\\server\\share
+         * - \\??\\C:\\a => C:\\a
+         * - 无法转换的路径原样返回
+         * @param paths 
+         */
+        translatePaths(paths: string | string[]): string[];
         /**
          * 获取当前文件系统的驱动器名称及路径
          */
@@ -1612,13 +2021,22 @@ export module HMC {
         /**
          * 内联 轮询枚举的进程句柄
          * @param enumID 枚举id 由enumProcessHandle 提供
+         * @returns done 为 true 时枚举已结束 (之后此id不再有数据)  并附带统计 stats
          */
-        enumProcessHandlePolling(enumID: number): void | ProcessHandle[];
+        enumProcessHandlePolling(enumID: number): { data: ProcessHandle[], done: boolean, stats?: ProcessHandleStats } | void;
         /**
          * 内联 枚举进程的所有句柄 并返回一个枚举id
          * @param ProcessID 
+         * @param onReadable 有新数据或者枚举结束时调用 (之后需要调用 enumProcessHandlePolling 取出)
+         * @param highWaterMark 未取出的数量达到此值时暂停枚举 默认1024 0为不限制
+         * @param nameTimeout 单个句柄获取名称的期限 (ms) 默认100
          */
-        enumProcessHandle(ProcessID: number): number;
+        enumProcessHandle(ProcessID: number, onReadable?: () => void, highWaterMark?: number, nameTimeout?: number): number;
+        /**
+         * 内联 放弃句柄枚举
+         * @param enumID 
+         */
+        closeEnumProcessHandle(enumID: number): void;
         /**
          * 查询进程加载的模块
          * @param ProcessID 
@@ -1651,18 +2069,32 @@ export module HMC {
         clearEnumAllProcessList(): void;
         /**
        * 内联 启动枚举进程快照 与句柄
+       * @param onReadable 有新数据或者枚举结束时调用 (之后需要调用 enumAllProcessPolling 取出)
+       * @param highWaterMark 未取出的数量达到此值时暂停枚举 默认1024 0为不限制
        */
-        enumAllProcess(): number;
+        enumAllProcess(onReadable?: () => void, highWaterMark?: number): number;
+        /**
+         * 内联 放弃进程快照枚举
+         * @param enumID 
+         */
+        closeEnumAllProcess(enumID: number): void;
         /**
          * 内联 枚举进程快照结果查询
          * @param enumID 枚举id
+         * @returns done 为 true 时枚举已结束 (之后此id不再有数据)
          */
-        enumAllProcessPolling(enumID: number): Array<HMC.PROCESSENTRY | void> | void;
+        enumAllProcessPolling(enumID: number): { data: HMC.PROCESSENTRY[], done: boolean } | void;
         /**
-         * 获取子进程id
+         * 获取所有后代进程id (子进程 孙进程 ...)
          * @param ProcessID 
          */
         getSubProcessID(ProcessID: number): number[];
+        /**
+         * 获取进程树 (广度优先)  不传 pid 时返回所有进程
+         * @param ProcessID 起点进程 (depth 为 0)
+         * @param maxDepth 最大深度 默认不限制
+         */
+        getProcessTree(ProcessID?: number | null, maxDepth?: number): HMC.ProcessTreeNode[];
         /**
          * 通过可执行文件或者带有图标的文件设置窗口图标
          * @param handle 句柄
@@ -1686,6 +2118,58 @@ export module HMC {
          * @param y 从上面开始的坐标
          */
         getColor(x: number, y: number): Color;
+        /**
+         * 批量获取屏幕上多个坐标的颜色 (只截取一次包含所有坐标的矩形)
+         * @param points 坐标 [x0, y0, x1, y1, ...]
+         * @returns 每个坐标一个 0xRRGGBB  不在屏幕范围内为 0xFFFFFFFF
+         */
+        getColors(points: number[]): Uint32Array;
+        /**
+         * 在屏幕区域内按颜色搜索 (区域只截取一次)
+         * @param region [x, y, width, height] 宽或高为 0 时为整个屏幕
+         * @param color 0xRRGGBB
+         * @param tolerance 每个颜色通道允许的误差 0-255
+         * @param step 每隔多少个像素比较一次
+         * @param mode first -> {x, y} | null  all -> Int32Array [x0, y0, ...]  count -> number
+         * @param limit all 模式最多返回的数量 0 为不限
+         */
+        pixelSearch(region: number[], color: number, tolerance: number, step: number, mode: "first", limit: number): { x: number, y: number } | null;
+        pixelSearch(region: number[], color: number, tolerance: number, step: number, mode: "all", limit: number): Int32Array;
+        pixelSearch(region: number[], color: number, tolerance: number, step: number, mode: "count", limit: number): number;
+        /**
+         * 在屏幕区域内查找模板图像
+         * @param needle needleWidth / needleHeight 大于 0 时为 BGRA 像素  否则为 BMP 文件内容
+         * @param region [x, y, width, height] 宽或高为 0 时为整个屏幕
+         * @param threshold 最低得分 0-1
+         * @param scales 模板的缩放比例
+         * @param limit 最多返回的数量 0 为不限
+         * @returns 每 6 个为一个结果 [x, y, width, height, score, scale]
+         */
+        findImage(needle: Uint8Array, needleWidth: number, needleHeight: number, region: number[], threshold: number, scales: number[], limit: number): Float64Array;
+        /**
+         * 截取屏幕区域  data 直接引用常驻的截图缓冲区 (不复制)
+         * @param x
+         * @param y
+         * @param width 宽或高为 0 时为整个屏幕
+         * @param height
+         */
+        captureScreenFrame(x: number, y: number, width: number, height: number): ScreenFrame | null;
+        /**
+         * 立即归还 captureScreenFrame 的缓冲区 (data 会被分离)
+         */
+        releaseScreenFrame(data: ArrayBuffer): boolean;
+        /**
+         * 开始连续截图  只投递与上一帧相比变化的 64x64 块
+         * @param region [x, y, width, height] 宽或高为 0 时为整个屏幕
+         * @param fps 每秒帧数
+         * @param callback 变化的块
+         * @returns 流的 id
+         */
+        startCaptureStream(region: number[], fps: number, callback: (frame: CaptureStreamDelivery) => void): number;
+        /**停止连续截图 */
+        stopCaptureStream(id: number): boolean;
+        /**连续截图的计数 */
+        getCaptureStreamStats(id: number): CaptureStreamStats | null;
         /**
          * 截屏指定的宽高坐标 并将其存储写入为文件 
          * @param FilePath 文件路径
@@ -1694,7 +2178,13 @@ export module HMC {
          * @param width 宽度
          * @param height 高度
          */
-        captureBmpToFile(FilePath: string, x: number | null | 0, y: number | null | 0, width: number | null | 0, height: number | null | 0): void;
+        captureBmpToFile(FilePath: string, x: number | null | 0, y: number | null | 0, width: number | null | 0, height: number | null | 0, format?: ImageFormat, level?: number): boolean;
+        /**
+         * 截屏指定的宽高坐标 并返回编码后的文件内容
+         * @param format 默认 bmp
+         * @param level png 压缩等级 1-9
+         */
+        captureBmpToBuff(x: number, y: number, width: number, height: number, format?: ImageFormat, level?: number): Uint8Array | null;
         /**
          * 响应标准快捷键
          */
@@ -1742,10 +2232,11 @@ export module HMC {
          * 通过标题或类名搜索所有窗口句柄
          * @param className 类名
          * @param titleName 标题
-         * @param isWindow 是否要求为窗口(忽略子组件) 默认 true
-         * @param isCaseSensitive 忽略区分大小写 默认 true
+         * @param isWindow 只要可见的窗口 默认 true
+         * @param isCaseSensitive 区分大小写 默认 false
+         * @param options 匹配方式与数量上限
          */
-        findAllWindow(className: string | null, titleName: string | null, isWindow: boolean | null, isCaseSensitive: boolean | null): number[];
+        findAllWindow(className: string | null, titleName: string | null, isWindow: boolean | null, isCaseSensitive: boolean | null, options?: HMC.WindowMatchOptions): number[];
         /**
          * 通过标题或类名搜索窗口句柄
          * @param className 类名
@@ -1957,7 +2448,7 @@ export module HMC {
          * @param is_execPath 需要解析可执行文件路径 (获取延时50ms左右)
          * @returns 
          */
-        getAllProcessList: (is_execPath?: boolean) => Promise<string> | number;
+        getAllProcessList: (is_execPath?: boolean) => Promise<HMC.PackedRows>;
         /**
          * 获取进程列表（枚举法）
          * - 枚举是最快的 最安全的 不会出现遗漏
@@ -1966,7 +2457,7 @@ export module HMC {
          * @param is_execPath 需要解析可执行文件路径 (获取延时50ms左右)
          * @returns 
          */
-        getAllProcessListSync: (is_execPath?: boolean) => string;
+        getAllProcessListSync: (is_execPath?: boolean) => HMC.PackedRows;
         /**
          * 获取进程列表 (快照法)  
          * - (一般用来枚举进程树)
@@ -1975,7 +2466,7 @@ export module HMC {
          * @time 66.428ms
          * @returns 
          */
-        getAllProcessListSnp: () => Promise<string> | number;
+        getAllProcessListSnp: () => Promise<HMC.PackedRows>;
         /**
          * 获取进程列表 (快照法)  
          * - (一般用来枚举进程树)
@@ -1984,7 +2475,7 @@ export module HMC {
          * @time 66.428ms
          * @returns 
          */
-        getAllProcessListSnpSync: () => string;
+        getAllProcessListSnpSync: () => HMC.PackedRows;
         /**
          * 获取进程列表 (内核法)
          * - (可以获取内核软件和系统服务的名称)
@@ -1994,7 +2485,7 @@ export module HMC {
          * @time 30.542ms
          * @returns 
          */
-        getAllProcessListNt: () => Promise<string> | number;
+        getAllProcessListNt: () => Promise<HMC.PackedRows>;
         /**
          * 获取进程列表 (内核法)
          * - (可以获取内核软件和系统服务的名称)
@@ -2004,21 +2495,97 @@ export module HMC {
          * @time 30.542ms
          * @returns 
          */
-        getAllProcessListNtSync: () => string;
+        getAllProcessListNtSync: () => HMC.PackedRows;
+        /**
+         * 获取按列存放的进程表 (一次快照)
+         * @module 异步
+         */
+        getProcessTable(): Promise<HMC.ProcessTable | null>;
+        /**
+         * 获取按列存放的进程表 (一次快照)
+         * @module 同步
+         */
+        getProcessTableSync(): HMC.ProcessTable | null;
+        /**
+         * 获取进程加载的模块  [数值 [base, size, timestamp], 字符串 [path, name, version]]
+         * @module 异步
+         * @param pid 
+         * @param withVersion 是否获取文件版本
+         */
+        getProcessModules(pid: number, withVersion?: boolean): Promise<HMC.PackedRows | null>;
+        /**
+         * 获取进程加载的模块  [数值 [base, size, timestamp], 字符串 [path, name, version]]
+         * @module 同步
+         * @param pid 
+         * @param withVersion 是否获取文件版本
+         */
+        getProcessModulesSync(pid: number, withVersion?: boolean): HMC.PackedRows | null;
+        /**
+         * 查找打开了指定路径 (文件 或 目录中的文件) 的句柄  只获取一次系统句柄快照
+         * @module 异步
+         * @param paths 
+         * @param timeout 单个句柄获取名称的期限 (ms) 默认100
+         */
+        findHandlesByPath(paths: string | string[], timeout?: number): Promise<{ matches: HMC.FileHandleMatch[], stats: HMC.ProcessHandleStats } | null>;
         /**
-         * 获取指定进程的cpu百分比 (10% -> 10.02515102152)
+         * 查找打开了指定路径 (文件 或 目录中的文件) 的句柄  只获取一次系统句柄快照
+         * @module 同步
+         * @param paths 
+         * @param timeout 单个句柄获取名称的期限 (ms) 默认100
+         */
+        findHandlesByPathSync(paths: string | string[], timeout?: number): { matches: HMC.FileHandleMatch[], stats: HMC.ProcessHandleStats } | null;
+        /**
+         * 获取指定进程的cpu百分比 (10% -> 10.02515102152)  进程不存在时为 -1
+         * @description 读取后台采样器(每秒一次)的最近结果  采样器首次启动时需要等待约 250ms
          * @module 异步  
-         * @time 1000ms+
          * @param pid 
          */
         getProcessCpuUsage(pid: number): Promise<number>;
         /**
-         * 获取指定进程的cpu百分比 (10% -> 10.02515102152)
+         * 获取指定进程的cpu百分比 (10% -> 10.02515102152)  进程不存在时为 -1
+         * @description 读取后台采样器(每秒一次)的最近结果  采样器首次启动时会阻塞约 250ms
          * @module 同步 
-         * ! 请注意此函数会阻塞进程最少1000ms 因为运算cpu占比需要一秒内进行两次对比
          * @param pid 进程id
          */
         getProcessCpuUsageSync(pid: number): number;
+        /**
+         * 获取所有进程的cpu百分比
+         * @description 读取后台采样器(每秒一次)的最近结果 30秒内没有查询时采样器会自动停止
+         * @module 异步
+         */
+        getAllProcessCpuUsage(): Promise<{ pid: number, usage: number }[]>;
+        /**
+         * 获取所有进程的cpu百分比
+         * @module 同步
+         */
+        getAllProcessCpuUsageSync(): { pid: number, usage: number }[];
+        /**
+         * 获取指定进程最近的cpu百分比采样 (每秒一次 从旧到新 最多60个)  进程不存在时为 null
+         * @param pid 进程id
+         */
+        getProcessCpuUsageHistory(pid: number): number[] | null;
+        /**
+         * 创建进程差异存储 (立即记录当前进程列表作为基准)
+         * @returns 存储id 失败为 0
+         */
+        createProcessDiffStore(): number;
+        /**
+         * 释放进程差异存储
+         * @param id 存储id
+         */
+        closeProcessDiffStore(id: number): boolean;
+        /**
+         * 重新获取进程列表 只返回与上一次相比的变化  存储不存在时为 null
+         * @module 异步
+         * @param id 存储id
+         */
+        refreshProcessDiffStore(id: number): Promise<HMC.ProcessChange[] | null>;
+        /**
+         * 重新获取进程列表 只返回与上一次相比的变化  存储不存在时为 null
+         * @module 同步
+         * @param id 存储id
+         */
+        refreshProcessDiffStoreSync(id: number): HMC.ProcessChange[] | null;
         /**
          * 获取指定进程的文件路径
          * @module 异步 
@@ -2100,6 +2667,14 @@ export module HMC {
          * @param pid 
          */
         getProcessCwdSync(pid: number): string;
+        /**
+         * 获取异步执行器的队列深度与延迟统计 (异步函数使用插件独立的线程 不占用 libuv 线程池)
+         */
+        getExecutorStats(): { quick: HMC.ExecutorLaneStats, long: HMC.ExecutorLaneStats };
+        /**
+         * 设置异步执行器的线程数量
+         */
+        setExecutorOptions(options: HMC.ExecutorOptions): void;
         /**
          * 获取注册表值
          */
@@ -2134,7 +2709,7 @@ export module HMC {
          * @param Hive 
          * @param folderPath 
          */
-        getRegistrFolderStat(Hive: HMC.HKEY, folderPath: string, is_enum?: boolean): string | null;
+        getRegistrFolderStat(Hive: HMC.HKEY, folderPath: string, is_enum?: boolean): (HMC.RegistrFolderStat & { key: string[], folder: string[] }) | null;
         /**
          * 删除目录
          * @param Hive 
@@ -2176,6 +2751,44 @@ export module HMC {
         type: "ALPC Port" | "Event" | "Timer" | "Mutant" | "Key" | "Section" | "File" | "Thread" | string;
     };
 
+    /**
+     * 打开了指定路径的文件句柄
+     */
+    export type FileHandleMatch = {
+        /**对应查询路径的序号 */
+        index: number;
+        /**打开此文件的进程 */
+        pid: number;
+        /**句柄 (位于 pid 进程中) */
+        handle: number;
+        /**打开的文件路径 */
+        path: string;
+    };
+
+    /**
+     * findHandlesByPath 的结果
+     */
+    export type FindHandlesResult = {
+        matches: FileHandleMatch[];
+        /**打开了这些路径的进程 (去重) */
+        pids: number[];
+        stats: ProcessHandleStats;
+    };
+
+    /**
+     * 句柄枚举的统计 (枚举结束时提供)
+     */
+    export type ProcessHandleStats = {
+        /**目标进程的句柄数量 */
+        handles: number;
+        /**获取名称超时的数量 (这些句柄的 name 为空) */
+        timeouts: number;
+        /**已知会阻塞 (同步管道) 而跳过获取名称的数量 */
+        skipped: number;
+        /**耗时 (ms) */
+        elapsed: number;
+    };
+
     export type Volume = {
         // 真实的文件路径  例如： 'D:\\' 
         path: string;
@@ -2675,13 +3288,14 @@ export class PromiseSession {
         const this_ = this;
         return new Promise(function (resolve, reject) {
             try {
-                setInterval(() => {
+                const timer = setInterval(() => {
                     const temp = native._PromiseSession_get(this_.SessionID, 50);
                     for (let index = 0; index < (temp || []).length; index++) {
                         const element = (temp || [])[index];
                         this_.data_list.push(element);
                     }
                     if (!temp && native._PromiseSession_isClosed(this_.SessionID)) {
+                        clearInterval(timer);
                         resolve(format(this_.data_list));
                     }
                 }, 25);
@@ -2701,7 +3315,7 @@ export class PromiseSession {
     public to_callback<T>(format: (value: Array<undefined | null | any>) => T, callback?: (value: T) => any, everyCallback?: boolean) {
         try {
             const this_ = this;
-            setInterval(() => {
+            const timer = setInterval(() => {
                 const temp = native._PromiseSession_get(this_.SessionID, 50);
                 for (let index = 0; index < (temp || []).length; index++) {
                     const element = (temp || [])[index];
@@ -2716,6 +3330,7 @@ export class PromiseSession {
                 }
 
                 if (!temp && native._PromiseSession_isClosed(this_.SessionID)) {
+                    clearInterval(timer);
                     if (everyCallback) {
                         if (callback) {
                             callback(format(this_.data_list));
@@ -2757,6 +3372,124 @@ export class PromiseSession {
     }
 }
 
+// 没有结束就被回收的游标 放弃对应的原生查询 (FinalizationRegistry 需要 Node 14.6+)
+const cursorFinalizer = typeof FinalizationRegistry == "function" ? new FinalizationRegistry<() => void>(close => close()) : null;
+
+// 原生回调只能弱引用游标 否则 threadsafe_function 持有的回调会让游标永远不能被回收
+function weakCursor<T extends object>(target: T): { deref(): T | undefined } {
+    return typeof WeakRef == "function" ? new WeakRef(target) : { deref: () => target };
+}
+
+/**
+ * 原生流式查询的游标 (异步迭代器)
+ * 原生线程有新数据时通过 threadsafe_function 通知 不需要定时轮询
+ * 未取出的数量达到 highWaterMark 时原生线程会暂停 直到被取出
+ * 通知不会阻止进程退出  只有等待 next() 时才保持事件循环  丢弃的游标在被回收时结束查询
+ * ```ts
+ * for await (const item of enumAllProcessIterator()) { ... }
+ * ```
+ */
+export class NativeCursor<T, S = void> implements AsyncIterableIterator<T> {
+    /**结束时原生查询附带的统计 (支持的查询才有) */
+    public stats: S | null = null;
+    private buffer: T[] = [];
+    private index = 0;
+    private done = false;
+    private readable = false;
+    private waiter: null | (() => void) = null;
+    private readonly id: number;
+    private readonly poll: (id: number) => { data: T[], done: boolean, stats?: S } | void;
+    private readonly close: (id: number) => void;
+
+    /**
+     * @param open 启动原生查询 返回查询id
+     * @param poll 取出查询结果
+     * @param close 放弃查询
+     */
+    constructor(open: (onReadable: () => void) => number, poll: (id: number) => { data: T[], done: boolean, stats?: S } | void, close: (id: number) => void) {
+        this.poll = poll;
+        this.close = close;
+        const target = weakCursor(this);
+        this.id = open(() => target.deref()?.wake());
+        if (typeof this.id != "number") throw new Error("No enumerated id to query unknown error");
+        const id = this.id;
+        cursorFinalizer?.register(this, () => close(id), this);
+    }
+
+    // 原生通知有新数据或者已结束
+    private wake() {
+        this.readable = true;
+        const waiter = this.waiter;
+        this.waiter = null;
+        if (waiter) waiter();
+    }
+
+    // 查询已结束 不再需要回收时放弃
+    private finish() {
+        this.done = true;
+        cursorFinalizer?.unregister(this);
+    }
+
+    // 取出原生缓冲区中的数据
+    private pull() {
+        this.readable = false;
+        const result = this.poll(this.id);
+        if (!result) {
+            this.finish();
+            return;
+        }
+        this.buffer = result.data;
+        this.index = 0;
+        if (result.stats) this.stats = result.stats;
+        if (result.done) this.finish();
+    }
+
+    public async next(): Promise<IteratorResult<T>> {
+        while (true) {
+            if (this.index < this.buffer.length) {
+                return { value: this.buffer[this.index++], done: false };
+            }
+            if (this.done) {
+                this.buffer = [];
+                return { value: undefined, done: true };
+            }
+            this.pull();
+            if (this.index < this.buffer.length || this.done || this.readable) continue;
+            // threadsafe_function 已 unref  等待期间用定时器保持事件循环
+            const keepAlive = setInterval(() => { }, 0x7fffffff);
+            try {
+                await new Promise<void>(resolve => this.waiter = resolve);
+            } finally {
+                clearInterval(keepAlive);
+            }
+        }
+    }
+
+    public async return(): Promise<IteratorResult<T>> {
+        if (!this.done) {
+            this.finish();
+            this.close(this.id);
+        }
+        this.buffer = [];
+        return { value: undefined, done: true };
+    }
+
+    /**
+     * 读取全部结果
+     */
+    public async toArray(): Promise<T[]> {
+        const result: T[] = [];
+        for await (const item of this) {
+            result.push(item);
+        }
+        return result;
+    }
+
+    [Symbol.asyncIterator]() {
+        return this;
+    }
+}
+
 // 初始化一个v2 接口的sp对象 并且将其转为callback或者Promise (js标准)
 export function PromiseSP<T>(SessionID: number | Promise<any>, format: ((value: Array<undefined | null | any>) => T), Callback: undefined | ((error: null | Error, ...args: any[]) => any)): void;
 export function PromiseSP<T>(SessionID: number | Promise<any>, format: ((value: Array<undefined | null | any>) => T)): Promise<T>;
@@ -3035,13 +3768,13 @@ export function getRegistrBuffValue(HKEY: HMC.HKEY, Path: string, key: string) {
 export function enumRegistrKey(HKEY: HMC.HKEY, Path: string) {
     has_reg_args(HKEY, Path, "enumRegistrKey");
     let enumKeyList: Set<string> = new Set();
-    let NatenumKey = JSON.parse(native.getRegistrFolderStat(
+    let NatenumKey = (native.getRegistrFolderStat(
         HKEY,
         ref
             .string(Path)
             .split(/[\\\/]+/g)
             .join("\\"), true
-    ) || "{}") as HMC.RegistrFolderStat;
+    ) || {}) as HMC.RegistrFolderStat;
     const key_list = [...NatenumKey.folder || [], ...NatenumKey.key || []];
 
     for (let index = 0; index < key_list.length; index++) {
@@ -3424,8 +4157,7 @@ export function getRegistrFolderStat(Hive: HMC.HKEY, folderPath: string): HMC.Re
  * @returns 
  */
 export function getRegistrFolderStat(Hive: HMC.HKEY, folderPath: unknown, enumKey?: unknown): unknown {
-    const data = native.getRegistrFolderStat(ref.string(Hive) as HMC.HKEY, ref.string(folderPath), enumKey ? true : false);
-    return data ? JSON.parse(data) : null;
+    return native.getRegistrFolderStat(ref.string(Hive) as HMC.HKEY, ref.string(folderPath), enumKey ? true : false) || null;
 }
 
 
@@ -3708,6 +4440,48 @@ export function watchUSB(CallBack: (env: "add" | "remove" | "start", id: string)
     }
 }
 
+/**
+ * 当进程启动 退出 或者线程数/父进程变化时发生回调
+ * @description 差异在插件内计算 (以 pid + 创建时间 识别进程 pid 被复用也能正确区分)  只有变化的进程会传递到js
+ * @param CallBack 回调函数
+ * @param nextAwaitMs 每次刷新的间隔 默认 `1000` ms
+ * @returns 
+ */
+export function watchProcessChange(CallBack: (change: HMC.ProcessChange) => void, nextAwaitMs?: number) {
+    let NextAwaitMs = nextAwaitMs || 1000;
+    let Next = true;
+    let storeID = native.createProcessDiffStore();
+    (async function () {
+        while (Next && storeID) {
+            await Sleep(NextAwaitMs);
+            if (!Next) break;
+            let changeList = await native.refreshProcessDiffStore(storeID);
+            if (!changeList) continue;
+            for (let index = 0; index < changeList.length; index++) {
+                if (!Next) break;
+                CallBack && CallBack(changeList[index]);
+            }
+        }
+        if (storeID) native.closeProcessDiffStore(storeID);
+        storeID = 0;
+    })();
+    return {
+        /**
+         * 取消继续监听
+         */
+        unwatcher() {
+            Next = false;
+        },
+        /**
+         * 每次刷新的间隔 默认 `1000` ms
+         * @param nextAwaitMs 
+         */
+        setNextAwaitMs(nextAwaitMs: number) {
+            NextAwaitMs = ref.int(nextAwaitMs) || 1000;
+        }
+    }
+}
+
 /**
  * 获取所有屏幕
  * @returns 
@@ -3850,23 +4624,137 @@ export function getAllWindowsHandle(isWindows: boolean) {
 }
 
 /**
- * 进程监听 当该进程被关闭的时候执行回调
- * @param ProcessID 进程id
- * @param callback 回调函数
- * @param awaitMs 每次执行的延迟事件
- * @default awaitMs 500
+ * 批量获取窗口属性
+ * - 一次调用获取所有窗口的指定字段 (取代逐个窗口调用 标题/类名/位置/pid 等接口)
+ * - 结果按列存放 第 i 个窗口的数据位于每一列的第 i 位  rect 每个窗口占 4 位
  * @example ```javascript
- * hmc_win32.processWatchdog(4836,()=>console.log("进程已经退出。。。"));
- * hmc_win32.sleep(2836);
- * hmc_win32.killProcess(4836);
+ * const table = hmc.queryWindows("visible", ["title", "pid"]);
+ * for (let i = 0; i < table.length; i++) {
+ *     console.log(table.hwnd[i], table.pid[i], table.title[i]);
+ * }
  * ```
- * @returns 包含一个quit函数(结束监听)的异步或对象
+ * @param hwnds 窗口句柄数组 或 "all" (所有顶层窗口) / "visible" (可见的顶层窗口)
+ * @param fields 需要的字段
+ * @returns 
  */
-export function processWatchdog(ProcessID: number, callback?: (() => void) | number, awaitMs?: number) {
-    let quit = false;
-    if (!callback) {
-        let Prom: Promise<void> & { quit: () => void } = new Promise(
-            async (resolve, reject) => {
+export function queryWindows(hwnds: number[] | "all" | "visible", fields: HMC.WindowQueryField[]): HMC.WindowTable {
+    const hwnd_list = Array.isArray(hwnds) ? hwnds.map(hwnd => ref.int(hwnd)) : (hwnds == "visible" ? "visible" : "all");
+    return native.queryWindows(hwnd_list, fields.map(field => ref.string(field)) as HMC.WindowQueryField[]);
+}
+
+const WINDOW_INDEX_EVENT_TYPE: HMC.WindowIndexEvent["type"][] = ["create", "create", "destroy", "title", "location", "foreground", "show", "hide"];
+
+/**
+ * 启动常驻内存的窗口索引
+ * - 启动时获取一次所有顶层窗口 之后由 WinEvent 钩子 (独立线程) 保持更新
+ * - 运行期间 findWindow / getAllWindows / getProcessMainWindow 直接从索引返回 不再遍历桌面
+ * - 再次调用只更新监听函数
+ * @example ```javascript
+ * hmc.startWindowIndex((events) => {
+ *     for (const event of events) console.log(event.type, event.hwnd);
+ * });
+ * ```
+ * @param listener 变化事件 (同一批事件合并为一次回调)
+ * @returns 是否启动成功
+ */
+export function startWindowIndex(listener?: (events: HMC.WindowIndexEvent[]) => void): boolean {
+    if (typeof listener !== "function") {
+        return native.startWindowIndex();
+    }
+    return native.startWindowIndex((records: Float64Array) => {
+        const events: HMC.WindowIndexEvent[] = new Array(records.length / 2);
+        for (let index = 0; index < events.length; index++) {
+            events[index] = {
+                type: WINDOW_INDEX_EVENT_TYPE[records[index * 2]] || "create",
+                hwnd: records[index * 2 + 1],
+            };
+        }
+        listener(events);
+    });
+}
+
+/**
+ * 停止窗口索引 (释放钩子与内存)
+ */
+export function stopWindowIndex() {
+    return native.stopWindowIndex();
+}
+
+/**
+ * 窗口索引是否在运行
+ */
+export function isWindowIndexRunning() {
+    return native.isWindowIndexRunning();
+}
+
+/**
+ * 窗口索引的状态
+ * - size 窗口数量
+ * - updates 已处理的事件数量
+ * - pending 未读取的推送事件
+ * - overflow 推送缓冲区满而丢弃的数量
+ */
+export function getWindowIndexStats() {
+    return native.getWindowIndexStats();
+}
+
+/**
+ * 从窗口索引读取窗口信息 (不访问目标窗口)
+ * @param Handle 句柄
+ * @returns 索引未运行或没有记录时为 null
+ */
+export function getIndexedWindow(Handle: number | HWND) {
+    return native.windowIndexGet(ref.int(Handle));
+}
+
+/**
+ * 获取进程的主窗口 (可见 没有所有者 优先前台窗口 其次有标题且面积最大的)
+ * - 窗口索引运行时直接从索引返回
+ * @param ProcessID 进程id
+ * @returns 一个可以操作的伪数字类
+ */
+export function getProcessMainWindow(ProcessID: number) {
+    let Handle = 0;
+    if (native.isWindowIndexRunning()) {
+        Handle = native.windowIndexMainWindow(ref.int(ProcessID));
+    } else {
+        const table = native.queryWindows("visible", ["pid", "owner", "title", "rect"]);
+        const foreground = native.getForegroundWindow();
+        let best_score = -1;
+        for (let index = 0; index < table.length; index++) {
+            if (table.pid![index] != ProcessID || table.owner![index]) continue;
+            if (table.hwnd[index] == foreground) {
+                Handle = foreground;
+                break;
+            }
+            const score = (table.title![index] ? 2 ** 48 : 0) + Math.max(table.rect![index * 4 + 2] * table.rect![index * 4 + 3], 0);
+            if (score > best_score) {
+                best_score = score;
+                Handle = table.hwnd[index];
+            }
+        }
+    }
+    return Handle ? new HWND(Handle) : null;
+}
+
+/**
+ * 进程监听 当该进程被关闭的时候执行回调
+ * @param ProcessID 进程id
+ * @param callback 回调函数
+ * @param awaitMs 每次执行的延迟事件
+ * @default awaitMs 500
+ * @example ```javascript
+ * hmc_win32.processWatchdog(4836,()=>console.log("进程已经退出。。。"));
+ * hmc_win32.sleep(2836);
+ * hmc_win32.killProcess(4836);
+ * ```
+ * @returns 包含一个quit函数(结束监听)的异步或对象
+ */
+export function processWatchdog(ProcessID: number, callback?: (() => void) | number, awaitMs?: number) {
+    let quit = false;
+    if (!callback) {
+        let Prom: Promise<void> & { quit: () => void } = new Promise(
+            async (resolve, reject) => {
                 while (true) {
                     if (quit) break;
                     await Sleep(awaitMs || 500);
@@ -4958,7 +5846,7 @@ export function getAllWindows(isWindows: boolean, initialize: boolean) {
         }
     }
 
-    let AllWindowsHandle = native.getAllWindowsHandle(isWindows === false ? false : true);
+    let AllWindowsHandle = native.isWindowIndexRunning() ? native.windowIndexList(isWindows === false ? false : true) : native.getAllWindowsHandle(isWindows === false ? false : true);
     let AllWindows: HMC.GET_ALL_WINDOWS_INFO[] = [];
     for (let index = 0; index < AllWindowsHandle.length; index++) {
         const handle = AllWindowsHandle[index];
@@ -5181,14 +6069,24 @@ export function hasPortUDP(port: number, callBack?: (hasPort: boolean) => unknow
  */
 export function formatVolumePath(VolumePath: string) {
     if (VolumePath && VolumePath?.match(/^\\/)) {
-        for (let Volume of hmc.getVolumeList()) {
-            if (VolumePath.indexOf(Volume.device) == 0) {
-                return VolumePath.replace(Volume.device, Volume.path).replace(/[\\/]+/, "\\");
-            }
-        }
+        return native.translatePaths(ref.string(VolumePath))[0];
     } else return VolumePath;
 }
 
+/**
+ * 批量转换 NT 设备路径为 DOS 路径 (句柄名 模块路径 进程路径等)
+ * - '\Device\HarddiskVolume3\a.txt' => "C:\a.txt"
+ * - '\Device\Mup\server\share' => "\\server\share"
+ * - 设备路径索引会被缓存 驱动器或卷变化时自动重建
+ * - 无法转换的路径原样返回
+ * @param paths 路径或路径数组
+ * @returns 与输入顺序一致的路径数组
+ */
+export function translatePaths(paths: string | string[]): string[] {
+    const path_list = (Array.isArray(paths) ? paths : [paths]).map(path => ref.string(path));
+    return native.translatePaths(path_list);
+}
+
 /**
  * 获取当前文件系统的驱动器名称及路径
  * @returns 
@@ -5228,47 +6126,33 @@ export function enumProcessHandle(ProcessID: number, CallBack: (PHandle: HMC.Pro
  * @returns 
  */
 export function enumProcessHandle(ProcessID: number, CallBack?: (PHandle: HMC.ProcessHandle) => void) {
-    let enumID = native.enumProcessHandle(ref.int(ProcessID));
-    let next = true;
-    let enumProcessHandleList: HMC.ProcessHandle[] = [];
-    if (typeof enumID != "number") throw new Error("No enumerated id to query unknown error");
+    const cursor = enumProcessHandleIterator(ProcessID);
     if (typeof CallBack == "function") {
         ; (async () => {
-            while (next) {
-                await Sleep(50);
-                let data = native.enumProcessHandlePolling(enumID);
-                if (data) {
-                    for (let index = 0; index < data.length; index++) {
-                        const enumProcessHandle = data[index];
-                        if (!enumProcessHandle) continue;
-                        if (enumProcessHandle.type == 'hmc::endl::') {
-                            return;
-                        }
-                        CallBack(enumProcessHandle);
-                    }
-                }
+            for await (const PHandle of cursor) {
+                CallBack(PHandle);
             }
         })();
         return;
     }
-    return new Promise(async (resolve, reject) => {
-        while (next) {
-            await Sleep(50);
-            let data = native.enumProcessHandlePolling(enumID);
-            if (data) {
-                for (let index = 0; index < data.length; index++) {
-                    const enumProcessHandle = data[index];
-                    if (!enumProcessHandle) continue;
-                    if (enumProcessHandle.type == 'hmc::endl::') {
-                        return resolve(enumProcessHandleList);
-                    }
-                    enumProcessHandleList.push(enumProcessHandle);
-                }
-            }
-        }
-        resolve(enumProcessHandleList);
-    });
+    return cursor.toArray();
+}
 
+/**
+ * 枚举进程id的句柄 (异步迭代器)
+ * - 句柄名称并行获取 结果按获取完成的顺序输出
+ * - 结束后可以从 cursor.stats 读取统计 (超时 / 跳过的数量 耗时)
+ * @param ProcessID 被枚举的进程id
+ * @param highWaterMark 未读取的数量达到此值时暂停枚举 默认1024
+ * @param nameTimeout 单个句柄获取名称的期限 (ms) 默认100
+ * @returns 
+ */
+export function enumProcessHandleIterator(ProcessID: number, highWaterMark: number = 1024, nameTimeout: number = 100) {
+    return new NativeCursor<HMC.ProcessHandle, HMC.ProcessHandleStats>(
+        onReadable => native.enumProcessHandle(ref.int(ProcessID), onReadable, ref.int(highWaterMark), ref.int(nameTimeout)),
+        id => native.enumProcessHandlePolling(id),
+        id => native.closeEnumProcessHandle(id)
+    );
 }
 /**
 * 枚举进程的线程id
@@ -5300,7 +6184,7 @@ export function getProcessThreadList(ProcessID: unknown, returnDetail?: unknown)
 }
 
 /**
- * 获取所有该进程下的 子进程id
+ * 获取所有该进程下的 子进程id (包含孙进程等所有后代)
  * @param ProcessID 进程id
  * @returns 
  */
@@ -5308,6 +6192,18 @@ export function getSubProcessID(ProcessID: number) {
     return native.getSubProcessID(ref.int(ProcessID)) || [];
 }
 
+/**
+ * 获取进程树 (广度优先 一次快照建立索引)
+ * @param ProcessID 起点进程id  不传时返回所有进程 (从没有存活父进程的进程开始)
+ * @param maxDepth 最大深度 默认不限制
+ * @returns 
+ */
+export function getProcessTree(ProcessID?: number | null, maxDepth?: number): HMC.ProcessTreeNode[] {
+    let pid = typeof ProcessID == "number" ? ref.int(ProcessID) : null;
+    let depth = typeof maxDepth == "number" ? ref.int(maxDepth) : -1;
+    return native.getProcessTree(pid, depth) || [];
+}
+
 /**
  * 获取进程id的主进程
  * @param ProcessID 进程id
@@ -5324,47 +6220,29 @@ export function getProcessParentProcessID(ProcessID: number, is_SessionCache: bo
  * @returns 
  */
 export function enumAllProcessHandle(CallBack?: (PHandle: HMC.PROCESSENTRY) => void) {
-    let enumID = native.enumAllProcess();
-    let next = true;
-    let PROCESSENTRYLIST: HMC.PROCESSENTRY[] = [];
-    if (typeof enumID != "number") throw new Error("No enumerated id to query unknown error");
+    const cursor = enumAllProcessIterator();
     if (typeof CallBack == "function") {
         ; (async () => {
-            while (next) {
-                await Sleep(15);
-                let data = native.enumAllProcessPolling(enumID);
-                if (data) {
-                    for (let index = 0; index < data.length; index++) {
-                        const PROCESSENTRY = data[index];
-                        if (!PROCESSENTRY) continue;
-                        if (PROCESSENTRY.szExeFile == 'HMC::endl::') {
-                            return;
-                        }
-                        CallBack(PROCESSENTRY);
-                    }
-                }
+            for await (const PROCESSENTRY of cursor) {
+                CallBack(PROCESSENTRY);
             }
         })();
         return;
     }
-    return new Promise(async (resolve, reject) => {
-        while (next) {
-            await Sleep(50);
-            let data = native.enumAllProcessPolling(enumID);
-            if (data) {
-                for (let index = 0; index < data.length; index++) {
-                    const PROCESSENTRY = data[index];
-                    if (!PROCESSENTRY) continue;
-                    if (PROCESSENTRY.szExeFile == 'HMC::endl::') {
-                        return resolve(PROCESSENTRYLIST);
-                    }
-                    PROCESSENTRYLIST.push(PROCESSENTRY);
-                }
-            }
-        }
-        resolve(PROCESSENTRYLIST);
-    });
+    return cursor.toArray();
+}
 
+/**
+ * 枚举所有进程 (异步迭代器)
+ * @param highWaterMark 未读取的数量达到此值时暂停枚举 默认1024
+ * @returns 
+ */
+export function enumAllProcessIterator(highWaterMark: number = 1024) {
+    return new NativeCursor<HMC.PROCESSENTRY>(
+        onReadable => native.enumAllProcess(onReadable, ref.int(highWaterMark)),
+        id => native.enumAllProcessPolling(id),
+        id => native.closeEnumAllProcess(id)
+    );
 }
 
 
@@ -5443,7 +6321,8 @@ export const Watch = {
     usb: watchUSB,
     windowFocus: WatchWindowForeground,
     windowPoint: WatchWindowPoint,
-    process: processWatchdog
+    process: processWatchdog,
+    processChange: watchProcessChange,
 }
 
 // 剪贴板工具集  (拥有统一化名称)
@@ -5740,10 +6619,17 @@ class Keyboard {
      * 键值代码
      */
     keyCode: VK_keyCode;
-    constructor(str: `${number}|${0 | 1}`) {
-        const data = str.split("|");
-        this.vKey = Number(data[0]);
-        this.__isDown = Number(data[1]) ? true : false;
+    constructor(str: `${number}|${0 | 1}`);
+    constructor(vKey: number, isDown: boolean);
+    constructor(str: unknown, isDown?: boolean) {
+        if (typeof str === "number") {
+            this.vKey = str;
+            this.__isDown = isDown ? true : false;
+        } else {
+            const data = String(str).split("|");
+            this.vKey = Number(data[0]);
+            this.__isDown = Number(data[1]) ? true : false;
+        }
         let KeyboardcodeEmen = KeyboardcodeEmenList.get(this.vKey);
         if (!KeyboardcodeEmen) {
             KeyboardcodeEmen = ["unknown", null, this.vKey, 0];
@@ -6151,9 +7037,35 @@ export function setWindowIconForExtract(handle: number, Extract: string, index:
     * @param y 从顶部的哪里开始 为空为0
     * @param width 宽度
     * @param height 高度
+    * @param options 文件格式 (默认按文件扩展名 .png / .qoi  其他为 bmp) / png 压缩等级
+    * @returns 是否写入成功
+    * @example ```javascript
+    * hmc.captureBmpToFile("./screen.png", 0, 0, 0, 0);
+    * hmc.captureBmpToFile("./screen.dat", 0, 0, 1920, 1080, { format: "qoi" });
+    * ```
     */
-export function captureBmpToFile(FilePath: string, x: number | null, y: number | null, width: number | null, height: number | null) {
-    native.captureBmpToFile(ref.string(FilePath), ref.int(x || 0), ref.int(y || 0), ref.int(width || 0), ref.int(height || 0))
+export function captureBmpToFile(FilePath: string, x: number | null, y: number | null, width: number | null, height: number | null, options?: HMC.CaptureImageOptions) {
+    if (options?.format) {
+        return native.captureBmpToFile(ref.string(FilePath), ref.int(x || 0), ref.int(y || 0), ref.int(width || 0), ref.int(height || 0), ref.string(options.format) as HMC.ImageFormat, ref.int(options.level || 0));
+    }
+    return native.captureBmpToFile(ref.string(FilePath), ref.int(x || 0), ref.int(y || 0), ref.int(width || 0), ref.int(height || 0), undefined, ref.int(options?.level || 0));
+}
+
+/**
+ * 截屏指定的宽高坐标 并返回编码后的文件内容 (宽或高为 0 时为主屏幕)
+ * @param x 从左边的哪里开始 为空为0
+ * @param y 从顶部的哪里开始 为空为0
+ * @param width 宽度
+ * @param height 高度
+ * @param options 文件格式 (默认 bmp) / png 压缩等级
+ * @returns 截图失败时为 null
+ * @example ```javascript
+ * const png = hmc.captureBmpToBuff(0, 0, 800, 600, { format: "png" });
+ * ```
+ */
+export function captureBmpToBuff(x: number | null, y: number | null, width: number | null, height: number | null, options?: HMC.CaptureImageOptions): Buffer | null {
+    const data = native.captureBmpToBuff(ref.int(x || 0), ref.int(y || 0), ref.int(width || 0), ref.int(height || 0), ref.string(options?.format || "bmp") as HMC.ImageFormat, ref.int(options?.level || 0));
+    return data ? Buffer.from(data.buffer, data.byteOffset, data.byteLength) : null;
 }
 
 /**
@@ -6224,6 +7136,200 @@ export function sendKeyboardSequence(...keys: Array<{ key: number | string, down
 export function getColor(x: number, y: number) {
     return native.getColor(ref.int(x), ref.int(y));
 }
+/**
+ * 颜色转为 0xRRGGBB
+ * @param color 0xRRGGBB 或 "#RRGGBB" 或 {r, g, b}
+ */
+function toRGBNumber(color: number | string | { r: number, g: number, b: number }) {
+    if (typeof color == "number") return color & 0xFFFFFF;
+    if (typeof color == "string") return parseInt(color.replace(/^#/, ""), 16) & 0xFFFFFF;
+    return ((ref.int(color.r) & 0xFF) << 16) | ((ref.int(color.g) & 0xFF) << 8) | (ref.int(color.b) & 0xFF);
+}
+
+function toPixelSearchRegion(region: { x: number, y: number, width: number, height: number } | [number, number, number, number] | null | undefined) {
+    if (!region) return [0, 0, 0, 0];
+    if (Array.isArray(region)) return region.map(value => ref.int(value));
+    return [ref.int(region.x), ref.int(region.y), ref.int(region.width), ref.int(region.height)];
+}
+
+/**
+ * 在屏幕区域内搜索颜色 (取代 AU3_PixelSearch 与循环调用 getColor)
+ * 区域只截取一次 在内存中由 SIMD 内核扫描
+ * @param region 区域 为空时搜索整个屏幕
+ * @param color 0xRRGGBB 或 "#RRGGBB" 或 {r, g, b}
+ * @param options 误差 / 步长
+ * @returns 第一个命中的屏幕坐标 (逐行从左到右)  没有时为 null
+ * @example ```javascript
+ * const point = hmc.pixelSearch({ x: 0, y: 0, width: 800, height: 600 }, "#336699", { tolerance: 8 });
+ * ```
+ */
+export function pixelSearch(region: { x: number, y: number, width: number, height: number } | [number, number, number, number] | null, color: number | string | HMC.Color, options?: HMC.PixelSearchOptions): { x: number, y: number } | null {
+    return native.pixelSearch(toPixelSearchRegion(region), toRGBNumber(color), ref.int(options?.tolerance || 0), ref.int(options?.step || 1), "first", 0);
+}
+
+/**
+ * 在屏幕区域内搜索颜色 返回所有命中的屏幕坐标
+ * @returns [x0, y0, x1, y1, ...]
+ */
+export function pixelSearchAll(region: { x: number, y: number, width: number, height: number } | [number, number, number, number] | null, color: number | string | HMC.Color, options?: HMC.PixelSearchOptions): Int32Array {
+    return native.pixelSearch(toPixelSearchRegion(region), toRGBNumber(color), ref.int(options?.tolerance || 0), ref.int(options?.step || 1), "all", ref.int(options?.limit || 0)) || new Int32Array(0);
+}
+
+/**
+ * 在屏幕区域内搜索颜色 只返回命中的数量
+ */
+export function pixelSearchCount(region: { x: number, y: number, width: number, height: number } | [number, number, number, number] | null, color: number | string | HMC.Color, options?: HMC.PixelSearchOptions): number {
+    return native.pixelSearch(toPixelSearchRegion(region), toRGBNumber(color), ref.int(options?.tolerance || 0), ref.int(options?.step || 1), "count", 0) || 0;
+}
+
+/**
+ * 截取屏幕区域 (BGRA 像素)
+ * 像素由常驻的截图缓冲区直接提供给 JS 不经过复制  用完后调用 releaseScreenFrame 立即归还 (否则在垃圾回收时归还)
+ * 同时持有超过 8 个未归还的截图时 之后的截图改为复制 (不再占用截图缓冲区)
+ * @param region 区域 为空时截取整个屏幕
+ * @example ```javascript
+ * const frame = hmc.captureScreenFrame({ x: 0, y: 0, width: 800, height: 600 });
+ * try {
+ *     const pixels = new Uint32Array(frame.data);
+ *     console.log((pixels[0] & 0xFFFFFF).toString(16));
+ * } finally {
+ *     hmc.releaseScreenFrame(frame);
+ * }
+ * ```
+ */
+export function captureScreenFrame(region?: { x: number, y: number, width: number, height: number } | [number, number, number, number] | null): HMC.ScreenFrame | null {
+    const [x, y, width, height] = toPixelSearchRegion(region);
+    return native.captureScreenFrame(x, y, width, height);
+}
+
+/**
+ * 立即归还 captureScreenFrame 的截图缓冲区  之后 data 的长度为 0 (不能再读取)
+ * @returns 不是 captureScreenFrame 返回的或者已经归还时为 false
+ */
+export function releaseScreenFrame(frame: HMC.ScreenFrame | ArrayBuffer | null | undefined): boolean {
+    if (!frame) return false;
+    return native.releaseScreenFrame(frame instanceof ArrayBuffer ? frame : frame.data);
+}
+
+/**
+ * 开始连续截图 (独立线程按帧率截取同一个区域)
+ * 每一帧与上一帧按 64x64 的块比较  只回调变化的块 第一次回调为整个区域
+ * 回调处理不过来时 变化合并到下一次回调 (不会丢失变化  frame.dropped 为合并的帧数)
+ * @param region 区域 为空时截取整个屏幕
+ * @param fps 每秒帧数 默认 10
+ * @param callback 变化的块
+ * @returns 流的 id (用于 stopCaptureStream)
+ * @example ```javascript
+ * const id = hmc.startCaptureStream({ x: 0, y: 0, width: 1920, height: 1080 }, 10, (frame) => {
+ *     for (const tile of frame.tiles) console.log(tile.x, tile.y, tile.width, tile.height);
+ * });
+ * // ...
+ * hmc.stopCaptureStream(id);
+ * ```
+ */
+export function startCaptureStream(region: { x: number, y: number, width: number, height: number } | [number, number, number, number] | null | undefined, fps: number, callback: (frame: HMC.CaptureStreamFrame) => void): number {
+    if (typeof callback !== "function") {
+        throw new TypeError("startCaptureStream(region, fps, callback) requires callback");
+    }
+    return native.startCaptureStream(toPixelSearchRegion(region), Number(fps) || 10, (delivery: HMC.CaptureStreamDelivery) => {
+        const tiles: HMC.CaptureStreamTile[] = new Array(delivery.rects.length / 4);
+        let offset = 0;
+        for (let index = 0; index < tiles.length; index++) {
+            const width = delivery.rects[index * 4 + 2];
+            const height = delivery.rects[index * 4 + 3];
+            tiles[index] = {
+                x: delivery.rects[index * 4],
+                y: delivery.rects[index * 4 + 1],
+                width,
+                height,
+                pixels: new Uint32Array(delivery.data, offset * 4, width * height),
+            };
+            offset += width * height;
+        }
+        callback(Object.assign(delivery, { tiles }));
+    });
+}
+
+/**
+ * 停止连续截图 (等待截图线程结束  之后不会再回调)
+ * @returns id 不存在时为 false
+ */
+export function stopCaptureStream(id: number): boolean {
+    return native.stopCaptureStream(ref.int(id));
+}
+
+/**
+ * 连续截图的计数
+ * - frames 已截取的帧数
+ * - delivered 已回调的次数
+ * - dropped 有变化但回调还没处理完上一次  合并到之后回调的帧数
+ * - overruns 截图与比较的时间超过帧间隔而跳过的帧数
+ * - failed 截图失败的帧数
+ */
+export function getCaptureStreamStats(id: number): HMC.CaptureStreamStats | null {
+    return native.getCaptureStreamStats(ref.int(id));
+}
+
+/**
+ * 在屏幕区域内查找模板图像 (找图)
+ * 灰度金字塔由粗到细搜索 在原始分辨率确认得分  多线程
+ * @param needle 模板: BMP 文件路径 / BMP 文件内容 (例如 captureBmpToFile 的输出) / BGRA 像素
+ * @param region 区域 为空时搜索整个屏幕
+ * @param options 最低得分 / 缩放比例 / 数量
+ * @returns 按得分从高到低  互相重叠超过一半的只保留得分最高的
+ * @example ```javascript
+ * const [button] = hmc.findImage("./button.bmp", null, { threshold: 0.97, scales: [1, 1.25, 1.5] });
+ * if (button) hmc.setCursorPos(button.x + button.width / 2, button.y + button.height / 2);
+ * ```
+ */
+export function findImage(needle: string | Buffer | Uint8Array | { width: number, height: number, data: Uint8Array | Uint8ClampedArray | Uint32Array }, region?: { x: number, y: number, width: number, height: number } | [number, number, number, number] | null, options?: HMC.ImageMatchOptions): HMC.ImageMatch[] {
+    let data: Uint8Array;
+    let width = 0;
+    let height = 0;
+    if (typeof needle == "string") {
+        data = fs.readFileSync(needle);
+    } else if (needle instanceof Uint8Array) {
+        data = needle;
+    } else {
+        data = new Uint8Array(needle.data.buffer, needle.data.byteOffset, needle.data.byteLength);
+        width = ref.int(needle.width);
+        height = ref.int(needle.height);
+    }
+
+    const scales = (options?.scales || [1]).map(scale => Number(scale));
+    const rows = native.findImage(data, width, height, toPixelSearchRegion(region), Number(options?.threshold || 0), scales, ref.int(options?.limit || 0));
+    const result: HMC.ImageMatch[] = [];
+    for (let index = 0; index + 6 <= rows.length; index += 6) {
+        result.push({
+            x: rows[index],
+            y: rows[index + 1],
+            width: rows[index + 2],
+            height: rows[index + 3],
+            score: rows[index + 4],
+            scale: rows[index + 5],
+        });
+    }
+    return result;
+}
+
+/**
+ * 批量获取屏幕上多个坐标的颜色  只截取一次包含所有坐标的矩形 再从内存中读取
+ * @param points 坐标列表 `{x, y}` 或 `[x, y]`
+ * @returns 与 points 一一对应的 0xRRGGBB  不在屏幕范围内的为 0xFFFFFFFF
+ * @example ```javascript
+ * const colors = hmc.getColors([{ x: 10, y: 10 }, [20, 30]]);
+ * const hex = "#" + colors[0].toString(16).padStart(6, "0");
+ * ```
+ */
+export function getColors(points: Array<{ x: number, y: number } | [number, number]>): Uint32Array {
+    const flat: number[] = new Array(points.length * 2);
+    for (let index = 0; index < points.length; index++) {
+        const point = points[index];
+        flat[index * 2] = ref.int(Array.isArray(point) ? point[0] : point.x);
+        flat[index * 2 + 1] = ref.int(Array.isArray(point) ? point[1] : point.y);
+    }
+    return native.getColors(flat);
+}
 /**
  * 执行标准快捷键
  * @param basicCout 四大按键的包含表
@@ -6360,6 +7466,25 @@ export function getProcessCommand2Sync(pid: number): string | null {
     return native.getProcessCommandSync(ref.int(pid));
 }
 
+/**
+ * 获取异步执行器的队列深度与延迟统计
+ * @description 异步函数由插件独立的线程执行 分为 quick(快速查询) 与 long(长耗时/阻塞) 两条通道
+ */
+export function getExecutorStats() {
+    return native.getExecutorStats();
+}
+
+/**
+ * 设置异步执行器
+ * @param options 
+ * - quickWorkers 快速查询通道的线程数量 (1-64)
+ * - longWorkers 长耗时通道的线程数量 (1-64)
+ * - resetStats 清空累计统计
+ */
+export function setExecutorOptions(options: HMC.ExecutorOptions) {
+    native.setExecutorOptions(options);
+}
+
 
 /**
  * 限制鼠标光标可移动范围 (异步)
@@ -6437,7 +7562,7 @@ class Iohook_Keyboard {
         change: [] as Function[],
     };
     private _Close = false;
-    private _next_Sleep = 50;
+    private _next_Sleep = 16;
     constructor() {
 
     }
@@ -6468,21 +7593,20 @@ class Iohook_Keyboard {
         return keyboardHook;
     };
     /**
-     * 设置于hmc 对接的刷新延迟毫秒数 数字越小读取越快但是性能消耗将会增加
-     * @param Sleep 要求 10ms - 10,000
-     * @default 50ms
+     * 设置于hmc 对接的合并推送毫秒数 (下次 start 生效) 数字越小响应越快但是回调次数将会增加
+     * @param Sleep 要求 0ms - 10,000 (0 为每次按键立即推送)
+     * @default 16ms
      * @returns 
      */
-    setRefreshRate(Sleep = 50) {
+    setRefreshRate(Sleep = 16) {
         Sleep = Number(Sleep);
 
         if (isNaN(Sleep)) return false;
 
-        // 小于10会导致访问过快照成性能消耗过大
-        if (Sleep < 10) {
+        if (Sleep < 0) {
             return false;
         }
-        // 太慢了会导致内存过大 如果内存超出了缓冲区预开辟内存大小将会变成动态开辟内存 影响单次键鼠响应的速度
+        // 太慢了会导致缓冲区写满 超出的按键将会被丢弃
         if (Sleep > 10000) {
             return false;
         }
@@ -6490,6 +7614,12 @@ class Iohook_Keyboard {
         this._next_Sleep = Sleep;
         return true;
     }
+    /**
+     * 获取键盘挂钩缓冲区状态 (overflow 大于0 说明读取速度跟不上输入 可以调小 setRefreshRate)
+     */
+    getStats() {
+        return native.getKeyboardHookStats();
+    }
     /**
      * 开始
      * @returns 
@@ -6498,29 +7628,23 @@ class Iohook_Keyboard {
         SetIohook = true;
         let start = native.isStartKeyboardHook();
         if (start) throw new Error("the Task Has Started.");
-        native.installKeyboardHook();
-        if (native.isStartKeyboardHook()) {
-            keyboardHook._Close = false;
-        }
-        keyboardHook.emit("start");
-        let emit_getKeyboardNextSession = () => {
-            let getKeyboardNextSession = native.getKeyboardNextSession();
-            if (getKeyboardNextSession?.length) keyboardHook.emit("data", getKeyboardNextSession);
-            if (getKeyboardNextSession)
-                for (let index = 0; index < getKeyboardNextSession.length; index++) {
-                    const KeyboardNextSession = getKeyboardNextSession[index];
-                    const KeyboardPoint = new Keyboard(KeyboardNextSession);
-                    keyboardHook.emit("change", KeyboardPoint);
+        keyboardHook._Close = false;
+        // 推送模式 由原生线程按批次回调 不再需要定时轮询
+        native.installKeyboardHook((records: Uint32Array) => {
+            if (keyboardHook._Close) return;
+            // data 事件沿用旧的文本格式 只有存在监听时才生成
+            if (keyboardHook._onlistenerCountList.data.length || keyboardHook._oncelistenerCountList.data.length) {
+                const data: (`${number}|0` | `${number}|1`)[] = [];
+                for (let index = 0; index < records.length; index += 3) {
+                    data.push(`${records[index]}|${records[index + 1] & 0x80 ? 0 : 1}` as `${number}|${0 | 1}`);
                 }
-
-        }
-        (async () => {
-            while (true) {
-                if (keyboardHook._Close) return;
-                await Sleep(this._next_Sleep);
-                emit_getKeyboardNextSession();
+                keyboardHook.emit("data", data);
             }
-        })();
+            for (let index = 0; index < records.length; index += 3) {
+                keyboardHook.emit("change", new Keyboard(records[index], !(records[index + 1] & 0x80)));
+            }
+        }, { batchMs: this._next_Sleep });
+        keyboardHook.emit("start");
         return start;
     }
     /**
@@ -6630,6 +7754,16 @@ export const Auto = {
     sendKeyboard,
     sendKeyboardSequence,
     getColor,
+    getColors,
+    findImage,
+    captureScreenFrame,
+    releaseScreenFrame,
+    startCaptureStream,
+    stopCaptureStream,
+    getCaptureStreamStats,
+    pixelSearch,
+    pixelSearchAll,
+    pixelSearchCount,
     sendBasicKeys,
     setWindowEnabled,
     setCursorPos,
@@ -6684,6 +7818,7 @@ export const Process = {
     parentID: getProcessParentProcessID,
     mianPID: getProcessParentProcessID,
     subPID: getSubProcessID,
+    tree: getProcessTree,
     threadList: getProcessThreadList
 }
 
@@ -6978,21 +8113,32 @@ export function getTCPPortProcessID(Port: number) {
     return null
 }
 
-// /**
-//  * 通过标题或类名搜索所有窗口句柄
-//  * @param className 类名
-//  * @param titleName 标题
-//  * @param isWindow 是否要求为窗口(忽略子组件) 默认 true
-//  * @param isCaseSensitive 忽略区分大小写 默认 true
-//  */
-// export function findAllWindow(className: string | null, titleName?: string | null, isWindow?: boolean | null, isCaseSensitive?: boolean | null): number[]{
-//     return native.findAllWindow(
-//         typeof className == "string" ? ref.string(className):null, 
-//         typeof titleName == "string" ? ref.string(titleName) : null, 
-//         typeof isWindow == "boolean" ? isWindow:null, 
-//         typeof isCaseSensitive == "boolean" ? isCaseSensitive : null,
-//         );
-// }
+/**
+ * 通过标题或类名搜索所有窗口句柄 (按 Z 序)
+ * - 匹配规则只编译一次 先比较类名 命中后才获取标题
+ * - 设置 limit 后找到足够数量立即结束 (例如 limit: 1 代替循环 findWindow)
+ * @example ```javascript
+ * hmc.findAllWindow(null, "*记事本", true, false, { mode: "glob" });
+ * hmc.findAllWindow("Chrome_WidgetWin_1", "^.+ - Google Chrome$", true, false, { mode: "regex", limit: 1 });
+ * ```
+ * @param className 类名
+ * @param titleName 标题
+ * @param isWindow 只要可见的窗口 默认 true
+ * @param isCaseSensitive 区分大小写 默认 false
+ * @param options 匹配方式 (默认 exact) 与数量上限
+ */
+export function findAllWindow(className: string | null, titleName?: string | null, isWindow?: boolean | null, isCaseSensitive?: boolean | null, options?: HMC.WindowMatchOptions): number[] {
+    return native.findAllWindow(
+        typeof className == "string" ? ref.string(className) : null,
+        typeof titleName == "string" ? ref.string(titleName) : null,
+        typeof isWindow == "boolean" ? isWindow : null,
+        typeof isCaseSensitive == "boolean" ? isCaseSensitive : null,
+        {
+            mode: options?.mode || "exact",
+            limit: options?.limit ? ref.int(options.limit) : 0,
+        },
+    );
+}
 
 /**
  * 通过标题或类名搜索窗口句柄
@@ -7000,6 +8146,13 @@ export function getTCPPortProcessID(Port: number) {
  * @param titleName 标题
  */
 export function findWindow(className?: string | null, titleName?: string | null): number | null {
+    if ((className || titleName) && native.isWindowIndexRunning()) {
+        return native.windowIndexFind(
+            typeof className == "string" ? ref.string(className) : null,
+            typeof titleName == "string" ? ref.string(titleName) : null,
+            1,
+        )[0] || null;
+    }
     return native.findWindow(
         typeof className == "string" ? ref.string(className) : null,
         typeof titleName == "string" ? ref.string(titleName) : null,
@@ -7447,6 +8600,100 @@ export const isWindowTop = hasWindowTop;
 export const getProcessFilePath = getProcessidFilePath;
 
 
+/**
+ * 组装 getAllProcessListSnp 的紧凑结果
+ * - 数值 [th32ProcessID, th32ParentProcessID, cntThreads, cntUsage, dwFlags, dwSize, pcPriClassBase, th32DefaultHeapID, th32ModuleID]
+ * - 字符串 [szExeFile]
+ */
+function unpackProcessListSnp(table: HMC.PackedRows | null | undefined): Array<HMC.PROCESSENTRY_V2> {
+    if (!table) return [];
+    const [numbers, strings] = table;
+    const length = strings.length;
+    const data_list: Array<HMC.PROCESSENTRY_V2> = new Array(length);
+    for (let index = 0; index < length; index++) {
+        const offset = index * 9;
+        const name = strings[index];
+        const pid = numbers[offset];
+        const ppid = numbers[offset + 1];
+        data_list[index] = {
+            szExeFile: name,
+            th32ProcessID: pid,
+            th32ParentProcessID: ppid,
+            cntThreads: numbers[offset + 2],
+            cntUsage: numbers[offset + 3],
+            dwFlags: numbers[offset + 4],
+            dwSize: numbers[offset + 5],
+            pcPriClassBase: numbers[offset + 6],
+            th32DefaultHeapID: numbers[offset + 7],
+            th32ModuleID: numbers[offset + 8],
+            pid,
+            ppid,
+            name,
+        };
+    }
+    return data_list;
+}
+
+/**
+ * 组装 getAllProcessListNt 的紧凑结果
+ * - 数值 [UniqueProcessId, NextEntryOffset, NumberOfThreads, BasePriority, HandleCount, SessionId, PeakVirtualSize, VirtualSize, PeakWorkingSetSize, WorkingSetSize, QuotaPagedPoolUsage, QuotaNonPagedPoolUsage, PagefileUsage, PeakPagefileUsage, PrivatePageCount]
+ * - 字符串 [ImageName]
+ */
+function unpackProcessListNt(table: HMC.PackedRows | null | undefined): Array<HMC.PSYSTEM_PROCESS_INFORMATION & { name: string, pid: number }> {
+    if (!table) return [];
+    const [numbers, strings] = table;
+    const length = strings.length;
+    const data_list: Array<HMC.PSYSTEM_PROCESS_INFORMATION & { name: string, pid: number }> = new Array(length);
+    for (let index = 0; index < length; index++) {
+        const offset = index * 15;
+        const name = strings[index];
+        const pid = numbers[offset];
+        data_list[index] = {
+            ImageName: name,
+            UniqueProcessId: pid,
+            NextEntryOffset: numbers[offset + 1],
+            NumberOfThreads: numbers[offset + 2],
+            BasePriority: numbers[offset + 3],
+            HandleCount: numbers[offset + 4],
+            SessionId: numbers[offset + 5],
+            PeakVirtualSize: numbers[offset + 6],
+            VirtualSize: numbers[offset + 7],
+            PeakWorkingSetSize: numbers[offset + 8],
+            WorkingSetSize: numbers[offset + 9],
+            QuotaPagedPoolUsage: numbers[offset + 10],
+            QuotaNonPagedPoolUsage: numbers[offset + 11],
+            PagefileUsage: numbers[offset + 12],
+            PeakPagefileUsage: numbers[offset + 13],
+            PrivatePageCount: numbers[offset + 14],
+            pid,
+            name,
+        };
+    }
+    return data_list;
+}
+
+/**
+ * 组装 getAllProcessList 的紧凑结果
+ * - 数值 [pid]
+ * - 字符串 [path, name] (仅 is_execPath)
+ */
+function unpackProcessList(table: HMC.PackedRows | null | undefined): Array<{ pid: number, name: string, path: string }> {
+    if (!table) return [];
+    const [numbers, strings] = table;
+    const length = numbers.length;
+    const data_list: Array<{ pid: number, name: string, path: string }> = new Array(length);
+    if (!strings.length) {
+        for (let index = 0; index < length; index++) {
+            data_list[index] = { pid: numbers[index] } as { pid: number, name: string, path: string };
+        }
+        return data_list;
+    }
+    for (let index = 0; index < length; index++) {
+        data_list[index] = { pid: numbers[index], path: strings[index * 2], name: strings[index * 2 + 1] };
+    }
+    return data_list;
+}
+
 /**
    * 获取进程列表 (快照法)  
    * - (一般用来枚举进程树)
@@ -7458,27 +8705,7 @@ export const getProcessFilePath = getProcessidFilePath;
 export function getAllProcessListSnp2(callback: (data_list: Array<HMC.PROCESSENTRY_V2>, err: null | Error) => void): void;
 export function getAllProcessListSnp2(): Promise<Array<HMC.PROCESSENTRY_V2>>;
 export function getAllProcessListSnp2(callback?: unknown) {
-    const data = native.getAllProcessListSnp();
-    let result: Promise<Array<HMC.PROCESSENTRY_V2>>;
-
-    if (typeof data == "number") {
-        result = (new PromiseSession(data)).to_Promise((data) => {
-            return !data ? [] : (JSON.parse(data[0]) as any[]).map(result => {
-                result.pid = result.UniqueProcessId;
-                result.name = result.ImageName;
-                return result;
-            })
-        });
-    } else {
-        result = data.then((data) => {
-            return !data ? [] : (JSON.parse(data) as any[]).map(result => {
-                result.pid = result.th32ProcessID;
-                result.name = result.szExeFile;
-                result.ppid = result.th32ParentProcessID;
-                return result;
-            })
-        });
-    }
+    const result = native.getAllProcessListSnp().then(unpackProcessListSnp);
 
     if (typeof callback === 'function') {
         result.then((data) => callback(data, null)).catch((err) => { callback([], err) });
@@ -7560,26 +8787,7 @@ export function getAllProcessListSnpSession2Sync(): Array<HMC.PROCESSENTRY_V2> {
 export function getAllProcessListNt2(callback: (data_list: Array<HMC.PSYSTEM_PROCESS_INFORMATION & { name: string, pid: number }> | null, err: null | Error) => void): void;
 export function getAllProcessListNt2(): Promise<Array<HMC.PSYSTEM_PROCESS_INFORMATION & { name: string, pid: number }>>;
 export function getAllProcessListNt2(callback?: unknown) {
-    const data = native.getAllProcessListNt();
-    let result: Promise<Array<HMC.PSYSTEM_PROCESS_INFORMATION & { name: string, pid: number }>>;
-
-    if (typeof data == "number") {
-        result = (new PromiseSession(data)).to_Promise((data) => {
-            return (JSON.parse(data[0]) as any[]).map(result => {
-                result.pid = result.UniqueProcessId;
-                result.name = result.ImageName;
-                return result;
-            })
-        });
-    } else {
-        result = data.then((data) => {
-            return (JSON.parse(data) as any[]).map(result => {
-                result.pid = result.UniqueProcessId;
-                result.name = result.ImageName;
-                return result;
-            })
-        });
-    }
+    const result = native.getAllProcessListNt().then(unpackProcessListNt);
 
     if (typeof callback === 'function') {
         result.then((data) => callback(data, null)).catch((err) => { callback(null, err) });
@@ -7607,34 +8815,8 @@ export function getAllProcessList2(callback?: unknown, is_execPath?: unknown) {
         callback = void 0;
     }
 
-    const data = is_execPath ? native.getAllProcessList(true) : native.getAllProcessList();
-    let result: Promise<any[]>;
-
-
-    if (typeof data == "number") {
-        result = (new PromiseSession(data)).to_Promise((data) => {
-            let data_list = JSON.parse(data[0]);
-            const v_list: HMC.Volume[] = [];// native.getVolumeList(); 
-            for (let index = 0; index < data_list.length; index++) {
-                const element: { pid: number, name: string, path: string } = data_list[index];
-                // \\Device\\HarddiskVolume1\1.exe
-
-                if (element?.path?.match(/^[\\\/][\\\/]?Device[\\\/][\\\/]?HarddiskVolume/)) {
-                    if (!v_list.length) {
-                        v_list.push(...native.getVolumeList());
-                        for (let index = 0; index < v_list.length; index++) {
-                            const Volume = v_list[index];
-                            element.path = element?.path?.replace(Volume.device, Volume.path) || ""
-                            element.path = element?.path?.replace(Volume.name, Volume.path) || ""
-                        }
-                    }
-                }
-            }
-            return data_list;
-        });
-    } else {
-        result = data.then((data) => (JSON.parse(data) as any[]));
-    }
+    // 原生层已将 \\Device\\HarddiskVolume1\1.exe 转换为 dos 路径
+    const result = (is_execPath ? native.getAllProcessList(true) : native.getAllProcessList()).then(unpackProcessList);
 
     if (typeof callback === 'function') {
         const to_callback = callback;
@@ -7656,22 +8838,8 @@ export function getAllProcessList2(callback?: unknown, is_execPath?: unknown) {
 export function getAllProcessList2Sync(is_execPath?: true): Array<{ pid: number, name: string, path: string }>;
 export function getAllProcessList2Sync(): Array<{ pid: number }>;
 export function getAllProcessList2Sync(is_execPath?: unknown) {
-    const v_list: HMC.Volume[] = [];// native.getVolumeList(); 
-    return JSON.parse(is_execPath ? native.getAllProcessListSync(true) : native.getAllProcessListSync())?.map((item: { pid: number, name: string, path: string }) => {
-
-        // \\Device\\HarddiskVolume1\1.exe
-        if (item?.path?.match(/^[\\\/][\\\/]?Device[\\\/][\\\/]?HarddiskVolume/)) {
-            if (!v_list.length) {
-                v_list.push(...native.getVolumeList());
-                for (let index = 0; index < v_list.length; index++) {
-                    const Volume = v_list[index];
-                    item.path = item?.path?.replace(Volume.device, Volume.path) || ""
-                }
-            }
-        }
-
-        return item;
-    });
+    // 原生层已将 \\Device\\HarddiskVolume1\1.exe 转换为 dos 路径
+    return unpackProcessList(is_execPath ? native.getAllProcessListSync(true) : native.getAllProcessListSync());
 }
 
 
@@ -7685,13 +8853,7 @@ export function getAllProcessList2Sync(is_execPath?: unknown) {
  * @returns 
  */
 export function getAllProcessListNt2Sync(): Array<HMC.PSYSTEM_PROCESS_INFORMATION & { name: string, pid: number }> {
-    const data_list = JSON.parse(native.getAllProcessListNtSync()) as Array<HMC.PSYSTEM_PROCESS_INFORMATION & { name: string, pid: number }>;
-    for (let index = 0; index < data_list.length; index++) {
-        const data = data_list[index];
-        data.pid = data.UniqueProcessId;
-        data.name = data.ImageName;
-    }
-    return data_list;
+    return unpackProcessListNt(native.getAllProcessListNtSync());
 }
 
 /**
@@ -7704,17 +8866,121 @@ export function getAllProcessListNt2Sync(): Array<HMC.PSYSTEM_PROCESS_INFORMATIO
  */
 export function getAllProcessListSnp2Sync(): Array<HMC.PROCESSENTRY_V2>;
 export function getAllProcessListSnp2Sync() {
-    const data_list = JSON.parse(native.getAllProcessListSnpSync());
-    for (let index = 0; index < data_list.length; index++) {
-        const data = data_list[index];
-        data.ppid = data.th32ParentProcessID;
-        data.pid = data.th32ProcessID;
-        data.name = data.szExeFile;
+    return unpackProcessListSnp(native.getAllProcessListSnpSync());
+}
+
+
+
+/**
+ * 获取按列存放的进程表
+ * - 所有进程的数据放在少数几个 TypedArray 与一个字符串中  适合频繁获取大量进程时减少 GC 压力
+ * @module 异步
+ * @returns 
+ */
+export function getProcessTable(): Promise<HMC.ProcessTable | null> {
+    return native.getProcessTable();
+}
+
+/**
+ * 获取按列存放的进程表
+ * @module 同步
+ * @returns 
+ */
+export function getProcessTableSync(): HMC.ProcessTable | null {
+    return native.getProcessTableSync();
+}
+
+/**
+ * 读取进程表中第 index 个进程的名称
+ * @param table getProcessTable 的结果
+ * @param index 
+ * @returns 
+ */
+export function getProcessTableName(table: HMC.ProcessTable, index: number): string {
+    return table.names.slice(table.nameOffsets[index], table.nameOffsets[index + 1]);
+}
+
+/**
+ * 组装 getProcessModules 的紧凑结果
+ * - 数值 [base, size, timestamp]
+ * - 字符串 [path, name, version]
+ */
+function unpackProcessModules(table: HMC.PackedRows | null | undefined): Array<HMC.ProcessModule> {
+    if (!table) return [];
+    const [numbers, strings] = table;
+    const length = strings.length / 3;
+    const data_list: Array<HMC.ProcessModule> = new Array(length);
+    for (let index = 0; index < length; index++) {
+        const offset = index * 3;
+        data_list[index] = {
+            base: numbers[offset],
+            size: numbers[offset + 1],
+            timestamp: numbers[offset + 2],
+            path: strings[offset],
+            name: strings[offset + 1],
+            version: strings[offset + 2],
+        };
     }
     return data_list;
 }
 
+/**
+ * 获取进程加载的模块
+ * - 模块路径在多次调用 / 多个进程之间共享缓存  不会逐个打开模块文件
+ * @module 异步
+ * @param pid 进程id
+ * @param withVersion 是否获取文件版本 (首次需要读取文件 之后使用缓存)
+ * @returns 进程不存在或没有权限时为空数组
+ */
+export function getProcessModules(pid: number, withVersion?: boolean): Promise<Array<HMC.ProcessModule>> {
+    return native.getProcessModules(ref.int(pid), ref.bool(withVersion)).then(unpackProcessModules);
+}
+
+/**
+ * 获取进程加载的模块
+ * @module 同步
+ * @param pid 进程id
+ * @param withVersion 是否获取文件版本 (首次需要读取文件 之后使用缓存)
+ * @returns 进程不存在或没有权限时为空数组
+ */
+export function getProcessModulesSync(pid: number, withVersion?: boolean): Array<HMC.ProcessModule> {
+    return unpackProcessModules(native.getProcessModulesSync(ref.int(pid), ref.bool(withVersion)));
+}
 
+function toFindHandlesResult(data: { matches: HMC.FileHandleMatch[], stats: HMC.ProcessHandleStats } | null | undefined): HMC.FindHandlesResult {
+    if (!data) return { matches: [], pids: [], stats: { handles: 0, timeouts: 0, skipped: 0, elapsed: 0 } };
+    return {
+        matches: data.matches,
+        pids: [...new Set(data.matches.map(match => match.pid))],
+        stats: data.stats,
+    };
+}
+
+/**
+ * 查找打开了指定路径的进程 (例如部署前检查文件被哪些进程占用)
+ * - 只获取一次系统句柄快照 只解析文件类型的句柄 (并行 带超时)
+ * - 传入目录时 匹配目录本身以及其中的所有文件
+ * @module 异步
+ * @param paths 文件或目录路径
+ * @param timeout 单个句柄获取名称的期限 (ms) 默认100
+ * @returns 
+ */
+export function findHandlesByPath(paths: string | string[], timeout: number = 100): Promise<HMC.FindHandlesResult> {
+    const path_list = (Array.isArray(paths) ? paths : [paths]).map(path => ref.string(path));
+    return native.findHandlesByPath(path_list, ref.int(timeout)).then(toFindHandlesResult);
+}
+
+/**
+ * 查找打开了指定路径的进程 (例如部署前检查文件被哪些进程占用)
+ * @module 同步
+ * @param paths 文件或目录路径
+ * @param timeout 单个句柄获取名称的期限 (ms) 默认100
+ * @returns 
+ */
+export function findHandlesByPathSync(paths: string | string[], timeout: number = 100): HMC.FindHandlesResult {
+    const path_list = (Array.isArray(paths) ? paths : [paths]).map(path => ref.string(path));
+    return toFindHandlesResult(native.findHandlesByPathSync(path_list, ref.int(timeout)));
+}
 
 /**
  * 获取匹配进程的 父进程信息
@@ -7796,20 +9062,7 @@ function get_sy_ProcessFilePathSync(error_name: string | null, ProcessID: number
 
     // 处理Volume路径
     if (error_name.indexOf("\\\\?\\Volume") == 0 || error_name.indexOf("\\Device\\") == 0) {
-        const volumeList = hmc.getVolumeList();
-        for (let index = 0; index < volumeList.length; index++) {
-            const volume = volumeList[index];
-
-            if (error_name.indexOf(volume.name)) {
-                error_name = error_name?.replace(volume.name, volume.path + "\\");
-                error_name = error_name?.replace(/[\\\/]+]/g, path.sep);
-            }
-
-            if (error_name.indexOf(volume.device)) {
-                error_name = error_name?.replace(volume.device, volume.path + "\\");
-                error_name = error_name?.replace(/[\\\/]+]/g, path.sep);
-            }
-        }
+        error_name = native.translatePaths(error_name)[0];
     }
 
     // 不是最高权限的应用  ->  != error:::[5,5]
@@ -7844,20 +9097,7 @@ async function get_sy_ProcessFilePath(error_name: string | null, ProcessID: numb
 
         // 处理Volume路径
         if (error_name.indexOf("\\\\?\\Volume") == 0 || error_name.indexOf("\\Device\\") == 0) {
-            const volumeList = hmc.getVolumeList();
-            for (let index = 0; index < volumeList.length; index++) {
-                const volume = volumeList[index];
-
-                if (error_name.indexOf(volume.name)) {
-                    error_name = error_name?.replace(volume.name, volume.path + "\\");
-                    error_name = error_name?.replace(/[\\\/]+]/g, path.sep);
-                }
-
-                if (error_name.indexOf(volume.device)) {
-                    error_name = error_name?.replace(volume.device, volume.path + "\\");
-                    error_name = error_name?.replace(/[\\\/]+]/g, path.sep);
-                }
-            }
+            error_name = native.translatePaths(error_name)[0];
         }
 
         // 不是最高权限的应用  ->  != error:::[5,5]
@@ -8253,6 +9493,12 @@ export const hmc = {
     alert,
     analysisDirectPath,
     captureBmpToFile,
+    captureBmpToBuff,
+    captureScreenFrame,
+    releaseScreenFrame,
+    startCaptureStream,
+    stopCaptureStream,
+    getCaptureStreamStats,
     clearClipboard,
     closeWindow,
     closedHandle,
@@ -8265,16 +9511,21 @@ export const hmc = {
     deleteFile,
     desc,
     enumAllProcessHandle,
+    enumAllProcessIterator,
     enumChildWindows,
     enumProcessHandle,
+    enumProcessHandleIterator,
     enumRegistrKey,
     escapeEnvVariable,
     findProcess,
     findProcess2,
     findProcess2Sync,
     findWindow,
+    findAllWindow,
     findWindowEx,
+    findImage,
     formatVolumePath,
+    translatePaths,
     freePort,
     getAllEnv,
     getAllProcessList2,
@@ -8283,15 +9534,24 @@ export const hmc = {
     getAllProcessListNt2Sync,
     getAllProcessListSnp2,
     getAllProcessListSnp2Sync,
+    getProcessTable,
+    getProcessTableSync,
+    getProcessTableName,
+    getProcessModules,
+    getProcessModulesSync,
+    findHandlesByPath,
+    findHandlesByPathSync,
     getAllProcessListSnpSession2,
     getAllProcessListSnpSession2Sync,
     getAllWindows,
     getAllWindowsHandle,
+    queryWindows,
     getBasicKeys,
     getClipboardFilePaths,
     getClipboardSequenceNumber,
     getClipboardText,
     getColor,
+    getColors,
     getConsoleHandle,
     getCurrentMonitorRect,
     getDetailsProcessList,
@@ -8304,6 +9564,12 @@ export const hmc = {
     getHandleProcessID,
     getHidUsbList,
     getMainWindow,
+    getProcessMainWindow,
+    startWindowIndex,
+    stopWindowIndex,
+    isWindowIndexRunning,
+    getWindowIndexStats,
+    getIndexedWindow,
     getMetrics,
     getModulePathList,
     getMouseMovePoints,
@@ -8339,6 +9605,7 @@ export const hmc = {
     getShortcutLink,
     getStringRegKey,
     getSubProcessID,
+    getProcessTree,
     getSystemIdleTime,
     getSystemKeyList,
     getSystemMenu,
@@ -8400,6 +9667,9 @@ export const hmc = {
     openExternal,
     openPath,
     openURL,
+    pixelSearch,
+    pixelSearchAll,
+    pixelSearchCount,
     platform,
     popen,
     powerControl,
@@ -8452,6 +9722,7 @@ export const hmc = {
     version,
     watchClipboard,
     watchUSB,
+    watchProcessChange,
     windowJitter,
     hasMouseLeftActivate,
     hasMouseRightActivate,
@@ -8462,6 +9733,8 @@ export const hmc = {
     getProcessCwd2,
     getProcessCommand2,
     getProcessCommand2Sync,
+    getExecutorStats,
+    setExecutorOptions,
 }
 
 export default hmc;
@@ -0,0 +1,185 @@
+// hmc_image_encode 基准测试 (不依赖 windows / node 可以单独编译)
+// 在合成的截图上比较 BMP / QOI / PNG 的大小与耗时  PNG 另外比较行过滤 (逐字节 / SIMD) 与线程数
+// g++ -O2 -std=c++17 -pthread image_encode_bench.cc ../CPP/util/hmc_image_encode.cpp -o image_encode_bench && ./image_encode_bench [输出目录]
+// 指定输出目录时写出每种格式的文件 (可用任意看图软件检查)
+#include "../CPP/util/hmc_image_encode.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hmc_image_encode;
+
+static uint32_t nextRandom(uint32_t &seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// 类似桌面的画面: 纯色背景 窗口 标题栏 文字 (细小的高对比度笔画) 渐变 与一块照片般的噪声
+// alpha 随机 (BitBlt 得到的 alpha 不可靠 编码时应忽略)
+static std::vector<uint32_t> makeDesktop(int width, int height)
+{
+    std::vector<uint32_t> pixels((size_t)width * height);
+    uint32_t seed = 2024;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            uint32_t color = 0x1E3A5F + (uint32_t)((y * 40 / height) << 8);
+            pixels[(size_t)y * width + x] = color;
+        }
+    }
+
+    for (int window = 0; window < 12; window++)
+    {
+        int left = (int)(nextRandom(seed) % (uint32_t)(width * 3 / 4));
+        int top = (int)(nextRandom(seed) % (uint32_t)(height * 3 / 4));
+        int right = std::min(width, left + 300 + (int)(nextRandom(seed) % 900));
+        int bottom = std::min(height, top + 200 + (int)(nextRandom(seed) % 600));
+        uint32_t text_color = nextRandom(seed) & 0x3F3F3F;
+        for (int y = top; y < bottom; y++)
+        {
+            for (int x = left; x < right; x++)
+            {
+                uint32_t color = y < top + 32 ? 0xF0F0F0 - (uint32_t)((y - top) * 0x010101) : 0xFFFFFF;
+                // 文字行: 每 18 像素一行 笔画由噪声决定
+                int line = (y - top - 40) % 18;
+                if (y > top + 40 && line < 12 && x > left + 8 && x < right - 8 && (nextRandom(seed) & 7) == 0)
+                {
+                    color = text_color;
+                }
+                pixels[(size_t)y * width + x] = color;
+            }
+        }
+    }
+
+    // 照片区域
+    int photo_left = width / 2, photo_top = height / 2;
+    for (int y = photo_top; y < std::min(height, photo_top + height / 3); y++)
+    {
+        for (int x = photo_left; x < std::min(width, photo_left + width / 3); x++)
+        {
+            uint32_t noise = nextRandom(seed) & 0x0F0F0F;
+            uint32_t base = ((uint32_t)(x & 0xFF) << 16) | ((uint32_t)(y & 0xFF) << 8) | (uint32_t)((x + y) & 0xFF);
+            pixels[(size_t)y * width + x] = (base & 0xF0F0F0) + noise;
+        }
+    }
+
+    for (auto &pixel : pixels)
+    {
+        pixel = (pixel & 0x00FFFFFF) | ((nextRandom(seed) & 0xFF) << 24);
+    }
+    return pixels;
+}
+
+// 输出位置  只统计大小与耗时时不保存
+class CountWriter : public Writer
+{
+public:
+    bool write(const void *, size_t size) override
+    {
+        total += size;
+        writes++;
+        return true;
+    }
+    size_t total = 0;
+    size_t writes = 0;
+};
+
+static double runMs(const Image &image, const Options &options, size_t &size, int rounds)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++)
+    {
+        CountWriter writer;
+        encode(image, options, writer);
+        size = writer.total;
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+int main(int argc, char **argv)
+{
+    const int width = 3840;
+    const int height = 2160;
+    std::vector<uint32_t> pixels = makeDesktop(width, height);
+    Image image = {pixels.data(), width, height, (size_t)width};
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+
+    // 行过滤的两种实现输出必须完全一致
+    bool ok = true;
+    for (int sub_width : {width, 1001, 7, 1})
+    {
+        Image sub_image = {pixels.data(), sub_width, 97, (size_t)width};
+        Options scalar;
+        scalar.format = FORMAT_PNG;
+        scalar.simd = false;
+        Options simd = scalar;
+        simd.simd = true;
+        simd.threads = 3;
+        std::vector<uint8_t> expect, actual;
+        VectorWriter expect_writer(expect), actual_writer(actual);
+        encode(sub_image, scalar, expect_writer);
+        encode(sub_image, simd, actual_writer);
+        if (expect != actual)
+        {
+            printf("png mismatch width=%d\n", sub_width);
+            ok = false;
+        }
+    }
+    printf("%dx%d  cores %u  png filter results %s\n", width, height, cores, ok ? "match" : "MISMATCH");
+
+    struct Case
+    {
+        const char *name;
+        Format format;
+        int level;
+        unsigned int threads;
+        bool simd;
+    };
+    const Case cases[] = {
+        {"bmp", FORMAT_BMP, 0, 1, true},
+        {"qoi", FORMAT_QOI, 0, 1, true},
+        {"png 1 scalar", FORMAT_PNG, 1, 1, false},
+        {"png 1", FORMAT_PNG, 1, 1, true},
+        {"png 3", FORMAT_PNG, 3, 1, true},
+        {"png 6", FORMAT_PNG, 6, 1, true},
+        {"png 9", FORMAT_PNG, 9, 1, true},
+        {"png 3 all cores", FORMAT_PNG, 3, 0, true},
+        {"png 6 all cores", FORMAT_PNG, 6, 0, true},
+    };
+
+    const double raw_mb = (double)width * height * 4 / (1024 * 1024);
+    for (const Case &item : cases)
+    {
+        Options options;
+        options.format = item.format;
+        options.level = item.level;
+        options.threads = item.threads;
+        options.simd = item.simd;
+        size_t size = 0;
+        double ms = runMs(image, options, size, 3);
+        printf("%-16s %9.2f ms  %8.2f MB  %6.2f%%  %7.0f MB/s\n", item.name, ms, (double)size / (1024 * 1024),
+               100.0 * size / (width * height * 3), raw_mb / ms * 1000);
+    }
+
+    if (argc > 1)
+    {
+        for (Format format : {FORMAT_BMP, FORMAT_QOI, FORMAT_PNG})
+        {
+            std::string path = std::string(argv[1]) + "/desktop." + formatName(format);
+            std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+            StreamWriter writer(file);
+            Options options;
+            options.format = format;
+            printf("write %s %s\n", path.c_str(), encode(image, options, writer) ? "ok" : "failed");
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,280 @@
+// hmc_image_match 基准测试 (不依赖 windows / node 可以单独编译)
+// 1. 在噪声 / 重复纹理 / 类似界面的图像上 从奇数偏移处截取模板 检查能否找回原位置 (金字塔降采样的相位不对齐)
+// 2. 缩放比例的边界 (NaN 负数 0 过大 过小) 与缩放后的模板
+// 3. 单线程与多线程的结果一致  4K 图像上的耗时
+// g++ -O2 -std=c++17 -pthread image_match_bench.cc ../CPP/util/hmc_image_match.cpp -o image_match_bench && ./image_match_bench
+#include "../CPP/util/hmc_image_match.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+using namespace hmc_image_match;
+
+// 只用高位 (线性同余的低位周期很短)
+static uint32_t nextRandom(uint32_t &seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 16;
+}
+
+// 每个像素独立的随机灰度 (降采样后几乎不保留原图的信息 相位不对齐时最难找)
+static Gray makeNoise(int width, int height, uint32_t seed)
+{
+    Gray image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize((size_t)width * height);
+    for (auto &pixel : image.pixels)
+    {
+        pixel = (uint8_t)nextRandom(seed);
+    }
+    return image;
+}
+
+// 同一块图案平铺 加少量噪声  每个周期都是得分很高的近似结果
+static Gray makeRepeated(int width, int height, uint32_t seed)
+{
+    const int tile_width = 48;
+    const int tile_height = 24;
+    std::vector<uint8_t> tile((size_t)tile_width * tile_height);
+    for (auto &pixel : tile)
+    {
+        pixel = (uint8_t)(60 + nextRandom(seed) % 140);
+    }
+
+    Gray image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize((size_t)width * height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int noise = (int)(nextRandom(seed) % 7) - 3;
+            image.pixels[(size_t)y * width + x] = (uint8_t)(tile[(size_t)(y % tile_height) * tile_width + x % tile_width] + noise);
+        }
+    }
+    return image;
+}
+
+// 类似界面: 纯色块 细线 文字般的高对比度笔画
+static Gray makeInterface(int width, int height, uint32_t seed)
+{
+    Gray image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize((size_t)width * height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            uint32_t block = ((uint32_t)(x / 37) * 73856093u) ^ ((uint32_t)(y / 23) * 19349663u);
+            uint8_t value = (uint8_t)(40 + (block * 2654435761u >> 24) % 170);
+            if (x % 37 == 0 || y % 23 == 0)
+            {
+                value = 20;
+            }
+            // 文字般的笔画
+            if ((y % 23) > 6 && (y % 23) < 16 && (nextRandom(seed) % 5) == 0)
+            {
+                value = (uint8_t)(value > 128 ? 10 : 245);
+            }
+            image.pixels[(size_t)y * width + x] = value;
+        }
+    }
+    return image;
+}
+
+static Gray crop(const Gray &image, int x, int y, int width, int height)
+{
+    Gray output;
+    output.width = width;
+    output.height = height;
+    output.pixels.resize((size_t)width * height);
+    for (int row = 0; row < height; row++)
+    {
+        for (int column = 0; column < width; column++)
+        {
+            output.pixels[(size_t)row * width + column] = image.pixels[(size_t)(y + row) * image.width + x + column];
+        }
+    }
+    return output;
+}
+
+// 结果中是否有原位置 (得分需为 1)
+static bool hasExact(const std::vector<Match> &matches, int x, int y)
+{
+    for (auto &match : matches)
+    {
+        if (match.x == x && match.y == y && match.score > 0.999)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 从图像中截取模板再查找  返回找回原位置的数量
+static int checkCrops(const char *name, const Gray &image, const std::vector<int> &crops, uint32_t seed, int random_count)
+{
+    // 固定的用例 (x, y, width, height) 之后是随机的奇数偏移
+    std::vector<int> cases = crops;
+    for (int i = 0; i < random_count; i++)
+    {
+        int width = 16 + (int)(nextRandom(seed) % 100);
+        int height = 12 + (int)(nextRandom(seed) % 70);
+        int x = (int)(nextRandom(seed) % (image.width - width)) | 1;
+        int y = (int)(nextRandom(seed) % (image.height - height)) | 1;
+        cases.insert(cases.end(), {std::min(x, image.width - width), std::min(y, image.height - height), width, height});
+    }
+
+    int found = 0;
+    int total = (int)cases.size() / 4;
+    double total_ms = 0;
+    for (size_t i = 0; i < cases.size(); i += 4)
+    {
+        int x = cases[i], y = cases[i + 1], width = cases[i + 2], height = cases[i + 3];
+        Gray needle = crop(image, x, y, width, height);
+
+        Options options;
+        options.threshold = 0.95;
+        std::vector<Match> matches;
+        auto start = std::chrono::steady_clock::now();
+        find(image, needle, options, matches);
+        total_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (hasExact(matches, x, y))
+        {
+            found++;
+        }
+        else
+        {
+            printf("  %s: %dx%d at (%d,%d) not found  (%zu matches", name, width, height, x, y, matches.size());
+            if (!matches.empty())
+            {
+                printf(", best %d,%d score %.4f", matches[0].x, matches[0].y, matches[0].score);
+            }
+            printf(")\n");
+        }
+    }
+
+    printf("%-10s %d / %d crops recovered  avg %.2f ms\n", name, found, total, total_ms / total);
+    return total - found;
+}
+
+// 缩放比例的边界  不应崩溃 也不应缩放出巨大的模板
+static bool checkScales(const Gray &image)
+{
+    bool ok = true;
+    Gray needle = crop(image, 301, 211, 64, 40);
+
+    // 粘贴一个缩小一半的副本
+    Gray pasted = image;
+    Gray half;
+    resize(needle, 32, 20, half);
+    for (int y = 0; y < half.height; y++)
+    {
+        for (int x = 0; x < half.width; x++)
+        {
+            pasted.pixels[(size_t)(501 + y) * pasted.width + 777 + x] = half.pixels[(size_t)y * half.width + x];
+        }
+    }
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    struct ScaleCase
+    {
+        const char *name;
+        std::vector<double> scales;
+        size_t expect_min;
+    };
+    const ScaleCase cases[] = {
+        {"nan", {nan}, 0},
+        {"negative", {-1.0}, 0},
+        {"zero", {0.0}, 0},
+        {"infinity", {inf}, 0},
+        {"huge", {1e9}, 0},
+        {"tiny", {1e-9}, 0},
+        {"larger than haystack", {40.0}, 0},
+        {"mixed invalid + 1.0", {nan, -2.0, 1.0, 1e12}, 1},
+        {"0.5", {0.5}, 1},
+    };
+
+    for (auto &item : cases)
+    {
+        Options options;
+        options.scales = item.scales;
+        std::vector<Match> matches;
+        size_t count = find(pasted, needle, options, matches);
+        bool pass = count >= item.expect_min && (item.expect_min != 0 || count == 0);
+        if (item.scales.size() == 1 && item.scales[0] == 0.5)
+        {
+            pass = pass && hasExact(matches, 777, 501);
+        }
+        printf("  scale %-22s %zu match%s  %s\n", item.name, count, count == 1 ? "" : "es", pass ? "ok" : "FAIL");
+        ok = ok && pass;
+    }
+
+    // 模板比被搜索图像大  1 像素的模板
+    std::vector<Match> matches;
+    Gray small = crop(image, 0, 0, 8, 8);
+    bool larger = find(small, needle, Options(), matches) == 0;
+    Gray pixel = crop(image, 3, 5, 1, 1);
+    Options options;
+    options.threshold = 1.0;
+    options.limit = 1;
+    bool single = find(image, pixel, options, matches) == 1 && matches[0].score == 1.0;
+    printf("  needle larger than haystack %s  1x1 needle %s\n", larger ? "ok" : "FAIL", single ? "ok" : "FAIL");
+    return ok && larger && single;
+}
+
+// 单线程与多线程的结果一致
+static bool checkThreads(const Gray &image)
+{
+    Gray needle = crop(image, 1237, 903, 97, 61);
+    Options options;
+    options.threshold = 0.9;
+    options.scales = {1.0, 0.5};
+
+    std::vector<Match> single, multi;
+    options.threads = 1;
+    auto start = std::chrono::steady_clock::now();
+    find(image, needle, options, single);
+    double single_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    options.threads = 4;
+    start = std::chrono::steady_clock::now();
+    find(image, needle, options, multi);
+    double multi_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    bool same = single.size() == multi.size();
+    for (size_t i = 0; same && i < single.size(); i++)
+    {
+        same = single[i].x == multi[i].x && single[i].y == multi[i].y && single[i].score == multi[i].score;
+    }
+    bool found = hasExact(multi, 1237, 903);
+    printf("%dx%d 97x61  1 thread %.1f ms  4 threads %.1f ms  results %s  exact %s\n",
+           image.width, image.height, single_ms, multi_ms, same ? "match" : "MISMATCH", found ? "found" : "MISSING");
+    return same && found;
+}
+
+int main()
+{
+    int missed = 0;
+
+    Gray noise = makeNoise(1280, 720, 7);
+    missed += checkCrops("noise", noise, {564, 180, 99, 65}, 11, 40);
+
+    Gray repeated = makeRepeated(1280, 720, 8);
+    missed += checkCrops("repeated", repeated, {731, 68, 57, 19}, 12, 40);
+
+    Gray interface = makeInterface(1280, 720, 9);
+    missed += checkCrops("interface", interface, {}, 13, 40);
+
+    bool ok = checkScales(interface);
+    ok = checkThreads(makeInterface(3840, 2160, 10)) && ok;
+
+    return missed == 0 && ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+// hmc_pixel_search 基准测试 (不依赖 windows / node 可以单独编译)
+// 在合成的 BGRA 缓冲区上比较各个内核的结果与耗时
+// g++ -O2 -std=c++17 pixel_search_bench.cc ../CPP/util/hmc_pixel_search.cpp -o pixel_search_bench && ./pixel_search_bench
+#include "../CPP/util/hmc_pixel_search.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace hmc_pixel_search;
+
+// 4K 屏幕大小的噪声图像  alpha 随机 (BitBlt 得到的 alpha 不可靠)
+static std::vector<uint32_t> makeImage(int width, int height)
+{
+    std::vector<uint32_t> pixels((size_t)width * height);
+    uint32_t seed = 12345;
+    for (auto &pixel : pixels)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        // 避开 0x336699 附近 保证只有放置的目标会命中
+        pixel = (seed & 0xFF000000u) | ((seed >> 8) & 0x00FFFFFF) | 0x00800000u;
+    }
+    return pixels;
+}
+
+static double runMs(Kernel kernel, const Image &image, const Options &options, size_t &result, int rounds)
+{
+    std::vector<Point> output;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++)
+    {
+        result = search(image, options, output, kernel);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+static bool sameOutput(const Image &image, const Options &options, Kernel kernel)
+{
+    std::vector<Point> expect, actual;
+    size_t expect_count = search(image, options, expect, KERNEL_SCALAR);
+    size_t actual_count = search(image, options, actual, kernel);
+    if (expect_count != actual_count || expect.size() != actual.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < expect.size(); i++)
+    {
+        if (expect[i].x != actual[i].x || expect[i].y != actual[i].y)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    const int width = 3840;
+    const int height = 2160;
+    std::vector<uint32_t> pixels = makeImage(width, height);
+
+    // 目标颜色放在几个位置 (包括行尾不足一组 SIMD 宽度的列)
+    const uint32_t color = 0x336699;
+    const int targets[][2] = {{3000, 1900}, {3839, 2000}, {17, 2100}, {3837, 2159}, {640, 2100}};
+    for (auto &target : targets)
+    {
+        pixels[(size_t)target[1] * width + target[0]] = 0xFF000000u | (color + 0x010101);
+    }
+
+    Image image = {pixels.data(), width, height, (size_t)width};
+    const Kernel kernels[] = {KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2};
+
+    // 结果一致性 (各种模式 误差 步长 以及不足一组的宽度)
+    bool ok = true;
+    for (Kernel kernel : kernels)
+    {
+        if (!isSupported(kernel))
+        {
+            continue;
+        }
+        for (int mode = MODE_FIRST; mode <= MODE_COUNT; mode++)
+        {
+            for (int step : {1, 2, 3, 7})
+            {
+                for (int tolerance : {0, 1, 40})
+                {
+                    for (int sub_width : {width, 13, 3})
+                    {
+                        Options options;
+                        options.color = color;
+                        options.tolerance = tolerance;
+                        options.step = step;
+                        options.mode = (Mode)mode;
+                        Image sub_image = {pixels.data(), sub_width, height, (size_t)width};
+                        if (!sameOutput(sub_image, options, kernel))
+                        {
+                            printf("mismatch kernel=%s mode=%d step=%d tolerance=%d width=%d\n", kernelName(kernel), mode, step, tolerance, sub_width);
+                            ok = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    printf("best kernel: %s  results %s\n", kernelName(bestKernel()), ok ? "match" : "MISMATCH");
+
+    // 耗时 (整屏 找不到时需要扫描全部像素)
+    for (Kernel kernel : kernels)
+    {
+        if (!isSupported(kernel))
+        {
+            printf("%-6s  not supported\n", kernelName(kernel));
+            continue;
+        }
+
+        Options first;
+        first.color = color;
+        first.tolerance = 1;
+        size_t first_result = 0;
+        double first_ms = runMs(kernel, image, first, first_result, 20);
+
+        Options count = first;
+        count.mode = MODE_COUNT;
+        count.tolerance = 40;
+        size_t count_result = 0;
+        double count_ms = runMs(kernel, image, count, count_result, 20);
+
+        Options missing = first;
+        missing.color = 0x000000;
+        missing.tolerance = 0;
+        size_t missing_result = 0;
+        double missing_ms = runMs(kernel, image, missing, missing_result, 20);
+
+        printf("%-6s  first %.2f ms (%zu)  count %.2f ms (%zu)  not found %.2f ms  %.0f Mpx/s\n",
+               kernelName(kernel), first_ms, first_result, count_ms, count_result, missing_ms,
+               (double)width * height / missing_ms / 1000.0);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+// hmc_spsc_ring 基准测试 (不依赖 windows / node 可以单独编译)
+// g++ -O2 -std=c++17 -pthread spsc_ring_bench.cc -o spsc_ring_bench && ./spsc_ring_bench
+// 1. 吞吐: 生产者在缓冲区满时自旋等待 全部数据都经过缓冲区送达 统计送达速度
+// 2. 溢出: 生产者按固定速率写入 消费者每 16ms 取一次 (模拟 js 的投递间隔) 统计丢弃比例
+#include "../CPP/util/hmc_spsc_ring.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+struct bench_keyboard_record
+{
+    uint32_t vkCode;
+    uint32_t flags;
+    uint32_t time;
+};
+
+typedef hmc_spsc_ring::SpscRing<bench_keyboard_record, 4096> BenchRing;
+
+// 取出并检查顺序  返回本次取出的数量
+static size_t drainChecked(BenchRing &ring, std::vector<bench_keyboard_record> &batch, size_t &received, uint32_t &last_time, bool &ordered)
+{
+    batch.clear();
+    size_t count = ring.drain(batch);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (received != 0 && batch[i].time <= last_time)
+        {
+            ordered = false;
+        }
+        last_time = batch[i].time;
+        received++;
+    }
+    return count;
+}
+
+// 满了就让出时间片重试 不丢弃
+static bool runThroughput(size_t total)
+{
+    static BenchRing ring;
+    ring.clear();
+    ring.reset_counter();
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&]()
+                         {
+        for (size_t i = 0; i < total; i++)
+        {
+            bench_keyboard_record record{(uint32_t)(i & 0xFF), (uint32_t)(i & 0x80), (uint32_t)i};
+            while (!ring.push(record))
+            {
+                std::this_thread::yield();
+            }
+        } });
+
+    size_t received = 0;
+    uint32_t last_time = 0;
+    bool ordered = true;
+    std::vector<bench_keyboard_record> batch;
+    batch.reserve(4096);
+
+    while (received < total)
+    {
+        if (drainChecked(ring, batch, received, last_time, ordered) == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    // 满时的失败重试也会计入 overflow  这里只用于说明生产者等待了多少次
+    std::printf("throughput  delivered: %zu / %zu  ordered: %s  full retries: %llu\n",
+                received, total, ordered ? "yes" : "no", (unsigned long long)ring.overflow());
+    std::printf("            time: %.2f ms  (%.2f ns/event  %.1f M events/s)\n",
+                ms, ms * 1e6 / (double)total, (double)total / ms / 1000);
+
+    return received == total && ordered;
+}
+
+// 按 rate 个/秒 写入 duration_ms 毫秒  消费者每 16ms 取一次
+static bool runPaced(double rate, int duration_ms)
+{
+    static BenchRing ring;
+    ring.clear();
+    ring.reset_counter();
+
+    const auto interval = std::chrono::duration<double>(1.0 / rate);
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::milliseconds(duration_ms);
+    size_t attempted = 0;
+
+    std::thread producer([&]()
+                         {
+        // 按时间计算应写入的数量 追上进度后让出时间片
+        auto now = std::chrono::steady_clock::now();
+        while (now < end)
+        {
+            size_t due = (size_t)((now - start) / interval);
+            for (; attempted < due; attempted++)
+            {
+                ring.push(bench_keyboard_record{(uint32_t)(attempted & 0xFF), 0, (uint32_t)attempted});
+            }
+            std::this_thread::yield();
+            now = std::chrono::steady_clock::now();
+        } });
+
+    size_t received = 0;
+    uint32_t last_time = 0;
+    bool ordered = true;
+    std::vector<bench_keyboard_record> batch;
+    batch.reserve(4096);
+
+    while (std::chrono::steady_clock::now() < end)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        drainChecked(ring, batch, received, last_time, ordered);
+    }
+    producer.join();
+    drainChecked(ring, batch, received, last_time, ordered);
+
+    unsigned long long overflow = (unsigned long long)ring.overflow();
+    std::printf("paced %8.0f/s  pushed: %zu  delivered: %zu  overflow: %llu (%.2f%%)  ordered: %s\n",
+                rate, attempted, received, overflow, attempted == 0 ? 0.0 : 100.0 * (double)overflow / (double)attempted,
+                ordered ? "yes" : "no");
+
+    return received + overflow == attempted && ordered;
+}
+
+int main()
+{
+    bool ok = runThroughput(20000000);
+
+    // 4096 个槽位 每 16ms 取一次: 约 25 万个/秒 以内不应丢弃
+    for (double rate : {1000.0, 100000.0, 1000000.0})
+    {
+        ok = runPaced(rate, 500) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+// hmc_tile_diff 基准测试 (不依赖 windows / node 可以单独编译)
+// 各个内核的脏块与逐像素比较的结果一致: 第一帧全部为脏块  四个角的单个像素  每行超出 width 的部分 (stride > width) 不算变化
+// g++ -O2 -std=c++17 tile_diff_bench.cc ../CPP/util/hmc_tile_diff.cpp -o tile_diff_bench && ./tile_diff_bench
+#include "../CPP/util/hmc_tile_diff.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace hmc_tile_diff;
+
+// 只用高位 (线性同余的低位周期很短)
+static uint32_t nextRandom(uint32_t &seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 16;
+}
+
+struct Frame
+{
+    int width;
+    int height;
+    size_t stride;
+    std::vector<uint32_t> pixels;
+
+    uint32_t &at(int x, int y) { return pixels[(size_t)y * stride + x]; }
+};
+
+static Frame makeFrame(int width, int height, size_t stride, uint32_t seed)
+{
+    Frame frame = {width, height, stride, std::vector<uint32_t>(stride * height)};
+    for (auto &pixel : frame.pixels)
+    {
+        pixel = nextRandom(seed) | (nextRandom(seed) << 16);
+    }
+    return frame;
+}
+
+// 逐像素比较得到的脏块 (与实现无关)  再按同一行相邻合并
+static void expectRects(const Frame &frame, const Frame *previous, int tile_size, std::vector<int32_t> &rects, std::vector<uint32_t> &pixels)
+{
+    int columns = (frame.width + tile_size - 1) / tile_size;
+    int rows = (frame.height + tile_size - 1) / tile_size;
+    std::vector<uint8_t> dirty((size_t)columns * rows, previous == NULL ? 1 : 0);
+    if (previous != NULL)
+    {
+        for (int y = 0; y < frame.height; y++)
+        {
+            for (int x = 0; x < frame.width; x++)
+            {
+                if (frame.pixels[(size_t)y * frame.stride + x] != previous->pixels[(size_t)y * previous->stride + x])
+                {
+                    dirty[(size_t)(y / tile_size) * columns + x / tile_size] = 1;
+                }
+            }
+        }
+    }
+
+    rects.clear();
+    pixels.clear();
+    for (int tile_y = 0; tile_y < rows; tile_y++)
+    {
+        for (int tile_x = 0; tile_x < columns; tile_x++)
+        {
+            if (!dirty[(size_t)tile_y * columns + tile_x])
+            {
+                continue;
+            }
+            int first = tile_x;
+            while (tile_x + 1 < columns && dirty[(size_t)tile_y * columns + tile_x + 1])
+            {
+                tile_x++;
+            }
+            int left = first * tile_size;
+            int top = tile_y * tile_size;
+            int width = std::min((tile_x + 1) * tile_size, frame.width) - left;
+            int height = std::min(top + tile_size, frame.height) - top;
+            rects.insert(rects.end(), {left, top, width, height});
+            for (int y = top; y < top + height; y++)
+            {
+                for (int x = left; x < left + width; x++)
+                {
+                    pixels.push_back(frame.pixels[(size_t)y * frame.stride + x]);
+                }
+            }
+        }
+    }
+}
+
+// 更新一帧并取出  与逐像素比较的结果相同
+static bool checkFrame(TileDiff &diff, const Frame &frame, const Frame *previous, const char *step)
+{
+    std::vector<int32_t> expect_rects, rects;
+    std::vector<uint32_t> expect_pixels, pixels;
+    expectRects(frame, previous, diff.tileSize(), expect_rects, expect_pixels);
+
+    diff.update(frame.pixels.data(), frame.width, frame.height, frame.stride);
+    diff.take(rects, pixels);
+    if (rects != expect_rects || pixels != expect_pixels)
+    {
+        printf("  %s: %zu rects (expect %zu)\n", step, rects.size() / 4, expect_rects.size() / 4);
+        return false;
+    }
+    return true;
+}
+
+static bool checkKernel(Kernel kernel, int width, int height, size_t stride, int tile_size)
+{
+    bool ok = true;
+    uint32_t seed = (uint32_t)(width * 31 + height * 17 + stride);
+    TileDiff diff(tile_size, kernel);
+
+    // 第一帧全部为脏块
+    Frame previous = makeFrame(width, height, stride, seed);
+    ok = checkFrame(diff, previous, NULL, "first frame") && ok;
+
+    // 没有变化
+    ok = checkFrame(diff, previous, &previous, "unchanged") && ok;
+
+    // 每行超出 width 的部分变化 不算脏块
+    if (stride > (size_t)width)
+    {
+        Frame frame = previous;
+        for (int y = 0; y < height; y++)
+        {
+            for (size_t x = width; x < stride; x++)
+            {
+                frame.pixels[(size_t)y * stride + x] ^= 0xFFFFFFFFu;
+            }
+        }
+        ok = checkFrame(diff, frame, &previous, "stride padding") && ok;
+        previous = frame;
+    }
+
+    // 四个角的单个像素 (只改变一个字节的一位)
+    const int corners[][2] = {{0, 0}, {width - 1, 0}, {0, height - 1}, {width - 1, height - 1}};
+    for (auto &corner : corners)
+    {
+        Frame frame = previous;
+        frame.at(corner[0], corner[1]) ^= 0x01000000u;
+        char step[64];
+        snprintf(step, sizeof(step), "corner (%d,%d)", corner[0], corner[1]);
+        ok = checkFrame(diff, frame, &previous, step) && ok;
+        previous = frame;
+    }
+
+    // 随机位置
+    for (int round = 0; round < 20; round++)
+    {
+        Frame frame = previous;
+        int count = 1 + (int)(nextRandom(seed) % 12);
+        for (int i = 0; i < count; i++)
+        {
+            frame.at((int)(nextRandom(seed) % width), (int)(nextRandom(seed) % height)) ^= 1u << (nextRandom(seed) % 32);
+        }
+        ok = checkFrame(diff, frame, &previous, "random pixels") && ok;
+        previous = frame;
+    }
+
+    // reset 之后全部为脏块  尺寸变化同样
+    diff.reset();
+    ok = checkFrame(diff, previous, NULL, "after reset") && ok;
+    Frame taller = makeFrame(width, height + 1, stride, seed);
+    ok = checkFrame(diff, taller, NULL, "resized") && ok;
+
+    if (!ok)
+    {
+        printf("mismatch kernel=%s %dx%d stride=%zu tile=%d\n", kernelName(kernel), width, height, stride, tile_size);
+    }
+    return ok;
+}
+
+int main()
+{
+    const Kernel kernels[] = {KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2};
+
+    // 宽度包括不足一组 SIMD 宽度的块  以及块大小不整除的边缘
+    struct Size
+    {
+        int width;
+        int height;
+        int padding;
+        int tile_size;
+    };
+    const Size sizes[] = {
+        {200, 130, 0, 64},
+        {200, 130, 13, 64},
+        {67, 45, 5, 16},
+        {1, 1, 3, 64},
+        {9, 70, 0, 8},
+        {1920, 1080, 64, 64},
+    };
+
+    bool ok = true;
+    for (Kernel kernel : kernels)
+    {
+        if (!isSupported(kernel))
+        {
+            printf("%-6s  not supported\n", kernelName(kernel));
+            continue;
+        }
+        bool kernel_ok = true;
+        for (auto &size : sizes)
+        {
+            kernel_ok = checkKernel(kernel, size.width, size.height, (size_t)(size.width + size.padding), size.tile_size) && kernel_ok;
+        }
+        printf("%-6s  results %s\n", kernelName(kernel), kernel_ok ? "match" : "MISMATCH");
+        ok = ok && kernel_ok;
+    }
+
+    // 耗时 (4K 没有变化时需要比较全部像素  以及少量变化)
+    const int width = 3840;
+    const int height = 2160;
+    Frame frame = makeFrame(width, height, width, 1);
+    for (Kernel kernel : kernels)
+    {
+        if (!isSupported(kernel))
+        {
+            continue;
+        }
+        TileDiff diff(TILE_SIZE, kernel);
+        std::vector<int32_t> rects;
+        std::vector<uint32_t> pixels;
+        diff.update(frame.pixels.data(), width, height, width);
+        diff.take(rects, pixels);
+
+        const int rounds = 20;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++)
+        {
+            diff.update(frame.pixels.data(), width, height, width);
+        }
+        double unchanged_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / rounds;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++)
+        {
+            frame.at(100 + i, 200 + i * 50)++;
+            frame.at(3000 - i, 1900 - i * 30)++;
+            diff.update(frame.pixels.data(), width, height, width);
+            diff.take(rects, pixels);
+        }
+        double changed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / rounds;
+
+        printf("%-6s  unchanged %.2f ms  2 pixels changed %.2f ms  %.0f Mpx/s\n",
+               kernelName(kernel), unchanged_ms, changed_ms, (double)width * height / unchanged_ms / 1000.0);
+    }
+
+    return ok ? 0 : 1;
+}